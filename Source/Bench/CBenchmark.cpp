@@ -0,0 +1,219 @@
+/*******************************************
+	CBenchmark.cpp
+
+	Simple microbenchmark runner
+********************************************/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+#include "CBenchmark.h"
+#include "CTimer.h"
+
+namespace gen
+{
+
+volatile TFloat32 BenchSink = 0.0f;
+
+
+// Quote a CSV field if it contains a comma, quote or line break, doubling any quotes inside
+static string EscapeCSV( const string& text )
+{
+	if (text.find_first_of( ",\"\r\n" ) == string::npos)
+	{
+		return text;
+	}
+	string escaped = "\"";
+	for (TUInt32 i = 0; i < text.size(); ++i)
+	{
+		if (text[i] == '"')
+		{
+			escaped += '"';
+		}
+		escaped += text[i];
+	}
+	return escaped + "\"";
+}
+
+// Escape the contents of a JSON string - quotes, backslashes and control characters
+static string EscapeJSON( const string& text )
+{
+	string escaped;
+	for (TUInt32 i = 0; i < text.size(); ++i)
+	{
+		char c = text[i];
+		if (c == '"' || c == '\\')
+		{
+			escaped += '\\';
+			escaped += c;
+		}
+		else if (static_cast<unsigned char>(c) < 0x20)
+		{
+			char code[8];
+			sprintf( code, "\\u%04x", static_cast<unsigned int>(c) );
+			escaped += code;
+		}
+		else
+		{
+			escaped += c;
+		}
+	}
+	return escaped;
+}
+
+
+// Constructor may be passed the number of timed repetitions and the minimum time (seconds)
+// for each repetition. The number of operations per repetition is calibrated during warmup
+CBenchmark::CBenchmark( TUInt32 numReps /*= 15*/, TFloat32 minRepTime /*= 0.01f*/ )
+{
+	m_NumReps = numReps > 0 ? numReps : 1;
+	m_MinRepTime = minRepTime;
+}
+
+
+// Add a benchmark to the suite
+void CBenchmark::Add( const string& group, const string& name, TBenchFunc func )
+{
+	SBench bench;
+	bench.group = group;
+	bench.name = name;
+	bench.func = func;
+	m_Benches.push_back( bench );
+}
+
+
+// Run all (filtered) benchmarks, printing a line for each one as it completes
+void CBenchmark::Run()
+{
+	m_Results.clear();
+
+	printf( "%-14s %-24s %10s %10s %10s %8s %14s\n",
+	        "Group", "Benchmark", "min ns/op", "med ns/op", "mean ns/op", "stddev", "ops/sec" );
+	for (TUInt32 i = 0; i < m_Benches.size(); ++i)
+	{
+		const SBench& bench = m_Benches[i];
+		if (!m_Filter.empty() && (bench.group + "." + bench.name).find( m_Filter ) == string::npos)
+		{
+			continue;
+		}
+
+		SBenchResult result = RunOne( bench );
+		m_Results.push_back( result );
+		printf( "%-14s %-24s %10.2f %10.2f %10.2f %8.2f %14.0f\n", result.group.c_str(),
+		        result.name.c_str(), result.minNs, result.medianNs, result.meanNs,
+		        result.stdDevNs, result.opsPerSec );
+	}
+}
+
+
+// Run a single benchmark and return its statistics
+SBenchResult CBenchmark::RunOne( const SBench& bench )
+{
+	CTimer timer;
+	timer.Start();
+
+	// Warmup / calibration - double the operation count until a repetition takes long enough.
+	// This also brings code and data into cache and lets the CPU clock settle
+	TUInt32 numOps = 64;
+	while (true)
+	{
+		timer.GetLapTime();
+		bench.func( numOps );
+		if (timer.GetLapTime() >= m_MinRepTime || numOps >= 0x40000000)
+		{
+			break;
+		}
+		numOps *= 2;
+	}
+	bench.func( numOps ); // One more untimed repetition at the final count
+
+	// Timed repetitions
+	vector<TFloat64> samples( m_NumReps );
+	for (TUInt32 rep = 0; rep < m_NumReps; ++rep)
+	{
+		timer.GetLapTime();
+		bench.func( numOps );
+		samples[rep] = timer.GetLapTime() * 1.0e9 / numOps;
+	}
+
+	// Statistics
+	SBenchResult result;
+	result.group = bench.group;
+	result.name = bench.name;
+	result.opsPerRep = numOps;
+	result.numReps = m_NumReps;
+
+	TFloat64 sum = 0.0;
+	for (TUInt32 rep = 0; rep < m_NumReps; ++rep)
+	{
+		sum += samples[rep];
+	}
+	result.meanNs = sum / m_NumReps;
+
+	TFloat64 sumSq = 0.0;
+	for (TUInt32 rep = 0; rep < m_NumReps; ++rep)
+	{
+		sumSq += (samples[rep] - result.meanNs) * (samples[rep] - result.meanNs);
+	}
+	result.stdDevNs = m_NumReps > 1 ? sqrt( sumSq / (m_NumReps - 1) ) : 0.0;
+
+	sort( samples.begin(), samples.end() );
+	result.minNs = samples[0];
+	result.medianNs = (m_NumReps % 2) ? samples[m_NumReps / 2] :
+	                  0.5 * (samples[m_NumReps / 2 - 1] + samples[m_NumReps / 2]);
+	result.opsPerSec = result.medianNs > 0.0 ? 1.0e9 / result.medianNs : 0.0;
+
+	return result;
+}
+
+
+// Write results of the last run to a file as CSV. Return false on failure
+bool CBenchmark::WriteCSV( const string& fileName )
+{
+	FILE* file = fopen( fileName.c_str(), "w" );
+	if (!file)
+	{
+		return false;
+	}
+
+	fprintf( file, "label,group,name,ops_per_rep,reps,min_ns,median_ns,mean_ns,stddev_ns,ops_per_sec\n" );
+	for (TUInt32 i = 0; i < m_Results.size(); ++i)
+	{
+		const SBenchResult& r = m_Results[i];
+		fprintf( file, "%s,%s,%s,%u,%u,%.4f,%.4f,%.4f,%.4f,%.1f\n", EscapeCSV( m_Label ).c_str(),
+		         EscapeCSV( r.group ).c_str(), EscapeCSV( r.name ).c_str(), r.opsPerRep, r.numReps,
+		         r.minNs, r.medianNs, r.meanNs, r.stdDevNs, r.opsPerSec );
+	}
+
+	fclose( file );
+	return true;
+}
+
+// Write results of the last run to a file as JSON. Return false on failure
+bool CBenchmark::WriteJSON( const string& fileName )
+{
+	FILE* file = fopen( fileName.c_str(), "w" );
+	if (!file)
+	{
+		return false;
+	}
+
+	fprintf( file, "{\n  \"label\": \"%s\",\n  \"results\": [\n", EscapeJSON( m_Label ).c_str() );
+	for (TUInt32 i = 0; i < m_Results.size(); ++i)
+	{
+		const SBenchResult& r = m_Results[i];
+		fprintf( file, "    { \"group\": \"%s\", \"name\": \"%s\", \"ops_per_rep\": %u, \"reps\": %u, "
+		               "\"min_ns\": %.4f, \"median_ns\": %.4f, \"mean_ns\": %.4f, \"stddev_ns\": %.4f, "
+		               "\"ops_per_sec\": %.1f }%s\n",
+		         EscapeJSON( r.group ).c_str(), EscapeJSON( r.name ).c_str(), r.opsPerRep, r.numReps,
+		         r.minNs, r.medianNs, r.meanNs, r.stdDevNs, r.opsPerSec, (i + 1 < m_Results.size()) ? "," : "" );
+	}
+	fprintf( file, "  ]\n}\n" );
+
+	fclose( file );
+	return true;
+}
+
+
+} // namespace gen
@@ -0,0 +1,129 @@
+/*******************************************
+	CBenchmark.h
+
+	Simple microbenchmark runner
+********************************************/
+
+#pragma once
+
+#include <string>
+#include <vector>
+using namespace std;
+
+#include "Defines.h"
+
+namespace gen
+{
+
+// A benchmark function runs the operation being measured the given number of times
+typedef void (*TBenchFunc)( TUInt32 numOps );
+
+
+// Statistics collected for a single benchmark
+struct SBenchResult
+{
+	string   group;      // Group the benchmark belongs to (e.g. "CMatrix4x4")
+	string   name;       // Name of the benchmark (e.g. "Inverse")
+	TUInt32  opsPerRep;  // Operations performed in each timed repetition
+	TUInt32  numReps;    // Number of timed repetitions
+	TFloat64 minNs;      // Nanoseconds per operation - fastest, median, mean and standard deviation
+	TFloat64 medianNs;   //   of all repetitions
+	TFloat64 meanNs;
+	TFloat64 stdDevNs;
+	TFloat64 opsPerSec;  // Throughput derived from the median
+};
+
+
+/*-----------------------------------------------------------------------------------------
+-------------------------------------------------------------------------------------------
+	Benchmark Runner Class
+-------------------------------------------------------------------------------------------
+-----------------------------------------------------------------------------------------*/
+
+// Runs registered benchmarks with a warmup phase and repeated timed samples, then reports
+// the results to the console and as CSV / JSON so runs can be compared between commits
+class CBenchmark
+{
+/////////////////////////////////////
+//	Constructors/Destructors
+public:
+	// Constructor may be passed the number of timed repetitions and the minimum time (seconds)
+	// for each repetition. The number of operations per repetition is calibrated during warmup
+	CBenchmark( TUInt32 numReps = 15, TFloat32 minRepTime = 0.01f );
+
+
+/////////////////////////////////////
+//	Public interface
+public:
+
+	/////////////////////////////////////
+	// Setup
+
+	// Add a benchmark to the suite
+	void Add( const string& group, const string& name, TBenchFunc func );
+
+	// Only run benchmarks whose "group.name" contains this string (empty string runs all)
+	void SetFilter( const string& filter )
+	{
+		m_Filter = filter;
+	}
+
+	// Set a label written with the results, e.g. a commit id
+	void SetLabel( const string& label )
+	{
+		m_Label = label;
+	}
+
+
+	/////////////////////////////////////
+	// Running / Output
+
+	// Run all (filtered) benchmarks, printing a line for each one as it completes
+	void Run();
+
+	// Access results of the last run
+	const vector<SBenchResult>& GetResults()
+	{
+		return m_Results;
+	}
+
+	// Write results of the last run to a file as CSV or JSON. Return false on failure
+	bool WriteCSV( const string& fileName );
+	bool WriteJSON( const string& fileName );
+
+
+/////////////////////////////////////
+//	Private interface
+private:
+
+	// Registered benchmark
+	struct SBench
+	{
+		string     group;
+		string     name;
+		TBenchFunc func;
+	};
+
+	// Run a single benchmark and return its statistics
+	SBenchResult RunOne( const SBench& bench );
+
+
+	// Timed repetitions per benchmark and minimum time for each repetition
+	TUInt32  m_NumReps;
+	TFloat32 m_MinRepTime;
+
+	// Registered benchmarks and results of last run
+	vector<SBench>       m_Benches;
+	vector<SBenchResult> m_Results;
+
+	string m_Filter;
+	string m_Label;
+};
+
+
+// Sink for benchmark results. Benchmarks should accumulate their results into this to prevent
+// the compiler removing the work being measured
+extern volatile TFloat32 BenchSink;
+
+
+} // namespace gen
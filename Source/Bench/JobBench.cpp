@@ -0,0 +1,217 @@
+/*******************************************
+	JobBench.cpp
+
+	Microbenchmarks for the job system - job
+	overhead, parallel for and stealing
+
+	Usage: JobBench [-threads N] [-reps N] [-filter text] [-label text] [-csv file] [-json file]
+	  -threads Total threads including the main thread (default one per hardware thread)
+	  -reps    Number of timed repetitions per benchmark (default 15)
+	  -filter  Only run benchmarks whose "Group.Name" contains the text
+	  -label   Label stored with the results (e.g. a commit id) to help compare runs
+	  -csv     Write results as CSV to the given file
+	  -json    Write results as JSON to the given file
+********************************************/
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "CBenchmark.h"
+#include "CJobSystem.h"
+#include "BaseMath.h"
+
+using namespace gen;
+
+namespace
+{
+
+/*-----------------------------------------------------------------------------------------
+	Job system and work
+-----------------------------------------------------------------------------------------*/
+// Benchmarks share one job system, started before they run. Each operation is one item of
+// work, so the results show the cost of the job system per item at each grain size
+
+CJobSystem JobSystem;
+
+// Jobs created at once by the steal benchmark, well within the ring of jobs for one thread
+const TUInt32 kStealBatch = 1024;
+
+// Items of data worked on, cycled through so the work stays in cache. A power of 2
+const TUInt32 kDataSize = 4096;
+const TUInt32 kDataMask = kDataSize - 1;
+TFloat32 Data[kDataSize];
+
+// A small amount of work on one item
+inline TFloat32 ItemWork( TUInt32 item )
+{
+	return Sqrt( Data[item & kDataMask] );
+}
+
+// Job doing the work for its range of items, adding the result to the sink. Races on the sink
+// don't matter, it only stops the work being optimised away
+void ItemJob( SJob* job )
+{
+	TFloat32 sum = 0.0f;
+	for (TUInt32 item = job->begin; item < job->end; ++item)
+	{
+		sum += ItemWork( item );
+	}
+	BenchSink = sum;
+}
+
+void EmptyJob( SJob* )
+{
+}
+
+
+/*-----------------------------------------------------------------------------------------
+	Benchmarks
+-----------------------------------------------------------------------------------------*/
+
+/////////////////////////////////////
+// Jobs
+
+// Create, run and wait for one empty job at a time - the fixed cost of a job
+void BenchCreateRunWait( TUInt32 numOps )
+{
+	for (TUInt32 i = 0; i < numOps; ++i)
+	{
+		SJob* job = JobSystem.CreateJob( EmptyJob );
+		JobSystem.Run( job );
+		JobSystem.Wait( job );
+	}
+}
+
+// One job per item, all created on the main thread as children of a root job. Other threads
+// only get work by stealing from the front of the main thread's queue
+void BenchSteal( TUInt32 numOps )
+{
+	for (TUInt32 batch = 0; batch < numOps; batch += kStealBatch)
+	{
+		TUInt32 batchEnd = Min( batch + kStealBatch, numOps );
+		SJob* root = JobSystem.CreateJob( EmptyJob );
+		for (TUInt32 item = batch; item < batchEnd; ++item)
+		{
+			JobSystem.Run( JobSystem.CreateJob( ItemJob, 0, item, item + 1, root ) );
+		}
+		JobSystem.Run( root );
+		JobSystem.Wait( root );
+	}
+}
+
+
+/////////////////////////////////////
+// Parallel for
+
+// Parallel for over all items with the given grain size
+template <TUInt32 GrainSize>
+void BenchParallelFor( TUInt32 numOps )
+{
+	JobSystem.ParallelFor( 0, numOps, GrainSize, []( TUInt32 begin, TUInt32 end )
+	{
+		TFloat32 sum = 0.0f;
+		for (TUInt32 item = begin; item < end; ++item)
+		{
+			sum += ItemWork( item );
+		}
+		BenchSink = sum;
+	} );
+}
+
+// The same work on the main thread alone, for comparison
+void BenchSerialFor( TUInt32 numOps )
+{
+	TFloat32 sum = 0.0f;
+	for (TUInt32 item = 0; item < numOps; ++item)
+	{
+		sum += ItemWork( item );
+	}
+	BenchSink = sum;
+}
+
+} // namespace
+
+
+/*-----------------------------------------------------------------------------------------
+	Main
+-----------------------------------------------------------------------------------------*/
+
+int main( int argc, char* argv[] )
+{
+	TUInt32 numThreads = 0;
+	TUInt32 numReps = 15;
+	string filter, label, csvFile, jsonFile;
+	for (int arg = 1; arg < argc; ++arg)
+	{
+		if (arg + 1 < argc)
+		{
+			if (!strcmp( argv[arg], "-threads" ))
+			{
+				numThreads = atoi( argv[++arg] );
+				continue;
+			}
+			if (!strcmp( argv[arg], "-reps" ))
+			{
+				numReps = atoi( argv[++arg] );
+				continue;
+			}
+			if (!strcmp( argv[arg], "-filter" ))
+			{
+				filter = argv[++arg];
+				continue;
+			}
+			if (!strcmp( argv[arg], "-label" ))
+			{
+				label = argv[++arg];
+				continue;
+			}
+			if (!strcmp( argv[arg], "-csv" ))
+			{
+				csvFile = argv[++arg];
+				continue;
+			}
+			if (!strcmp( argv[arg], "-json" ))
+			{
+				jsonFile = argv[++arg];
+				continue;
+			}
+		}
+		printf( "Usage: JobBench [-threads N] [-reps N] [-filter text] [-label text] [-csv file] [-json file]\n" );
+		return 1;
+	}
+
+	for (TUInt32 i = 0; i < kDataSize; ++i)
+	{
+		Data[i] = static_cast<TFloat32>(i + 1);
+	}
+	JobSystem.Start( numThreads );
+	printf( "Threads: %d\n", JobSystem.NumThreads() );
+
+	CBenchmark bench( numReps );
+	bench.SetFilter( filter );
+	bench.SetLabel( label );
+
+	bench.Add( "Job", "CreateRunWait", BenchCreateRunWait );
+	bench.Add( "Job", "Steal", BenchSteal );
+
+	bench.Add( "ParallelFor", "Serial", BenchSerialFor );
+	bench.Add( "ParallelFor", "Grain16", BenchParallelFor<16> );
+	bench.Add( "ParallelFor", "Grain256", BenchParallelFor<256> );
+	bench.Add( "ParallelFor", "Grain4096", BenchParallelFor<4096> );
+
+	bench.Run();
+	JobSystem.Stop();
+
+	if (!csvFile.empty() && !bench.WriteCSV( csvFile ))
+	{
+		printf( "Error writing %s\n", csvFile.c_str() );
+		return 1;
+	}
+	if (!jsonFile.empty() && !bench.WriteJSON( jsonFile ))
+	{
+		printf( "Error writing %s\n", jsonFile.c_str() );
+		return 1;
+	}
+	return 0;
+}
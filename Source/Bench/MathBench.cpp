@@ -0,0 +1,695 @@
+/*******************************************
+	MathBench.cpp
+
+	Microbenchmarks for the math library
+
+	Usage: MathBench [-reps N] [-filter text] [-label text] [-csv file] [-json file]
+	  -reps    Number of timed repetitions per benchmark (default 15)
+	  -filter  Only run benchmarks whose "Group.Name" contains the text
+	  -label   Label stored with the results (e.g. a commit id) to help compare runs
+	  -csv     Write results as CSV to the given file
+	  -json    Write results as JSON to the given file
+********************************************/
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "CBenchmark.h"
+#include "BaseMath.h"
+#include "CVector2.h"
+#include "CVector3.h"
+#include "CVector4.h"
+#include "CMatrix2x2.h"
+#include "CMatrix3x3.h"
+#include "CMatrix4x4.h"
+#include "CQuaternion.h"
+#include "CQuatTransform.h"
+#include "FastMath.h"
+#include "Geometry.h"
+
+using namespace gen;
+
+namespace
+{
+
+/*-----------------------------------------------------------------------------------------
+	Input data
+-----------------------------------------------------------------------------------------*/
+// Benchmarks cycle through small arrays of random inputs, which stay in L1 cache so the
+// results measure the math rather than memory. Size must be a power of 2
+
+const TUInt32 kDataSize = 256;
+const TUInt32 kDataMask = kDataSize - 1;
+
+TFloat32       Floats[kDataSize];   // In range [0.01, 100]
+TFloat32       Angles[kDataSize];   // In range [-pi, pi]
+TFloat32       Unit[kDataSize];     // In range [-1, 1]
+CVector2       Vec2s[kDataSize];
+CVector3       Vec3s[kDataSize];
+CVector4       Vec4s[kDataSize];
+CMatrix2x2     Mat2s[kDataSize];
+CMatrix3x3     Mat3s[kDataSize];
+CMatrix4x4     Mat4s[kDataSize];
+CQuaternion    Quats[kDataSize];
+CQuatTransform QuatTransforms[kDataSize];
+SAABB          Boxes[kDataSize];
+SSphere        Spheres[kDataSize];
+SSegment       Segments[kDataSize];
+SAABB4         Box4s[kDataSize / 4];     // Same as Boxes and Spheres, four at a time
+SSphere4       Sphere4s[kDataSize / 4];
+
+// Fill input arrays with random (but repeatable) data
+void InitData()
+{
+	srand( 1 );
+	for (TUInt32 i = 0; i < kDataSize; ++i)
+	{
+		Floats[i] = Random( 0.01f, 100.0f );
+		Angles[i] = Random( -kfPi, kfPi );
+		Unit[i] = Random( -1.0f, 1.0f );
+
+		CVector3 position( Random( -100.0f, 100.0f ), Random( -100.0f, 100.0f ), Random( -100.0f, 100.0f ) );
+		CVector3 rotation( Random( -kfPi, kfPi ), Random( -kfPi, kfPi ), Random( -kfPi, kfPi ) );
+		CVector3 scale( Random( 0.5f, 2.0f ), Random( 0.5f, 2.0f ), Random( 0.5f, 2.0f ) );
+
+		Vec2s[i] = CVector2( position.x, position.y );
+		Vec3s[i] = position;
+		Vec4s[i] = CVector4( position, 1.0f );
+		Mat2s[i] = CMatrix2x2( rotation.x, CVector2( scale.x, scale.y ) );
+		Mat3s[i] = CMatrix3x3( rotation, kZXY, scale );
+		Mat4s[i] = CMatrix4x4( position, rotation, kZXY, scale );
+		Quats[i] = CQuaternion( CMatrix4x4( CVector3::kOrigin, rotation ) );
+		QuatTransforms[i] = CQuatTransform( Mat4s[i] );
+
+		// Boxes and spheres of size 1-20 in a region 100 units across, segments 50 units long on
+		// average, so roughly half of the tests hit
+		CVector3 centre( Random( -50.0f, 50.0f ), Random( -50.0f, 50.0f ), Random( -50.0f, 50.0f ) );
+		CVector3 extents( Random( 0.5f, 10.0f ), Random( 0.5f, 10.0f ), Random( 0.5f, 10.0f ) );
+		Boxes[i].minPt = centre - extents;
+		Boxes[i].maxPt = centre + extents;
+		Spheres[i].centre = centre;
+		Spheres[i].radius = extents.x;
+		Segments[i].start = CVector3( Random( -50.0f, 50.0f ), Random( -50.0f, 50.0f ), Random( -50.0f, 50.0f ) );
+		Segments[i].end = Segments[i].start + CVector3( Random( -50.0f, 50.0f ), Random( -50.0f, 50.0f ),
+		                                                Random( -50.0f, 50.0f ) );
+		Box4s[i / 4].Set( i % 4, Boxes[i] );
+		Sphere4s[i / 4].Set( i % 4, Spheres[i] );
+	}
+}
+
+
+/*-----------------------------------------------------------------------------------------
+	Benchmarks
+-----------------------------------------------------------------------------------------*/
+// Each benchmark performs numOps operations on the input data and accumulates something from
+// the result into BenchSink so the work cannot be optimised away
+
+/////////////////////////////////////
+// BaseMath
+
+void BenchSqrt( TUInt32 numOps )
+{
+	TFloat32 sum = 0.0f;
+	for (TUInt32 i = 0; i < numOps; ++i)
+	{
+		sum += Sqrt( Floats[i & kDataMask] );
+	}
+	BenchSink = sum;
+}
+
+void BenchInvSqrt( TUInt32 numOps )
+{
+	TFloat32 sum = 0.0f;
+	for (TUInt32 i = 0; i < numOps; ++i)
+	{
+		sum += InvSqrt( Floats[i & kDataMask] );
+	}
+	BenchSink = sum;
+}
+
+void BenchSinCos( TUInt32 numOps )
+{
+	TFloat32 sum = 0.0f;
+	for (TUInt32 i = 0; i < numOps; ++i)
+	{
+		TFloat32 s, c;
+		SinCos( Angles[i & kDataMask], &s, &c );
+		sum += s + c;
+	}
+	BenchSink = sum;
+}
+
+void BenchACos( TUInt32 numOps )
+{
+	TFloat32 sum = 0.0f;
+	for (TUInt32 i = 0; i < numOps; ++i)
+	{
+		sum += ACos( Unit[i & kDataMask] );
+	}
+	BenchSink = sum;
+}
+
+void BenchRandom( TUInt32 numOps )
+{
+	TFloat32 sum = 0.0f;
+	for (TUInt32 i = 0; i < numOps; ++i)
+	{
+		sum += Random( 0.0f, 1.0f );
+	}
+	BenchSink = sum;
+}
+
+
+/////////////////////////////////////
+// FastMath
+
+void BenchFastInvSqrt( TUInt32 numOps )
+{
+	TFloat32 sum = 0.0f;
+	for (TUInt32 i = 0; i < numOps; ++i)
+	{
+		sum += FastInvSqrt( Floats[i & kDataMask] );
+	}
+	BenchSink = sum;
+}
+
+void BenchFastSinCos( TUInt32 numOps )
+{
+	TFloat32 sum = 0.0f;
+	for (TUInt32 i = 0; i < numOps; ++i)
+	{
+		TFloat32 s, c;
+		FastSinCos( Angles[i & kDataMask], &s, &c );
+		sum += s + c;
+	}
+	BenchSink = sum;
+}
+
+void BenchFastACos( TUInt32 numOps )
+{
+	TFloat32 sum = 0.0f;
+	for (TUInt32 i = 0; i < numOps; ++i)
+	{
+		sum += FastACos( Unit[i & kDataMask] );
+	}
+	BenchSink = sum;
+}
+
+// The four-wide versions count each value as one operation, so are directly comparable with
+// the scalar versions
+void BenchFastInvSqrt4( TUInt32 numOps )
+{
+	__m128 sum = _mm_setzero_ps();
+	for (TUInt32 i = 0; i < numOps; i += 4)
+	{
+		sum = _mm_add_ps( sum, FastInvSqrt4( _mm_loadu_ps( &Floats[i & kDataMask] ) ) );
+	}
+	BenchSink = _mm_cvtss_f32( sum );
+}
+
+void BenchFastSinCos4( TUInt32 numOps )
+{
+	__m128 sum = _mm_setzero_ps();
+	for (TUInt32 i = 0; i < numOps; i += 4)
+	{
+		__m128 s, c;
+		FastSinCos4( _mm_loadu_ps( &Angles[i & kDataMask] ), &s, &c );
+		sum = _mm_add_ps( sum, _mm_add_ps( s, c ) );
+	}
+	BenchSink = _mm_cvtss_f32( sum );
+}
+
+void BenchFastACos4( TUInt32 numOps )
+{
+	__m128 sum = _mm_setzero_ps();
+	for (TUInt32 i = 0; i < numOps; i += 4)
+	{
+		sum = _mm_add_ps( sum, FastACos4( _mm_loadu_ps( &Unit[i & kDataMask] ) ) );
+	}
+	BenchSink = _mm_cvtss_f32( sum );
+}
+
+
+/////////////////////////////////////
+// Vectors
+
+void BenchVector2Normalise( TUInt32 numOps )
+{
+	TFloat32 sum = 0.0f;
+	for (TUInt32 i = 0; i < numOps; ++i)
+	{
+		sum += Normalise( Vec2s[i & kDataMask] ).x;
+	}
+	BenchSink = sum;
+}
+
+void BenchVector3Dot( TUInt32 numOps )
+{
+	TFloat32 sum = 0.0f;
+	for (TUInt32 i = 0; i < numOps; ++i)
+	{
+		sum += Dot( Vec3s[i & kDataMask], Vec3s[(i + 1) & kDataMask] );
+	}
+	BenchSink = sum;
+}
+
+void BenchVector3Cross( TUInt32 numOps )
+{
+	TFloat32 sum = 0.0f;
+	for (TUInt32 i = 0; i < numOps; ++i)
+	{
+		sum += Cross( Vec3s[i & kDataMask], Vec3s[(i + 1) & kDataMask] ).x;
+	}
+	BenchSink = sum;
+}
+
+void BenchVector3Normalise( TUInt32 numOps )
+{
+	TFloat32 sum = 0.0f;
+	for (TUInt32 i = 0; i < numOps; ++i)
+	{
+		sum += Normalise( Vec3s[i & kDataMask] ).x;
+	}
+	BenchSink = sum;
+}
+
+void BenchVector3Distance( TUInt32 numOps )
+{
+	TFloat32 sum = 0.0f;
+	for (TUInt32 i = 0; i < numOps; ++i)
+	{
+		sum += Distance( Vec3s[i & kDataMask], Vec3s[(i + 1) & kDataMask] );
+	}
+	BenchSink = sum;
+}
+
+void BenchVector4Normalise( TUInt32 numOps )
+{
+	TFloat32 sum = 0.0f;
+	for (TUInt32 i = 0; i < numOps; ++i)
+	{
+		sum += Normalise( Vec4s[i & kDataMask] ).x;
+	}
+	BenchSink = sum;
+}
+
+
+/////////////////////////////////////
+// Matrices
+
+void BenchMatrix2x2Multiply( TUInt32 numOps )
+{
+	TFloat32 sum = 0.0f;
+	for (TUInt32 i = 0; i < numOps; ++i)
+	{
+		sum += (Mat2s[i & kDataMask] * Mat2s[(i + 1) & kDataMask]).e00;
+	}
+	BenchSink = sum;
+}
+
+void BenchMatrix2x2Inverse( TUInt32 numOps )
+{
+	TFloat32 sum = 0.0f;
+	for (TUInt32 i = 0; i < numOps; ++i)
+	{
+		sum += Inverse( Mat2s[i & kDataMask] ).e00;
+	}
+	BenchSink = sum;
+}
+
+void BenchMatrix3x3Multiply( TUInt32 numOps )
+{
+	TFloat32 sum = 0.0f;
+	for (TUInt32 i = 0; i < numOps; ++i)
+	{
+		sum += (Mat3s[i & kDataMask] * Mat3s[(i + 1) & kDataMask]).e00;
+	}
+	BenchSink = sum;
+}
+
+void BenchMatrix3x3Inverse( TUInt32 numOps )
+{
+	TFloat32 sum = 0.0f;
+	for (TUInt32 i = 0; i < numOps; ++i)
+	{
+		sum += Inverse( Mat3s[i & kDataMask] ).e00;
+	}
+	BenchSink = sum;
+}
+
+void BenchMatrix4x4Multiply( TUInt32 numOps )
+{
+	TFloat32 sum = 0.0f;
+	for (TUInt32 i = 0; i < numOps; ++i)
+	{
+		sum += (Mat4s[i & kDataMask] * Mat4s[(i + 1) & kDataMask]).e00;
+	}
+	BenchSink = sum;
+}
+
+void BenchMatrix4x4TransformPoint( TUInt32 numOps )
+{
+	TFloat32 sum = 0.0f;
+	for (TUInt32 i = 0; i < numOps; ++i)
+	{
+		sum += Mat4s[i & kDataMask].TransformPoint( Vec3s[(i + 1) & kDataMask] ).x;
+	}
+	BenchSink = sum;
+}
+
+void BenchMatrix4x4Inverse( TUInt32 numOps )
+{
+	TFloat32 sum = 0.0f;
+	for (TUInt32 i = 0; i < numOps; ++i)
+	{
+		sum += Inverse( Mat4s[i & kDataMask] ).e00;
+	}
+	BenchSink = sum;
+}
+
+void BenchMatrix4x4InverseAffine( TUInt32 numOps )
+{
+	TFloat32 sum = 0.0f;
+	for (TUInt32 i = 0; i < numOps; ++i)
+	{
+		sum += InverseAffine( Mat4s[i & kDataMask] ).e00;
+	}
+	BenchSink = sum;
+}
+
+void BenchMatrix4x4FaceTarget( TUInt32 numOps )
+{
+	TFloat32 sum = 0.0f;
+	for (TUInt32 i = 0; i < numOps; ++i)
+	{
+		CMatrix4x4 m = Mat4s[i & kDataMask];
+		m.FaceTarget( Vec3s[(i + 1) & kDataMask] );
+		sum += m.e00;
+	}
+	BenchSink = sum;
+}
+
+void BenchMatrix4x4DecomposeEuler( TUInt32 numOps )
+{
+	TFloat32 sum = 0.0f;
+	for (TUInt32 i = 0; i < numOps; ++i)
+	{
+		CVector3 angles;
+		Mat4s[i & kDataMask].DecomposeAffineEuler( NULL, &angles, NULL );
+		sum += angles.y;
+	}
+	BenchSink = sum;
+}
+
+
+/////////////////////////////////////
+// Quaternions
+
+void BenchQuaternionMultiply( TUInt32 numOps )
+{
+	TFloat32 sum = 0.0f;
+	for (TUInt32 i = 0; i < numOps; ++i)
+	{
+		sum += (Quats[i & kDataMask] * Quats[(i + 1) & kDataMask]).w;
+	}
+	BenchSink = sum;
+}
+
+void BenchQuaternionSlerp( TUInt32 numOps )
+{
+	TFloat32 sum = 0.0f;
+	for (TUInt32 i = 0; i < numOps; ++i)
+	{
+		CQuaternion q;
+		Slerp( Quats[i & kDataMask], Quats[(i + 1) & kDataMask], 0.3f, q );
+		sum += q.w;
+	}
+	BenchSink = sum;
+}
+
+void BenchQuaternionNLerp( TUInt32 numOps )
+{
+	TFloat32 sum = 0.0f;
+	for (TUInt32 i = 0; i < numOps; ++i)
+	{
+		CQuaternion q;
+		NLerp( Quats[i & kDataMask], Quats[(i + 1) & kDataMask], 0.3f, q );
+		sum += q.w;
+	}
+	BenchSink = sum;
+}
+
+
+/////////////////////////////////////
+// Quaternion transforms
+
+void BenchQuatTransformMultiply( TUInt32 numOps )
+{
+	TFloat32 sum = 0.0f;
+	for (TUInt32 i = 0; i < numOps; ++i)
+	{
+		sum += (QuatTransforms[i & kDataMask] * QuatTransforms[(i + 1) & kDataMask]).pos.x;
+	}
+	BenchSink = sum;
+}
+
+void BenchQuatTransformGetMatrix( TUInt32 numOps )
+{
+	TFloat32 sum = 0.0f;
+	for (TUInt32 i = 0; i < numOps; ++i)
+	{
+		CMatrix4x4 m;
+		QuatTransforms[i & kDataMask].GetMatrix( m );
+		sum += m.e00;
+	}
+	BenchSink = sum;
+}
+
+void BenchQuatTransformFromMatrix( TUInt32 numOps )
+{
+	TFloat32 sum = 0.0f;
+	for (TUInt32 i = 0; i < numOps; ++i)
+	{
+		sum += CQuatTransform( Mat4s[i & kDataMask] ).quat.w;
+	}
+	BenchSink = sum;
+}
+
+void BenchQuatTransformTransformPoint( TUInt32 numOps )
+{
+	TFloat32 sum = 0.0f;
+	for (TUInt32 i = 0; i < numOps; ++i)
+	{
+		sum += QuatTransforms[i & kDataMask].TransformPoint( Vec3s[(i + 1) & kDataMask] ).x;
+	}
+	BenchSink = sum;
+}
+
+void BenchQuatTransformGetYaw( TUInt32 numOps )
+{
+	TFloat32 sum = 0.0f;
+	for (TUInt32 i = 0; i < numOps; ++i)
+	{
+		sum += QuatTransforms[i & kDataMask].GetYaw();
+	}
+	BenchSink = sum;
+}
+
+
+
+/////////////////////////////////////
+// Geometry
+
+void BenchSegmentAABB( TUInt32 numOps )
+{
+	TUInt32 hits = 0;
+	for (TUInt32 i = 0; i < numOps; ++i)
+	{
+		hits += SegmentAABB( Segments[i & kDataMask], Boxes[(i + 1) & kDataMask] );
+	}
+	BenchSink = static_cast<TFloat32>(hits);
+}
+
+void BenchRayAABBPrecalc( TUInt32 numOps )
+{
+	// One ray against many boxes, as when traversing a bounding volume hierarchy
+	TUInt32 hits = 0;
+	SPrecalcRay ray = PrecalcRay( Segments[0] );
+	for (TUInt32 i = 0; i < numOps; ++i)
+	{
+		hits += RayAABB( ray, Boxes[i & kDataMask] );
+	}
+	BenchSink = static_cast<TFloat32>(hits);
+}
+
+void BenchSphereSphere( TUInt32 numOps )
+{
+	TUInt32 hits = 0;
+	for (TUInt32 i = 0; i < numOps; ++i)
+	{
+		hits += SphereSphere( Spheres[i & kDataMask], Spheres[(i + 1) & kDataMask] );
+	}
+	BenchSink = static_cast<TFloat32>(hits);
+}
+
+void BenchSweptSphereSphere( TUInt32 numOps )
+{
+	TUInt32 hits = 0;
+	for (TUInt32 i = 0; i < numOps; ++i)
+	{
+		const SSegment& path = Segments[i & kDataMask];
+		SSphere moving = { path.start, 1.0f };
+		hits += SweptSphereSphere( moving, path.end - path.start, Spheres[(i + 1) & kDataMask] );
+	}
+	BenchSink = static_cast<TFloat32>(hits);
+}
+
+// As with FastMath, the four-wide versions count each primitive tested as one operation
+void BenchRayAABB4( TUInt32 numOps )
+{
+	TUInt32 hits = 0;
+	SPrecalcRay ray = PrecalcRay( Segments[0] );
+	for (TUInt32 i = 0; i < numOps; i += 4)
+	{
+		hits += RayAABB4( ray, Box4s[(i / 4) & (kDataMask / 4)] );
+	}
+	BenchSink = static_cast<TFloat32>(hits);
+}
+
+void BenchSphereSphere4( TUInt32 numOps )
+{
+	TUInt32 hits = 0;
+	for (TUInt32 i = 0; i < numOps; i += 4)
+	{
+		hits += SphereSphere4( Spheres[i & kDataMask], Sphere4s[(i / 4 + 1) & (kDataMask / 4)] );
+	}
+	BenchSink = static_cast<TFloat32>(hits);
+}
+
+void BenchSweptSphereSphere4( TUInt32 numOps )
+{
+	TUInt32 hits = 0;
+	for (TUInt32 i = 0; i < numOps; i += 4)
+	{
+		const SSegment& path = Segments[i & kDataMask];
+		SSphere moving = { path.start, 1.0f };
+		hits += SweptSphereSphere4( moving, path.end - path.start, Sphere4s[(i / 4 + 1) & (kDataMask / 4)] );
+	}
+	BenchSink = static_cast<TFloat32>(hits);
+}
+
+} // namespace
+
+
+/*-----------------------------------------------------------------------------------------
+	Main
+-----------------------------------------------------------------------------------------*/
+
+int main( int argc, char* argv[] )
+{
+	TUInt32 numReps = 15;
+	string filter, label, csvFile, jsonFile;
+	for (int arg = 1; arg < argc; ++arg)
+	{
+		if (arg + 1 < argc)
+		{
+			if (!strcmp( argv[arg], "-reps" ))
+			{
+				numReps = atoi( argv[++arg] );
+				continue;
+			}
+			if (!strcmp( argv[arg], "-filter" ))
+			{
+				filter = argv[++arg];
+				continue;
+			}
+			if (!strcmp( argv[arg], "-label" ))
+			{
+				label = argv[++arg];
+				continue;
+			}
+			if (!strcmp( argv[arg], "-csv" ))
+			{
+				csvFile = argv[++arg];
+				continue;
+			}
+			if (!strcmp( argv[arg], "-json" ))
+			{
+				jsonFile = argv[++arg];
+				continue;
+			}
+		}
+		printf( "Usage: MathBench [-reps N] [-filter text] [-label text] [-csv file] [-json file]\n" );
+		return 1;
+	}
+
+	InitData();
+
+	CBenchmark bench( numReps );
+	bench.SetFilter( filter );
+	bench.SetLabel( label );
+
+	bench.Add( "BaseMath", "Sqrt", BenchSqrt );
+	bench.Add( "BaseMath", "InvSqrt", BenchInvSqrt );
+	bench.Add( "BaseMath", "SinCos", BenchSinCos );
+	bench.Add( "BaseMath", "ACos", BenchACos );
+	bench.Add( "BaseMath", "Random", BenchRandom );
+
+	bench.Add( "FastMath", "FastInvSqrt", BenchFastInvSqrt );
+	bench.Add( "FastMath", "FastSinCos", BenchFastSinCos );
+	bench.Add( "FastMath", "FastACos", BenchFastACos );
+	bench.Add( "FastMath", "FastInvSqrt4", BenchFastInvSqrt4 );
+	bench.Add( "FastMath", "FastSinCos4", BenchFastSinCos4 );
+	bench.Add( "FastMath", "FastACos4", BenchFastACos4 );
+
+	bench.Add( "CVector2", "Normalise", BenchVector2Normalise );
+	bench.Add( "CVector3", "Dot", BenchVector3Dot );
+	bench.Add( "CVector3", "Cross", BenchVector3Cross );
+	bench.Add( "CVector3", "Normalise", BenchVector3Normalise );
+	bench.Add( "CVector3", "Distance", BenchVector3Distance );
+	bench.Add( "CVector4", "Normalise", BenchVector4Normalise );
+
+	bench.Add( "CMatrix2x2", "Multiply", BenchMatrix2x2Multiply );
+	bench.Add( "CMatrix2x2", "Inverse", BenchMatrix2x2Inverse );
+	bench.Add( "CMatrix3x3", "Multiply", BenchMatrix3x3Multiply );
+	bench.Add( "CMatrix3x3", "Inverse", BenchMatrix3x3Inverse );
+	bench.Add( "CMatrix4x4", "Multiply", BenchMatrix4x4Multiply );
+	bench.Add( "CMatrix4x4", "TransformPoint", BenchMatrix4x4TransformPoint );
+	bench.Add( "CMatrix4x4", "Inverse", BenchMatrix4x4Inverse );
+	bench.Add( "CMatrix4x4", "InverseAffine", BenchMatrix4x4InverseAffine );
+	bench.Add( "CMatrix4x4", "FaceTarget", BenchMatrix4x4FaceTarget );
+	bench.Add( "CMatrix4x4", "DecomposeAffineEuler", BenchMatrix4x4DecomposeEuler );
+
+	bench.Add( "CQuaternion", "Multiply", BenchQuaternionMultiply );
+	bench.Add( "CQuaternion", "Slerp", BenchQuaternionSlerp );
+	bench.Add( "CQuaternion", "NLerp", BenchQuaternionNLerp );
+
+	bench.Add( "CQuatTransform", "Multiply", BenchQuatTransformMultiply );
+	bench.Add( "CQuatTransform", "GetMatrix", BenchQuatTransformGetMatrix );
+	bench.Add( "CQuatTransform", "FromMatrix", BenchQuatTransformFromMatrix );
+	bench.Add( "CQuatTransform", "TransformPoint", BenchQuatTransformTransformPoint );
+	bench.Add( "CQuatTransform", "GetYaw", BenchQuatTransformGetYaw );
+
+	bench.Add( "Geometry", "SegmentAABB", BenchSegmentAABB );
+	bench.Add( "Geometry", "RayAABBPrecalc", BenchRayAABBPrecalc );
+	bench.Add( "Geometry", "SphereSphere", BenchSphereSphere );
+	bench.Add( "Geometry", "SweptSphereSphere", BenchSweptSphereSphere );
+	bench.Add( "Geometry", "RayAABB4", BenchRayAABB4 );
+	bench.Add( "Geometry", "SphereSphere4", BenchSphereSphere4 );
+	bench.Add( "Geometry", "SweptSphereSphere4", BenchSweptSphereSphere4 );
+
+	bench.Run();
+
+	if (!csvFile.empty() && !bench.WriteCSV( csvFile ))
+	{
+		printf( "Error writing %s\n", csvFile.c_str() );
+		return 1;
+	}
+	if (!jsonFile.empty() && !bench.WriteJSON( jsonFile ))
+	{
+		printf( "Error writing %s\n", jsonFile.c_str() );
+		return 1;
+	}
+	return 0;
+}
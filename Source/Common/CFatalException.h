@@ -61,6 +61,20 @@ public:
 	// Display the exception details to the user
 	void Display() const;
 
+	// Get the description and location of the exception
+	const string& GetDescription() const
+	{
+		return m_sDescription;
+	}
+	const string& GetFileName() const
+	{
+		return m_sFileName;
+	}
+	TInt32 GetLineNum() const
+	{
+		return m_iLineNum;
+	}
+
 
 	// Append current class, object and function names to the call stack string as each function in
 	// the call stack unwinds. Can specify if this is the final (root) entry to add to the stack
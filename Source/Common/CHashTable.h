@@ -212,6 +212,7 @@ public:
 		{
 			m_aBuckets[iBucket].clear();
 		}
+		m_iNumEntries = 0;
 	}
 
 
@@ -0,0 +1,363 @@
+/**************************************************************************************************
+	Module:       CJobSystem.cpp
+
+	Work-stealing job system - a pool of worker threads that run small jobs, with fork/join
+	parallel for loops and dependencies between jobs
+
+	See header file for further notes
+**************************************************************************************************/
+
+#include "CJobSystem.h"
+
+namespace gen
+{
+
+// Index of the current thread in the job system, workers set their own. Any other thread is
+// treated as the main thread
+static thread_local TUInt32 CurrentThread = 0;
+
+
+/*---------------------------------------------------------------------------------------------
+	Constructors/Destructors
+---------------------------------------------------------------------------------------------*/
+
+// Constructor doesn't start any threads, jobs are run by the main thread until Start is called
+CJobSystem::CJobSystem()
+{
+	m_NumQueued = 0;
+	m_NumSleeping = 0;
+	m_Running = false;
+
+	// Queue for the main thread
+	m_Queues.push_back( NewQueue( 1 ) );
+}
+
+// Destructor stops the worker threads
+CJobSystem::~CJobSystem()
+{
+	Stop();
+	delete[] m_Queues[0]->ring;
+	delete m_Queues[0];
+}
+
+
+/*---------------------------------------------------------------------------------------------
+	Threads
+---------------------------------------------------------------------------------------------*/
+
+// Start the worker threads, the calling thread becomes the main thread. Pass the total number of
+// threads including the main thread, or 0 for one per hardware thread
+void CJobSystem::Start( TUInt32 numThreads /*= 0*/ )
+{
+	GEN_ASSERT( !m_Running, "Job system already started" );
+	if (numThreads == 0)
+	{
+		numThreads = thread::hardware_concurrency();
+		if (numThreads == 0)
+		{
+			numThreads = 1;
+		}
+	}
+
+	// Create all queues before any worker starts, as workers steal from each other
+	for (TUInt32 threadIndex = 1; threadIndex < numThreads; ++threadIndex)
+	{
+		m_Queues.push_back( NewQueue( threadIndex * 2654435761u ) );
+	}
+	m_Running = true;
+	for (TUInt32 threadIndex = 1; threadIndex < numThreads; ++threadIndex)
+	{
+		m_Workers.push_back( thread( &CJobSystem::WorkerThread, this, threadIndex ) );
+	}
+}
+
+// Finish all queued jobs and stop the worker threads
+void CJobSystem::Stop()
+{
+	if (!m_Running)
+	{
+		return;
+	}
+
+	// Run anything left on this thread, then wake all workers so they see the system stopping
+	while (SJob* job = GetJob())
+	{
+		Execute( job );
+	}
+	{
+		lock_guard<mutex> sleepLock( m_SleepLock );
+		m_Running = false;
+	}
+	m_Wake.notify_all();
+	for (TUInt32 worker = 0; worker < m_Workers.size(); ++worker)
+	{
+		m_Workers[worker].join();
+	}
+	m_Workers.clear();
+
+	while (m_Queues.size() > 1)
+	{
+		delete[] m_Queues.back()->ring;
+		delete m_Queues.back();
+		m_Queues.pop_back();
+	}
+}
+
+// Index of the calling thread, 0 for the main thread, 1 and up for workers
+TUInt32 CJobSystem::ThreadIndex() const
+{
+	return CurrentThread;
+}
+
+
+// Worker thread function, runs jobs until the system is stopped
+void CJobSystem::WorkerThread( TUInt32 threadIndex )
+{
+	CurrentThread = threadIndex;
+	while (true)
+	{
+		SJob* job = GetJob();
+		if (job)
+		{
+			Execute( job );
+			continue;
+		}
+
+		// Nothing to do - sleep until jobs are queued. Count this worker as sleeping before
+		// checking the queued count, and Push adds to the count before checking for sleepers, so
+		// one or the other sees the change and a wake up can't be missed
+		unique_lock<mutex> sleepLock( m_SleepLock );
+		++m_NumSleeping;
+		while (m_NumQueued.load() == 0 && m_Running)
+		{
+			m_Wake.wait( sleepLock );
+		}
+		--m_NumSleeping;
+		if (!m_Running && m_NumQueued.load() == 0)
+		{
+			return;
+		}
+	}
+}
+
+
+/*---------------------------------------------------------------------------------------------
+	Jobs
+---------------------------------------------------------------------------------------------*/
+
+// Create a job that will call the given function with the given data and range. If a parent is
+// given it will not finish until this job has. The job does not start until Run is called
+SJob* CJobSystem::CreateJob( TJobFunction function, void* data /*= 0*/, TUInt32 begin /*= 0*/,
+                             TUInt32 end /*= 0*/, SJob* parent /*= 0*/ )
+{
+	// Take the next free job from this thread's ring, no other thread allocates from it. Jobs
+	// still in use (not run, not finished or still being finished) are skipped
+	SJobQueue* queue = m_Queues[CurrentThread];
+	SJob* job = &queue->ring[queue->nextJob];
+	TUInt32 numTried = 1;
+	while (job->inUse.load( memory_order_acquire ))
+	{
+		GEN_ASSERT( numTried < kMaxJobs, "Too many jobs in use on one thread" );
+		queue->nextJob = (queue->nextJob + 1) & (kMaxJobs - 1);
+		job = &queue->ring[queue->nextJob];
+		++numTried;
+	}
+	queue->nextJob = (queue->nextJob + 1) & (kMaxJobs - 1);
+
+	job->function = function;
+	job->data = data;
+	job->begin = begin;
+	job->end = end;
+	job->parent = parent;
+	job->unfinished.store( 1, memory_order_relaxed );
+	job->dependencies.store( 1, memory_order_relaxed );
+	job->dependentsLock.clear();
+	job->finished = false;
+	job->numDependents = 0;
+	job->inUse.store( true, memory_order_relaxed );
+	if (parent)
+	{
+		parent->unfinished.fetch_add( 1, memory_order_relaxed );
+	}
+	return job;
+}
+
+// Make a job wait for another to finish before starting. Must be called before the job is run,
+// the dependency may be running or finished already
+void CJobSystem::AddDependency( SJob* job, SJob* dependency )
+{
+	while (dependency->dependentsLock.test_and_set( memory_order_acquire ))
+	{
+		this_thread::yield();
+	}
+	if (!dependency->finished)
+	{
+		GEN_ASSERT( dependency->numDependents < SJob::kMaxDependents, "Too many jobs depend on one job" );
+		dependency->dependents[dependency->numDependents++] = job;
+		job->dependencies.fetch_add( 1, memory_order_relaxed );
+	}
+	dependency->dependentsLock.clear( memory_order_release );
+}
+
+// Queue a job to run on any thread, once its dependencies are finished
+void CJobSystem::Run( SJob* job )
+{
+	// Release the hold put on the job when it was created
+	if (job->dependencies.fetch_sub( 1, memory_order_acq_rel ) == 1)
+	{
+		Push( job );
+	}
+}
+
+// Wait until a job and all its children have finished, running other jobs meanwhile
+void CJobSystem::Wait( const SJob* job )
+{
+	while (!IsFinished( job ))
+	{
+		SJob* otherJob = GetJob();
+		if (otherJob)
+		{
+			Execute( otherJob );
+		}
+		else
+		{
+			// The remaining work is running on other threads
+			this_thread::yield();
+		}
+	}
+}
+
+
+/*---------------------------------------------------------------------------------------------
+	Private functions
+---------------------------------------------------------------------------------------------*/
+
+// Create a queue for a thread with a ring of free jobs, seeding its random steal order
+CJobSystem::SJobQueue* CJobSystem::NewQueue( TUInt32 randomSeed )
+{
+	SJobQueue* queue = new SJobQueue;
+	queue->ring = new SJob[kMaxJobs];
+	for (TUInt32 job = 0; job < kMaxJobs; ++job)
+	{
+		queue->ring[job].unfinished.store( 0, memory_order_relaxed );
+		queue->ring[job].inUse.store( false, memory_order_relaxed );
+	}
+	queue->nextJob = 0;
+	queue->random = randomSeed;
+	return queue;
+}
+
+// Add a job whose dependencies have finished to the calling thread's queue
+void CJobSystem::Push( SJob* job )
+{
+	SJobQueue* queue = m_Queues[CurrentThread];
+	{
+		lock_guard<mutex> queueLock( queue->lock );
+		queue->jobs.push_back( job );
+	}
+	++m_NumQueued;
+	if (m_NumSleeping.load() > 0)
+	{
+		lock_guard<mutex> sleepLock( m_SleepLock );
+		m_Wake.notify_one();
+	}
+}
+
+// Take a job from the calling thread's queue, or steal one from another thread. Returns 0 if
+// there are none
+SJob* CJobSystem::GetJob()
+{
+	if (m_NumQueued.load( memory_order_relaxed ) == 0)
+	{
+		return 0;
+	}
+
+	// Newest job from own queue
+	SJobQueue* queue = m_Queues[CurrentThread];
+	{
+		lock_guard<mutex> queueLock( queue->lock );
+		if (!queue->jobs.empty())
+		{
+			SJob* job = queue->jobs.back();
+			queue->jobs.pop_back();
+			--m_NumQueued;
+			return job;
+		}
+	}
+
+	// Oldest job from another queue, trying each in turn from a random start (xorshift)
+	TUInt32 numQueues = NumThreads();
+	queue->random ^= queue->random << 13;
+	queue->random ^= queue->random >> 17;
+	queue->random ^= queue->random << 5;
+	TUInt32 victim = queue->random % numQueues;
+	for (TUInt32 attempt = 0; attempt < numQueues; ++attempt, victim = (victim + 1) % numQueues)
+	{
+		if (victim == CurrentThread)
+		{
+			continue;
+		}
+		SJobQueue* victimQueue = m_Queues[victim];
+		lock_guard<mutex> queueLock( victimQueue->lock );
+		if (!victimQueue->jobs.empty())
+		{
+			SJob* job = victimQueue->jobs.front();
+			victimQueue->jobs.pop_front();
+			--m_NumQueued;
+			return job;
+		}
+	}
+	return 0;
+}
+
+// Run a job and finish it
+void CJobSystem::Execute( SJob* job )
+{
+	job->function( job );
+	Finish( job );
+}
+
+// Record that a job or one of its children has finished. When the job and all its children have,
+// finish its parent and start the jobs that depend on it
+void CJobSystem::Finish( SJob* job )
+{
+	if (job->unfinished.fetch_sub( 1, memory_order_acq_rel ) != 1)
+	{
+		return;
+	}
+
+	// Take the dependents and mark the job so no more are added, then start any that have no
+	// other unfinished dependencies
+	while (job->dependentsLock.test_and_set( memory_order_acquire ))
+	{
+		this_thread::yield();
+	}
+	job->finished = true;
+	TUInt32 numDependents = job->numDependents;
+	SJob* dependents[SJob::kMaxDependents];
+	for (TUInt32 dependent = 0; dependent < numDependents; ++dependent)
+	{
+		dependents[dependent] = job->dependents[dependent];
+	}
+	job->dependentsLock.clear( memory_order_release );
+	for (TUInt32 dependent = 0; dependent < numDependents; ++dependent)
+	{
+		if (dependents[dependent]->dependencies.fetch_sub( 1, memory_order_acq_rel ) == 1)
+		{
+			Push( dependents[dependent] );
+		}
+	}
+
+	// The job is now finished with, its slot may be reused as soon as it is released (the owner
+	// may already have seen it finish), so read the parent first. The parent is finished with its
+	// last child
+	SJob* parent = job->parent;
+	job->inUse.store( false, memory_order_release );
+	if (parent)
+	{
+		Finish( parent );
+	}
+}
+
+
+} // namespace gen
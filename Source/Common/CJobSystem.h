@@ -0,0 +1,266 @@
+/**************************************************************************************************
+	Module:       CJobSystem.h
+
+	Work-stealing job system - a pool of worker threads that run small jobs, with fork/join
+	parallel for loops and dependencies between jobs
+
+	Each thread (the main thread and each worker) has its own queue of jobs. A thread adds the jobs
+	it creates to the back of its own queue and takes its next job from the back too, so it works
+	on the most recently split, cache-warm work first. A thread with an empty queue steals the
+	oldest job from the front of another thread's queue, which tends to be the largest piece of
+	work left. Threads waiting for a job to finish run other jobs rather than blocking, so the main
+	thread takes part in the work it has handed out
+**************************************************************************************************/
+
+#ifndef GEN_C_JOB_SYSTEM_H_INCLUDED
+#define GEN_C_JOB_SYSTEM_H_INCLUDED
+
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <vector>
+using namespace std;
+
+#include "Defines.h"
+#include "Error.h"
+
+namespace gen
+{
+
+/*------------------------------------------------------------------------------------------------
+	Jobs
+ ------------------------------------------------------------------------------------------------*/
+
+struct SJob;
+
+// Function run by a job, it is passed the job so it can read its data and range, and so it can
+// create child jobs
+typedef void (*TJobFunction)( SJob* job );
+
+// A job is a function with a pointer to its data and an index range for the function to work on
+// (the meaning of these is up to the function). Jobs are created and run through CJobSystem.
+//
+// A job may have a parent, the parent is not finished until all of its children are finished.
+// This is used to fork work from a job and join it when waiting on the parent. A job may also
+// depend on other jobs, it does not start until they are finished
+struct SJob
+{
+	TJobFunction function;
+	void*        data;
+	TUInt32      begin;
+	TUInt32      end;
+
+	// Maximum number of jobs that can depend on one job
+	static const TUInt32 kMaxDependents = 8;
+
+	//*** Private to CJobSystem
+	SJob*           parent;
+	atomic<TInt32>  unfinished;   // 1 for the job itself + 1 for each unfinished child
+	atomic<TInt32>  dependencies; // Unfinished jobs this one depends on + 1 until it is run
+	atomic_flag     dependentsLock;
+	bool            finished;     // Set when dependents have been started, under the lock above
+	atomic<bool>    inUse;        // Cleared once finishing is complete, the job may then be reused
+	TUInt32         numDependents;
+	SJob*           dependents[kMaxDependents];
+};
+
+
+/*---------------------------------------------------------------------------------------------
+	CJobSystem class
+---------------------------------------------------------------------------------------------*/
+
+// Pool of worker threads running jobs. The thread that calls Start is the main thread and counts
+// as thread 0, workers are threads 1 and up. Only the main thread may start and stop the system,
+// jobs may be created, run and waited on from the main thread or from within jobs.
+//
+// Jobs are allocated from a fixed ring for each thread, skipping jobs still in use, so no thread
+// may have more than kMaxJobs jobs in use (created and not yet fully finished) at once. A job is
+// reported finished as soon as it and its children are, but its slot is only reused after the
+// thread finishing it has started its dependents and finished its parent. A finished job
+// may be reused for the next job created on that thread, so job pointers must not be kept once a
+// job has been waited on
+class CJobSystem
+{
+/////////////////////////////////////
+//	Constructors/Destructors
+public:
+	// Maximum jobs in use at once by one thread, a power of 2
+	static const TUInt32 kMaxJobs = 4096;
+
+	// Constructor doesn't start any threads, jobs are run by the main thread until Start is called
+	CJobSystem();
+
+	// Destructor stops the worker threads
+	~CJobSystem();
+
+private:
+	// Prevent use of copy constructor and assignment operator (private and not defined)
+	CJobSystem( const CJobSystem& );
+	CJobSystem& operator=( const CJobSystem& );
+
+
+/////////////////////////////////////
+//	Public interface
+public:
+
+	/////////////////////////////////////
+	// Threads
+
+	// Start the worker threads, the calling thread becomes the main thread. Pass the total number
+	// of threads including the main thread, or 0 for one per hardware thread
+	void Start( TUInt32 numThreads = 0 );
+
+	// Finish all queued jobs and stop the worker threads
+	void Stop();
+
+	// Total number of threads running jobs, including the main thread
+	TUInt32 NumThreads() const
+	{
+		return static_cast<TUInt32>(m_Queues.size());
+	}
+
+	// Index of the calling thread, 0 for the main thread, 1 and up for workers
+	TUInt32 ThreadIndex() const;
+
+
+	/////////////////////////////////////
+	// Jobs
+
+	// Create a job that will call the given function with the given data and range. If a parent
+	// is given it will not finish until this job has. The job does not start until Run is called
+	SJob* CreateJob( TJobFunction function, void* data = 0, TUInt32 begin = 0, TUInt32 end = 0,
+	                 SJob* parent = 0 );
+
+	// Make a job wait for another to finish before starting. Must be called before the job is
+	// run, the dependency may be running or finished but must not yet have been waited on
+	void AddDependency( SJob* job, SJob* dependency );
+
+	// Queue a job to run on any thread, once its dependencies are finished
+	void Run( SJob* job );
+
+	// Return true if a job and all its children have finished
+	bool IsFinished( const SJob* job ) const
+	{
+		return job->unfinished.load( memory_order_acquire ) == 0;
+	}
+
+	// Wait until a job and all its children have finished, running other jobs meanwhile
+	void Wait( const SJob* job );
+
+
+	/////////////////////////////////////
+	// Parallel for
+
+	// Call function( rangeBegin, rangeEnd ) on sub-ranges covering begin to end, in parallel,
+	// returning when all calls have finished. The range is split in half repeatedly until the
+	// pieces are no larger than the grain size, the halves are queued as jobs for other threads
+	// to steal. The function is called with sub-ranges in no particular order and from several
+	// threads at once, so it must only write to data for its own range
+	template <class TFunction>
+	void ParallelFor( TUInt32 begin, TUInt32 end, TUInt32 grainSize, const TFunction& function )
+	{
+		if (begin >= end)
+		{
+			return;
+		}
+		if (grainSize == 0)
+		{
+			grainSize = 1;
+		}
+		if (end - begin <= grainSize || NumThreads() == 1)
+		{
+			function( begin, end );
+			return;
+		}
+
+		SParallelFor<TFunction> parallelFor = { this, &function, grainSize };
+		SJob* root = CreateJob( ParallelForJob<TFunction>, &parallelFor, begin, end );
+		Run( root );
+		Wait( root );
+	}
+
+
+/////////////////////////////////////
+//	Private interface
+private:
+
+	// Data for a parallel for loop shared by all of its jobs
+	template <class TFunction>
+	struct SParallelFor
+	{
+		CJobSystem*      jobSystem;
+		const TFunction* function;
+		TUInt32          grainSize;
+	};
+
+	// Parallel for job - splits off the upper half of its range as a child job until the range is
+	// no more than the grain size, then calls the function on what is left
+	template <class TFunction>
+	static void ParallelForJob( SJob* job )
+	{
+		const SParallelFor<TFunction>* parallelFor = static_cast<const SParallelFor<TFunction>*>(job->data);
+		TUInt32 begin = job->begin;
+		TUInt32 end = job->end;
+		while (end - begin > parallelFor->grainSize)
+		{
+			TUInt32 middle = begin + (end - begin) / 2;
+			SJob* half = parallelFor->jobSystem->CreateJob( ParallelForJob<TFunction>, job->data, middle, end, job );
+			parallelFor->jobSystem->Run( half );
+			end = middle;
+		}
+		(*parallelFor->function)( begin, end );
+	}
+
+	// Queue of jobs for one thread. The owner pushes and pops at the back, other threads steal
+	// from the front
+	struct SJobQueue
+	{
+		mutex         lock;
+		deque<SJob*>  jobs;
+		SJob*         ring;     // Jobs allocated by this thread, kMaxJobs of them
+		TUInt32       nextJob;  // Next job to allocate from the ring
+		TUInt32       random;   // State for choosing threads to steal from
+	};
+
+	// Create a queue for a thread with a ring of free jobs, seeding its random steal order
+	SJobQueue* NewQueue( TUInt32 randomSeed );
+
+	// Worker thread function, runs jobs until the system is stopped
+	void WorkerThread( TUInt32 threadIndex );
+
+	// Add a job whose dependencies have finished to the calling thread's queue
+	void Push( SJob* job );
+
+	// Take a job from the calling thread's queue, or steal one from another thread. Returns 0 if
+	// there are none
+	SJob* GetJob();
+
+	// Run a job and finish it
+	void Execute( SJob* job );
+
+	// Record that a job or one of its children has finished. When the job and all its children
+	// have, finish its parent and start the jobs that depend on it
+	void Finish( SJob* job );
+
+
+	// Queues for each thread, the main thread first. Created on Start, there is always one for the
+	// main thread
+	vector<SJobQueue*> m_Queues;
+	vector<thread>     m_Workers;
+
+	// Number of jobs in all queues, and workers waiting for more
+	atomic<TInt32> m_NumQueued;
+	atomic<TInt32> m_NumSleeping;
+
+	// Workers with no jobs sleep on this, until jobs are queued or the system stops
+	mutex              m_SleepLock;
+	condition_variable m_Wake;
+	atomic<bool>       m_Running;
+};
+
+
+} // namespace gen
+
+#endif // GEN_C_JOB_SYSTEM_H_INCLUDED
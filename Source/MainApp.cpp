@@ -137,6 +137,9 @@ bool D3DSetup( HWND hWnd )
 // Reset the Direct3D device to resize window or toggle fullscreen/windowed
 bool ResetDevice( HWND hWnd, bool ToggleFullscreen = false )
 {
+	// The render thread must not be drawing while the device is reset
+	FinishRendering();
+
 	// Not implemented in this exercise
 	return true;
 }
@@ -278,7 +281,8 @@ INT WINAPI WinMain( HINSTANCE hInst, HINSTANCE, LPSTR, INT )
                 }
                 else
 				{
-					// Render and update the scene - using variable timing
+					// Render and update the scene - using variable timing. Rendering hands the last
+					// tick to the render thread, which draws it while this thread updates the next
 					float updateTime = gen::Timer.GetLapTime();
                     gen::RenderScene( updateTime );
 					gen::UpdateScene( updateTime );
@@ -25,20 +25,6 @@ namespace gen
 	Constructors/Destructors
 -----------------------------------------------------------------------------------------*/
 
-// Construct by value
-CMatrix2x2::CMatrix2x2
-(
-	const TFloat32 elt00, const TFloat32 elt01,
-	const TFloat32 elt10, const TFloat32 elt11
-)
-{
-	e00 = elt00;
-	e01 = elt01;
-
-	e10 = elt10;
-	e11 = elt11;
-}
-
 // Construct through pointer to 4 floats, may specify row/column order of data
 CMatrix2x2::CMatrix2x2
 (
@@ -115,31 +101,6 @@ CMatrix2x2::CMatrix2x2
 }
 
 
-// Copy constructor
-CMatrix2x2::CMatrix2x2( const CMatrix2x2& m )
-{
-	e00 = m.e00;
-	e01 = m.e01;
-
-	e10 = m.e10;
-	e11 = m.e11;
-}
-
-// Assignment operator
-CMatrix2x2& CMatrix2x2::operator=( const CMatrix2x2& m )
-{
-	if ( this != &m )
-	{
-		e00 = m.e00;
-		e01 = m.e01;
-
-		e10 = m.e10;
-		e11 = m.e11;
-	}
-	return *this;
-}
-
-
 /*-----------------------------------------------------------------------------------------
 	Setters
 -----------------------------------------------------------------------------------------*/
@@ -879,39 +840,6 @@ CMatrix2x2& CMatrix2x2::operator*=( const TFloat32 s )
 	return *this;
 }
 
-// Matrix-scalar multiplication - non-member version
-CMatrix2x2 operator*
-(
-	const CMatrix2x2& m,
-	const TFloat32    s
-)
-{
-	CMatrix2x2 mOut;
-    mOut.e00 = m.e00 * s;
-    mOut.e01 = m.e01 * s;
-    mOut.e10 = m.e10 * s;
-    mOut.e11 = m.e11 * s;
-
-	return mOut;
-}
-
-// Scalar-matrix multiplication - non-member version
-CMatrix2x2 operator*
-(
-	const TFloat32    s,
-	const CMatrix2x2& m
-)
-{
-	CMatrix2x2 mOut;
-    mOut.e00 = m.e00 * s;
-    mOut.e01 = m.e01 * s;
-    mOut.e10 = m.e10 * s;
-    mOut.e11 = m.e11 * s;
-
-	return mOut;
-}
-
-
 // Scalar division
 CMatrix2x2& CMatrix2x2::operator/=(	const TFloat32 s )
 {
@@ -1021,25 +949,6 @@ CMatrix2x2& CMatrix2x2::operator*=( const CMatrix2x2& m )
 }
 
 
-// Binary matrix-matrix multiplication - non-member version
-CMatrix2x2 operator*
-(
-	const CMatrix2x2& m1,
-	const CMatrix2x2& m2
-)
-{
-	CMatrix2x2 mOut;
-
-	mOut.e00 = m1.e00*m2.e00 + m1.e01*m2.e10;
-	mOut.e01 = m1.e00*m2.e01 + m1.e01*m2.e11;
-
-	mOut.e10 = m1.e10*m2.e00 + m1.e11*m2.e10;
-	mOut.e11 = m1.e10*m2.e01 + m1.e11*m2.e11;
-
-	return mOut;
-}
-
-
 /*---------------------------------------------------------------------------------------------
 	Static constants
 ---------------------------------------------------------------------------------------------*/
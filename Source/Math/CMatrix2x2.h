@@ -49,11 +49,13 @@ public:
 	CMatrix2x2() {}
 
 	// Construct by value
-	CMatrix2x2
+	constexpr CMatrix2x2
 	(
 		const TFloat32 elt00, const TFloat32 elt01,
 		const TFloat32 elt10, const TFloat32 elt11
-	);
+	) : e00( elt00 ), e01( elt01 ),
+	    e10( elt10 ), e11( elt11 )
+	{}
 
 	// Construct through pointer to 4 floats, may specify row/column order of data
 	explicit CMatrix2x2
@@ -85,10 +87,24 @@ public:
 
 
 	// Copy constructor
-    CMatrix2x2( const CMatrix2x2& m );
+    constexpr CMatrix2x2( const CMatrix2x2& m )
+		: e00( m.e00 ), e01( m.e01 ),
+		  e10( m.e10 ), e11( m.e11 )
+	{}
 
 	// Assignment operator
-    CMatrix2x2& operator=( const CMatrix2x2& m );
+    constexpr CMatrix2x2& operator=( const CMatrix2x2& m )
+	{
+		if ( this != &m )
+		{
+			e00 = m.e00;
+			e01 = m.e01;
+
+			e10 = m.e10;
+			e11 = m.e11;
+		}
+		return *this;
+	}
 
 
 	/*-----------------------------------------------------------------------------------------
@@ -442,18 +458,26 @@ bool operator!=
 // Scalar multiplication/division
 
 // Scalar-matrix multiplication
-CMatrix2x2 operator*
+constexpr CMatrix2x2 operator*
 (
 	const TFloat32    s,
 	const CMatrix2x2& m
-);
+)
+{
+	return CMatrix2x2( m.e00 * s, m.e01 * s,
+	                   m.e10 * s, m.e11 * s );
+}
 
 // Matrix-scalar multiplication
-CMatrix2x2 operator*
+constexpr CMatrix2x2 operator*
 (
 	const CMatrix2x2& m,
 	const TFloat32    s
-);
+)
+{
+	return CMatrix2x2( m.e00 * s, m.e01 * s,
+	                   m.e10 * s, m.e11 * s );
+}
 
 // Matrix-scalar division
 CMatrix2x2 operator/
@@ -487,11 +511,18 @@ CVector2 operator*
 // Matrix multiplication
 
 // General matrix-matrix multiplication
-CMatrix2x2 operator*
+constexpr CMatrix2x2 operator*
 (
 	const CMatrix2x2& m1,
 	const CMatrix2x2& m2
-);
+)
+{
+	return CMatrix2x2( m1.e00*m2.e00 + m1.e01*m2.e10,
+	                   m1.e00*m2.e01 + m1.e01*m2.e11,
+
+	                   m1.e10*m2.e00 + m1.e11*m2.e10,
+	                   m1.e10*m2.e01 + m1.e11*m2.e11 );
+}
 
 
 /*-----------------------------------------------------------------------------------------
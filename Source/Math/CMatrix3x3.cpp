@@ -29,27 +29,6 @@ namespace gen
 	Constructors/Destructors
 -----------------------------------------------------------------------------------------*/
 
-// Construct by value
-CMatrix3x3::CMatrix3x3
-(
-	const TFloat32 elt00, const TFloat32 elt01, const TFloat32 elt02,
-	const TFloat32 elt10, const TFloat32 elt11, const TFloat32 elt12,
-	const TFloat32 elt20, const TFloat32 elt21, const TFloat32 elt22
-)
-{
-	e00 = elt00;
-	e01 = elt01;
-	e02 = elt02;
-
-	e10 = elt10;
-	e11 = elt11;
-	e12 = elt12;
-
-	e20 = elt20;
-	e21 = elt21;
-	e22 = elt22;
-}
-
 // Construct through pointer to 9 floats, may specify row/column order of data
 CMatrix3x3::CMatrix3x3
 (
@@ -331,43 +310,6 @@ CMatrix3x3::CMatrix3x3
 }
 
 
-// Copy constructor
-CMatrix3x3::CMatrix3x3( const CMatrix3x3& m )
-{
-	e00 = m.e00;
-	e01 = m.e01;
-	e02 = m.e02;
-
-	e10 = m.e10;
-	e11 = m.e11;
-	e12 = m.e12;
-
-	e20 = m.e20;
-	e21 = m.e21;
-	e22 = m.e22;
-}
-
-// Assignment operator
-CMatrix3x3& CMatrix3x3::operator=( const CMatrix3x3& m )
-{
-	if ( this != &m )
-	{
-		e00 = m.e00;
-		e01 = m.e01;
-		e02 = m.e02;
-
-		e10 = m.e10;
-		e11 = m.e11;
-		e12 = m.e12;
-
-		e20 = m.e20;
-		e21 = m.e21;
-		e22 = m.e22;
-	}
-	return *this;
-}
-
-
 /*-----------------------------------------------------------------------------------------
 	Setters
 -----------------------------------------------------------------------------------------*/
@@ -2938,49 +2880,6 @@ CMatrix3x3& CMatrix3x3::operator*=( const TFloat32 s )
 	return *this;
 }
 
-// Matrix-scalar multiplication - non-member version
-CMatrix3x3 operator*
-(
-	const CMatrix3x3& m,
-	const TFloat32    s
-)
-{
-	CMatrix3x3 mOut;
-    mOut.e00 = m.e00 * s;
-    mOut.e01 = m.e01 * s;
-    mOut.e02 = m.e02 * s;
-    mOut.e10 = m.e10 * s;
-    mOut.e11 = m.e11 * s;
-    mOut.e12 = m.e12 * s;
-    mOut.e20 = m.e20 * s;
-    mOut.e21 = m.e21 * s;
-    mOut.e22 = m.e22 * s;
-
-	return mOut;
-}
-
-// Scalar-matrix multiplication - non-member version
-CMatrix3x3 operator*
-(
-	const TFloat32    s,
-	const CMatrix3x3& m
-)
-{
-	CMatrix3x3 mOut;
-    mOut.e00 = m.e00 * s;
-    mOut.e01 = m.e01 * s;
-    mOut.e02 = m.e02 * s;
-    mOut.e10 = m.e10 * s;
-    mOut.e11 = m.e11 * s;
-    mOut.e12 = m.e12 * s;
-    mOut.e20 = m.e20 * s;
-    mOut.e21 = m.e21 * s;
-    mOut.e22 = m.e22 * s;
-
-	return mOut;
-}
-
-
 // Scalar division
 CMatrix3x3& CMatrix3x3::operator/=(	const TFloat32 s )
 {
@@ -3136,31 +3035,6 @@ CMatrix3x3& CMatrix3x3::operator*=( const CMatrix3x3& m )
 }
 
 
-// Binary matrix-matrix multiplication - non-member version
-CMatrix3x3 operator*
-(
-	const CMatrix3x3& m1,
-	const CMatrix3x3& m2
-)
-{
-	CMatrix3x3 mOut;
-
-	mOut.e00 = m1.e00*m2.e00 + m1.e01*m2.e10 + m1.e02*m2.e20;
-	mOut.e01 = m1.e00*m2.e01 + m1.e01*m2.e11 + m1.e02*m2.e21;
-	mOut.e02 = m1.e00*m2.e02 + m1.e01*m2.e12 + m1.e02*m2.e22;
-
-	mOut.e10 = m1.e10*m2.e00 + m1.e11*m2.e10 + m1.e12*m2.e20;
-	mOut.e11 = m1.e10*m2.e01 + m1.e11*m2.e11 + m1.e12*m2.e21;
-	mOut.e12 = m1.e10*m2.e02 + m1.e11*m2.e12 + m1.e12*m2.e22;
-
-	mOut.e20 = m1.e20*m2.e00 + m1.e21*m2.e10 + m1.e22*m2.e20;
-	mOut.e21 = m1.e20*m2.e01 + m1.e21*m2.e11 + m1.e22*m2.e21;
-	mOut.e22 = m1.e20*m2.e02 + m1.e21*m2.e12 + m1.e22*m2.e22;
-
-	return mOut;
-}
-
-
 // Post-multiply this matrix by the given one assuming they are both affine
 CMatrix3x3& CMatrix3x3::MultiplyAffine2D( const CMatrix3x3& m )
 {
@@ -84,12 +84,15 @@ public:
 	CMatrix3x3() {}
 
 	// Construct by value
-	CMatrix3x3
+	constexpr CMatrix3x3
 	(
 		const TFloat32 elt00, const TFloat32 elt01, const TFloat32 elt02,
 		const TFloat32 elt10, const TFloat32 elt11, const TFloat32 elt12,
 		const TFloat32 elt20, const TFloat32 elt21, const TFloat32 elt22
-	);
+	) : e00( elt00 ), e01( elt01 ), e02( elt02 ),
+	    e10( elt10 ), e11( elt11 ), e12( elt12 ),
+	    e20( elt20 ), e21( elt21 ), e22( elt22 )
+	{}
 
 	// Construct through pointer to 9 floats, may specify row/column order of data
 	explicit CMatrix3x3
@@ -176,10 +179,31 @@ public:
 
 
 	// Copy constructor
-    CMatrix3x3( const CMatrix3x3& m );
+    constexpr CMatrix3x3( const CMatrix3x3& m )
+		: e00( m.e00 ), e01( m.e01 ), e02( m.e02 ),
+		  e10( m.e10 ), e11( m.e11 ), e12( m.e12 ),
+		  e20( m.e20 ), e21( m.e21 ), e22( m.e22 )
+	{}
 
 	// Assignment operator
-    CMatrix3x3& operator=( const CMatrix3x3& m );
+    constexpr CMatrix3x3& operator=( const CMatrix3x3& m )
+	{
+		if ( this != &m )
+		{
+			e00 = m.e00;
+			e01 = m.e01;
+			e02 = m.e02;
+
+			e10 = m.e10;
+			e11 = m.e11;
+			e12 = m.e12;
+
+			e20 = m.e20;
+			e21 = m.e21;
+			e22 = m.e22;
+		}
+		return *this;
+	}
 
 
 	/*-----------------------------------------------------------------------------------------
@@ -1277,18 +1301,28 @@ bool operator!=
 // Scalar multiplication/division
 
 // Scalar-matrix multiplication
-CMatrix3x3 operator*
+constexpr CMatrix3x3 operator*
 (
 	const TFloat32    s,
 	const CMatrix3x3& m
-);
+)
+{
+	return CMatrix3x3( m.e00 * s, m.e01 * s, m.e02 * s,
+	                   m.e10 * s, m.e11 * s, m.e12 * s,
+	                   m.e20 * s, m.e21 * s, m.e22 * s );
+}
 
 // Matrix-scalar multiplication
-CMatrix3x3 operator*
+constexpr CMatrix3x3 operator*
 (
 	const CMatrix3x3& m,
 	const TFloat32    s
-);
+)
+{
+	return CMatrix3x3( m.e00 * s, m.e01 * s, m.e02 * s,
+	                   m.e10 * s, m.e11 * s, m.e12 * s,
+	                   m.e20 * s, m.e21 * s, m.e22 * s );
+}
 
 // Matrix-scalar division
 CMatrix3x3 operator/
@@ -1322,11 +1356,24 @@ CVector3 operator*
 // Matrix multiplication
 
 // General matrix-matrix multiplication
-CMatrix3x3 operator*
+constexpr CMatrix3x3 operator*
 (
 	const CMatrix3x3& m1,
 	const CMatrix3x3& m2
-);
+)
+{
+	return CMatrix3x3( m1.e00*m2.e00 + m1.e01*m2.e10 + m1.e02*m2.e20,
+	                   m1.e00*m2.e01 + m1.e01*m2.e11 + m1.e02*m2.e21,
+	                   m1.e00*m2.e02 + m1.e01*m2.e12 + m1.e02*m2.e22,
+
+	                   m1.e10*m2.e00 + m1.e11*m2.e10 + m1.e12*m2.e20,
+	                   m1.e10*m2.e01 + m1.e11*m2.e11 + m1.e12*m2.e21,
+	                   m1.e10*m2.e02 + m1.e11*m2.e12 + m1.e12*m2.e22,
+
+	                   m1.e20*m2.e00 + m1.e21*m2.e10 + m1.e22*m2.e20,
+	                   m1.e20*m2.e01 + m1.e21*m2.e11 + m1.e22*m2.e21,
+	                   m1.e20*m2.e02 + m1.e21*m2.e12 + m1.e22*m2.e22 );
+}
 
 // Matrix-matrix multiplication assuming both matrices are 2D affine transformations
 CMatrix3x3 MultiplyAffine2D
@@ -31,36 +31,6 @@ namespace gen
 	Constructors/Destructors
 -----------------------------------------------------------------------------------------*/
 
-// Construct by value
-CMatrix4x4::CMatrix4x4
-(
-	const TFloat32 elt00, const TFloat32 elt01, const TFloat32 elt02, const TFloat32 elt03,
-	const TFloat32 elt10, const TFloat32 elt11, const TFloat32 elt12, const TFloat32 elt13,
-	const TFloat32 elt20, const TFloat32 elt21, const TFloat32 elt22, const TFloat32 elt23,
-	const TFloat32 elt30, const TFloat32 elt31, const TFloat32 elt32, const TFloat32 elt33
-)
-{
-	e00 = elt00;
-	e01 = elt01;
-	e02 = elt02;
-	e03 = elt03;
-
-	e10 = elt10;
-	e11 = elt11;
-	e12 = elt12;
-	e13 = elt13;
-
-	e20 = elt20;
-	e21 = elt21;
-	e22 = elt22;
-	e23 = elt23;
-
-	e30 = elt30;
-	e31 = elt31;
-	e32 = elt32;
-	e33 = elt33;
-}
-
 // Construct through pointer to 16 floats, may specify row/column order of data
 CMatrix4x4::CMatrix4x4
 (
@@ -233,32 +203,6 @@ CMatrix4x4::CMatrix4x4
 	}
 }
  
-// Construct affine transformation from position (translation) only
-CMatrix4x4::CMatrix4x4( const CVector3& position )
-{
-	// Take most elements from identity
-	e00 = 1.0f;
-	e01 = 0.0f;
-	e02 = 0.0f;
-	e03 = 0.0f;
-
-	e10 = 0.0f;
-	e11 = 1.0f;
-	e12 = 0.0f;
-	e13 = 0.0f;
-
-	e20 = 0.0f;
-	e21 = 0.0f;
-	e22 = 1.0f;
-	e23 = 0.0f;
-
-	// Put position (translation) in bottom row
-	e30 = position.x;
-	e31 = position.y;
-	e32 = position.z;
-	e33 = 1.0f;
-}
-
 // Construct affine transformation from position, Euler angles and optional scaling, with 
 // remaining elements taken from the identity matrix. May specify order to apply rotations
 // Matrix is effectively built in this order: M = Scale*Rotation*Translation
@@ -436,59 +380,6 @@ CMatrix4x4::CMatrix4x4
 }
 
 
-// Copy constructor
-CMatrix4x4::CMatrix4x4( const CMatrix4x4& m )
-{
-	e00 = m.e00;
-	e01 = m.e01;
-	e02 = m.e02;
-	e03 = m.e03;
-
-	e10 = m.e10;
-	e11 = m.e11;
-	e12 = m.e12;
-	e13 = m.e13;
-
-	e20 = m.e20;
-	e21 = m.e21;
-	e22 = m.e22;
-	e23 = m.e23;
-
-	e30 = m.e30;
-	e31 = m.e31;
-	e32 = m.e32;
-	e33 = m.e33;
-}
-
-// Assignment operator
-CMatrix4x4& CMatrix4x4::operator=( const CMatrix4x4& m )
-{
-	if ( this != &m )
-	{
-		e00 = m.e00;
-		e01 = m.e01;
-		e02 = m.e02;
-		e03 = m.e03;
-
-		e10 = m.e10;
-		e11 = m.e11;
-		e12 = m.e12;
-		e13 = m.e13;
-
-		e20 = m.e20;
-		e21 = m.e21;
-		e22 = m.e22;
-		e23 = m.e23;
-
-		e30 = m.e30;
-		e31 = m.e31;
-		e32 = m.e32;
-		e33 = m.e33;
-	}
-	return *this;
-}
-
-
 /*-----------------------------------------------------------------------------------------
 	Setters
 -----------------------------------------------------------------------------------------*/
@@ -2985,63 +2876,6 @@ CMatrix4x4& CMatrix4x4::operator*=( const TFloat32 s )
 	return *this;
 }
 
-// Matrix-scalar multiplication - non-member version
-CMatrix4x4 operator*
-(
-	const CMatrix4x4& m,
-	const TFloat32    s
-)
-{
-	CMatrix4x4 mOut;
-    mOut.e00 = m.e00 * s;
-    mOut.e01 = m.e01 * s;
-    mOut.e02 = m.e02 * s;
-    mOut.e03 = m.e03 * s;
-    mOut.e10 = m.e10 * s;
-    mOut.e11 = m.e11 * s;
-    mOut.e12 = m.e12 * s;
-    mOut.e13 = m.e13 * s;
-    mOut.e20 = m.e20 * s;
-    mOut.e21 = m.e21 * s;
-    mOut.e22 = m.e22 * s;
-    mOut.e23 = m.e23 * s;
-    mOut.e30 = m.e30 * s;
-    mOut.e31 = m.e31 * s;
-    mOut.e32 = m.e32 * s;
-    mOut.e33 = m.e33 * s;
-
-	return mOut;
-}
-
-// Scalar-matrix multiplication - non-member version
-CMatrix4x4 operator*
-(
-	const TFloat32    s,
-	const CMatrix4x4& m
-)
-{
-	CMatrix4x4 mOut;
-    mOut.e00 = m.e00 * s;
-    mOut.e01 = m.e01 * s;
-    mOut.e02 = m.e02 * s;
-    mOut.e03 = m.e03 * s;
-    mOut.e10 = m.e10 * s;
-    mOut.e11 = m.e11 * s;
-    mOut.e12 = m.e12 * s;
-    mOut.e13 = m.e13 * s;
-    mOut.e20 = m.e20 * s;
-    mOut.e21 = m.e21 * s;
-    mOut.e22 = m.e22 * s;
-    mOut.e23 = m.e23 * s;
-    mOut.e30 = m.e30 * s;
-    mOut.e31 = m.e31 * s;
-    mOut.e32 = m.e32 * s;
-    mOut.e33 = m.e33 * s;
-
-	return mOut;
-}
-
-
 // Scalar division
 CMatrix4x4& CMatrix4x4::operator/=(	const TFloat32 s )
 {
@@ -3230,39 +3064,6 @@ CMatrix4x4& CMatrix4x4::operator*=( const CMatrix4x4& m )
 }
 
 
-// Binary matrix-matrix multiplication - non-member version
-CMatrix4x4 operator*
-(
-	const CMatrix4x4& m1,
-	const CMatrix4x4& m2
-)
-{
-	CMatrix4x4 mOut;
-
-	mOut.e00 = m1.e00*m2.e00 + m1.e01*m2.e10 + m1.e02*m2.e20 + m1.e03*m2.e30;
-	mOut.e01 = m1.e00*m2.e01 + m1.e01*m2.e11 + m1.e02*m2.e21 + m1.e03*m2.e31;
-	mOut.e02 = m1.e00*m2.e02 + m1.e01*m2.e12 + m1.e02*m2.e22 + m1.e03*m2.e32;
-	mOut.e03 = m1.e00*m2.e03 + m1.e01*m2.e13 + m1.e02*m2.e23 + m1.e03*m2.e33;
-
-	mOut.e10 = m1.e10*m2.e00 + m1.e11*m2.e10 + m1.e12*m2.e20 + m1.e13*m2.e30;
-	mOut.e11 = m1.e10*m2.e01 + m1.e11*m2.e11 + m1.e12*m2.e21 + m1.e13*m2.e31;
-	mOut.e12 = m1.e10*m2.e02 + m1.e11*m2.e12 + m1.e12*m2.e22 + m1.e13*m2.e32;
-	mOut.e13 = m1.e10*m2.e03 + m1.e11*m2.e13 + m1.e12*m2.e23 + m1.e13*m2.e33;
-
-	mOut.e20 = m1.e20*m2.e00 + m1.e21*m2.e10 + m1.e22*m2.e20 + m1.e23*m2.e30;
-	mOut.e21 = m1.e20*m2.e01 + m1.e21*m2.e11 + m1.e22*m2.e21 + m1.e23*m2.e31;
-	mOut.e22 = m1.e20*m2.e02 + m1.e21*m2.e12 + m1.e22*m2.e22 + m1.e23*m2.e32;
-	mOut.e23 = m1.e20*m2.e03 + m1.e21*m2.e13 + m1.e22*m2.e23 + m1.e23*m2.e33;
-
-	mOut.e30 = m1.e30*m2.e00 + m1.e31*m2.e10 + m1.e32*m2.e20 + m1.e33*m2.e30;
-	mOut.e31 = m1.e30*m2.e01 + m1.e31*m2.e11 + m1.e32*m2.e21 + m1.e33*m2.e31;
-	mOut.e32 = m1.e30*m2.e02 + m1.e31*m2.e12 + m1.e32*m2.e22 + m1.e33*m2.e32;
-	mOut.e33 = m1.e30*m2.e03 + m1.e31*m2.e13 + m1.e32*m2.e23 + m1.e33*m2.e33;
-
-	return mOut;
-}
-
-
 // Post-multiply this matrix by the given one assuming they are both affine
 CMatrix4x4& CMatrix4x4::MultiplyAffine( const CMatrix4x4& m )
 {
@@ -54,6 +54,50 @@ CQuatTransform operator*
 }
 
 
+/*-----------------------------------------------------------------------------------------
+	Manipulation
+-----------------------------------------------------------------------------------------*/
+
+// Rotate by given angle (radians) around world X axis & local origin
+void CQuatTransform::RotateX( const TFloat32 x )
+{
+	// Post-multiplying by an axis rotation matches CMatrix4x4::RotateX
+	TFloat32 s, c;
+	SinCos( x * 0.5f, &s, &c );
+	quat *= CQuaternion( c, s, 0.0f, 0.0f );
+}
+
+// Rotate by given angle (radians) around world Y axis & local origin
+void CQuatTransform::RotateY( const TFloat32 y )
+{
+	TFloat32 s, c;
+	SinCos( y * 0.5f, &s, &c );
+	quat *= CQuaternion( c, 0.0f, s, 0.0f );
+}
+
+// Rotate by given angle (radians) around world Z axis & local origin
+void CQuatTransform::RotateZ( const TFloat32 z )
+{
+	TFloat32 s, c;
+	SinCos( z * 0.5f, &s, &c );
+	quat *= CQuaternion( c, 0.0f, 0.0f, s );
+}
+
+// Rotate to face from current position to given target (in the Z direction). Can pass up
+// vector. Retains the current scaling
+void CQuatTransform::FaceTarget
+(
+	const CVector3& target,
+	const CVector3& up /*= CVector3::kYAxis*/
+)
+{
+	// Build facing rotation as a matrix, then convert - the matrix is unscaled so the
+	// quaternion conversion does not need to remove any scaling
+	quat = CQuaternion( MatrixFaceTarget( pos, target, up ) );
+	quat.Normalise();
+}
+
+
 /*---------------------------------------------------------------------------------------------
 	Interpolation
 ---------------------------------------------------------------------------------------------*/
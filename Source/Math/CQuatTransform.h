@@ -31,7 +31,7 @@ public:
 	CQuatTransform() {}
 
 	// Constructor by value
-    CQuatTransform
+    constexpr CQuatTransform
 	(
 		const CQuaternion& initQuat,
 		const CVector3&    initPos,
@@ -57,13 +57,13 @@ public:
 
 
 	// Copy constructor
-    CQuatTransform
+    constexpr CQuatTransform
 	(
 		const CQuatTransform& src
 	) : quat( src.quat ), pos( src.pos ), scale( src.scale ) {}
 
 	// Assignment operator
-    CQuatTransform& operator=
+    constexpr CQuatTransform& operator=
 	(
 		const CQuatTransform& src
 	)
@@ -77,9 +77,6 @@ public:
 		return *this;
 	}
 
-	// Destructor
-	~CQuatTransform() {}
-
 
 /*-----------------------------------------------------------------------------------------
 	Public functions
@@ -90,19 +87,95 @@ public:
 		Matrix extraction
 	-----------------------------------------------------------------------------------------*/
 
-	// Get the 4x4 matrix equivalent to this quaternion-transform
+	// Get the 4x4 matrix equivalent to this quaternion-transform. Assumes the quaternion is
+	// normalised, which allows the scale to be combined in a single pass
     void GetMatrix
 	(
 		CMatrix4x4& mat
 	) const
 	{
-		// Create initial matrix from quaternion
-		mat = CMatrix4x4( quat );
+		mat.MakeAffineQuaternion( quat, pos, scale );
+	}
+
+
+	/*-----------------------------------------------------------------------------------------
+		Axes and angles
+	-----------------------------------------------------------------------------------------*/
+	// These functions assume the quaternion is normalised. The axes returned are unit length
+	// (scaling is not included) and match the rows of the equivalent matrix
+
+	// Return the local X axis of this transform
+	CVector3 XAxis() const
+	{
+		return CVector3( 1.0f - 2.0f*(quat.y*quat.y + quat.z*quat.z),
+		                 2.0f*(quat.x*quat.y + quat.w*quat.z),
+		                 2.0f*(quat.z*quat.x - quat.w*quat.y) );
+	}
+
+	// Return the local Y axis of this transform
+	CVector3 YAxis() const
+	{
+		return CVector3( 2.0f*(quat.x*quat.y - quat.w*quat.z),
+		                 1.0f - 2.0f*(quat.x*quat.x + quat.z*quat.z),
+		                 2.0f*(quat.y*quat.z + quat.w*quat.x) );
+	}
+
+	// Return the local Z axis of this transform
+	CVector3 ZAxis() const
+	{
+		return CVector3( 2.0f*(quat.z*quat.x + quat.w*quat.y),
+		                 2.0f*(quat.y*quat.z - quat.w*quat.x),
+		                 1.0f - 2.0f*(quat.x*quat.x + quat.y*quat.y) );
+	}
+
+	// Return the angle (radians) of the local Z axis around the world Y axis. For a transform
+	// that only rotates around Y this is the same as the Y angle from DecomposeAffineEuler, but
+	// avoids the full decomposition
+	TFloat32 GetYaw() const
+	{
+		return ATan( 2.0f*(quat.z*quat.x + quat.w*quat.y),
+		             1.0f - 2.0f*(quat.x*quat.x + quat.y*quat.y) );
+	}
+
+
+	/*-----------------------------------------------------------------------------------------
+		Manipulation
+	-----------------------------------------------------------------------------------------*/
+	// Equivalents of the CMatrix4x4 affine manipulation functions of the same names
 
-		// Add scale and position to matrix
-		mat.SetScale( scale );
-		mat.SetPosition( pos );
+	// Move position along the local X, Y or Z axis. Will move exactly the given number of units,
+	// regardless of scaling
+	void MoveLocalX( const TFloat32 x )
+	{
+		pos += XAxis() * x;
+	}
+	void MoveLocalY( const TFloat32 y )
+	{
+		pos += YAxis() * y;
 	}
+	void MoveLocalZ( const TFloat32 z )
+	{
+		pos += ZAxis() * z;
+	}
+
+	// Rotate by given angle (radians) around world X, Y or Z axis & local origin
+	void RotateX( const TFloat32 x );
+	void RotateY( const TFloat32 y );
+	void RotateZ( const TFloat32 z );
+
+	// Alter the scale in the local X, Y & Z directions. The effect is multiplicative
+	void Scale( const CVector3& s )
+	{
+		scale.Set( scale.x * s.x, scale.y * s.y, scale.z * s.z );
+	}
+
+	// Rotate to face from current position to given target (in the Z direction). Can pass up
+	// vector. Retains the current scaling
+	void FaceTarget
+	(
+		const CVector3& target,
+		const CVector3& up = CVector3::kYAxis
+	);
 
 
 	/*-----------------------------------------------------------------------------------------
@@ -269,7 +342,7 @@ public:
 // Addition / subtraction
 
 // Addition
-inline CQuatTransform operator+
+constexpr CQuatTransform operator+
 (
 	const CQuatTransform& qt1,
 	const CQuatTransform& qt2
@@ -279,7 +352,7 @@ inline CQuatTransform operator+
 }
 
 // Subtraction
-inline CQuatTransform operator-
+constexpr CQuatTransform operator-
 (
 	const CQuatTransform& qt1,
 	const CQuatTransform& qt2
@@ -289,7 +362,7 @@ inline CQuatTransform operator-
 }
 
 // Unary positive (for completeness)
-inline CQuatTransform operator+
+constexpr CQuatTransform operator+
 (
 	const CQuatTransform& qt
 )
@@ -298,7 +371,7 @@ inline CQuatTransform operator+
 }
 
 // Unary negation
-inline CQuatTransform operator-
+constexpr CQuatTransform operator-
 (
 	const CQuatTransform& qt
 )
@@ -311,7 +384,7 @@ inline CQuatTransform operator-
 // Scalar operations
 
 // Scalar multiplication
-inline CQuatTransform operator*
+constexpr CQuatTransform operator*
 (
 	const CQuatTransform& qt1,
 	const TFloat32        scalar
@@ -36,7 +36,7 @@ public:
 	CQuaternion() {}
 
 	// Construct by value - four floats
-	CQuaternion
+	constexpr CQuaternion
 	(
 		const TFloat32 initW,
 		const TFloat32 initX,
@@ -45,7 +45,7 @@ public:
 	) : w( initW ), x( initX ), y( initY ), z( initZ ) {}
 
 	// Construct by value - float and CVector3
-	CQuaternion
+	constexpr CQuaternion
 	(
 		const TFloat32 initW,
 		const CVector3 initV
@@ -59,7 +59,7 @@ public:
 	) : w( pWXYZ[0] ), x( pWXYZ[1] ), y( pWXYZ[2] ), z( pWXYZ[3] ) {}
 
  	// Construct from a CVector3 - w value becomes 0
-	explicit CQuaternion
+	explicit constexpr CQuaternion
 	(
 		const CVector3& src
 	) : w( 0.0f ), x( src.x ), y( src.y ), z( src.z ) {};
@@ -72,13 +72,13 @@ public:
 
 
 	// Copy constructor
-    CQuaternion
+    constexpr CQuaternion
 	(
 		const CQuaternion& src
 	) : w( src.w ), x( src.x ), y( src.y ), z( src.z ) {}
 
 	// Assignment operator
-    CQuaternion& operator=
+    constexpr CQuaternion& operator=
 	(
 		const CQuaternion& src
 	)
@@ -93,9 +93,6 @@ public:
 		return *this;
 	}
 
-	// Destructor
-	~CQuaternion() {}
-
 
 	/*-----------------------------------------------------------------------------------------
 		Setters
@@ -247,7 +244,7 @@ public:
 	// Addition / subtraction
 
 	// Add another quaternion to this quaternion
-    CQuaternion& operator+=
+    constexpr CQuaternion& operator+=
 	(
 		const CQuaternion& quat
 	)
@@ -260,7 +257,7 @@ public:
 	}
 
 	// Subtract another quaternion from this quaternion
-    CQuaternion& operator-=
+    constexpr CQuaternion& operator-=
 	(
 		const CQuaternion& quat
 	)
@@ -277,7 +274,7 @@ public:
 	// Scalar multiplication & division
 
 	// Multiply this quaternion by a scalar
-	CQuaternion& operator*=
+	constexpr CQuaternion& operator*=
 	(
 		const TFloat32 scalar
 	)
@@ -307,14 +304,14 @@ public:
 	// Quaternion multiplication
 
 	// Binary form as friend to define function below
-	friend CQuaternion operator*
+	friend constexpr CQuaternion operator*
 	(
 		const CQuaternion& quat1,
 		const CQuaternion& quat2
 	);
 
 	// Multiply this quaternion by another
-    CQuaternion& operator*=
+    constexpr CQuaternion& operator*=
 	(
 		const CQuaternion& quat
 	)
@@ -328,7 +325,7 @@ public:
 	// Other operations
 
 	// Dot product of this with another quaternion
-    TFloat32 Dot
+    constexpr TFloat32 Dot
 	(
 		const CQuaternion& quat
 	) const
@@ -349,7 +346,7 @@ public:
 	}
 
 	// Return squared norm of this quaternion
-	TFloat32 NormSquared() const
+	constexpr TFloat32 NormSquared() const
 	{
 		return w*w + x*x + y*y + z*z;
 	}
@@ -438,7 +435,7 @@ inline bool operator!=
 // Addition / subtraction
 
 // Quaternion addition
-inline CQuaternion operator+
+constexpr CQuaternion operator+
 (
 	const CQuaternion& quat1,
 	const CQuaternion& quat2
@@ -448,7 +445,7 @@ inline CQuaternion operator+
 }
 
 // Quaternion subtraction
-inline CQuaternion operator-
+constexpr CQuaternion operator-
 (
 	const CQuaternion& quat1,
 	const CQuaternion& quat2
@@ -458,7 +455,7 @@ inline CQuaternion operator-
 }
 
 // Unary positive (for completeness)
-inline CQuaternion operator+
+constexpr CQuaternion operator+
 (
 	const CQuaternion& quat
 )
@@ -467,7 +464,7 @@ inline CQuaternion operator+
 }
 
 // Unary negation
-inline CQuaternion operator-
+constexpr CQuaternion operator-
 (
 	const CQuaternion& quat
 )
@@ -480,7 +477,7 @@ inline CQuaternion operator-
 // Scalar multiplication & division
 
 // Quaternion multiplied by scalar
-inline CQuaternion operator*
+constexpr CQuaternion operator*
 (
 	const CQuaternion& quat,
 	const TFloat32     scalar
@@ -490,7 +487,7 @@ inline CQuaternion operator*
 }
 
 // Scalar multiplied by quaternion
-inline CQuaternion operator*
+constexpr CQuaternion operator*
 (
 	const TFloat32     scalar,
 	const CQuaternion& quat
@@ -514,18 +511,25 @@ inline CQuaternion operator/
 // Quaternion multiplication
 
 // Return the quaternion result of multiplying two quaternions
-CQuaternion operator*
+constexpr CQuaternion operator*
 (
-	const CQuaternion& quat1,
-	const CQuaternion& quat2
-);
+	const CQuaternion& q1,
+	const CQuaternion& q2
+)
+{
+	// w = w1*w2 - v1.v2, v = w1*v2 + w2*v1 + v2 x v1
+	return CQuaternion( q1.w*q2.w - q1.x*q2.x - q1.y*q2.y - q1.z*q2.z,
+	                    q1.w*q2.x + q2.w*q1.x + q2.y*q1.z - q2.z*q1.y,
+	                    q1.w*q2.y + q2.w*q1.y + q2.z*q1.x - q2.x*q1.z,
+	                    q1.w*q2.z + q2.w*q1.z + q2.x*q1.y - q2.y*q1.x );
+}
 
 
 ////////////////////////////////////
 // Other operations
 
 // Dot product of two given quaternions (order not important) - non-member version
-inline TFloat32 Dot
+constexpr TFloat32 Dot
 (
 	const CQuaternion& quat1,
 	const CQuaternion& quat2
@@ -549,7 +553,7 @@ inline TFloat32 Norm
 }
 
 // Return squared norm of a quaternion - non-member version
-inline TFloat32 NormSquared
+constexpr TFloat32 NormSquared
 (
 	const CQuaternion& quat
 )
@@ -42,7 +42,7 @@ public:
 	CVector3() {}
 
 	// Construct by value
-	CVector3
+	constexpr CVector3
 	(
 		const TFloat32 xIn,
 		const TFloat32 yIn,
@@ -68,7 +68,7 @@ public:
 
 
 	// Construct as vector between two points (p1 to p2)
-	CVector3
+	constexpr CVector3
 	(
 		const CVector3& p1,
 		const CVector3& p2
@@ -77,7 +77,7 @@ public:
 
 
 	// Construct from a CVector2 and a z value (defaults to 0)
-	explicit CVector3
+	explicit constexpr CVector3
 	(
 		const CVector2& v,
 		const TFloat32 zIn = 0.0f
@@ -91,11 +91,11 @@ public:
 
 
 	// Copy constructor, construct from CVector3
-    CVector3( const CVector3& v ) : x( v.x ), y( v.y ), z( v.z )
+    constexpr CVector3( const CVector3& v ) : x( v.x ), y( v.y ), z( v.z )
 	{}
 
 	// Assignment operator
-    CVector3& operator=( const CVector3& v )
+    constexpr CVector3& operator=( const CVector3& v )
 	{
 		if ( this != &v )
 		{
@@ -112,7 +112,7 @@ public:
 	-----------------------------------------------------------------------------------------*/
 
 	// Set all three vector components
-    void Set
+    constexpr void Set
 	(
 		const TFloat32 xIn,
 		const TFloat32 yIn,
@@ -133,7 +133,7 @@ public:
 	}
 
 	// Set as vector between two points (p1 to p2)
-    void Set
+    constexpr void Set
 	(
 		const CVector3& p1,
 		const CVector3& p2
@@ -145,7 +145,7 @@ public:
 	}
 
 	// Set the vector to (0,0,0)
-    void SetZero()
+    constexpr void SetZero()
 	{
 		x = y = z = 0.0f;
 	}
@@ -218,7 +218,7 @@ public:
 	// Addition / subtraction
 
 	// Add another vector to this vector
-    CVector3& operator+=( const CVector3& v )
+    constexpr CVector3& operator+=( const CVector3& v )
 	{
 		x += v.x;
 		y += v.y;
@@ -227,7 +227,7 @@ public:
 	}
 
 	// Subtract another vector from this vector
-    CVector3& operator-=( const CVector3& v )
+    constexpr CVector3& operator-=( const CVector3& v )
 	{
 		x -= v.x;
 		y -= v.y;
@@ -240,7 +240,7 @@ public:
 	// Scalar multiplication & division
 
 	// Multiply this vector by a scalar
-	CVector3& operator*=( const TFloat32 s )
+	constexpr CVector3& operator*=( const TFloat32 s )
 	{
 		x *= s;
 		y *= s;
@@ -267,14 +267,14 @@ public:
 	// Other operations
 
 	// Dot product of this with another vector
-    TFloat32 Dot( const CVector3& v ) const
+    constexpr TFloat32 Dot( const CVector3& v ) const
 	{
 	    return x*v.x + y*v.y + z*v.z;
 	}
 	
 	
 	// Cross product of this with another vector
-    CVector3 Cross( const CVector3& v ) const
+    constexpr CVector3 Cross( const CVector3& v ) const
 	{
 		return CVector3(y*v.z - z*v.y, z*v.x - x*v.z, x*v.y - y*v.x);
 	}
@@ -294,7 +294,7 @@ public:
 	// Return squared length of this vector
 	// More efficient than Length when exact value is not required (e.g. for comparisons)
 	// Use InvSqrt( LengthSquared(...) ) to calculate 1 / length more efficiently
-	TFloat32 LengthSquared() const
+	constexpr TFloat32 LengthSquared() const
 	{
 		return x*x + y*y + z*z;
 	}
@@ -370,7 +370,7 @@ inline bool operator!=
 // Addition / subtraction
 
 // Vector addition
-inline CVector3 operator+
+constexpr CVector3 operator+
 (
 	const CVector3& v1,
 	const CVector3& v2
@@ -380,7 +380,7 @@ inline CVector3 operator+
 }
 
 // Vector subtraction
-inline CVector3 operator-
+constexpr CVector3 operator-
 (
 	const CVector3& v1,
 	const CVector3& v2
@@ -390,13 +390,13 @@ inline CVector3 operator-
 }
 
 // Unary positive (i.e. a = +v, included for completeness)
-inline CVector3 operator+( const CVector3& v )
+constexpr CVector3 operator+( const CVector3& v )
 {
 	return v;
 }
 
 // Unary negation (i.e. a = -v)
-inline CVector3 operator-( const CVector3& v )
+constexpr CVector3 operator-( const CVector3& v )
 {
 	return CVector3(-v.x, -v.y, -v.z);
 }
@@ -406,7 +406,7 @@ inline CVector3 operator-( const CVector3& v )
 // Scalar multiplication & division
 
 // Vector multiplied by scalar
-inline CVector3 operator*
+constexpr CVector3 operator*
 (
 	const CVector3& v,
 	const TFloat32  s
@@ -416,7 +416,7 @@ inline CVector3 operator*
 }
 
 // Scalar multiplied by vector
-inline CVector3 operator*
+constexpr CVector3 operator*
 (
 	const TFloat32  s,
 	const CVector3& v
@@ -445,7 +445,7 @@ inline CVector3 operator/
 // Other operations
 
 // Dot product of two given vectors (order not important) - non-member version
-inline TFloat32 Dot
+constexpr TFloat32 Dot
 (
 	const CVector3& v1,
 	const CVector3& v2
@@ -455,7 +455,7 @@ inline TFloat32 Dot
 }
 
 // Cross product of two given vectors (order is important) - non-member version
-inline CVector3 Cross
+constexpr CVector3 Cross
 (
 	const CVector3& v1,
 	const CVector3& v2
@@ -478,7 +478,7 @@ inline TFloat32 Length( const CVector3& v )
 // Return squared length of given vector
 // More efficient than Length when exact value is not required (e.g. for comparisons)
 // Use InvSqrt( LengthSquared(...) ) to calculate 1 / length more efficiently
-inline TFloat32 LengthSquared( const CVector3& v )
+constexpr TFloat32 LengthSquared( const CVector3& v )
 {
 	return v.x*v.x + v.y*v.y + v.z*v.z;
 }
@@ -0,0 +1,172 @@
+/*******************************************
+	FastMath.h
+
+	Approximate versions of the BaseMath
+	square root and trigonometry functions,
+	trading accuracy for speed
+********************************************/
+
+#ifndef GEN_FAST_MATH_H_INCLUDED
+#define GEN_FAST_MATH_H_INCLUDED
+
+#include <xmmintrin.h>
+#include <emmintrin.h>
+
+#include "Defines.h"
+#include "BaseMath.h"
+
+namespace gen
+{
+
+// The functions here are for code that can tolerate a small loss of accuracy, typically game
+// simulation (AI, movement) rather than rendering or the math library itself. Each function
+// states the maximum error over its valid input range
+//
+// The ...4 functions process four values at once in SSE registers. Inputs outside the valid
+// ranges given are not checked
+
+
+/*-----------------------------------------------------------------------------------------
+	Inverse square root
+-----------------------------------------------------------------------------------------*/
+
+// 1 / Sqrt of four values. Hardware estimate refined with one Newton-Raphson step
+// Valid for x > 0 (normalised floats). Maximum relative error 4.0e-7 (about 3 ULP) for any
+// hardware estimate within the SSE specification, 2.7e-7 measured over all inputs
+inline __m128 FastInvSqrt4( const __m128 x )
+{
+	const __m128 half = _mm_set1_ps( 0.5f );
+	const __m128 threeHalves = _mm_set1_ps( 1.5f );
+
+	// y' = y * (1.5 - 0.5 * x * y * y)
+	__m128 y = _mm_rsqrt_ps( x );
+	__m128 xyy = _mm_mul_ps( _mm_mul_ps( x, y ), y );
+	return _mm_mul_ps( y, _mm_sub_ps( threeHalves, _mm_mul_ps( half, xyy ) ) );
+}
+
+// 1 / Sqrt. Hardware estimate refined with one Newton-Raphson step
+// Valid for x > 0 (normalised floats). Maximum relative error 4.0e-7 (about 3 ULP) for any
+// hardware estimate within the SSE specification, 2.7e-7 measured over all inputs
+inline TFloat32 FastInvSqrt( const TFloat32 x )
+{
+	__m128 vx = _mm_set_ss( x );
+	__m128 y = _mm_rsqrt_ss( vx );
+	__m128 xyy = _mm_mul_ss( _mm_mul_ss( vx, y ), y );
+	y = _mm_mul_ss( y, _mm_sub_ss( _mm_set_ss( 1.5f ), _mm_mul_ss( _mm_set_ss( 0.5f ), xyy ) ) );
+	return _mm_cvtss_f32( y );
+}
+
+
+/*-----------------------------------------------------------------------------------------
+	Sine and cosine
+-----------------------------------------------------------------------------------------*/
+
+// Sin and cos of four values. Range reduction to [-pi/4, pi/4] followed by polynomials
+// Valid for |x| <= 8192. Maximum absolute error 1.0e-7 for |x| <= 1000, 1.5e-7 at the limit
+inline void FastSinCos4
+(
+	const __m128 x,
+	__m128*      pSin,
+	__m128*      pCos
+)
+{
+	// Quadrant q = round(x * 2/pi), then r = x - q * pi/2. The multiple of pi/2 is subtracted in
+	// two parts to preserve accuracy (Cody-Waite reduction)
+	__m128i q = _mm_cvtps_epi32( _mm_mul_ps( x, _mm_set1_ps( 0.63661977236758134f ) ) );
+	__m128 qf = _mm_cvtepi32_ps( q );
+	__m128 r = _mm_sub_ps( x, _mm_mul_ps( qf, _mm_set1_ps( 1.5703125f ) ) );
+	r = _mm_sub_ps( r, _mm_mul_ps( qf, _mm_set1_ps( 4.8382679e-4f ) ) );
+	__m128 r2 = _mm_mul_ps( r, r );
+
+	// Minimax polynomials for sin and cos over [-pi/4, pi/4]
+	__m128 s = _mm_set1_ps( -1.9515295891e-4f );
+	s = _mm_add_ps( _mm_mul_ps( s, r2 ), _mm_set1_ps( 8.3321608736e-3f ) );
+	s = _mm_add_ps( _mm_mul_ps( s, r2 ), _mm_set1_ps( -1.6666654611e-1f ) );
+	s = _mm_add_ps( _mm_mul_ps( _mm_mul_ps( s, r2 ), r ), r );
+
+	__m128 c = _mm_set1_ps( 2.443315711809948e-5f );
+	c = _mm_add_ps( _mm_mul_ps( c, r2 ), _mm_set1_ps( -1.388731625493765e-3f ) );
+	c = _mm_add_ps( _mm_mul_ps( c, r2 ), _mm_set1_ps( 4.166664568298827e-2f ) );
+	c = _mm_mul_ps( _mm_mul_ps( c, r2 ), r2 );
+	c = _mm_add_ps( _mm_sub_ps( c, _mm_mul_ps( _mm_set1_ps( 0.5f ), r2 ) ), _mm_set1_ps( 1.0f ) );
+
+	// Use the quadrant to select and negate: odd quadrants swap sin & cos, sin is negated in
+	// quadrants 2 & 3, cos in quadrants 1 & 2
+	const __m128i one = _mm_set1_epi32( 1 );
+	const __m128i two = _mm_set1_epi32( 2 );
+	__m128 swap = _mm_castsi128_ps( _mm_cmpeq_epi32( _mm_and_si128( q, one ), one ) );
+	__m128 sinNeg = _mm_castsi128_ps( _mm_slli_epi32( _mm_and_si128( q, two ), 30 ) );
+	__m128 cosNeg = _mm_castsi128_ps( _mm_slli_epi32( _mm_and_si128( _mm_add_epi32( q, one ), two ), 30 ) );
+
+	__m128 sinResult = _mm_or_ps( _mm_and_ps( swap, c ), _mm_andnot_ps( swap, s ) );
+	__m128 cosResult = _mm_or_ps( _mm_and_ps( swap, s ), _mm_andnot_ps( swap, c ) );
+	*pSin = _mm_xor_ps( sinResult, sinNeg );
+	*pCos = _mm_xor_ps( cosResult, cosNeg );
+}
+
+// Get both sin and cos of x, using the same method as FastSinCos4
+// Valid for |x| <= 8192. Maximum absolute error 1.0e-7 for |x| <= 1000, 1.5e-7 at the limit
+inline void FastSinCos
+(
+	const TFloat32 x,
+	TFloat32*      pSin,
+	TFloat32*      pCos
+)
+{
+	TInt32 q = _mm_cvtss_si32( _mm_set_ss( x * 0.63661977236758134f ) );
+	TFloat32 qf = static_cast<TFloat32>(q);
+	TFloat32 r = (x - qf * 1.5703125f) - qf * 4.8382679e-4f;
+	TFloat32 r2 = r * r;
+
+	TFloat32 s = ((-1.9515295891e-4f * r2 + 8.3321608736e-3f) * r2 - 1.6666654611e-1f) * r2 * r + r;
+	TFloat32 c = ((2.443315711809948e-5f * r2 - 1.388731625493765e-3f) * r2 + 4.166664568298827e-2f) *
+	             r2 * r2 - 0.5f * r2 + 1.0f;
+
+	// Select and negate by quadrant: odd quadrants swap sin & cos, sin is negated in quadrants
+	// 2 & 3, cos in quadrants 1 & 2
+	TFloat32 sinVal = (q & 1) ? c : s;
+	TFloat32 cosVal = (q & 1) ? s : c;
+	*pSin = (q & 2) ? -sinVal : sinVal;
+	*pCos = ((q + 1) & 2) ? -cosVal : cosVal;
+}
+
+
+/*-----------------------------------------------------------------------------------------
+	Arc cosine
+-----------------------------------------------------------------------------------------*/
+
+// Arc cosine of four values. Uses acos(x) = sqrt(1 - x) * P(x) for x >= 0, with the polynomial
+// from Abramowitz & Stegun 4.4.46, and acos(-x) = pi - acos(x)
+// Inputs are clamped to [-1, 1], so dot products of normalised vectors that round to just over 1
+// are safe. Maximum absolute error 4.5e-7 radians
+inline __m128 FastACos4( const __m128 x )
+{
+	const __m128 signMask = _mm_set1_ps( -0.0f );
+	__m128 negative = _mm_cmplt_ps( x, _mm_setzero_ps() );
+	__m128 a = _mm_min_ps( _mm_andnot_ps( signMask, x ), _mm_set1_ps( 1.0f ) );
+
+	__m128 p = _mm_set1_ps( -0.0012624911f );
+	p = _mm_add_ps( _mm_mul_ps( p, a ), _mm_set1_ps( 0.0066700901f ) );
+	p = _mm_add_ps( _mm_mul_ps( p, a ), _mm_set1_ps( -0.0170881256f ) );
+	p = _mm_add_ps( _mm_mul_ps( p, a ), _mm_set1_ps( 0.0308918810f ) );
+	p = _mm_add_ps( _mm_mul_ps( p, a ), _mm_set1_ps( -0.0501743046f ) );
+	p = _mm_add_ps( _mm_mul_ps( p, a ), _mm_set1_ps( 0.0889789874f ) );
+	p = _mm_add_ps( _mm_mul_ps( p, a ), _mm_set1_ps( -0.2145988016f ) );
+	p = _mm_add_ps( _mm_mul_ps( p, a ), _mm_set1_ps( 1.5707963050f ) );
+	p = _mm_mul_ps( p, _mm_sqrt_ps( _mm_sub_ps( _mm_set1_ps( 1.0f ), a ) ) );
+
+	__m128 reflected = _mm_sub_ps( _mm_set1_ps( kfPi ), p );
+	return _mm_or_ps( _mm_and_ps( negative, reflected ), _mm_andnot_ps( negative, p ) );
+}
+
+// Arc cosine, approximated as FastACos4
+// Inputs are clamped to [-1, 1]. Maximum absolute error 4.5e-7 radians
+inline TFloat32 FastACos( const TFloat32 x )
+{
+	return _mm_cvtss_f32( FastACos4( _mm_set_ss( x ) ) );
+}
+
+
+} // namespace gen
+
+#endif // GEN_FAST_MATH_H_INCLUDED
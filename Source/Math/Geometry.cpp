@@ -0,0 +1,628 @@
+/*******************************************
+	Geometry.cpp
+
+	Geometric primitives (boxes, spheres,
+	rays etc.) and intersection tests
+********************************************/
+
+#include <cfloat>
+#include <xmmintrin.h>
+
+#include "Geometry.h"
+
+namespace gen
+{
+
+// Direction components smaller than this are treated as zero when calculating the inverse
+// direction for box tests, and are given the large inverse below instead
+const TFloat32 kfMinDirection = 1.0e-20f;
+const TFloat32 kfLargeInverse = 1.0e30f;
+
+
+/*-----------------------------------------------------------------------------------------
+	Primitives
+-----------------------------------------------------------------------------------------*/
+
+// Set box to be empty (inside out), ready to be expanded with points or other boxes
+void SAABB::SetEmpty()
+{
+	minPt = CVector3( FLT_MAX, FLT_MAX, FLT_MAX );
+	maxPt = CVector3( -FLT_MAX, -FLT_MAX, -FLT_MAX );
+}
+
+// Expand the box to contain the given point
+void SAABB::Expand( const CVector3& pt )
+{
+	minPt = CVector3( Min( minPt.x, pt.x ), Min( minPt.y, pt.y ), Min( minPt.z, pt.z ) );
+	maxPt = CVector3( Max( maxPt.x, pt.x ), Max( maxPt.y, pt.y ), Max( maxPt.z, pt.z ) );
+}
+
+// Expand the box to contain the given box
+void SAABB::Expand( const SAABB& box )
+{
+	minPt = CVector3( Min( minPt.x, box.minPt.x ), Min( minPt.y, box.minPt.y ), Min( minPt.z, box.minPt.z ) );
+	maxPt = CVector3( Max( maxPt.x, box.maxPt.x ), Max( maxPt.y, box.maxPt.y ), Max( maxPt.z, box.maxPt.z ) );
+}
+
+// Surface area of the box
+TFloat32 SAABB::SurfaceArea() const
+{
+	CVector3 size = maxPt - minPt;
+	return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+}
+
+
+// Set one of the four boxes
+void SAABB4::Set( const TUInt32 index, const SAABB& box )
+{
+	minX[index] = box.minPt.x;
+	minY[index] = box.minPt.y;
+	minZ[index] = box.minPt.z;
+	maxX[index] = box.maxPt.x;
+	maxY[index] = box.maxPt.y;
+	maxZ[index] = box.maxPt.z;
+}
+
+// Set one of the four boxes to be empty (inside out) - the box tests never report a hit on it
+void SAABB4::SetEmpty( const TUInt32 index )
+{
+	minX[index] = minY[index] = minZ[index] = FLT_MAX;
+	maxX[index] = maxY[index] = maxZ[index] = -FLT_MAX;
+}
+
+// Set one of the four rays
+void SRay4::Set( const TUInt32 index, const SRay& ray )
+{
+	SPrecalcRay precalc = PrecalcRay( ray, 0.0f );
+	originX[index] = ray.origin.x;
+	originY[index] = ray.origin.y;
+	originZ[index] = ray.origin.z;
+	dirX[index] = ray.direction.x;
+	dirY[index] = ray.direction.y;
+	dirZ[index] = ray.direction.z;
+	invDirX[index] = precalc.invDirection.x;
+	invDirY[index] = precalc.invDirection.y;
+	invDirZ[index] = precalc.invDirection.z;
+}
+
+// Set one of the four spheres
+void SSphere4::Set( const TUInt32 index, const SSphere& sphere )
+{
+	x[index] = sphere.centre.x;
+	y[index] = sphere.centre.y;
+	z[index] = sphere.centre.z;
+	radius[index] = sphere.radius;
+}
+
+
+/*-----------------------------------------------------------------------------------------
+	Construction
+-----------------------------------------------------------------------------------------*/
+
+// Return the axis-aligned box containing a box after it is transformed by a matrix
+SAABB TransformAABB( const SAABB& box, const CMatrix4x4& mat )
+{
+	// Transform the centre, then find the new half-size by summing the absolute contributions
+	// of each of the old half-size components (Arvo's method)
+	CVector3 centre = mat.TransformPoint( box.Centre() );
+	CVector3 extents = box.Extents();
+	CVector3 newExtents( Abs( mat.e00 ) * extents.x + Abs( mat.e10 ) * extents.y + Abs( mat.e20 ) * extents.z,
+	                     Abs( mat.e01 ) * extents.x + Abs( mat.e11 ) * extents.y + Abs( mat.e21 ) * extents.z,
+	                     Abs( mat.e02 ) * extents.x + Abs( mat.e12 ) * extents.y + Abs( mat.e22 ) * extents.z );
+
+	SAABB result;
+	result.minPt = centre - newExtents;
+	result.maxPt = centre + newExtents;
+	return result;
+}
+
+// Return the oriented box given by transforming an axis-aligned box by a matrix. The matrix
+// may contain scaling but not shear
+SOBB TransformToOBB( const SAABB& box, const CMatrix4x4& mat )
+{
+	CVector3 extents = box.Extents();
+	CVector3 axisX( mat.e00, mat.e01, mat.e02 );
+	CVector3 axisY( mat.e10, mat.e11, mat.e12 );
+	CVector3 axisZ( mat.e20, mat.e21, mat.e22 );
+	TFloat32 scaleX = Length( axisX );
+	TFloat32 scaleY = Length( axisY );
+	TFloat32 scaleZ = Length( axisZ );
+
+	SOBB result;
+	result.centre = mat.TransformPoint( box.Centre() );
+	result.axes[0] = axisX / scaleX;
+	result.axes[1] = axisY / scaleY;
+	result.axes[2] = axisZ / scaleZ;
+	result.extents = CVector3( extents.x * scaleX, extents.y * scaleY, extents.z * scaleZ );
+	return result;
+}
+
+// Return the plane through a point with the given normal (normal need not be unit length)
+SPlane PlaneFromPointNormal( const CVector3& pt, const CVector3& normal )
+{
+	SPlane plane;
+	plane.normal = Normalise( normal );
+	plane.d = -Dot( plane.normal, pt );
+	return plane;
+}
+
+// Return the plane through three points, with normal in the direction of Cross( p2 - p1, p3 - p1 )
+SPlane PlaneFromPoints( const CVector3& p1, const CVector3& p2, const CVector3& p3 )
+{
+	return PlaneFromPointNormal( p1, Cross( p2 - p1, p3 - p1 ) );
+}
+
+
+// Return inverse of a direction component for the slab tests
+static TFloat32 SafeInverse( const TFloat32 d )
+{
+	if (Abs( d ) < kfMinDirection)
+	{
+		return (d < 0.0f) ? -kfLargeInverse : kfLargeInverse;
+	}
+	return 1.0f / d;
+}
+
+// Return the precalculated form of a ray
+SPrecalcRay PrecalcRay( const SRay& ray, const TFloat32 maxT )
+{
+	SPrecalcRay result;
+	result.origin = ray.origin;
+	result.invDirection = CVector3( SafeInverse( ray.direction.x ), SafeInverse( ray.direction.y ),
+	                                SafeInverse( ray.direction.z ) );
+	result.maxT = maxT;
+	return result;
+}
+
+// Return the precalculated form of a segment, maxT will be 1
+SPrecalcRay PrecalcRay( const SSegment& segment )
+{
+	SRay ray = { segment.start, segment.end - segment.start };
+	return PrecalcRay( ray, 1.0f );
+}
+
+
+/*-----------------------------------------------------------------------------------------
+	Ray / segment tests
+-----------------------------------------------------------------------------------------*/
+
+// Test a ray against an axis-aligned box. Optionally return the parametric distance of the
+// first hit in pT
+bool RayAABB( const SRay& ray, const TFloat32 maxT, const SAABB& box, TFloat32* pT /*= 0*/ )
+{
+	return RayAABB( PrecalcRay( ray, maxT ), box, pT );
+}
+
+// Test a precalculated ray against an axis-aligned box. Intersects the ray with the three
+// pairs of planes (slabs) bounding the box, the ray hits the box if these intervals overlap.
+// Empty (inside out) boxes are never hit - the slab intervals would be swapped into valid ones
+bool RayAABB( const SPrecalcRay& ray, const SAABB& box, TFloat32* pT /*= 0*/ )
+{
+	if (box.minPt.x > box.maxPt.x || box.minPt.y > box.maxPt.y || box.minPt.z > box.maxPt.z)
+	{
+		return false;
+	}
+
+	TFloat32 t1 = (box.minPt.x - ray.origin.x) * ray.invDirection.x;
+	TFloat32 t2 = (box.maxPt.x - ray.origin.x) * ray.invDirection.x;
+	TFloat32 tMin = Max( 0.0f, Min( t1, t2 ) );
+	TFloat32 tMax = Min( ray.maxT, Max( t1, t2 ) );
+
+	t1 = (box.minPt.y - ray.origin.y) * ray.invDirection.y;
+	t2 = (box.maxPt.y - ray.origin.y) * ray.invDirection.y;
+	tMin = Max( tMin, Min( t1, t2 ) );
+	tMax = Min( tMax, Max( t1, t2 ) );
+
+	t1 = (box.minPt.z - ray.origin.z) * ray.invDirection.z;
+	t2 = (box.maxPt.z - ray.origin.z) * ray.invDirection.z;
+	tMin = Max( tMin, Min( t1, t2 ) );
+	tMax = Min( tMax, Max( t1, t2 ) );
+
+	if (tMin > tMax)
+	{
+		return false;
+	}
+	if (pT)
+	{
+		*pT = tMin;
+	}
+	return true;
+}
+
+// Test a segment against an axis-aligned box
+bool SegmentAABB( const SSegment& segment, const SAABB& box, TFloat32* pT /*= 0*/ )
+{
+	return RayAABB( PrecalcRay( segment ), box, pT );
+}
+
+
+// Test a ray against an oriented box
+bool RayOBB( const SRay& ray, const TFloat32 maxT, const SOBB& box, TFloat32* pT /*= 0*/ )
+{
+	// Express the ray in the box's local space, then test against an axis-aligned box
+	CVector3 offset = ray.origin - box.centre;
+	SRay localRay;
+	localRay.origin = CVector3( Dot( offset, box.axes[0] ), Dot( offset, box.axes[1] ),
+	                            Dot( offset, box.axes[2] ) );
+	localRay.direction = CVector3( Dot( ray.direction, box.axes[0] ), Dot( ray.direction, box.axes[1] ),
+	                               Dot( ray.direction, box.axes[2] ) );
+	SAABB localBox = { -box.extents, box.extents };
+	return RayAABB( localRay, maxT, localBox, pT );
+}
+
+// Test a segment against an oriented box
+bool SegmentOBB( const SSegment& segment, const SOBB& box, TFloat32* pT /*= 0*/ )
+{
+	SRay ray = { segment.start, segment.end - segment.start };
+	return RayOBB( ray, 1.0f, box, pT );
+}
+
+
+// Test a ray against a sphere
+bool RaySphere( const SRay& ray, const TFloat32 maxT, const SSphere& sphere, TFloat32* pT /*= 0*/ )
+{
+	// Solve |origin + t * direction - centre| = radius, a quadratic in t
+	CVector3 offset = ray.origin - sphere.centre;
+	TFloat32 b = Dot( offset, ray.direction );
+	TFloat32 c = Dot( offset, offset ) - sphere.radius * sphere.radius;
+	if (c <= 0.0f)
+	{
+		// Starts inside sphere
+		if (pT)
+		{
+			*pT = 0.0f;
+		}
+		return true;
+	}
+	if (b > 0.0f)
+	{
+		return false; // Outside and pointing away
+	}
+
+	TFloat32 a = Dot( ray.direction, ray.direction );
+	TFloat32 discriminant = b * b - a * c;
+	if (discriminant < 0.0f || a == 0.0f)
+	{
+		return false;
+	}
+	TFloat32 t = (-b - Sqrt( discriminant )) / a;
+	if (t > maxT)
+	{
+		return false;
+	}
+	if (pT)
+	{
+		*pT = t;
+	}
+	return true;
+}
+
+// Test a segment against a sphere
+bool SegmentSphere( const SSegment& segment, const SSphere& sphere, TFloat32* pT /*= 0*/ )
+{
+	SRay ray = { segment.start, segment.end - segment.start };
+	return RaySphere( ray, 1.0f, sphere, pT );
+}
+
+
+// Test a ray against a plane, hitting from either side
+bool RayPlane( const SRay& ray, const TFloat32 maxT, const SPlane& plane, TFloat32* pT /*= 0*/ )
+{
+	TFloat32 startDist = plane.Distance( ray.origin );
+	TFloat32 approach = Dot( plane.normal, ray.direction );
+	if (approach == 0.0f)
+	{
+		// Parallel to plane - only hits if lying in it
+		if (startDist != 0.0f)
+		{
+			return false;
+		}
+		if (pT)
+		{
+			*pT = 0.0f;
+		}
+		return true;
+	}
+
+	TFloat32 t = -startDist / approach;
+	if (t < 0.0f || t > maxT)
+	{
+		return false;
+	}
+	if (pT)
+	{
+		*pT = t;
+	}
+	return true;
+}
+
+// Test a segment against a plane, hitting from either side
+bool SegmentPlane( const SSegment& segment, const SPlane& plane, TFloat32* pT /*= 0*/ )
+{
+	SRay ray = { segment.start, segment.end - segment.start };
+	return RayPlane( ray, 1.0f, plane, pT );
+}
+
+
+// Test a ray against a triangle, hitting from either side. Uses the Moller-Trumbore method,
+// solving for the distance and barycentric coordinates of the hit together
+bool RayTriangle( const SRay& ray, const TFloat32 maxT, const CVector3& v0, const CVector3& v1,
+                  const CVector3& v2, TFloat32* pT /*= 0*/ )
+{
+	CVector3 edge1 = v1 - v0;
+	CVector3 edge2 = v2 - v0;
+	CVector3 p = Cross( ray.direction, edge2 );
+	TFloat32 det = Dot( edge1, p );
+	if (det == 0.0f)
+	{
+		return false; // Ray parallel to triangle
+	}
+	TFloat32 invDet = 1.0f / det;
+
+	CVector3 offset = ray.origin - v0;
+	TFloat32 u = Dot( offset, p ) * invDet;
+	if (u < 0.0f || u > 1.0f)
+	{
+		return false;
+	}
+	CVector3 q = Cross( offset, edge1 );
+	TFloat32 v = Dot( ray.direction, q ) * invDet;
+	if (v < 0.0f || u + v > 1.0f)
+	{
+		return false;
+	}
+	TFloat32 t = Dot( edge2, q ) * invDet;
+	if (t < 0.0f || t > maxT)
+	{
+		return false;
+	}
+	if (pT)
+	{
+		*pT = t;
+	}
+	return true;
+}
+
+
+/*-----------------------------------------------------------------------------------------
+	Volume tests
+-----------------------------------------------------------------------------------------*/
+
+// Test if two spheres overlap
+bool SphereSphere( const SSphere& sphere1, const SSphere& sphere2 )
+{
+	TFloat32 radii = sphere1.radius + sphere2.radius;
+	return DistanceSquared( sphere1.centre, sphere2.centre ) <= radii * radii;
+}
+
+// Test if a sphere overlaps an axis-aligned box
+bool SphereAABB( const SSphere& sphere, const SAABB& box )
+{
+	// Find the nearest point in the box to the sphere centre
+	CVector3 nearest( Min( Max( sphere.centre.x, box.minPt.x ), box.maxPt.x ),
+	                  Min( Max( sphere.centre.y, box.minPt.y ), box.maxPt.y ),
+	                  Min( Max( sphere.centre.z, box.minPt.z ), box.maxPt.z ) );
+	return DistanceSquared( sphere.centre, nearest ) <= sphere.radius * sphere.radius;
+}
+
+// Test if two axis-aligned boxes overlap
+bool AABBAABB( const SAABB& box1, const SAABB& box2 )
+{
+	return box1.minPt.x <= box2.maxPt.x && box1.maxPt.x >= box2.minPt.x &&
+	       box1.minPt.y <= box2.maxPt.y && box1.maxPt.y >= box2.minPt.y &&
+	       box1.minPt.z <= box2.maxPt.z && box1.maxPt.z >= box2.minPt.z;
+}
+
+
+/*-----------------------------------------------------------------------------------------
+	Swept tests
+-----------------------------------------------------------------------------------------*/
+
+// Test a moving sphere against a stationary sphere. Equivalent to testing the path of the
+// moving sphere's centre against a sphere with the sum of the radii
+bool SweptSphereSphere( const SSphere& moving, const CVector3& movement, const SSphere& target,
+                        TFloat32* pT /*= 0*/ )
+{
+	SRay path = { moving.centre, movement };
+	SSphere expanded = { target.centre, moving.radius + target.radius };
+	return RaySphere( path, 1.0f, expanded, pT );
+}
+
+// Test a moving sphere against a stationary axis-aligned box. The box is expanded by the
+// sphere radius, so near the box edges and corners this may report hits slightly early
+bool SweptSphereAABB( const SSphere& moving, const CVector3& movement, const SAABB& box,
+                      TFloat32* pT /*= 0*/ )
+{
+	CVector3 radius( moving.radius, moving.radius, moving.radius );
+	SRay path = { moving.centre, movement };
+	SAABB expanded = { box.minPt - radius, box.maxPt + radius };
+	return RayAABB( path, 1.0f, expanded, pT );
+}
+
+
+/*-----------------------------------------------------------------------------------------
+	Batched SSE tests
+-----------------------------------------------------------------------------------------*/
+
+// Convert the result of an SSE comparison to a bit mask and store hit distances if required
+static TUInt32 HitMask4( const __m128 hit, const __m128 t, TFloat32* pT )
+{
+	if (pT)
+	{
+		_mm_storeu_ps( pT, t );
+	}
+	return static_cast<TUInt32>(_mm_movemask_ps( hit ));
+}
+
+// Test a ray against four axis-aligned boxes. Same slab method as the scalar version
+TUInt32 RayAABB4( const SPrecalcRay& ray, const SAABB4& boxes, TFloat32* pT /*= 0*/ )
+{
+	__m128 originX = _mm_set1_ps( ray.origin.x );
+	__m128 originY = _mm_set1_ps( ray.origin.y );
+	__m128 originZ = _mm_set1_ps( ray.origin.z );
+	__m128 invDirX = _mm_set1_ps( ray.invDirection.x );
+	__m128 invDirY = _mm_set1_ps( ray.invDirection.y );
+	__m128 invDirZ = _mm_set1_ps( ray.invDirection.z );
+
+	__m128 t1 = _mm_mul_ps( _mm_sub_ps( _mm_loadu_ps( boxes.minX ), originX ), invDirX );
+	__m128 t2 = _mm_mul_ps( _mm_sub_ps( _mm_loadu_ps( boxes.maxX ), originX ), invDirX );
+	__m128 tMin = _mm_max_ps( _mm_setzero_ps(), _mm_min_ps( t1, t2 ) );
+	__m128 tMax = _mm_min_ps( _mm_set1_ps( ray.maxT ), _mm_max_ps( t1, t2 ) );
+
+	t1 = _mm_mul_ps( _mm_sub_ps( _mm_loadu_ps( boxes.minY ), originY ), invDirY );
+	t2 = _mm_mul_ps( _mm_sub_ps( _mm_loadu_ps( boxes.maxY ), originY ), invDirY );
+	tMin = _mm_max_ps( tMin, _mm_min_ps( t1, t2 ) );
+	tMax = _mm_min_ps( tMax, _mm_max_ps( t1, t2 ) );
+
+	t1 = _mm_mul_ps( _mm_sub_ps( _mm_loadu_ps( boxes.minZ ), originZ ), invDirZ );
+	t2 = _mm_mul_ps( _mm_sub_ps( _mm_loadu_ps( boxes.maxZ ), originZ ), invDirZ );
+	tMin = _mm_max_ps( tMin, _mm_min_ps( t1, t2 ) );
+	tMax = _mm_min_ps( tMax, _mm_max_ps( t1, t2 ) );
+
+	// Empty (inside out) boxes are never hit
+	__m128 valid = _mm_and_ps( _mm_cmple_ps( _mm_loadu_ps( boxes.minX ), _mm_loadu_ps( boxes.maxX ) ),
+	                           _mm_cmple_ps( _mm_loadu_ps( boxes.minY ), _mm_loadu_ps( boxes.maxY ) ) );
+	valid = _mm_and_ps( valid, _mm_cmple_ps( _mm_loadu_ps( boxes.minZ ), _mm_loadu_ps( boxes.maxZ ) ) );
+
+	return HitMask4( _mm_and_ps( valid, _mm_cmple_ps( tMin, tMax ) ), tMin, pT );
+}
+
+// Test a segment against four axis-aligned boxes
+TUInt32 SegmentAABB4( const SSegment& segment, const SAABB4& boxes, TFloat32* pT /*= 0*/ )
+{
+	return RayAABB4( PrecalcRay( segment ), boxes, pT );
+}
+
+// Test a sphere against four spheres for overlap
+TUInt32 SphereSphere4( const SSphere& sphere, const SSphere4& spheres )
+{
+	__m128 dx = _mm_sub_ps( _mm_loadu_ps( spheres.x ), _mm_set1_ps( sphere.centre.x ) );
+	__m128 dy = _mm_sub_ps( _mm_loadu_ps( spheres.y ), _mm_set1_ps( sphere.centre.y ) );
+	__m128 dz = _mm_sub_ps( _mm_loadu_ps( spheres.z ), _mm_set1_ps( sphere.centre.z ) );
+	__m128 distSq = _mm_add_ps( _mm_add_ps( _mm_mul_ps( dx, dx ), _mm_mul_ps( dy, dy ) ), _mm_mul_ps( dz, dz ) );
+	__m128 radii = _mm_add_ps( _mm_loadu_ps( spheres.radius ), _mm_set1_ps( sphere.radius ) );
+
+	return static_cast<TUInt32>(_mm_movemask_ps( _mm_cmple_ps( distSq, _mm_mul_ps( radii, radii ) ) ));
+}
+
+// Test a moving sphere against four stationary spheres. Same method as the scalar version
+TUInt32 SweptSphereSphere4( const SSphere& moving, const CVector3& movement,
+                            const SSphere4& targets, TFloat32* pT /*= 0*/ )
+{
+	// Offset from each target centre to the start of the path
+	__m128 ox = _mm_sub_ps( _mm_set1_ps( moving.centre.x ), _mm_loadu_ps( targets.x ) );
+	__m128 oy = _mm_sub_ps( _mm_set1_ps( moving.centre.y ), _mm_loadu_ps( targets.y ) );
+	__m128 oz = _mm_sub_ps( _mm_set1_ps( moving.centre.z ), _mm_loadu_ps( targets.z ) );
+	__m128 radii = _mm_add_ps( _mm_loadu_ps( targets.radius ), _mm_set1_ps( moving.radius ) );
+
+	// Quadratic coefficients as RaySphere
+	__m128 b = _mm_add_ps( _mm_add_ps( _mm_mul_ps( ox, _mm_set1_ps( movement.x ) ),
+	                                   _mm_mul_ps( oy, _mm_set1_ps( movement.y ) ) ),
+	                       _mm_mul_ps( oz, _mm_set1_ps( movement.z ) ) );
+	__m128 c = _mm_sub_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps( ox, ox ), _mm_mul_ps( oy, oy ) ), _mm_mul_ps( oz, oz ) ),
+	                       _mm_mul_ps( radii, radii ) );
+	TFloat32 aScalar = Dot( movement, movement );
+	__m128 zero = _mm_setzero_ps();
+	__m128 inside = _mm_cmple_ps( c, zero );
+	if (aScalar == 0.0f)
+	{
+		return HitMask4( inside, zero, pT );
+	}
+
+	__m128 a = _mm_set1_ps( aScalar );
+	__m128 discriminant = _mm_sub_ps( _mm_mul_ps( b, b ), _mm_mul_ps( a, c ) );
+	__m128 t = _mm_div_ps( _mm_sub_ps( _mm_sub_ps( zero, b ), _mm_sqrt_ps( _mm_max_ps( discriminant, zero ) ) ), a );
+
+	// Hit if starting inside, or approaching with real roots and first contact within movement
+	__m128 hit = _mm_and_ps( _mm_cmple_ps( b, zero ), _mm_cmpge_ps( discriminant, zero ) );
+	hit = _mm_and_ps( hit, _mm_cmple_ps( t, _mm_set1_ps( 1.0f ) ) );
+	hit = _mm_or_ps( hit, inside );
+	t = _mm_andnot_ps( inside, t );
+
+	return HitMask4( hit, t, pT );
+}
+
+
+/*-----------------------------------------------------------------------------------------
+	Ray packet tests
+-----------------------------------------------------------------------------------------*/
+
+// Test four rays against an axis-aligned box. Same slab method as RayAABB
+TUInt32 Ray4AABB( const SRay4& rays, const TFloat32* pMaxT, const SAABB& box )
+{
+	if (box.minPt.x > box.maxPt.x || box.minPt.y > box.maxPt.y || box.minPt.z > box.maxPt.z)
+	{
+		return 0;
+	}
+
+	__m128 originX = _mm_loadu_ps( rays.originX );
+	__m128 originY = _mm_loadu_ps( rays.originY );
+	__m128 originZ = _mm_loadu_ps( rays.originZ );
+	__m128 invDirX = _mm_loadu_ps( rays.invDirX );
+	__m128 invDirY = _mm_loadu_ps( rays.invDirY );
+	__m128 invDirZ = _mm_loadu_ps( rays.invDirZ );
+
+	__m128 t1 = _mm_mul_ps( _mm_sub_ps( _mm_set1_ps( box.minPt.x ), originX ), invDirX );
+	__m128 t2 = _mm_mul_ps( _mm_sub_ps( _mm_set1_ps( box.maxPt.x ), originX ), invDirX );
+	__m128 tMin = _mm_max_ps( _mm_setzero_ps(), _mm_min_ps( t1, t2 ) );
+	__m128 tMax = _mm_min_ps( _mm_loadu_ps( pMaxT ), _mm_max_ps( t1, t2 ) );
+
+	t1 = _mm_mul_ps( _mm_sub_ps( _mm_set1_ps( box.minPt.y ), originY ), invDirY );
+	t2 = _mm_mul_ps( _mm_sub_ps( _mm_set1_ps( box.maxPt.y ), originY ), invDirY );
+	tMin = _mm_max_ps( tMin, _mm_min_ps( t1, t2 ) );
+	tMax = _mm_min_ps( tMax, _mm_max_ps( t1, t2 ) );
+
+	t1 = _mm_mul_ps( _mm_sub_ps( _mm_set1_ps( box.minPt.z ), originZ ), invDirZ );
+	t2 = _mm_mul_ps( _mm_sub_ps( _mm_set1_ps( box.maxPt.z ), originZ ), invDirZ );
+	tMin = _mm_max_ps( tMin, _mm_min_ps( t1, t2 ) );
+	tMax = _mm_min_ps( tMax, _mm_max_ps( t1, t2 ) );
+
+	return static_cast<TUInt32>(_mm_movemask_ps( _mm_cmple_ps( tMin, tMax ) ));
+}
+
+// Test four rays against a triangle, hitting from either side. Same method as RayTriangle.
+// Updates the maximum distance of rays that hit
+TUInt32 Ray4Triangle( const SRay4& rays, TFloat32* pMaxT, const CVector3& v0, const CVector3& v1,
+                      const CVector3& v2 )
+{
+	__m128 edge1X = _mm_set1_ps( v1.x - v0.x ), edge1Y = _mm_set1_ps( v1.y - v0.y ), edge1Z = _mm_set1_ps( v1.z - v0.z );
+	__m128 edge2X = _mm_set1_ps( v2.x - v0.x ), edge2Y = _mm_set1_ps( v2.y - v0.y ), edge2Z = _mm_set1_ps( v2.z - v0.z );
+	__m128 dirX = _mm_loadu_ps( rays.dirX ), dirY = _mm_loadu_ps( rays.dirY ), dirZ = _mm_loadu_ps( rays.dirZ );
+
+	// p = direction x edge2, det = edge1 . p
+	__m128 pX = _mm_sub_ps( _mm_mul_ps( dirY, edge2Z ), _mm_mul_ps( dirZ, edge2Y ) );
+	__m128 pY = _mm_sub_ps( _mm_mul_ps( dirZ, edge2X ), _mm_mul_ps( dirX, edge2Z ) );
+	__m128 pZ = _mm_sub_ps( _mm_mul_ps( dirX, edge2Y ), _mm_mul_ps( dirY, edge2X ) );
+	__m128 det = _mm_add_ps( _mm_add_ps( _mm_mul_ps( edge1X, pX ), _mm_mul_ps( edge1Y, pY ) ), _mm_mul_ps( edge1Z, pZ ) );
+	__m128 invDet = _mm_div_ps( _mm_set1_ps( 1.0f ), det );
+
+	// u = offset . p / det, where offset = origin - v0
+	__m128 offsetX = _mm_sub_ps( _mm_loadu_ps( rays.originX ), _mm_set1_ps( v0.x ) );
+	__m128 offsetY = _mm_sub_ps( _mm_loadu_ps( rays.originY ), _mm_set1_ps( v0.y ) );
+	__m128 offsetZ = _mm_sub_ps( _mm_loadu_ps( rays.originZ ), _mm_set1_ps( v0.z ) );
+	__m128 u = _mm_mul_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps( offsetX, pX ), _mm_mul_ps( offsetY, pY ) ),
+	                                   _mm_mul_ps( offsetZ, pZ ) ), invDet );
+
+	// q = offset x edge1, v = direction . q / det, t = edge2 . q / det
+	__m128 qX = _mm_sub_ps( _mm_mul_ps( offsetY, edge1Z ), _mm_mul_ps( offsetZ, edge1Y ) );
+	__m128 qY = _mm_sub_ps( _mm_mul_ps( offsetZ, edge1X ), _mm_mul_ps( offsetX, edge1Z ) );
+	__m128 qZ = _mm_sub_ps( _mm_mul_ps( offsetX, edge1Y ), _mm_mul_ps( offsetY, edge1X ) );
+	__m128 v = _mm_mul_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps( dirX, qX ), _mm_mul_ps( dirY, qY ) ),
+	                                   _mm_mul_ps( dirZ, qZ ) ), invDet );
+	__m128 t = _mm_mul_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps( edge2X, qX ), _mm_mul_ps( edge2Y, qY ) ),
+	                                   _mm_mul_ps( edge2Z, qZ ) ), invDet );
+
+	// Comparisons are all false for NaNs, so rays parallel to the triangle (det = 0) are rejected
+	__m128 zero = _mm_setzero_ps();
+	__m128 one = _mm_set1_ps( 1.0f );
+	__m128 maxT = _mm_loadu_ps( pMaxT );
+	__m128 hit = _mm_and_ps( _mm_cmpge_ps( u, zero ), _mm_cmpge_ps( v, zero ) );
+	hit = _mm_and_ps( hit, _mm_cmple_ps( _mm_add_ps( u, v ), one ) );
+	hit = _mm_and_ps( hit, _mm_and_ps( _mm_cmpge_ps( t, zero ), _mm_cmple_ps( t, maxT ) ) );
+
+	_mm_storeu_ps( pMaxT, _mm_or_ps( _mm_and_ps( hit, t ), _mm_andnot_ps( hit, maxT ) ) );
+	return static_cast<TUInt32>(_mm_movemask_ps( hit ));
+}
+
+
+} // namespace gen
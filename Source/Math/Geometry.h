@@ -0,0 +1,282 @@
+/*******************************************
+	Geometry.h
+
+	Geometric primitives (boxes, spheres,
+	rays etc.) and intersection tests
+********************************************/
+
+#ifndef GEN_GEOMETRY_H_INCLUDED
+#define GEN_GEOMETRY_H_INCLUDED
+
+#include "Defines.h"
+#include "BaseMath.h"
+#include "CVector3.h"
+#include "CMatrix4x4.h"
+
+namespace gen
+{
+
+// The primitives are plain structures with public data, the intersection tests are non-member
+// functions. None of the functions allocate memory
+//
+// Ray and segment tests can return the parametric distance of the first hit, t:
+//   o Rays: hit point = origin + t * direction, where 0 <= t <= maxT. The direction need not
+//     be normalised, if it is then t is the distance along the ray
+//   o Segments: hit point = start + t * (end - start), where 0 <= t <= 1
+// If the start point is inside the volume tested then t = 0. A ray lying exactly in the plane of
+// a box face, parallel to it, may or may not hit the box
+//
+// The ...4 functions test against four primitives at once using SSE, the primitives are
+// stored in the S...4 structures with one array per component (structure of arrays). These
+// functions return a bit mask with bit n set if primitive n was hit
+
+
+/*-----------------------------------------------------------------------------------------
+	Primitives
+-----------------------------------------------------------------------------------------*/
+
+// Axis-aligned bounding box, given by minimum and maximum corners
+struct SAABB
+{
+	CVector3 minPt;
+	CVector3 maxPt;
+
+	// Get centre point and half-size of the box
+	CVector3 Centre() const
+	{
+		return 0.5f * (minPt + maxPt);
+	}
+	CVector3 Extents() const
+	{
+		return 0.5f * (maxPt - minPt);
+	}
+
+	// Set box to be empty (inside out), ready to be expanded with points or other boxes. The ray
+	// and segment tests never report a hit on an empty box
+	void SetEmpty();
+
+	// Expand the box to contain the given point or box
+	void Expand( const CVector3& pt );
+	void Expand( const SAABB& box );
+
+	// Surface area of the box
+	TFloat32 SurfaceArea() const;
+
+	// Test if the box contains the given point
+	bool Contains( const CVector3& pt ) const
+	{
+		return pt.x >= minPt.x && pt.x <= maxPt.x && pt.y >= minPt.y && pt.y <= maxPt.y &&
+		       pt.z >= minPt.z && pt.z <= maxPt.z;
+	}
+};
+
+// Oriented bounding box, given by centre, three unit axes and the half-size along each axis
+struct SOBB
+{
+	CVector3 centre;
+	CVector3 axes[3];
+	CVector3 extents;
+};
+
+// Sphere
+struct SSphere
+{
+	CVector3 centre;
+	TFloat32 radius;
+};
+
+// Ray from an origin in a given direction
+struct SRay
+{
+	CVector3 origin;
+	CVector3 direction;
+};
+
+// Line segment between two points
+struct SSegment
+{
+	CVector3 start;
+	CVector3 end;
+};
+
+// Plane containing points p where Dot( normal, p ) + d = 0. The normal should be unit length
+struct SPlane
+{
+	CVector3 normal;
+	TFloat32 d;
+
+	// Signed distance from the plane to a point, positive on the side the normal faces
+	TFloat32 Distance( const CVector3& pt ) const
+	{
+		return Dot( normal, pt ) + d;
+	}
+};
+
+
+// Ray with precalculated inverse direction for fast repeated box tests (e.g. when traversing a
+// tree of boxes). Zero direction components are given a large finite inverse so the box tests
+// never generate NaNs
+struct SPrecalcRay
+{
+	CVector3 origin;
+	CVector3 invDirection;
+	TFloat32 maxT;
+};
+
+
+// Four axis-aligned bounding boxes, structure of arrays for the SSE functions
+struct SAABB4
+{
+	TFloat32 minX[4], minY[4], minZ[4];
+	TFloat32 maxX[4], maxY[4], maxZ[4];
+
+	// Set one of the four boxes
+	void Set( const TUInt32 index, const SAABB& box );
+
+	// Set one of the four boxes to be empty (inside out) - the box tests never report a hit on it
+	void SetEmpty( const TUInt32 index );
+};
+
+// Four rays with precalculated inverse directions, structure of arrays for the SSE packet
+// functions. Used to trace several rays with similar paths together (e.g. from the same point)
+struct SRay4
+{
+	TFloat32 originX[4], originY[4], originZ[4];
+	TFloat32 dirX[4], dirY[4], dirZ[4];
+	TFloat32 invDirX[4], invDirY[4], invDirZ[4];
+
+	// Set one of the four rays
+	void Set( const TUInt32 index, const SRay& ray );
+};
+
+// Four spheres, structure of arrays for the SSE functions
+struct SSphere4
+{
+	TFloat32 x[4], y[4], z[4];
+	TFloat32 radius[4];
+
+	// Set one of the four spheres
+	void Set( const TUInt32 index, const SSphere& sphere );
+};
+
+
+/*-----------------------------------------------------------------------------------------
+	Construction
+-----------------------------------------------------------------------------------------*/
+
+// Return the axis-aligned box containing a box after it is transformed by a matrix
+SAABB TransformAABB( const SAABB& box, const CMatrix4x4& mat );
+
+// Return the oriented box given by transforming an axis-aligned box by a matrix. The matrix
+// may contain scaling but not shear
+SOBB TransformToOBB( const SAABB& box, const CMatrix4x4& mat );
+
+// Return the plane through a point with the given normal (normal need not be unit length)
+SPlane PlaneFromPointNormal( const CVector3& pt, const CVector3& normal );
+
+// Return the plane through three points, with normal in the direction of Cross( p2 - p1, p3 - p1 )
+SPlane PlaneFromPoints( const CVector3& p1, const CVector3& p2, const CVector3& p3 );
+
+// Return the precalculated form of a ray or segment. For a segment maxT will be 1
+SPrecalcRay PrecalcRay( const SRay& ray, const TFloat32 maxT );
+SPrecalcRay PrecalcRay( const SSegment& segment );
+
+
+/*-----------------------------------------------------------------------------------------
+	Ray / segment tests
+-----------------------------------------------------------------------------------------*/
+
+// Test a ray or segment against an axis-aligned box. Optionally return the parametric distance
+// of the first hit in pT (see top of file)
+bool RayAABB( const SRay& ray, const TFloat32 maxT, const SAABB& box, TFloat32* pT = 0 );
+bool RayAABB( const SPrecalcRay& ray, const SAABB& box, TFloat32* pT = 0 );
+bool SegmentAABB( const SSegment& segment, const SAABB& box, TFloat32* pT = 0 );
+
+// Test a ray or segment against an oriented box
+bool RayOBB( const SRay& ray, const TFloat32 maxT, const SOBB& box, TFloat32* pT = 0 );
+bool SegmentOBB( const SSegment& segment, const SOBB& box, TFloat32* pT = 0 );
+
+// Test a ray or segment against a sphere
+bool RaySphere( const SRay& ray, const TFloat32 maxT, const SSphere& sphere, TFloat32* pT = 0 );
+bool SegmentSphere( const SSegment& segment, const SSphere& sphere, TFloat32* pT = 0 );
+
+// Test a ray or segment against a plane, hitting from either side
+bool RayPlane( const SRay& ray, const TFloat32 maxT, const SPlane& plane, TFloat32* pT = 0 );
+bool SegmentPlane( const SSegment& segment, const SPlane& plane, TFloat32* pT = 0 );
+
+
+// Test a ray against a triangle, hitting from either side
+bool RayTriangle( const SRay& ray, const TFloat32 maxT, const CVector3& v0, const CVector3& v1,
+                  const CVector3& v2, TFloat32* pT = 0 );
+
+
+/*-----------------------------------------------------------------------------------------
+	Volume tests
+-----------------------------------------------------------------------------------------*/
+
+// Test if two spheres overlap
+bool SphereSphere( const SSphere& sphere1, const SSphere& sphere2 );
+
+// Test if a sphere overlaps an axis-aligned box
+bool SphereAABB( const SSphere& sphere, const SAABB& box );
+
+// Test if two axis-aligned boxes overlap
+bool AABBAABB( const SAABB& box1, const SAABB& box2 );
+
+
+/*-----------------------------------------------------------------------------------------
+	Swept tests
+-----------------------------------------------------------------------------------------*/
+// A sphere moves from its current position by the given movement vector. Optionally returns
+// the fraction of the movement, t (0 to 1), at which contact first occurs
+
+// Test a moving sphere against a stationary sphere
+bool SweptSphereSphere( const SSphere& moving, const CVector3& movement, const SSphere& target,
+                        TFloat32* pT = 0 );
+
+// Test a moving sphere against a stationary axis-aligned box. The box is expanded by the
+// sphere radius, so near the box edges and corners this may report hits slightly early
+bool SweptSphereAABB( const SSphere& moving, const CVector3& movement, const SAABB& box,
+                      TFloat32* pT = 0 );
+
+
+/*-----------------------------------------------------------------------------------------
+	Batched SSE tests
+-----------------------------------------------------------------------------------------*/
+// Each function tests one primitive against four, returning a bit mask of those hit. If pT is
+// given it must point to an array of four values, the first hit distance for each primitive.
+// Values for primitives not hit are undefined
+
+// Test a ray against four axis-aligned boxes
+TUInt32 RayAABB4( const SPrecalcRay& ray, const SAABB4& boxes, TFloat32* pT = 0 );
+
+// Test a segment against four axis-aligned boxes
+TUInt32 SegmentAABB4( const SSegment& segment, const SAABB4& boxes, TFloat32* pT = 0 );
+
+// Test a sphere against four spheres for overlap
+TUInt32 SphereSphere4( const SSphere& sphere, const SSphere4& spheres );
+
+// Test a moving sphere against four stationary spheres
+TUInt32 SweptSphereSphere4( const SSphere& moving, const CVector3& movement,
+                            const SSphere4& targets, TFloat32* pT = 0 );
+
+
+/*-----------------------------------------------------------------------------------------
+	Ray packet tests
+-----------------------------------------------------------------------------------------*/
+// Each function tests four rays against one primitive, returning a bit mask of the rays that
+// hit. pMaxT points to an array of four maximum distances, one for each ray
+
+// Test four rays against an axis-aligned box
+TUInt32 Ray4AABB( const SRay4& rays, const TFloat32* pMaxT, const SAABB& box );
+
+// Test four rays against a triangle, hitting from either side. Where a ray hits closer than its
+// maximum distance, the maximum is updated to the hit distance, so pMaxT can be used to find
+// the nearest of several triangles
+TUInt32 Ray4Triangle( const SRay4& rays, TFloat32* pMaxT, const CVector3& v0, const CVector3& v1,
+                      const CVector3& v2 );
+
+
+} // namespace gen
+
+#endif // GEN_GEOMETRY_H_INCLUDED
@@ -110,27 +110,23 @@ void CMesh::BeginEnumTriangles()
 }
 
 // Get the next triangle in the mesh, used after BeginEnumTriangles. Fills the supplied
-// CVector3 pointers with the three vertex coordinates of the triangle. Returns true if a
+// CVector3 pointers with the three vertex coordinates of the triangle, in the space of the node
+// controlling its sub-mesh. Optionally returns the index of that node. Returns true if a
 // triangle was successfully returned, false if there are no more triangles to enumerate
-bool CMesh::GetTriangle( CVector3* pVertex1, CVector3* pVertex2, CVector3* pVertex3 )
+bool CMesh::GetTriangle( CVector3* pVertex1, CVector3* pVertex2, CVector3* pVertex3,
+                         TUInt32* pNode /*= 0*/ )
 {
-	// If enumerated all meshes then finished
-	if (m_EnumTriMesh >= m_NumSubMeshes)
+	// If enumerated all triangles in current mesh, move to next mesh (skipping any without
+	// triangles) - finished if no more meshes
+	while (m_EnumTriMesh < m_NumSubMeshes && m_EnumTri >= m_SubMeshes[m_EnumTriMesh].numFaces)
 	{
-		return false;
-	}
-
-	// If enumerated all triangles in current mesh...
-	if (m_EnumTri >= m_SubMeshes[m_EnumTriMesh].numFaces)
-	{
-		// Move to next mesh - finished if no more meshes
 		++m_EnumTriMesh;
-		if (m_EnumTriMesh >= m_NumSubMeshes)
-		{
-			return false;
-		}
 		m_EnumTri = 0; // Start at first triangle of next mesh
 	}
+	if (m_EnumTriMesh >= m_NumSubMeshes)
+	{
+		return false;
+	}
 
 	// Get current face from submesh
 	SMeshFace face = m_SubMeshes[m_EnumTriMesh].faces[m_EnumTri];
@@ -158,10 +154,16 @@ bool CMesh::GetTriangle( CVector3* pVertex1, CVector3* pVertex2, CVector3* pVert
 	pVertexData = m_SubMeshes[m_EnumTriMesh].vertices +
 	              face.aiVertex[2] * m_SubMeshes[m_EnumTriMesh].vertexSize;
 	pVertexCoord = reinterpret_cast<TFloat32*>(pVertexData);
-	pVertex2->x = *pVertexCoord++;
-	pVertex2->y = *pVertexCoord++;
-	pVertex2->z = *pVertexCoord;
+	pVertex3->x = *pVertexCoord++;
+	pVertex3->y = *pVertexCoord++;
+	pVertex3->z = *pVertexCoord;
 
+	if (pNode)
+	{
+		*pNode = m_SubMeshes[m_EnumTriMesh].node;
+	}
+
+	++m_EnumTri; // Next triangle
 	return true;
 }
 
@@ -344,6 +346,15 @@ bool CMesh::CreateSubMeshDX
 	subMeshDX->numVertices = subMesh.numVertices;
 	subMeshDX->numIndices = subMesh.numFaces * 3; // Using triangle lists, so always 3 indexes per face
 
+	// Without a device (e.g. in the scene tests) only the geometry is loaded, there are no buffers
+	subMeshDX->vertexBuffer = 0;
+	subMeshDX->vertexLayout = 0;
+	subMeshDX->indexBuffer = 0;
+	if (!g_pd3dDevice)
+	{
+		return true;
+	}
+
 	// Create vertex element list & layout.
 	unsigned int numElts = 0;
 	unsigned int offset = 0;
@@ -476,8 +487,15 @@ bool CMesh::CreateMaterialDX
 	SMeshMaterialDX*     materialDX
 )
 {
-	// Load shaders for render method
+	// Without a device (e.g. in the scene tests) only the geometry is loaded, no shaders or textures
 	materialDX->renderMethod = material.renderMethod;
+	materialDX->numTextures = 0;
+	if (!g_pd3dDevice)
+	{
+		return true;
+	}
+
+	// Load shaders for render method
 	if (!PrepareMethod( materialDX->renderMethod ))
 	{
 		return false;
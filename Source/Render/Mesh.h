@@ -72,9 +72,11 @@ public:
 	void BeginEnumTriangles();
 
 	// Get the next triangle in the mesh, used after BeginEnumTriangles. Fills the supplied
-	// CVector3 pointers with the three vertex coordinates of the triangle. Returns true if a
+	// CVector3 pointers with the three vertex coordinates of the triangle, in the space of the
+	// node controlling its sub-mesh. Optionally returns the index of that node. Returns true if a
 	// triangle was successfully returned, false if there are no more triangles to enumerate
-	bool GetTriangle( CVector3* pVertex1, CVector3* pVertex2, CVector3* pVertex3 );
+	bool GetTriangle( CVector3* pVertex1, CVector3* pVertex2, CVector3* pVertex3,
+	                  TUInt32* pNode = 0 );
 
 
 	// Return total number of vertices in the mesh
@@ -107,7 +109,8 @@ public:
 	/////////////////////////////////////
 	// Creation
 
-	// Load the mesh from an X-File
+	// Load the mesh from an X-File. Without a Direct3D device only the geometry is loaded, the
+	// mesh can't be rendered but its nodes and triangles can be used
 	bool Load( const string& fileName );
 
 
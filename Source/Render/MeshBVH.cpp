@@ -0,0 +1,356 @@
+/*******************************************
+	MeshBVH.cpp
+
+	Bounding volume hierarchy of mesh
+	triangles for precise ray casts
+********************************************/
+
+#include <algorithm>
+
+#include "MeshBVH.h"
+#include "Mesh.h"
+
+namespace gen
+{
+
+/*-----------------------------------------------------------------------------------------
+	Building
+-----------------------------------------------------------------------------------------*/
+
+// Build the hierarchy from the triangles of a mesh, placed by the mesh's default node hierarchy
+void CMeshBVH::Build( CMesh& mesh )
+{
+	// Get the matrix of each node relative to the root, in the same way entities calculate their
+	// absolute matrices. The root node is replaced by an entity's own world matrix, so is identity
+	// here. Parents always come before their children in the node list
+	TUInt32 numNodes = mesh.GetNumNodes();
+	vector<CMatrix4x4> nodeMatrices( numNodes );
+	nodeMatrices[0] = CMatrix4x4::kIdentity;
+	for (TUInt32 node = 1; node < numNodes; ++node)
+	{
+		const SMeshNode& meshNode = mesh.GetNode( node );
+		nodeMatrices[node] = meshNode.positionMatrix * nodeMatrices[meshNode.parent];
+	}
+
+	vector<CVector3> vertices;
+	vertices.reserve( mesh.GetNumTriangles() * 3 );
+
+	CVector3 v0, v1, v2;
+	TUInt32 node;
+	mesh.BeginEnumTriangles();
+	while (mesh.GetTriangle( &v0, &v1, &v2, &node ))
+	{
+		const CMatrix4x4& nodeMatrix = nodeMatrices[node];
+		vertices.push_back( nodeMatrix.TransformPoint( v0 ) );
+		vertices.push_back( nodeMatrix.TransformPoint( v1 ) );
+		vertices.push_back( nodeMatrix.TransformPoint( v2 ) );
+	}
+	Build( vertices );
+}
+
+// Build the hierarchy from a list of triangles, three vertices for each
+void CMeshBVH::Build( const vector<CVector3>& vertices )
+{
+	m_Nodes.clear();
+	m_Bounds.SetEmpty();
+	m_Triangles.resize( vertices.size() / 3 );
+	if (m_Triangles.empty())
+	{
+		return;
+	}
+
+	for (TUInt32 i = 0; i < m_Triangles.size(); ++i)
+	{
+		m_Triangles[i].v0 = vertices[i * 3];
+		m_Triangles[i].v1 = vertices[i * 3 + 1];
+		m_Triangles[i].v2 = vertices[i * 3 + 2];
+	}
+
+	// A binary tree with n leaves has 2n - 1 nodes, so this is an upper limit
+	m_Nodes.reserve( 2 * m_Triangles.size() );
+	m_Nodes.resize( 1 );
+	BuildNode( 0, 0, static_cast<TUInt32>(m_Triangles.size()), 0 );
+	m_Bounds = m_Nodes[0].bounds;
+}
+
+
+// Build the node at the given index to contain the given range of triangles, then build its
+// children. The triangles in the range are reordered so those in each child are together
+void CMeshBVH::BuildNode( TUInt32 nodeIndex, TUInt32 first, TUInt32 count, TUInt32 depth )
+{
+	// Node bounds contain all triangles, also find bounds of the triangle centres to place bins
+	SAABB bounds, centreBounds;
+	bounds.SetEmpty();
+	centreBounds.SetEmpty();
+	for (TUInt32 i = first; i < first + count; ++i)
+	{
+		const STriangle& tri = m_Triangles[i];
+		bounds.Expand( tri.v0 );
+		bounds.Expand( tri.v1 );
+		bounds.Expand( tri.v2 );
+		centreBounds.Expand( tri.v0 + tri.v1 + tri.v2 ); // Centre * 3, scale doesn't matter
+	}
+	m_Nodes[nodeIndex].bounds = bounds;
+	m_Nodes[nodeIndex].first = first;
+	m_Nodes[nodeIndex].count = count;
+	if (count == 1 || depth + 1 >= kMaxDepth)
+	{
+		return;
+	}
+
+	// Find the split with the lowest SAH cost. Triangles are placed into equal size bins along
+	// each axis, the candidate splits are between bins. The cost of a split is the sum over
+	// both sides of the number of triangles times the surface area of their bounds (the chance
+	// of a ray hitting them). Leaving the node as a leaf costs count times the node's area, a split
+	// must also pay for traversing the node (cost of area once), so must beat (count - 1) * area
+	TFloat32 bestCost = (count - 1) * bounds.SurfaceArea();
+	TUInt32 bestAxis = 0;
+	TUInt32 bestSplit = 0; // Bins up to and including this one go to the left child
+	bool splitFound = false;
+	for (TUInt32 axis = 0; axis < 3; ++axis)
+	{
+		TFloat32 axisMin = centreBounds.minPt[axis];
+		TFloat32 axisSize = centreBounds.maxPt[axis] - axisMin;
+		if (axisSize <= 0.0f)
+		{
+			continue;
+		}
+		TFloat32 binScale = kNumBins / axisSize;
+
+		TUInt32 binCounts[kNumBins] = { 0 };
+		SAABB binBounds[kNumBins];
+		for (TUInt32 bin = 0; bin < kNumBins; ++bin)
+		{
+			binBounds[bin].SetEmpty();
+		}
+		for (TUInt32 i = first; i < first + count; ++i)
+		{
+			const STriangle& tri = m_Triangles[i];
+			TFloat32 centre = tri.v0[axis] + tri.v1[axis] + tri.v2[axis];
+			TUInt32 bin = Min( kNumBins - 1, static_cast<TUInt32>((centre - axisMin) * binScale) );
+			++binCounts[bin];
+			binBounds[bin].Expand( tri.v0 );
+			binBounds[bin].Expand( tri.v1 );
+			binBounds[bin].Expand( tri.v2 );
+		}
+
+		// Sweep from the right to get the cost of the right side of each split, then from the
+		// left adding the cost of the left side
+		TFloat32 rightCosts[kNumBins];
+		SAABB sideBounds;
+		sideBounds.SetEmpty();
+		TUInt32 sideCount = 0;
+		for (TUInt32 bin = kNumBins - 1; bin > 0; --bin)
+		{
+			sideBounds.Expand( binBounds[bin] );
+			sideCount += binCounts[bin];
+			rightCosts[bin - 1] = sideCount ? sideCount * sideBounds.SurfaceArea() : -1.0f;
+		}
+		sideBounds.SetEmpty();
+		sideCount = 0;
+		for (TUInt32 split = 0; split < kNumBins - 1; ++split)
+		{
+			sideBounds.Expand( binBounds[split] );
+			sideCount += binCounts[split];
+			if (sideCount == 0 || rightCosts[split] < 0.0f)
+			{
+				continue; // Empty side, not a real split
+			}
+			TFloat32 cost = sideCount * sideBounds.SurfaceArea() + rightCosts[split];
+			if (cost < bestCost || (!splitFound && count > kMaxLeafSize))
+			{
+				bestCost = cost;
+				bestAxis = axis;
+				bestSplit = split;
+				splitFound = true;
+			}
+		}
+	}
+	if (!splitFound)
+	{
+		return; // Leaf is cheaper, or triangle centres coincide so cannot be split
+	}
+
+	// Partition the triangles by bin
+	TFloat32 axisMin = centreBounds.minPt[bestAxis];
+	TFloat32 binScale = kNumBins / (centreBounds.maxPt[bestAxis] - axisMin);
+	vector<STriangle>::iterator middle =
+		partition( m_Triangles.begin() + first, m_Triangles.begin() + first + count,
+		           [bestAxis, axisMin, binScale, bestSplit]( const STriangle& tri )
+		           {
+		               TFloat32 centre = tri.v0[bestAxis] + tri.v1[bestAxis] + tri.v2[bestAxis];
+		               return Min( kNumBins - 1, static_cast<TUInt32>((centre - axisMin) * binScale) ) <= bestSplit;
+		           } );
+	TUInt32 leftCount = static_cast<TUInt32>(middle - (m_Triangles.begin() + first));
+
+	// Children are allocated together. Note that m_Nodes may reallocate in BuildNode so node
+	// data is accessed by index
+	TUInt32 childIndex = static_cast<TUInt32>(m_Nodes.size());
+	m_Nodes.resize( childIndex + 2 );
+	m_Nodes[nodeIndex].first = childIndex;
+	m_Nodes[nodeIndex].count = 0;
+	BuildNode( childIndex, first, leftCount, depth + 1 );
+	BuildNode( childIndex + 1, first + leftCount, count - leftCount, depth + 1 );
+}
+
+
+/*-----------------------------------------------------------------------------------------
+	Ray casts
+-----------------------------------------------------------------------------------------*/
+
+// Return true if the ray hits any triangle within the maximum distance. Stops at the first
+// triangle found, so is faster than Intersect
+bool CMeshBVH::IsOccluded( const SRay& ray, const TFloat32 maxT ) const
+{
+	if (m_Nodes.empty())
+	{
+		return false;
+	}
+
+	SPrecalcRay boxRay = PrecalcRay( ray, maxT );
+	TUInt32 stack[kMaxDepth];
+	TUInt32 stackSize = 0;
+	stack[stackSize++] = 0;
+	while (stackSize > 0)
+	{
+		const SNode& node = m_Nodes[stack[--stackSize]];
+		if (!RayAABB( boxRay, node.bounds ))
+		{
+			continue;
+		}
+
+		if (node.count == 0)
+		{
+			stack[stackSize++] = node.first;
+			stack[stackSize++] = node.first + 1;
+		}
+		else
+		{
+			for (TUInt32 i = node.first; i < node.first + node.count; ++i)
+			{
+				const STriangle& tri = m_Triangles[i];
+				if (RayTriangle( ray, maxT, tri.v0, tri.v1, tri.v2 ))
+				{
+					return true;
+				}
+			}
+		}
+	}
+	return false;
+}
+
+// Find the nearest triangle hit by the ray within the maximum distance. Returns false if there
+// is none, otherwise returns true along with the distance of the hit and optionally the index
+// of the triangle hit
+bool CMeshBVH::Intersect( const SRay& ray, const TFloat32 maxT, TFloat32* pT,
+                          TUInt32* pTriangle /*= 0*/ ) const
+{
+	if (m_Nodes.empty())
+	{
+		return false;
+	}
+
+	// The ray's maxT is reduced to the nearest hit found so far, so boxes further away than that
+	// are rejected by the box tests
+	SPrecalcRay boxRay = PrecalcRay( ray, maxT );
+	TUInt32 nearest = 0;
+	bool found = false;
+
+	TUInt32 stack[kMaxDepth];
+	TUInt32 stackSize = 0;
+	if (RayAABB( boxRay, m_Nodes[0].bounds ))
+	{
+		stack[stackSize++] = 0;
+	}
+	while (stackSize > 0)
+	{
+		const SNode& node = m_Nodes[stack[--stackSize]];
+		if (node.count == 0)
+		{
+			// Visit the nearer child first (pushed last) to find close hits early
+			TFloat32 t0, t1;
+			bool hit0 = RayAABB( boxRay, m_Nodes[node.first].bounds, &t0 );
+			bool hit1 = RayAABB( boxRay, m_Nodes[node.first + 1].bounds, &t1 );
+			if (hit0 && hit1)
+			{
+				stack[stackSize++] = (t0 <= t1) ? node.first + 1 : node.first;
+				stack[stackSize++] = (t0 <= t1) ? node.first : node.first + 1;
+			}
+			else if (hit0)
+			{
+				stack[stackSize++] = node.first;
+			}
+			else if (hit1)
+			{
+				stack[stackSize++] = node.first + 1;
+			}
+		}
+		else
+		{
+			for (TUInt32 i = node.first; i < node.first + node.count; ++i)
+			{
+				const STriangle& tri = m_Triangles[i];
+				TFloat32 t;
+				if (RayTriangle( ray, boxRay.maxT, tri.v0, tri.v1, tri.v2, &t ))
+				{
+					boxRay.maxT = t;
+					nearest = i;
+					found = true;
+				}
+			}
+		}
+	}
+
+	if (found)
+	{
+		*pT = boxRay.maxT;
+		if (pTriangle)
+		{
+			*pTriangle = nearest;
+		}
+	}
+	return found;
+}
+
+// Find the nearest triangle hit by each of four rays, traversing the tree once for all of them.
+// pMaxT points to the maximum distance for each ray, which are updated with the nearest hit
+// distances. Returns a bit mask of the rays that hit a triangle
+TUInt32 CMeshBVH::Intersect4( const SRay4& rays, TFloat32* pMaxT ) const
+{
+	if (m_Nodes.empty())
+	{
+		return 0;
+	}
+
+	// A node is visited if any of the rays hits its box
+	TUInt32 hitMask = 0;
+	TUInt32 stack[kMaxDepth];
+	TUInt32 stackSize = 0;
+	stack[stackSize++] = 0;
+	while (stackSize > 0)
+	{
+		const SNode& node = m_Nodes[stack[--stackSize]];
+		if (!Ray4AABB( rays, pMaxT, node.bounds ))
+		{
+			continue;
+		}
+
+		if (node.count == 0)
+		{
+			stack[stackSize++] = node.first + 1;
+			stack[stackSize++] = node.first;
+		}
+		else
+		{
+			for (TUInt32 i = node.first; i < node.first + node.count; ++i)
+			{
+				const STriangle& tri = m_Triangles[i];
+				hitMask |= Ray4Triangle( rays, pMaxT, tri.v0, tri.v1, tri.v2 );
+			}
+		}
+	}
+	return hitMask;
+}
+
+
+} // namespace gen
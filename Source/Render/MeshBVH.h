@@ -0,0 +1,151 @@
+/*******************************************
+	MeshBVH.h
+
+	Bounding volume hierarchy of mesh
+	triangles for precise ray casts
+********************************************/
+
+#pragma once
+
+#include <vector>
+using namespace std;
+
+#include "Defines.h"
+#include "Geometry.h"
+
+namespace gen
+{
+
+// Forward declaration of classes, where includes are only possible/necessary in the .cpp file
+class CMesh;
+
+
+/*-----------------------------------------------------------------------------------------
+-------------------------------------------------------------------------------------------
+	Mesh BVH Class
+-------------------------------------------------------------------------------------------
+-----------------------------------------------------------------------------------------*/
+
+// Holds the triangles of a mesh in a binary tree of boxes so rays can be cast against the mesh
+// without testing every triangle. The tree is built in model space using the surface area
+// heuristic (SAH), which chooses splits that minimise the expected cost of a ray cast. The tree
+// is built once per mesh and shared by all entities using it - ray casts against an entity are
+// made by transforming the ray into model space with the inverse of the entity's world matrix
+//
+// Model space is the space of the mesh's root node, which entities replace with their world
+// matrix. Each triangle is placed by the default matrices of the nodes between its sub-mesh and
+// the root, matching how the mesh is drawn. Nodes that an entity animates are not followed
+class CMeshBVH
+{
+/////////////////////////////////////
+//	Constructors/Destructors
+public:
+	// Constructor creates an empty hierarchy
+	CMeshBVH()
+	{
+		m_Bounds.SetEmpty();
+	}
+
+private:
+	// Prevent use of copy constructor and assignment operator (private and not defined)
+	CMeshBVH( const CMeshBVH& );
+	CMeshBVH& operator=( const CMeshBVH& );
+
+
+/////////////////////////////////////
+//	Public interface
+public:
+
+	/////////////////////////////////////
+	// Building
+
+	// Build the hierarchy from the triangles of a mesh
+	void Build( CMesh& mesh );
+
+	// Build the hierarchy from a list of triangles, three vertices for each
+	void Build( const vector<CVector3>& vertices );
+
+
+	/////////////////////////////////////
+	// Ray casts
+	// Distances are parametric as described in Geometry.h, and the ray need not be normalised,
+	// so a ray transformed into model space gives the same distance as in world space
+
+	// Return true if the ray hits any triangle within the maximum distance. Stops at the first
+	// triangle found, so is faster than Intersect
+	bool IsOccluded( const SRay& ray, const TFloat32 maxT ) const;
+
+	// Find the nearest triangle hit by the ray within the maximum distance. Returns false if there
+	// is none, otherwise returns true along with the distance of the hit and optionally the index
+	// of the triangle hit
+	bool Intersect( const SRay& ray, const TFloat32 maxT, TFloat32* pT, TUInt32* pTriangle = 0 ) const;
+
+	// Find the nearest triangle hit by each of four rays, traversing the tree once for all of them.
+	// Efficient when the rays have similar paths. pMaxT points to the maximum distance for each
+	// ray, which are updated with the nearest hit distances. Returns a bit mask of the rays that
+	// hit a triangle
+	TUInt32 Intersect4( const SRay4& rays, TFloat32* pMaxT ) const;
+
+
+	/////////////////////////////////////
+	// Getters
+
+	// Bounds of the whole mesh in model space, empty if there are no triangles
+	const SAABB& GetBounds() const
+	{
+		return m_Bounds;
+	}
+
+	TUInt32 NumTriangles() const
+	{
+		return static_cast<TUInt32>(m_Triangles.size());
+	}
+
+	TUInt32 NumNodes() const
+	{
+		return static_cast<TUInt32>(m_Nodes.size());
+	}
+
+
+/////////////////////////////////////
+//	Private interface
+private:
+
+	// Triangle vertices
+	struct STriangle
+	{
+		CVector3 v0, v1, v2;
+	};
+
+	// Tree node (32 bytes). Interior nodes have two children in consecutive nodes starting at
+	// index first. Leaf nodes refer to count triangles starting at index first
+	struct SNode
+	{
+		SAABB   bounds;
+		TUInt32 first;
+		TUInt32 count; // 0 for interior nodes
+	};
+
+	// Number of bins used to evaluate candidate splits during the SAH build, maximum triangles in
+	// a leaf node and maximum depth of tree
+	static const TUInt32 kNumBins = 12;
+	static const TUInt32 kMaxLeafSize = 8;
+	static const TUInt32 kMaxDepth = 64;
+
+	// Build the node at the given index to contain the given range of triangles, then build its
+	// children. The triangles in the range are reordered so those in each child are together
+	void BuildNode( TUInt32 nodeIndex, TUInt32 first, TUInt32 count, TUInt32 depth );
+
+
+	// Tree nodes, root is at index 0. Empty if the hierarchy has not been built
+	vector<SNode> m_Nodes;
+
+	// Bounds of the root node, kept separately so they are valid (empty) without any nodes
+	SAABB m_Bounds;
+
+	// Triangles, ordered so each leaf node refers to a contiguous range
+	vector<STriangle> m_Triangles;
+};
+
+
+} // namespace gen
@@ -0,0 +1,91 @@
+/*******************************************
+	RenderState.h
+
+	Everything needed to draw one frame,
+	extracted from the scene at the end of
+	a tick for the render thread
+********************************************/
+
+#pragma once
+
+#include <string>
+#include <vector>
+using namespace std;
+
+#include "Defines.h"
+#include "CMatrix4x4.h"
+#include "Colour.h"
+#include "Camera.h"
+#include "Light.h"
+#include "Mesh.h"
+
+namespace gen
+{
+
+// A mesh to draw, its absolute node matrices are held in the render state's matrix list
+struct SRenderInstance
+{
+	CMesh*  mesh;
+	TUInt32 firstMatrix; // Index of the root node matrix, other nodes follow in order
+};
+
+// A string of on-screen text, may be centred on its position
+struct SRenderText
+{
+	string      text;
+	TInt32      X;
+	TInt32      Y;
+	SColourRGBA colour;
+	bool        centre;
+};
+
+
+// Render state for one frame. The scene is copied in here at the end of each tick, after which
+// the render thread draws it while the next tick is simulated, so it must not point at anything
+// the simulation changes. Meshes are shared, they are only loaded and released while the render
+// thread is idle
+struct SRenderState
+{
+	// Camera with matrices already calculated, and lights
+	CCamera       camera;
+	vector<CLight> lights;
+	SColourRGBA   ambientLight;
+
+	// Meshes to draw and their node matrices
+	vector<SRenderInstance> instances;
+	vector<CMatrix4x4>      matrices;
+
+	// On-screen text
+	vector<SRenderText> texts;
+
+
+	// Empty the state for a new frame, keeping memory allocated in earlier frames
+	void Clear()
+	{
+		lights.clear();
+		instances.clear();
+		matrices.clear();
+		texts.clear();
+	}
+
+	// Add an instance of a mesh to draw, returning the array of matrices to fill with its
+	// absolute node matrices. The array is only valid until the next instance is added
+	CMatrix4x4* AddInstance( CMesh* mesh )
+	{
+		SRenderInstance instance = { mesh, static_cast<TUInt32>(matrices.size()) };
+		instances.push_back( instance );
+		matrices.resize( matrices.size() + mesh->GetNumNodes() );
+		return &matrices[instance.firstMatrix];
+	}
+
+	// Add a string of text at the given position in the given colour, may optionally centre it
+	void AddText( const string& text, TInt32 X, TInt32 Y, TFloat32 r, TFloat32 g, TFloat32 b,
+	              bool centre = false )
+	{
+		SRenderText renderText = { text, X, Y, SColourRGBA( r, g, b, 1.0f ), centre };
+		texts.push_back( renderText );
+	}
+};
+
+
+} // namespace gen
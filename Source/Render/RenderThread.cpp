@@ -0,0 +1,125 @@
+/*******************************************
+	RenderThread.cpp
+
+	Render thread class implementation
+********************************************/
+
+#include "RenderThread.h"
+
+namespace gen
+{
+
+/*-----------------------------------------------------------------------------------------
+-------------------------------------------------------------------------------------------
+	Render Thread Class
+-------------------------------------------------------------------------------------------
+-----------------------------------------------------------------------------------------*/
+
+// Constructor doesn't start the thread, frames are drawn on submission until Start is called
+CRenderThread::CRenderThread()
+{
+	m_NextState = 0;
+	m_Render = 0;
+	m_Submitted = 0;
+	m_Running = false;
+}
+
+// Destructor stops the thread
+CRenderThread::~CRenderThread()
+{
+	Stop();
+}
+
+
+// Start the render thread, which draws submitted frames with the given function
+void CRenderThread::Start( TRenderFunction render )
+{
+	GEN_ASSERT( !m_Running, "Render thread already started" );
+
+	m_Render = render;
+	m_Running = true;
+	m_Thread = thread( &CRenderThread::RenderThread, this );
+}
+
+// Draw any submitted frame then stop the render thread
+void CRenderThread::Stop()
+{
+	if (!m_Running)
+	{
+		return;
+	}
+	Finish();
+
+	{
+		unique_lock<mutex> lock( m_Lock );
+		m_Running = false;
+	}
+	m_SubmittedSignal.notify_one();
+	m_Thread.join();
+}
+
+
+// Hand the next state to the render thread to draw, once the previous frame has been drawn.
+// The other state becomes the next state
+void CRenderThread::Submit()
+{
+	SRenderState& state = m_States[m_NextState];
+	m_NextState = 1 - m_NextState;
+
+	// Without a thread draw the frame straight away
+	if (!m_Running)
+	{
+		if (m_Render)
+		{
+			m_Render( state );
+		}
+		return;
+	}
+
+	Finish();
+	{
+		unique_lock<mutex> lock( m_Lock );
+		m_Submitted = &state;
+	}
+	m_SubmittedSignal.notify_one();
+}
+
+// Wait until the submitted frame, if any, has been drawn
+void CRenderThread::Finish()
+{
+	unique_lock<mutex> lock( m_Lock );
+	while (m_Submitted)
+	{
+		m_DrawnSignal.wait( lock );
+	}
+}
+
+
+// Render thread function, draws frames as they are submitted until stopped
+void CRenderThread::RenderThread()
+{
+	unique_lock<mutex> lock( m_Lock );
+	while (true)
+	{
+		while (!m_Submitted && m_Running)
+		{
+			m_SubmittedSignal.wait( lock );
+		}
+		if (!m_Submitted)
+		{
+			return; // Stopped
+		}
+
+		// Draw outside the lock so the main thread can carry on simulating
+		SRenderState* state = m_Submitted;
+		lock.unlock();
+		m_Render( *state );
+		lock.lock();
+
+		m_Submitted = 0;
+		m_DrawnSignal.notify_one();
+	}
+}
+
+
+} // namespace gen
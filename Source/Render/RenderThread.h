@@ -0,0 +1,102 @@
+/*******************************************
+	RenderThread.h
+
+	Draws each frame on its own thread while
+	the next frame is simulated
+********************************************/
+
+#pragma once
+
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+using namespace std;
+
+#include "Defines.h"
+#include "RenderState.h"
+
+namespace gen
+{
+
+// Function that draws a frame from its render state, called on the render thread
+typedef void (*TRenderFunction)( SRenderState& state );
+
+
+/*-----------------------------------------------------------------------------------------
+-------------------------------------------------------------------------------------------
+	Render Thread Class
+-------------------------------------------------------------------------------------------
+-----------------------------------------------------------------------------------------*/
+
+// Double-buffered render state and a thread that draws it. The main thread fills the next state
+// and submits it, the render thread then draws it while the main thread simulates the following
+// tick into the other state. Submitting waits for the previous frame to be drawn, so at most one
+// frame is in flight and input is never more than one frame behind what is shown
+//
+// Only the main thread may use this class. All other Direct3D use (resetting the device,
+// releasing resources) must wait for the render thread to go idle with Finish first
+class CRenderThread
+{
+/////////////////////////////////////
+//	Constructors/Destructors
+public:
+	// Constructor doesn't start the thread, frames are drawn on submission until Start is called
+	CRenderThread();
+
+	// Destructor stops the thread
+	~CRenderThread();
+
+private:
+	// Disallow use of copy constructor and assignment operator (private and not defined)
+	CRenderThread( const CRenderThread& );
+	CRenderThread& operator=( const CRenderThread& );
+
+
+/////////////////////////////////////
+//	Public interface
+public:
+
+	// Start the render thread, which draws submitted frames with the given function
+	void Start( TRenderFunction render );
+
+	// Draw any submitted frame then stop the render thread
+	void Stop();
+
+	// The render state to fill for the next frame. It is not in use by the render thread
+	SRenderState& NextState()
+	{
+		return m_States[m_NextState];
+	}
+
+	// Hand the next state to the render thread to draw, once the previous frame has been drawn.
+	// The other state becomes the next state
+	void Submit();
+
+	// Wait until the submitted frame, if any, has been drawn
+	void Finish();
+
+
+/////////////////////////////////////
+//	Private interface
+private:
+
+	// Render thread function, draws frames as they are submitted until stopped
+	void RenderThread();
+
+	// Frame states, one being filled by the main thread while the other is drawn
+	SRenderState    m_States[2];
+	TUInt32         m_NextState;
+	TRenderFunction m_Render;
+
+	// State submitted and not yet drawn, 0 if none. The render thread waits for a state to be
+	// submitted and the main thread waits for it to be drawn, both under the lock
+	SRenderState*      m_Submitted;
+	bool               m_Running;
+	mutex              m_Lock;
+	condition_variable m_SubmittedSignal;
+	condition_variable m_DrawnSignal;
+	thread             m_Thread;
+};
+
+
+} // namespace gen
@@ -0,0 +1,146 @@
+/*******************************************
+	AIScheduler.cpp
+
+	Spreads tank decision making across
+	frames within a budget
+********************************************/
+
+#include <algorithm>
+
+#include "AIScheduler.h"
+#include "EntityManager.h"
+#include "TankEntity.h"
+#include "VisibilityTable.h"
+
+namespace gen
+{
+
+// Level of detail settings for each tier. Tanks are at full rate a little beyond the distance
+// at which they can see enemies, so they are never reduced when a fight may start
+const CAIScheduler::STierSettings CAIScheduler::kTierSettings[AITier_Count] =
+{
+	//  Camera   Enemy   Interval  Think weight
+	{   80.0f,  120.0f,   1,       1.0f  }, // High
+	{  200.0f,  250.0f,   2,       0.5f  }, // Medium
+	{ 1e30f,    1e30f,    4,       0.25f }, // Low - any distance
+};
+
+// Time a tank must be less relevant before it drops a tier
+const TFloat32 CAIScheduler::kDemoteDelay = 1.0f;
+
+
+/*-----------------------------------------------------------------------------------------
+	Tanks
+-----------------------------------------------------------------------------------------*/
+
+// Add a tank to be scheduled
+void CAIScheduler::AddTank( TEntityUID UID )
+{
+	STank newTank = { UID, 0.0f, 0.0f, AITier_High, 0.0f };
+	m_Tanks.push_back( newTank );
+}
+
+// Remove a tank from scheduling. Does nothing if the tank is not present
+void CAIScheduler::RemoveTank( TEntityUID UID )
+{
+	for (TUInt32 tank = 0; tank < m_Tanks.size(); ++tank)
+	{
+		if (m_Tanks[tank].UID == UID)
+		{
+			m_Tanks[tank] = m_Tanks.back();
+			m_Tanks.pop_back();
+			return;
+		}
+	}
+}
+
+
+/*-----------------------------------------------------------------------------------------
+	Update
+-----------------------------------------------------------------------------------------*/
+
+// Choose the level of detail tier of each tank, age all tanks by the update time, then call
+// Think for the highest priority tanks until the budget is used
+void CAIScheduler::Update( CEntityManager& entityManager, const CVisibilityTable& visibilityTable,
+                           const CVector3& cameraPosition, TFloat32 updateTime )
+{
+	m_NumThinks = 0;
+	for (TUInt32 tier = 0; tier < AITier_Count; ++tier)
+	{
+		m_NumInTier[tier] = 0;
+	}
+
+	for (TUInt32 tank = 0; tank < m_Tanks.size(); ++tank)
+	{
+		CTankEntity* tankEntity = static_cast<CTankEntity*>(entityManager.GetEntity( m_Tanks[tank].UID ));
+
+		// Tanks not in the visibility table (dead) have no enemies
+		TFloat32 enemyDistance = 1e30f;
+		TUInt32 tableIndex;
+		if (visibilityTable.FindTank( m_Tanks[tank].UID, &tableIndex ))
+		{
+			enemyDistance = visibilityTable.GetNearestEnemyDistance( tableIndex );
+		}
+		UpdateTier( m_Tanks[tank], tankEntity->Position(), enemyDistance, cameraPosition, updateTime );
+		tankEntity->SetUpdateInterval( kTierSettings[m_Tanks[tank].tier].updateInterval );
+		++m_NumInTier[m_Tanks[tank].tier];
+
+		// Priority grows with time since the tank last thought, weighted by its state and tier
+		m_Tanks[tank].age += updateTime;
+		m_Tanks[tank].priority = tankEntity->ThinkPriority() * kTierSettings[m_Tanks[tank].tier].thinkWeight *
+		                         m_Tanks[tank].age;
+	}
+	// Order by UID where priorities are equal so the order doesn't depend on the order tanks were
+	// added and removed
+	sort( m_Tanks.begin(), m_Tanks.end(), []( const STank& a, const STank& b )
+	{
+		return a.priority > b.priority || (a.priority == b.priority && a.UID < b.UID);
+	} );
+
+	// Highest priority first until the budget is used
+	for (TUInt32 tank = 0; tank < m_Tanks.size() && m_Tanks[tank].priority > 0.0f &&
+	                       m_NumThinks < m_Budget; ++tank)
+	{
+		static_cast<CTankEntity*>(entityManager.GetEntity( m_Tanks[tank].UID ))->Think();
+		m_Tanks[tank].age = 0.0f;
+		++m_NumThinks;
+	}
+}
+
+
+// Choose the level of detail tier of a tank
+void CAIScheduler::UpdateTier( STank& tank, const CVector3& position, TFloat32 enemyDistance,
+                               const CVector3& cameraPosition, TFloat32 updateTime )
+{
+	// Find the highest tier the tank is relevant to
+	TFloat32 cameraDistance = Distance( position, cameraPosition );
+	TUInt32 relevantTier = 0;
+	while (relevantTier < AITier_Low && cameraDistance > kTierSettings[relevantTier].cameraDistance &&
+	       enemyDistance > kTierSettings[relevantTier].enemyDistance)
+	{
+		++relevantTier;
+	}
+
+	// Move up at once, but only move down one tier after a delay
+	if (relevantTier < static_cast<TUInt32>(tank.tier))
+	{
+		tank.tier = static_cast<EAITier>(relevantTier);
+		tank.demoteTimer = 0.0f;
+	}
+	else if (relevantTier > static_cast<TUInt32>(tank.tier))
+	{
+		tank.demoteTimer += updateTime;
+		if (tank.demoteTimer >= kDemoteDelay)
+		{
+			tank.tier = static_cast<EAITier>(tank.tier + 1);
+			tank.demoteTimer = 0.0f;
+		}
+	}
+	else
+	{
+		tank.demoteTimer = 0.0f;
+	}
+}
+
+
+} // namespace gen
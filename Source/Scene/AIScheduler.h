@@ -0,0 +1,190 @@
+/*******************************************
+	AIScheduler.h
+
+	Spreads tank decision making across
+	frames within a budget
+********************************************/
+
+#pragma once
+
+#include <vector>
+using namespace std;
+
+#include "Defines.h"
+#include "Error.h"
+#include "CVector3.h"
+#include "Entity.h"
+
+namespace gen
+{
+
+// Forward declaration of classes, where includes are only possible/necessary in the .cpp file
+class CEntityManager;
+class CVisibilityTable;
+
+
+/////////////////////////////////////
+//	Public types
+
+// AI level of detail tiers, from full rate to lowest rate
+enum EAITier
+{
+	AITier_High,   // Updated every tick
+	AITier_Medium, // Updated every 2 ticks
+	AITier_Low,    // Updated every 4 ticks
+	AITier_Count
+};
+
+
+/*-----------------------------------------------------------------------------------------
+-------------------------------------------------------------------------------------------
+	AI Scheduler Class
+-------------------------------------------------------------------------------------------
+-----------------------------------------------------------------------------------------*/
+
+// Tank behaviour is split into cheap per-tick work (movement, turret turning, reacting to
+// messages), done in CTankEntity::Update, and expensive decision making (choosing targets,
+// searching for crates), done in CTankEntity::Think. The scheduler calls Think for a budgeted
+// number of tanks each frame, so large battles spread their decisions over several frames
+// rather than spiking the frame time. The budget is a count rather than a time so the tanks
+// chosen depend only on the simulation, and a run can be repeated exactly
+//
+// Tanks are chosen by priority: the time since the tank last thought multiplied by the weight
+// of its current state (CTankEntity::ThinkPriority). Equal priorities are ordered by UID.
+// Waiting tanks age until they are chosen, and tanks in states that make no decisions (weight
+// 0) are not chosen at all. Perception gathered in Think (nearest enemy, nearest ammo crate) is
+// only refreshed on frames when the tank is chosen
+//
+// The scheduler also chooses a level of detail tier for each tank from its distance to the
+// camera and to the nearest enemy. Tanks in lower tiers think less often and run their Update
+// every few ticks with the time accumulated between (see EAITier). A tank moves to a higher tier
+// as soon as it becomes relevant, but only drops one tier at a time after it has been less
+// relevant for a while, so tanks don't flicker between tiers at the boundaries
+class CAIScheduler
+{
+/////////////////////////////////////
+//	Constructors/Destructors
+public:
+	// Constructor creates a scheduler with no tanks, with the given budget (tanks thinking per frame)
+	CAIScheduler( TUInt32 budget = 32 )
+	{
+		m_Budget = budget;
+		m_NumThinks = 0;
+		for (TUInt32 tier = 0; tier < AITier_Count; ++tier)
+		{
+			m_NumInTier[tier] = 0;
+		}
+	}
+
+private:
+	// Prevent use of copy constructor and assignment operator (private and not defined)
+	CAIScheduler( const CAIScheduler& );
+	CAIScheduler& operator=( const CAIScheduler& );
+
+
+/////////////////////////////////////
+//	Public interface
+public:
+
+	/////////////////////////////////////
+	// Tanks
+
+	// Add a tank to be scheduled
+	void AddTank( TEntityUID UID );
+
+	// Remove a tank from scheduling. Does nothing if the tank is not present
+	void RemoveTank( TEntityUID UID );
+
+
+	/////////////////////////////////////
+	// Update
+
+	// Choose the level of detail tier of each tank, age all tanks by the update time, then call
+	// Think for the highest priority tanks until the budget is used
+	void Update( CEntityManager& entityManager, const CVisibilityTable& visibilityTable,
+	             const CVector3& cameraPosition, TFloat32 updateTime );
+
+
+	/////////////////////////////////////
+	// Budget
+
+	// Maximum number of tanks that think each frame, at least one
+	TUInt32 GetBudget() const
+	{
+		return m_Budget;
+	}
+
+	void SetBudget( TUInt32 budget )
+	{
+		GEN_ASSERT( budget > 0, "At least one tank must be allowed to think" );
+		m_Budget = budget;
+	}
+
+
+	/////////////////////////////////////
+	// Statistics
+
+	TUInt32 NumTanks() const
+	{
+		return static_cast<TUInt32>(m_Tanks.size());
+	}
+
+	// Number of tanks that thought in the last update
+	TUInt32 NumThinks() const
+	{
+		return m_NumThinks;
+	}
+
+	// Number of tanks in a level of detail tier at the last update
+	TUInt32 NumTanksInTier( EAITier tier ) const
+	{
+		return m_NumInTier[tier];
+	}
+
+
+/////////////////////////////////////
+//	Private interface
+private:
+
+	// Scheduling data for a tank
+	struct STank
+	{
+		TEntityUID UID;
+		TFloat32   age;         // Time since the tank last thought
+		TFloat32   priority;    // Calculated each update
+		EAITier    tier;        // Level of detail tier
+		TFloat32   demoteTimer; // Time the tank has been relevant to a lower tier than its own
+	};
+
+	// Level of detail settings for each tier - distances from camera and nearest enemy within
+	// which a tank is in the tier, ticks between tank updates, and weight for thinking
+	struct STierSettings
+	{
+		TFloat32 cameraDistance;
+		TFloat32 enemyDistance;
+		TUInt32  updateInterval;
+		TFloat32 thinkWeight;
+	};
+	static const STierSettings kTierSettings[AITier_Count];
+
+	// Time a tank must be less relevant before it drops a tier
+	static const TFloat32 kDemoteDelay;
+
+	// Choose the level of detail tier of a tank
+	void UpdateTier( STank& tank, const CVector3& position, TFloat32 enemyDistance,
+	                 const CVector3& cameraPosition, TFloat32 updateTime );
+
+
+	// Scheduled tanks
+	vector<STank> m_Tanks;
+
+	// Maximum number of tanks that think each frame
+	TUInt32 m_Budget;
+
+	// Number of tanks that thought in the last update, and number in each tier
+	TUInt32 m_NumThinks;
+	TUInt32 m_NumInTier[AITier_Count];
+};
+
+
+} // namespace gen
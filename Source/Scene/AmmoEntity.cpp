@@ -1,11 +1,15 @@
 #include "AmmoEntity.h"
 #include "Messenger.h"
+#include "Blackboard.h"
 
 namespace gen
 {
 	// Messenger class for sending messages to and between entities
 	extern CMessenger Messenger;
 
+	// Team knowledge, crates are added when they land so tanks can find them
+	extern CBlackboard Blackboard;
+
 	CAmmoEntity::CAmmoEntity
 	(
 		CEntityTemplate* entityTemplate,
@@ -16,13 +20,22 @@ namespace gen
 		const CVector3& scale /*= CVector3( 1.0f, 1.0f, 1.0f )*/
 	) : CEntity(entityTemplate, UID, name, position, rotation, scale)
 	{
+		m_Landed = false;
+		m_JustLanded = false;
+		Wake();
+	}
+
+	// Fetch messages sent to the ammo, ready for the update
+	void CAmmoEntity::ReceiveMessages()
+	{
+		Messenger.FetchMessages(GetUID(), &m_Mailbox);
 	}
 
 	bool CAmmoEntity::Update(TFloat32 updateTime)
 	{
 		// Fetch any messages
 		SMessage msg;
-		while (Messenger.FetchMessage(GetUID(), &msg))
+		while (m_Mailbox.FetchMessage(&msg))
 		{
 			// Set state variables based on received messages
 			switch (msg.type)
@@ -38,11 +51,34 @@ namespace gen
 		//Lower crate to the ground slowly
 		if (Position().y > 0)
 		{
-			Matrix().MoveLocalY(-0.1);
+			Transform().MoveLocalY(-0.1);
+		}
+
+		// Crate can be collected once near the ground, it is added to the blackboard on commit
+		if (!m_Landed && Position().y < 1)
+		{
+			m_Landed = true;
+			m_JustLanded = true;
+		}
+
+		// Nothing more to do once on the ground until collected, the collection message wakes it
+		if (m_Landed && Position().y <= 0)
+		{
+			Sleep();
 		}
 
 		return true;
 	}
 
+	// Add the crate to the blackboard if it landed in the update
+	void CAmmoEntity::Commit()
+	{
+		if (m_JustLanded)
+		{
+			Blackboard.AddAmmo(GetUID(), Position());
+			m_JustLanded = false;
+		}
+	}
+
 }
 
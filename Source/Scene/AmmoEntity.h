@@ -12,6 +12,7 @@ using namespace std;
 #include "Defines.h"
 #include "CVector3.h"
 #include "Entity.h"
+#include "Messenger.h"
 #include "CTimer.h"
 
 namespace gen
@@ -52,10 +53,29 @@ namespace gen
 		/////////////////////////////////////
 		// Update
 
+		// Fetch messages sent to the ammo, ready for the update
+		virtual void ReceiveMessages();
+
 		// Update the ammo - performs simple ammo behaviour
 		// Return false if the entity is to be destroyed
 		// Keep as a virtual function in case of further derivation
 		virtual bool Update(TFloat32 updateTime);
+
+		// Add the crate to the blackboard if it landed in the update
+		virtual void Commit();
+
+
+	/////////////////////////////////////
+	//	Private interface
+	private:
+
+		// Whether the crate has reached the ground, and whether it did so in the last update so
+		// still needs adding to the blackboard
+		bool m_Landed;
+		bool m_JustLanded;
+
+		// Messages received and sent in the update
+		CMailbox m_Mailbox;
 	};
 
 
@@ -0,0 +1,242 @@
+/*******************************************
+	Blackboard.cpp
+
+	Shared team knowledge of enemies,
+	ammo crates and requests for help
+********************************************/
+
+#include "Blackboard.h"
+
+namespace gen
+{
+
+// Sightings older than this are forgotten
+const TFloat32 CBlackboard::kSightingLifetime = 10.0f;
+
+
+/*-----------------------------------------------------------------------------------------
+	Update
+-----------------------------------------------------------------------------------------*/
+
+// Advance the blackboard time and forget sightings that are too old to be useful
+void CBlackboard::Update( TFloat32 updateTime )
+{
+	m_Time += updateTime;
+
+	for (TUInt32 team = 0; team < m_Teams.size(); ++team)
+	{
+		vector<SSighting>& sightings = m_Teams[team].sightings;
+		TUInt32 sighting = 0;
+		while (sighting < sightings.size())
+		{
+			if (m_Time - sightings[sighting].time > kSightingLifetime)
+			{
+				// Order doesn't matter, so replace with last sighting rather than shifting the rest
+				sightings[sighting] = sightings.back();
+				sightings.pop_back();
+			}
+			else
+			{
+				++sighting;
+			}
+		}
+	}
+}
+
+// Remove all knowledge
+void CBlackboard::Clear()
+{
+	m_Time = 0.0f;
+	m_Teams.clear();
+	m_Ammo.clear();
+}
+
+
+// Get the data for a team, adding teams up to this number if needed
+CBlackboard::STeam& CBlackboard::Team( TUInt32 team )
+{
+	if (team >= m_Teams.size())
+	{
+		m_Teams.resize( team + 1 ); // New teams are zeroed, so have no help request (serial 0)
+	}
+	return m_Teams[team];
+}
+
+
+/*-----------------------------------------------------------------------------------------
+	Enemy sightings
+-----------------------------------------------------------------------------------------*/
+
+// Record that a team can see an enemy at the given position
+void CBlackboard::ReportSighting( TUInt32 team, TEntityUID enemy, const CVector3& position )
+{
+	// Update the existing sighting of this enemy if there is one
+	vector<SSighting>& sightings = Team( team ).sightings;
+	for (TUInt32 sighting = 0; sighting < sightings.size(); ++sighting)
+	{
+		if (sightings[sighting].enemy == enemy)
+		{
+			sightings[sighting].position = position;
+			sightings[sighting].time = m_Time;
+			return;
+		}
+	}
+
+	SSighting newSighting = { enemy, position, m_Time };
+	sightings.push_back( newSighting );
+}
+
+// Forget any sighting of an enemy by all teams (e.g. when it is destroyed)
+void CBlackboard::RemoveSightings( TEntityUID enemy )
+{
+	for (TUInt32 team = 0; team < m_Teams.size(); ++team)
+	{
+		vector<SSighting>& sightings = m_Teams[team].sightings;
+		for (TUInt32 sighting = 0; sighting < sightings.size(); ++sighting)
+		{
+			if (sightings[sighting].enemy == enemy)
+			{
+				sightings[sighting] = sightings.back();
+				sightings.pop_back();
+				break; // Only one sighting of each enemy per team
+			}
+		}
+	}
+}
+
+// Get a team's last sighting of an enemy. Returns false if the team has not seen it recently
+bool CBlackboard::GetSighting( TUInt32 team, TEntityUID enemy, SSighting* pSighting ) const
+{
+	if (team >= m_Teams.size())
+	{
+		return false;
+	}
+
+	const vector<SSighting>& sightings = m_Teams[team].sightings;
+	for (TUInt32 sighting = 0; sighting < sightings.size(); ++sighting)
+	{
+		if (sightings[sighting].enemy == enemy)
+		{
+			*pSighting = sightings[sighting];
+			return true;
+		}
+	}
+	return false;
+}
+
+// Find the team's most recently sighted enemy nearest to a position. Only considers sightings
+// up to the given age. Returns false if there are none
+bool CBlackboard::FindNearestSighting( TUInt32 team, const CVector3& position, TFloat32 maxAge,
+                                       SSighting* pSighting ) const
+{
+	if (team >= m_Teams.size())
+	{
+		return false;
+	}
+
+	bool found = false;
+	TFloat32 nearestDistanceSquared = 0.0f;
+	const vector<SSighting>& sightings = m_Teams[team].sightings;
+	for (TUInt32 sighting = 0; sighting < sightings.size(); ++sighting)
+	{
+		if (m_Time - sightings[sighting].time <= maxAge)
+		{
+			TFloat32 distanceSquared = LengthSquared( sightings[sighting].position - position );
+			if (!found || distanceSquared < nearestDistanceSquared)
+			{
+				nearestDistanceSquared = distanceSquared;
+				*pSighting = sightings[sighting];
+				found = true;
+			}
+		}
+	}
+	return found;
+}
+
+
+/*-----------------------------------------------------------------------------------------
+	Help requests
+-----------------------------------------------------------------------------------------*/
+
+// Ask the tank's team for help, replacing any earlier request on the team
+void CBlackboard::RequestHelp( TUInt32 team, TEntityUID tank, const CVector3& position )
+{
+	SHelpRequest& request = Team( team ).helpRequest;
+	request.tank = tank;
+	request.position = position;
+	request.time = m_Time;
+	++request.serial;
+}
+
+// Get the team's latest help request if it is newer than the one with the given serial, then
+// update the serial to that of the request. Returns false if there is no newer request
+bool CBlackboard::GetNewHelpRequest( TUInt32 team, TUInt32* pLastSerial,
+                                     SHelpRequest* pRequest ) const
+{
+	if (team >= m_Teams.size() || m_Teams[team].helpRequest.serial <= *pLastSerial)
+	{
+		return false;
+	}
+
+	*pRequest = m_Teams[team].helpRequest;
+	*pLastSerial = pRequest->serial;
+	return true;
+}
+
+
+/*-----------------------------------------------------------------------------------------
+	Ammo crates
+-----------------------------------------------------------------------------------------*/
+
+// Add an ammo crate that has landed and can be collected
+void CBlackboard::AddAmmo( TEntityUID crate, const CVector3& position )
+{
+	SAmmo newAmmo = { crate, position };
+	m_Ammo.push_back( newAmmo );
+}
+
+// Remove an ammo crate that has been collected or destroyed. Does nothing if not present
+void CBlackboard::RemoveAmmo( TEntityUID crate )
+{
+	for (TUInt32 ammo = 0; ammo < m_Ammo.size(); ++ammo)
+	{
+		if (m_Ammo[ammo].crate == crate)
+		{
+			m_Ammo[ammo] = m_Ammo.back();
+			m_Ammo.pop_back();
+			return;
+		}
+	}
+}
+
+// Find the ammo crate nearest to a position. Returns false if there are none
+bool CBlackboard::FindNearestAmmo( const CVector3& position, TEntityUID* pCrate,
+                                   TFloat32* pDistance /*= 0*/ ) const
+{
+	if (m_Ammo.empty())
+	{
+		return false;
+	}
+
+	TUInt32 nearest = 0;
+	TFloat32 nearestDistanceSquared = LengthSquared( m_Ammo[0].position - position );
+	for (TUInt32 ammo = 1; ammo < m_Ammo.size(); ++ammo)
+	{
+		TFloat32 distanceSquared = LengthSquared( m_Ammo[ammo].position - position );
+		if (distanceSquared < nearestDistanceSquared)
+		{
+			nearestDistanceSquared = distanceSquared;
+			nearest = ammo;
+		}
+	}
+
+	*pCrate = m_Ammo[nearest].crate;
+	if (pDistance)
+	{
+		*pDistance = Sqrt( nearestDistanceSquared );
+	}
+	return true;
+}
+
+
+} // namespace gen
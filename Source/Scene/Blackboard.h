@@ -0,0 +1,170 @@
+/*******************************************
+	Blackboard.h
+
+	Shared team knowledge of enemies,
+	ammo crates and requests for help
+********************************************/
+
+#pragma once
+
+#include <vector>
+using namespace std;
+
+#include "Defines.h"
+#include "CVector3.h"
+#include "Entity.h"
+
+namespace gen
+{
+
+/*-----------------------------------------------------------------------------------------
+-------------------------------------------------------------------------------------------
+	Blackboard Class
+-------------------------------------------------------------------------------------------
+-----------------------------------------------------------------------------------------*/
+
+// Holds what each team knows about the world, written by entities as things happen and read by
+// tanks instead of searching the entity list:
+//   o Enemy sightings - last known position of each enemy seen by the team, with the time seen
+//   o Help requests   - the latest tank on the team asking for help
+//   o Ammo crates     - crates on the ground ready to be collected. Crates are seen falling by
+//                       all teams, so these are held once rather than per-team
+// Teams are referred to by their team number, which is expected to be small (0, 1...)
+class CBlackboard
+{
+/////////////////////////////////////
+//	Public types
+public:
+
+	// Last known position of an enemy tank
+	struct SSighting
+	{
+		TEntityUID enemy;
+		CVector3   position;
+		TFloat32   time; // Blackboard time of the sighting
+	};
+
+	// Request for help from a tank
+	struct SHelpRequest
+	{
+		TEntityUID tank;
+		CVector3   position; // Where the tank was when it asked for help
+		TFloat32   time;
+		TUInt32    serial;   // Increases with each request on a team, starting at 1
+	};
+
+
+/////////////////////////////////////
+//	Constructors/Destructors
+public:
+	// Constructor creates an empty blackboard
+	CBlackboard()
+	{
+		m_Time = 0.0f;
+	}
+
+private:
+	// Prevent use of copy constructor and assignment operator (private and not defined)
+	CBlackboard( const CBlackboard& );
+	CBlackboard& operator=( const CBlackboard& );
+
+
+/////////////////////////////////////
+//	Public interface
+public:
+
+	/////////////////////////////////////
+	// Update
+
+	// Advance the blackboard time and forget sightings that are too old to be useful
+	void Update( TFloat32 updateTime );
+
+	// Remove all knowledge
+	void Clear();
+
+	// Current blackboard time, seconds since the last Clear
+	TFloat32 GetTime() const
+	{
+		return m_Time;
+	}
+
+
+	/////////////////////////////////////
+	// Enemy sightings
+
+	// Record that a team can see an enemy at the given position
+	void ReportSighting( TUInt32 team, TEntityUID enemy, const CVector3& position );
+
+	// Forget any sighting of an enemy by all teams (e.g. when it is destroyed)
+	void RemoveSightings( TEntityUID enemy );
+
+	// Get a team's last sighting of an enemy. Returns false if the team has not seen it recently
+	bool GetSighting( TUInt32 team, TEntityUID enemy, SSighting* pSighting ) const;
+
+	// Find the team's most recently sighted enemy nearest to a position. Only considers sightings
+	// up to the given age. Returns false if there are none
+	bool FindNearestSighting( TUInt32 team, const CVector3& position, TFloat32 maxAge,
+	                          SSighting* pSighting ) const;
+
+
+	/////////////////////////////////////
+	// Help requests
+
+	// Ask the tank's team for help, replacing any earlier request on the team
+	void RequestHelp( TUInt32 team, TEntityUID tank, const CVector3& position );
+
+	// Get the team's latest help request if it is newer than the one with the given serial, then
+	// update the serial to that of the request. Returns false if there is no newer request
+	bool GetNewHelpRequest( TUInt32 team, TUInt32* pLastSerial, SHelpRequest* pRequest ) const;
+
+
+	/////////////////////////////////////
+	// Ammo crates
+
+	// Add an ammo crate that has landed and can be collected
+	void AddAmmo( TEntityUID crate, const CVector3& position );
+
+	// Remove an ammo crate that has been collected or destroyed. Does nothing if not present
+	void RemoveAmmo( TEntityUID crate );
+
+	// Find the ammo crate nearest to a position. Returns false if there are none
+	bool FindNearestAmmo( const CVector3& position, TEntityUID* pCrate, TFloat32* pDistance = 0 ) const;
+
+
+/////////////////////////////////////
+//	Private interface
+private:
+
+	// Knowledge held for each team
+	struct STeam
+	{
+		vector<SSighting> sightings;
+		SHelpRequest      helpRequest; // Serial is 0 if there has been no request
+	};
+
+	// Ammo crate on the ground
+	struct SAmmo
+	{
+		TEntityUID crate;
+		CVector3   position;
+	};
+
+	// Sightings older than this are forgotten
+	static const TFloat32 kSightingLifetime;
+
+	// Get the data for a team, adding teams up to this number if needed
+	STeam& Team( TUInt32 team );
+
+
+	// Blackboard time, seconds since the last Clear
+	TFloat32 m_Time;
+
+	// Data for each team, indexed by team number
+	vector<STeam> m_Teams;
+
+	// Crates ready to collect
+	vector<SAmmo> m_Ammo;
+};
+
+
+} // namespace gen
@@ -0,0 +1,350 @@
+/*******************************************
+	CollisionSystem.cpp
+
+	Tank collisions with each other and with
+	scenery, using a persistent sweep and
+	prune broadphase
+********************************************/
+
+#include "CollisionSystem.h"
+#include "Kinematics.h"
+#include "ObstacleBVH.h"
+
+namespace gen
+{
+
+// Key for a pair of boxes in the pair table
+static inline TUInt64 PairKey( TUInt32 box1, TUInt32 box2 )
+{
+	return (static_cast<TUInt64>(box1) << 32) | box2;
+}
+
+
+/*-----------------------------------------------------------------------------------------
+	Setup
+-----------------------------------------------------------------------------------------*/
+
+// Set the static obstacles tanks collide with, from their footprints in the obstacle hierarchy
+void CCollisionSystem::SetObstacles( const CObstacleBVH& obstacles )
+{
+	Clear();
+	for (TUInt32 obstacle = 0; obstacle < obstacles.NumObstacles(); ++obstacle)
+	{
+		m_Obstacles.push_back( obstacles.GetObstacleFootprint( obstacle ) );
+	}
+}
+
+// Remove all tanks and obstacles
+void CCollisionSystem::Clear()
+{
+	m_Boxes.clear();
+	m_EndPoints.clear();
+	m_Obstacles.clear();
+	m_PairList.clear();
+	m_Pairs.RemoveAllKeys();
+	m_TankUIDs.clear();
+	m_NumTanks = 0;
+}
+
+// Clear the lists and add all boxes again, for the tanks currently in the kinematics
+void CCollisionSystem::Rebuild( const CKinematics& kinematics )
+{
+	m_NumTanks = kinematics.NumTanks();
+	m_TankUIDs.resize( m_NumTanks );
+	m_Boxes.resize( m_NumTanks + m_Obstacles.size() );
+	for (TUInt32 tank = 0; tank < m_NumTanks; ++tank)
+	{
+		m_TankUIDs[tank] = kinematics.GetUID( tank );
+		SetTankBox( tank, kinematics.PosX()[tank], kinematics.PosZ()[tank] );
+	}
+	for (TUInt32 obstacle = 0; obstacle < m_Obstacles.size(); ++obstacle)
+	{
+		SBox& box = m_Boxes[m_NumTanks + obstacle];
+		box.minX = m_Obstacles[obstacle].minPt.x;
+		box.maxX = m_Obstacles[obstacle].maxPt.x;
+		box.minZ = m_Obstacles[obstacle].minPt.z;
+		box.maxZ = m_Obstacles[obstacle].maxPt.z;
+	}
+
+	// Add the start then the end of each box to the end of the list and sort it into place. The
+	// pairs are found as the end points pass each other, just as when boxes move
+	m_EndPoints.clear();
+	m_PairList.clear();
+	m_Pairs.RemoveAllKeys();
+	for (TUInt32 box = 0; box < m_Boxes.size(); ++box)
+	{
+		SEndPoint start = { m_Boxes[box].minX, box * 2 };
+		m_EndPoints.push_back( start );
+		SortEndPoint( static_cast<TUInt32>(m_EndPoints.size()) - 1 );
+
+		SEndPoint end = { m_Boxes[box].maxX, box * 2 + 1 };
+		m_EndPoints.push_back( end );
+		SortEndPoint( static_cast<TUInt32>(m_EndPoints.size()) - 1 );
+	}
+}
+
+// Set the box of a tank from its position
+void CCollisionSystem::SetTankBox( TUInt32 tank, TFloat32 x, TFloat32 z )
+{
+	SBox& box = m_Boxes[tank];
+	box.minX = x - m_TankRadius;
+	box.maxX = x + m_TankRadius;
+	box.minZ = z - m_TankRadius;
+	box.maxZ = z + m_TankRadius;
+}
+
+
+/*-----------------------------------------------------------------------------------------
+	Update
+-----------------------------------------------------------------------------------------*/
+
+// Move the tank boxes to the integrated positions, update the overlapping pairs and push
+// colliding tanks apart
+void CCollisionSystem::Update( CKinematics& kinematics )
+{
+	m_NumSwaps = 0;
+	m_NumContacts = 0;
+
+	// Rebuild if tanks have been added or removed (or obstacles changed), otherwise move the tank
+	// boxes and re-sort. Tanks move little each tick, so the list is nearly in order and each end
+	// point only passes the few others it has moved past
+	bool rebuild = (kinematics.NumTanks() != m_NumTanks || m_Boxes.size() != m_NumTanks + m_Obstacles.size());
+	for (TUInt32 tank = 0; tank < m_NumTanks && !rebuild; ++tank)
+	{
+		rebuild = (kinematics.GetUID( tank ) != m_TankUIDs[tank]);
+	}
+	if (rebuild)
+	{
+		Rebuild( kinematics );
+	}
+	else
+	{
+		for (TUInt32 tank = 0; tank < m_NumTanks; ++tank)
+		{
+			SetTankBox( tank, kinematics.PosX()[tank], kinematics.PosZ()[tank] );
+		}
+		for (TUInt32 index = 0; index < m_EndPoints.size(); ++index)
+		{
+			TUInt32 box = m_EndPoints[index].boxEnd >> 1;
+			if (box < m_NumTanks)
+			{
+				m_EndPoints[index].x = (m_EndPoints[index].boxEnd & 1) ? m_Boxes[box].maxX : m_Boxes[box].minX;
+			}
+		}
+		for (TUInt32 index = 1; index < m_EndPoints.size(); ++index)
+		{
+			SortEndPoint( index );
+		}
+	}
+
+	// Narrowphase on the pairs that also overlap in Z. Tanks are pushed apart first, then out of
+	// obstacles, so scenery wins when a tank is pushed by another into it. Pairs are found before
+	// the pushes, so a tank pushed into an obstacle it wasn't near is only pushed out next tick
+	for (TUInt32 pass = 0; pass < 2; ++pass)
+	{
+		for (TUInt32 pair = 0; pair < m_PairList.size(); ++pair)
+		{
+			const SBox& box1 = m_Boxes[m_PairList[pair].box1];
+			const SBox& box2 = m_Boxes[m_PairList[pair].box2];
+			bool isObstacle = m_PairList[pair].box2 >= m_NumTanks;
+			if (isObstacle != (pass == 1) || box1.minZ > box2.maxZ || box2.minZ > box1.maxZ)
+			{
+				continue;
+			}
+			if (isObstacle)
+			{
+				CollideObstacle( kinematics, m_PairList[pair].box1, m_PairList[pair].box2 - m_NumTanks );
+			}
+			else
+			{
+				CollideTanks( kinematics, m_PairList[pair].box1, m_PairList[pair].box2 );
+			}
+		}
+	}
+}
+
+
+/*-----------------------------------------------------------------------------------------
+	Broadphase
+-----------------------------------------------------------------------------------------*/
+
+// Sort the end point at the given index left into place, adding and removing pairs as it
+// passes other end points
+void CCollisionSystem::SortEndPoint( TUInt32 index )
+{
+	SEndPoint endPoint = m_EndPoints[index];
+	TUInt32 box = endPoint.boxEnd >> 1;
+	bool isEnd = (endPoint.boxEnd & 1) != 0;
+	while (index > 0)
+	{
+		// Stop when in order. End points in the same place have starts before ends
+		const SEndPoint& other = m_EndPoints[index - 1];
+		bool otherIsEnd = (other.boxEnd & 1) != 0;
+		if (other.x < endPoint.x || (other.x == endPoint.x && (!otherIsEnd || isEnd)))
+		{
+			break;
+		}
+
+		// A start passing back over another box's end begins an overlap, an end passing back over
+		// another box's start ends one. Passing a start over a start or end over an end does not
+		// change whether the boxes overlap
+		TUInt32 otherBox = other.boxEnd >> 1;
+		if (!isEnd && otherIsEnd)
+		{
+			AddPair( box, otherBox );
+		}
+		else if (isEnd && !otherIsEnd)
+		{
+			RemovePair( box, otherBox );
+		}
+		m_EndPoints[index] = other;
+		--index;
+		++m_NumSwaps;
+	}
+	m_EndPoints[index] = endPoint;
+}
+
+// Add a pair of boxes overlapping in X. Pairs of obstacles are not kept
+void CCollisionSystem::AddPair( TUInt32 box1, TUInt32 box2 )
+{
+	if (box1 > box2)
+	{
+		TUInt32 temp = box1;
+		box1 = box2;
+		box2 = temp;
+	}
+	if (box1 >= m_NumTanks)
+	{
+		return;
+	}
+	SPair pair = { box1, box2 };
+	m_Pairs.SetKeyValue( PairKey( box1, box2 ), static_cast<TUInt32>(m_PairList.size()) );
+	m_PairList.push_back( pair );
+}
+
+// Remove a pair of boxes overlapping in X. Pairs of obstacles are not kept
+void CCollisionSystem::RemovePair( TUInt32 box1, TUInt32 box2 )
+{
+	if (box1 > box2)
+	{
+		TUInt32 temp = box1;
+		box1 = box2;
+		box2 = temp;
+	}
+	TUInt32 index;
+	if (box1 >= m_NumTanks || !m_Pairs.LookUpKey( PairKey( box1, box2 ), &index ))
+	{
+		return;
+	}
+	m_Pairs.RemoveKey( PairKey( box1, box2 ) );
+	if (index != m_PairList.size() - 1)
+	{
+		m_PairList[index] = m_PairList.back();
+		m_Pairs.SetKeyValue( PairKey( m_PairList[index].box1, m_PairList[index].box2 ), index );
+	}
+	m_PairList.pop_back();
+}
+
+
+/*-----------------------------------------------------------------------------------------
+	Narrowphase
+-----------------------------------------------------------------------------------------*/
+
+// Test two tanks as circles and push them apart if they touch. Tanks that can't move are not
+// pushed, the other tank is pushed the full distance
+void CCollisionSystem::CollideTanks( CKinematics& kinematics, TUInt32 tank1, TUInt32 tank2 )
+{
+	TFloat32* posX = kinematics.PosX();
+	TFloat32* posZ = kinematics.PosZ();
+	TFloat32 dx = posX[tank2] - posX[tank1];
+	TFloat32 dz = posZ[tank2] - posZ[tank1];
+	TFloat32 minDistance = 2.0f * m_TankRadius;
+	TFloat32 distanceSquared = dx * dx + dz * dz;
+	if (distanceSquared >= minDistance * minDistance)
+	{
+		return;
+	}
+	++m_NumContacts;
+
+	// Tanks in the same place separate along X
+	TFloat32 distance = Sqrt( distanceSquared );
+	TFloat32 normalX = 1.0f, normalZ = 0.0f;
+	if (distance > 0.001f)
+	{
+		normalX = dx / distance;
+		normalZ = dz / distance;
+	}
+
+	TFloat32 share1 = kinematics.CanMove( tank1 ) ? 1.0f : 0.0f;
+	TFloat32 share2 = kinematics.CanMove( tank2 ) ? 1.0f : 0.0f;
+	if (share1 + share2 == 0.0f)
+	{
+		return;
+	}
+	TFloat32 push = (minDistance - distance) / (share1 + share2);
+	posX[tank1] -= normalX * push * share1;
+	posZ[tank1] -= normalZ * push * share1;
+	posX[tank2] += normalX * push * share2;
+	posZ[tank2] += normalZ * push * share2;
+}
+
+// Test a tank as a circle against an obstacle box and push the tank out if they touch
+void CCollisionSystem::CollideObstacle( CKinematics& kinematics, TUInt32 tank, TUInt32 obstacle )
+{
+	if (!kinematics.CanMove( tank ))
+	{
+		return;
+	}
+	TFloat32& x = kinematics.PosX()[tank];
+	TFloat32& z = kinematics.PosZ()[tank];
+	const SAABB& bounds = m_Obstacles[obstacle];
+
+	// Nearest point of the box to the tank centre
+	TFloat32 nearestX = Min( Max( x, bounds.minPt.x ), bounds.maxPt.x );
+	TFloat32 nearestZ = Min( Max( z, bounds.minPt.z ), bounds.maxPt.z );
+	TFloat32 dx = x - nearestX;
+	TFloat32 dz = z - nearestZ;
+	TFloat32 distanceSquared = dx * dx + dz * dz;
+	if (distanceSquared >= m_TankRadius * m_TankRadius)
+	{
+		return;
+	}
+	++m_NumContacts;
+
+	if (distanceSquared > 0.0f)
+	{
+		// Centre outside the box - push away from the nearest point
+		TFloat32 distance = Sqrt( distanceSquared );
+		TFloat32 push = (m_TankRadius - distance) / distance;
+		x += dx * push;
+		z += dz * push;
+	}
+	else
+	{
+		// Centre inside the box - push out through the nearest side
+		TFloat32 toMinX = x - bounds.minPt.x;
+		TFloat32 toMaxX = bounds.maxPt.x - x;
+		TFloat32 toMinZ = z - bounds.minPt.z;
+		TFloat32 toMaxZ = bounds.maxPt.z - z;
+		TFloat32 nearest = Min( Min( toMinX, toMaxX ), Min( toMinZ, toMaxZ ) );
+		if (nearest == toMinX)
+		{
+			x = bounds.minPt.x - m_TankRadius;
+		}
+		else if (nearest == toMaxX)
+		{
+			x = bounds.maxPt.x + m_TankRadius;
+		}
+		else if (nearest == toMinZ)
+		{
+			z = bounds.minPt.z - m_TankRadius;
+		}
+		else
+		{
+			z = bounds.maxPt.z + m_TankRadius;
+		}
+	}
+}
+
+
+} // namespace gen
@@ -0,0 +1,179 @@
+/*******************************************
+	CollisionSystem.h
+
+	Tank collisions with each other and with
+	scenery, using a persistent sweep and
+	prune broadphase
+********************************************/
+
+#pragma once
+
+#include <vector>
+using namespace std;
+
+#include "Defines.h"
+#include "CHashTable.h"
+#include "Geometry.h"
+#include "Entity.h"
+
+namespace gen
+{
+
+// Forward declaration of classes, where includes are only possible/necessary in the .cpp file
+class CKinematics;
+class CObstacleBVH;
+
+
+/*-----------------------------------------------------------------------------------------
+-------------------------------------------------------------------------------------------
+	Collision System Class
+-------------------------------------------------------------------------------------------
+-----------------------------------------------------------------------------------------*/
+
+// Stops tanks overlapping each other and driving through scenery. Works on the positions in
+// CKinematics after they are integrated and before they are written back to the tanks:
+//  - Broadphase: every tank and static obstacle has a box in the XZ plane. The start and end of
+//    each box along X are kept in one list sorted by X, along with the set of pairs of boxes that
+//    overlap in X. Each tick the tank boxes are moved and the list is re-sorted by insertion sort.
+//    Each swap of a box start with another box's end adds or removes a pair, so the cost grows
+//    with how far the tanks move rather than the square of their number
+//  - Narrowphase: pairs that also overlap in Z are tested precisely, tanks as circles and
+//    obstacles as their footprint boxes (as used by CNavGrid, e.g. a tree's trunk rather than
+//    its canopy, see CObstacleBVH). Tanks are pushed apart first, then out of obstacles
+//
+// Tanks that can't move (dead) are not pushed, but still block other tanks. The lists are
+// rebuilt from scratch if the set of tanks changes
+class CCollisionSystem
+{
+/////////////////////////////////////
+//	Constructors/Destructors
+public:
+	// Constructor sets the collision radius of tanks
+	CCollisionSystem( TFloat32 tankRadius = 2.0f ) : m_Pairs( 256, JOneAtATimeHash )
+	{
+		m_TankRadius = tankRadius;
+		m_NumTanks = 0;
+		m_NumSwaps = 0;
+		m_NumContacts = 0;
+	}
+
+private:
+	// Prevent use of copy constructor and assignment operator (private and not defined)
+	CCollisionSystem( const CCollisionSystem& );
+	CCollisionSystem& operator=( const CCollisionSystem& );
+
+
+/////////////////////////////////////
+//	Public interface
+public:
+
+	/////////////////////////////////////
+	// Setup
+
+	// Set the static obstacles tanks collide with, from their footprints in the obstacle hierarchy
+	void SetObstacles( const CObstacleBVH& obstacles );
+
+	// Remove all tanks and obstacles
+	void Clear();
+
+
+	/////////////////////////////////////
+	// Update
+
+	// Move the tank boxes to the integrated positions, update the overlapping pairs and push
+	// colliding tanks apart
+	void Update( CKinematics& kinematics );
+
+
+	/////////////////////////////////////
+	// Statistics
+
+	// Number of pairs of boxes overlapping in X
+	TUInt32 NumPairs() const
+	{
+		return static_cast<TUInt32>(m_PairList.size());
+	}
+
+	// Number of swaps made re-sorting the box ends, and of pairs found to be touching, in the
+	// last update
+	TUInt32 NumSwaps() const
+	{
+		return m_NumSwaps;
+	}
+
+	TUInt32 NumContacts() const
+	{
+		return m_NumContacts;
+	}
+
+
+/////////////////////////////////////
+//	Private interface
+private:
+
+	// Box in the XZ plane. Tank boxes come first (with the same index as in CKinematics), then the
+	// obstacle boxes, which never move
+	struct SBox
+	{
+		TFloat32 minX, maxX;
+		TFloat32 minZ, maxZ;
+	};
+
+	// Start or end of a box along X. The box index is doubled with 1 added for the end, so
+	// ends of boxes in the same place sort after starts and touching boxes are kept as a pair
+	struct SEndPoint
+	{
+		TFloat32 x;
+		TUInt32  boxEnd;
+	};
+
+	// Pair of boxes overlapping in X, the first is always a tank and has the lower index
+	struct SPair
+	{
+		TUInt32 box1;
+		TUInt32 box2;
+	};
+
+	// Clear the lists and add all boxes again, for the tanks currently in the kinematics
+	void Rebuild( const CKinematics& kinematics );
+
+	// Set the box of a tank from its position
+	void SetTankBox( TUInt32 tank, TFloat32 x, TFloat32 z );
+
+	// Sort the end point at the given index left into place, adding and removing pairs as it
+	// passes other end points
+	void SortEndPoint( TUInt32 index );
+
+	// Add or remove a pair of boxes overlapping in X. Pairs of obstacles are not kept
+	void AddPair( TUInt32 box1, TUInt32 box2 );
+	void RemovePair( TUInt32 box1, TUInt32 box2 );
+
+	// Test a pair of boxes precisely and push the tanks apart if they touch
+	void CollideTanks( CKinematics& kinematics, TUInt32 tank1, TUInt32 tank2 );
+	void CollideObstacle( CKinematics& kinematics, TUInt32 tank, TUInt32 obstacle );
+
+
+	// Boxes and their end points sorted along X
+	vector<SBox>      m_Boxes;
+	vector<SEndPoint> m_EndPoints;
+	vector<SAABB>     m_Obstacles;
+
+	// Pairs overlapping in X, and the index of each pair in the list from a key made from both box
+	// indexes. Removing a pair moves the last pair into its place
+	vector<SPair>                m_PairList;
+	CHashTable<TUInt64, TUInt32> m_Pairs;
+
+	// Tanks the lists were built for
+	vector<TEntityUID> m_TankUIDs;
+	TUInt32            m_NumTanks;
+
+	// Settings
+	TFloat32 m_TankRadius;
+
+	// Statistics
+	TUInt32 m_NumSwaps;
+	TUInt32 m_NumContacts;
+};
+
+
+} // namespace gen
@@ -16,7 +16,7 @@ namespace gen
 -----------------------------------------------------------------------------------------*/
 
 // Base entity constructor, needs pointer to common template data and UID, may also pass 
-// name, initial position, rotation and scaling. Set up positional matrices for the entity
+// name, initial position, rotation and scaling. Set up positional transforms for the entity
 CEntity::CEntity
 (
 	CEntityTemplate* entityTemplate,
@@ -30,41 +30,44 @@ CEntity::CEntity
 	m_Template = entityTemplate;
 	m_UID = UID;
 	m_Name = name;
+	m_Sleeping = true;
 
-	// Allocate space for matrices
+	// Allocate space for transforms
 	TUInt32 numNodes = m_Template->Mesh()->GetNumNodes();
-	m_RelMatrices = new CMatrix4x4[numNodes];
-	m_Matrices = new CMatrix4x4[numNodes];
+	m_RelTransforms = new CQuatTransform[numNodes];
 
-	// Set initial matrices from mesh defaults
+	// Set initial transforms from mesh defaults
 	for (TUInt32 node = 0; node < numNodes; ++node)
 	{
-		m_RelMatrices[node] = m_Template->Mesh()->GetNode( node ).positionMatrix;
+		m_RelTransforms[node] = CQuatTransform( m_Template->Mesh()->GetNode( node ).positionMatrix );
 	}
 
-	// Override root matrix with constructor parameters
-	m_RelMatrices[0] = CMatrix4x4( position, rotation, kZXY, scale );
+	// Override root transform with constructor parameters
+	m_RelTransforms[0] = CQuatTransform( CMatrix4x4( position, rotation, kZXY, scale ) );
 }
 
 
-// Render the model
-void CEntity::Render()
+// Add the model to the given render state to be drawn
+void CEntity::ExtractRender( SRenderState& state )
 {
 	// Get pointer to mesh to simplify code
 	CMesh* Mesh = m_Template->Mesh();
 
-	// Calculate absolute matrices from relative node matrices & node heirarchy
-	m_Matrices[0] = m_RelMatrices[0];
+	// Absolute matrices are only needed to draw the frame, so are built straight into the render
+	// state rather than stored per-entity
 	TUInt32 numNodes = Mesh->GetNumNodes();
+	CMatrix4x4* matrices = state.AddInstance( Mesh );
+
+	// Calculate absolute matrices from relative node transforms & node heirarchy
+	m_RelTransforms[0].GetMatrix( matrices[0] );
+	CMatrix4x4 relMatrix;
 	for (TUInt32 node = 1; node < numNodes; ++node)
 	{
-		m_Matrices[node] = m_RelMatrices[node] * m_Matrices[Mesh->GetNode( node ).parent];
+		m_RelTransforms[node].GetMatrix( relMatrix );
+		matrices[node] = relMatrix * matrices[Mesh->GetNode( node ).parent];
 	}
 	// Incorporate any bone<->mesh offsets (only relevant for skinning)
 	// Don't need this step for this exercise
-
-	// Render with absolute matrices
-	Mesh->Render( m_Matrices );
 }
 
 
@@ -7,13 +7,17 @@
 #pragma once
 
 #include <string>
+#include <vector>
 using namespace std;
 
 #include "Defines.h"
 #include "CVector3.h"
 #include "CMatrix4x4.h"
+#include "CQuatTransform.h"
 #include "Camera.h"
 #include "Mesh.h"
+#include "MeshBVH.h"
+#include "RenderState.h"
 
 namespace gen
 {
@@ -46,6 +50,9 @@ public:
 	{
 		m_Type = type;
 		m_Name = name;
+		m_IsObstacle = false;
+		m_CollisionRadius = 0.0f;
+		m_MeshBVH = 0;
 
 		// Load mesh
 		m_Mesh = new CMesh();
@@ -60,6 +67,7 @@ public:
 	// Destructor - base class destructors should always be virtual
 	virtual ~CEntityTemplate()
 	{
+		delete m_MeshBVH;
 		delete m_Mesh;
 	}
 
@@ -91,6 +99,44 @@ public:
 		return m_Mesh;
 	}
 
+	// Entities with obstacle templates are static scenery that blocks line of sight
+	bool IsObstacle()
+	{
+		return m_IsObstacle;
+	}
+
+	// Radius in model space around the model's Y axis of the part of an obstacle that blocks
+	// movement (e.g. a tree trunk), or 0 if the whole mesh blocks movement
+	TFloat32 GetCollisionRadius()
+	{
+		return m_CollisionRadius;
+	}
+
+	// Triangle hierarchy of the mesh for precise ray casts, built on first use
+	const CMeshBVH* MeshBVH()
+	{
+		if (!m_MeshBVH)
+		{
+			m_MeshBVH = new CMeshBVH();
+			m_MeshBVH->Build( *m_Mesh );
+		}
+		return m_MeshBVH;
+	}
+
+
+	/////////////////////////////////////
+	//	Setters
+
+	void SetObstacle( bool isObstacle )
+	{
+		m_IsObstacle = isObstacle;
+	}
+
+	void SetCollisionRadius( TFloat32 collisionRadius )
+	{
+		m_CollisionRadius = collisionRadius;
+	}
+
 
 /////////////////////////////////////
 //	Private interface
@@ -102,6 +148,36 @@ private:
 
 	// The mesh representing this entity
 	CMesh* m_Mesh;
+
+	// Whether entities of this template are obstacles, and the radius that blocks movement
+	bool     m_IsObstacle;
+	TFloat32 m_CollisionRadius;
+
+	// Triangle hierarchy of the mesh, 0 until first requested
+	CMeshBVH* m_MeshBVH;
+};
+
+
+
+/*-----------------------------------------------------------------------------------------
+-------------------------------------------------------------------------------------------
+	Entity Snapshot
+-------------------------------------------------------------------------------------------
+-----------------------------------------------------------------------------------------*/
+
+// The public state of an entity at the start of the tick. Entities are updated in parallel, so
+// an entity update reads other entities through their snapshot (CEntityManager::GetSnapshot)
+// rather than the entities themselves, which may be changing
+struct SEntitySnapshot
+{
+	TEntityUID UID;
+	CVector3   position;
+
+	// Tanks only
+	bool       isTank;
+	TUInt32    team;
+	TInt32     HP;
+	bool       alive;
 };
 
 
@@ -113,15 +189,16 @@ private:
 -----------------------------------------------------------------------------------------*/
 
 // Base entity holds a pointer to its template data and the current position as a set of
-// matrices. The entity can be rendered but its update function does nothing - base class
-// entities are assumed to be static scene elements
+// quaternion transforms (one per mesh node). Matrices are only built when rendering. The entity
+// can be rendered but its update function does nothing - base class entities are assumed to be
+// static scene elements, so start asleep and are never updated
 class CEntity
 {
 /////////////////////////////////////
 //	Constructors/Destructors
 public:
 	// Base entity constructor, needs pointer to common template data and UID, may also pass 
-	// name, initial position, rotation and scaling. Set up positional matrices for the entity
+	// name, initial position, rotation and scaling. Set up positional transforms for the entity
 	CEntity
 	(
 		CEntityTemplate* entityTemplate,
@@ -135,8 +212,7 @@ public:
 	// Destructor - base class destructors should always be virtual
 	virtual ~CEntity()
 	{
-		delete[] m_Matrices;
-		delete[] m_RelMatrices;
+		delete[] m_RelTransforms;
 	}
 
 private:
@@ -169,29 +245,76 @@ public:
 
 
 	/////////////////////////////////////
-	// Matrix access
+	// Transform access
 
-	// Direct access to position and matrix
+	// Direct access to position and transform (relative to parent node)
 	CVector3& Position( TUInt32 node = 0 )
 	{
-		return m_RelMatrices[node].Position();
+		return m_RelTransforms[node].pos;
 	}
-	CMatrix4x4& Matrix( TUInt32 node = 0 )
+	CQuatTransform& Transform( TUInt32 node = 0 )
 	{
-		return m_RelMatrices[node];
+		return m_RelTransforms[node];
+	}
+
+	// Build the matrix equivalent of a node's transform (relative to parent node)
+	CMatrix4x4 Matrix( TUInt32 node = 0 ) const
+	{
+		CMatrix4x4 mat;
+		m_RelTransforms[node].GetMatrix( mat );
+		return mat;
 	}
 
 
 	/////////////////////////////////////
 	// Update / Render
 
+	// Entities are updated in two phases. Updates run in parallel, so may only change the entity
+	// itself, read other entities through their snapshots and read shared systems. Anything else
+	// is recorded by the entity and done in Commit, which is called for each entity in turn after
+	// all updates. Messages are fetched before the update with ReceiveMessages
+
+	// Fetch messages sent to the entity, ready for the update. Virtual function, base version
+	// does nothing
+	virtual void ReceiveMessages() {}
+
 	// Perform whatever update is required for this entity, pass time since last update
 	// Return false if the entity is to be destroyed
 	// Virtual function, base version does nothing
 	virtual bool Update( TFloat32 updateTime ) { return true; }
+
+	// Apply changes to the rest of the world recorded during the update (send messages etc.)
+	// Virtual function, base version does nothing
+	virtual void Commit() {}
+
+	// Sleeping entities are not updated until woken by a message or by the entity manager's
+	// WakeEntity. Base entities start asleep, entities with behaviour wake in their constructor
+	bool IsSleeping() const
+	{
+		return m_Sleeping;
+	}
+
+	// Wake the entity. Entities held by the manager must be woken with CEntityManager::WakeEntity
+	// so it can move them to its active list
+	void Wake()
+	{
+		m_Sleeping = false;
+	}
 	
-	// Render the entity
-	void Render();
+	// Add the entity to the given render state to be drawn
+	void ExtractRender( SRenderState& state );
+
+
+/////////////////////////////////////
+//	Protected interface
+protected:
+
+	// Put the entity to sleep from its Update function. It is not updated again until woken, e.g.
+	// when it is sent a message
+	void Sleep()
+	{
+		m_Sleeping = true;
+	}
 
 
 /////////////////////////////////////
@@ -205,9 +328,11 @@ private:
 	TEntityUID  m_UID;
 	string      m_Name;
 
-	// Relative and absolute world matrices for each node in the template's mesh
-	CMatrix4x4* m_RelMatrices; // Dynamically allocated arrays
-	CMatrix4x4* m_Matrices;
+	// Whether the entity is skipped by updates
+	bool        m_Sleeping;
+
+	// Transforms for each node in the template's mesh, relative to the parent node
+	CQuatTransform* m_RelTransforms; // Dynamically allocated array
 };
 
 
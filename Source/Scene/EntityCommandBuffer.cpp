@@ -0,0 +1,84 @@
+/*******************************************
+	EntityCommandBuffer.cpp
+
+	Entity creation and destruction recorded
+	during the update and applied together
+	at the end of the tick
+********************************************/
+
+#include "EntityCommandBuffer.h"
+#include "EntityManager.h"
+
+namespace gen
+{
+
+/*-----------------------------------------------------------------------------------------
+	Recording
+-----------------------------------------------------------------------------------------*/
+
+// Record the creation of a base class entity, see CEntityManager::CreateEntity
+void CEntityCommandBuffer::CreateEntity
+(
+	const string&   templateName,
+	const string&   name /*= ""*/,
+	const CVector3& position /*= CVector3::kOrigin*/, 
+	const CVector3& rotation /*= CVector3( 0.0f, 0.0f, 0.0f )*/,
+	const CVector3& scale /*= CVector3( 1.0f, 1.0f, 1.0f )*/
+)
+{
+	AddCreate( EntityCommand_CreateEntity, templateName, name, position, rotation, scale );
+}
+
+// Record the creation of a tank, see CEntityManager::CreateTank
+void CEntityCommandBuffer::CreateTank
+(
+	const string&   templateName,
+	TUInt32         team,
+	const string&   name /*= ""*/,
+	const CVector3& position /*= CVector3::kOrigin*/,
+	const CVector3& rotation /*= CVector3( 0.0f, 0.0f, 0.0f )*/,
+	const CVector3& scale /*= CVector3( 1.0f, 1.0f, 1.0f )*/,
+	const vector<CVector3> patrolPoints
+)
+{
+	SCreateCommand& command = AddCreate( EntityCommand_CreateTank, templateName, name, position, rotation, scale );
+	command.team = team;
+	command.patrolPoints = patrolPoints;
+}
+
+// Record the creation of an ammo crate, see CEntityManager::CreateAmmo
+void CEntityCommandBuffer::CreateAmmo
+(
+	const string&   templateName,
+	const string&   name /*= ""*/,
+	const CVector3& position /*= CVector3::kOrigin*/,
+	const CVector3& rotation /*= CVector3( 0.0f, 0.0f, 0.0f )*/,
+	const CVector3& scale /*= CVector3( 1.0f, 1.0f, 1.0f )*/
+)
+{
+	AddCreate( EntityCommand_CreateAmmo, templateName, name, position, rotation, scale );
+}
+
+
+// Add a creation command with the given type and common arguments, keyed by the current creator.
+// Returns the new command
+SCreateCommand& CEntityCommandBuffer::AddCreate( EEntityCommandType type, const string& templateName,
+                                                 const string& name, const CVector3& position,
+                                                 const CVector3& rotation, const CVector3& scale )
+{
+	m_Creates.push_back( SCreateCommand() );
+	SCreateCommand& command = m_Creates.back();
+	command.type = type;
+	command.creator = m_Creator;
+	command.sequence = m_NextSequence++;
+	command.templateName = templateName;
+	command.team = 0;
+	command.name = name;
+	command.position = position;
+	command.rotation = rotation;
+	command.scale = scale;
+	return command;
+}
+
+
+} // namespace gen
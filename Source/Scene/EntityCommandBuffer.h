@@ -0,0 +1,190 @@
+/*******************************************
+	EntityCommandBuffer.h
+
+	Entity creation and destruction recorded
+	during the update and applied together
+	at the end of the tick
+********************************************/
+
+#pragma once
+
+#include <string>
+#include <vector>
+using namespace std;
+
+#include "Defines.h"
+#include "CVector3.h"
+#include "Entity.h"
+
+namespace gen
+{
+
+/////////////////////////////////////
+//	Public types
+
+// Kinds of entity that can be created by a command
+enum EEntityCommandType
+{
+	EntityCommand_CreateEntity, // Base entity (scenery)
+	EntityCommand_CreateTank,
+	EntityCommand_CreateAmmo
+};
+
+// A recorded entity creation, holds the arguments of the matching CEntityManager create function.
+// Creations are ordered by the UID of the entity that recorded them (SystemUID if none, so after
+// all entities) then the order that entity recorded them in
+struct SCreateCommand
+{
+	EEntityCommandType type;
+	TEntityUID         creator;
+	TUInt32            sequence;
+	string             templateName;
+	TUInt32            team; // Tanks only
+	string             name;
+	CVector3           position;
+	CVector3           rotation;
+	CVector3           scale;
+	vector<CVector3>   patrolPoints; // Tanks only
+};
+
+
+/*-----------------------------------------------------------------------------------------
+-------------------------------------------------------------------------------------------
+	Entity Command Buffer Class
+-------------------------------------------------------------------------------------------
+-----------------------------------------------------------------------------------------*/
+
+// Records entity creation and destruction so the entity list is not changed while it is being
+// updated. The entity manager holds one buffer for each thread that updates entities and applies
+// the commands from all of them in one pass at the end of the tick (CEntityManager::ApplyCommands)
+//
+// Created entities are given their UIDs when the commands are applied, in the order of the
+// entities that recorded them (see SetCreator, the entity manager sets each entity as the creator
+// while it commits) and then the order each recorded them in. So the
+// UIDs don't depend on which thread or buffer recorded a creation, and no UID is shared between
+// threads while recording. An entity that is to be destroyed still exists until the commands are
+// applied
+class CEntityCommandBuffer
+{
+/////////////////////////////////////
+//	Constructors/Destructors
+public:
+	// Constructor creates an empty buffer, recording for no entity
+	CEntityCommandBuffer()
+	{
+		m_Creator = SystemUID;
+		m_NextSequence = 0;
+	}
+
+private:
+	// Prevent use of copy constructor and assignment operator (private and not defined)
+	CEntityCommandBuffer( const CEntityCommandBuffer& );
+	CEntityCommandBuffer& operator=( const CEntityCommandBuffer& );
+
+
+/////////////////////////////////////
+//	Public interface
+public:
+
+	/////////////////////////////////////
+	// Recording
+
+	// Set the entity whose creations are recorded next, SystemUID for code outside any entity. An
+	// entity's creations must all be recorded in one buffer in a deterministic order, e.g. during
+	// its commit
+	void SetCreator( TEntityUID creator )
+	{
+		m_Creator = creator;
+	}
+
+	// Record the creation of a base class entity, see CEntityManager::CreateEntity
+	void CreateEntity
+	(
+		const string&    templateName,
+		const string&    name = "",
+		const CVector3&  position = CVector3::kOrigin, 
+		const CVector3&  rotation = CVector3( 0.0f, 0.0f, 0.0f ),
+		const CVector3&  scale = CVector3( 1.0f, 1.0f, 1.0f )
+	);
+
+	// Record the creation of a tank, see CEntityManager::CreateTank
+	void CreateTank
+	(
+		const string&   templateName,
+		TUInt32         team,
+		const string&   name = "",
+		const CVector3& position = CVector3::kOrigin,
+		const CVector3& rotation = CVector3( 0.0f, 0.0f, 0.0f ),
+		const CVector3& scale = CVector3( 1.0f, 1.0f, 1.0f ),
+		const vector<CVector3> patrolPoints = {}
+	);
+
+	// Record the creation of an ammo crate, see CEntityManager::CreateAmmo
+	void CreateAmmo
+	(
+		const string&   templateName,
+		const string&   name = "",
+		const CVector3& position = CVector3::kOrigin,
+		const CVector3& rotation = CVector3( 0.0f, 0.0f, 0.0f ),
+		const CVector3& scale = CVector3( 1.0f, 1.0f, 1.0f )
+	);
+
+	// Record the destruction of an entity. It is not an error to destroy an entity more than
+	// once, or one that no longer exists when the commands are applied
+	void DestroyEntity( TEntityUID UID )
+	{
+		m_Destroys.push_back( UID );
+	}
+
+
+	/////////////////////////////////////
+	// Commands
+
+	bool IsEmpty() const
+	{
+		return m_Creates.empty() && m_Destroys.empty();
+	}
+
+	const vector<SCreateCommand>& Creates() const
+	{
+		return m_Creates;
+	}
+
+	const vector<TEntityUID>& Destroys() const
+	{
+		return m_Destroys;
+	}
+
+	// Remove all recorded commands. Keeps the memory used for the next tick
+	void Clear()
+	{
+		m_Creates.clear();
+		m_Destroys.clear();
+		m_Creator = SystemUID;
+		m_NextSequence = 0;
+	}
+
+
+/////////////////////////////////////
+//	Private interface
+private:
+
+	// Add a creation command with the given type and common arguments, keyed by the current
+	// creator. Returns the new command
+	SCreateCommand& AddCreate( EEntityCommandType type, const string& templateName, const string& name,
+	                           const CVector3& position, const CVector3& rotation, const CVector3& scale );
+
+
+	// Entity recording creations, and the sequence number of the next creation in this buffer.
+	// Sequence numbers only increase, so they keep each creator's creations in order even if the
+	// creator is set more than once
+	TEntityUID m_Creator;
+	TUInt32    m_NextSequence;
+
+	// Recorded commands in the order they were recorded
+	vector<SCreateCommand> m_Creates;
+	vector<TEntityUID>     m_Destroys;
+};
+
+
+} // namespace gen
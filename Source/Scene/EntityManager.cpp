@@ -5,11 +5,18 @@
 	destruction
 ********************************************/
 
+#include <algorithm>
+using namespace std;
+
 #include "EntityManager.h"
+#include "Messenger.h"
 
 namespace gen
 {
 
+// Messenger class for sending messages to and between entities, entities sent messages are woken
+extern CMessenger Messenger;
+
 /////////////////////////////////////
 // Constructors/Destructors
 
@@ -22,6 +29,13 @@ CEntityManager::CEntityManager()
 
 	// Set first entity UID that will be used
 	m_NextUID = 0;
+	for (TUInt32 group = 0; group < UpdateGroup_Count; ++group)
+	{
+		m_GroupEnd[group] = 0;
+	}
+
+	// One command buffer until more threads update entities
+	m_CommandBuffers.push_back( new CEntityCommandBuffer() );
 
 	m_IsEnumerating = false;
 }
@@ -30,6 +44,10 @@ CEntityManager::CEntityManager()
 CEntityManager::~CEntityManager()
 {
 	DestroyAllEntities();
+	for (TUInt32 buffer = 0; buffer < m_CommandBuffers.size(); ++buffer)
+	{
+		delete m_CommandBuffers[buffer];
+	}
 	delete m_EntityUIDMap;
 }
 
@@ -118,19 +136,10 @@ TEntityUID CEntityManager::CreateEntity
 	CEntityTemplate* entityTemplate = GetTemplate( templateName );
 
 	// Create new entity with next UID
-	CEntity* newEntity = new CEntity( entityTemplate, m_NextUID, name, position, rotation, scale );
-
-	// Get vector index for new entity and add it to vector
-	TUInt32 entityIndex = static_cast<TUInt32>(m_Entities.size());
-	m_Entities.push_back( newEntity );
+	CEntity* newEntity = new CEntity( entityTemplate, m_NextUID++, name, position, rotation, scale );
 
-	// Add mapping from UID to entity index into hash map
-	m_EntityUIDMap->SetKeyValue( m_NextUID, entityIndex );
-	
-	m_IsEnumerating = false; // Cancel any entity enumeration (entity list has changed)
-
-	// Return UID of new entity then increase it ready for next entity
-	return m_NextUID++;
+	// Add to the sleeping entities (no behaviour), return UID of new entity
+	return AddEntity( newEntity, UpdateGroup_None );
 }
 
 
@@ -152,76 +161,47 @@ TEntityUID CEntityManager::CreateTank
 	CTankTemplate* tankTemplate = static_cast<CTankTemplate*>(GetTemplate(templateName));
 
 	// Create new tank entity with next UID
-	CEntity* newEntity = new CTankEntity(tankTemplate, m_NextUID, team, name, position, rotation, scale, patrolPoints);
-
-	// Get vector index for new entity and add it to vector
-	TUInt32 entityIndex = static_cast<int>(m_Entities.size());
-	m_Entities.push_back(newEntity);
-
-	// Add mapping from UID to entity index into hash map
-	m_EntityUIDMap->SetKeyValue(m_NextUID, entityIndex);
-
-	m_IsEnumerating = false; // Cancel any entity enumeration (entity list has changed)
+	CEntity* newEntity = new CTankEntity(tankTemplate, m_NextUID++, team, name, position, rotation, scale, patrolPoints);
 
-							 // Return UID of new entity then increase it ready for next entity
-	return m_NextUID++;
+	// Add to the tanks, return UID of new entity
+	return AddEntity(newEntity, UpdateGroup_Tank);
 }
 
 
-// Create a shell, requires a shell template name, may supply entity name and position
-// Returns the UID of the new entity
-TEntityUID CEntityManager::CreateShell
-(
-	const string&   templateName,
-	const string&   name /*= ""*/,
-	const CVector3& position /*= CVector3::kOrigin*/,
-	const CVector3& rotation /*= CVector3( 0.0f, 0.0f, 0.0f )*/,
-	const CVector3& scale /*= CVector3( 1.0f, 1.0f, 1.0f )*/,
-	const int		team,
-	const int		damage
-	)
+TEntityUID CEntityManager::CreateAmmo(const string& templateName, const string& name, const CVector3& position, const CVector3& rotation, const CVector3& scale)
 {
 	// Get template associated with the template name
 	CEntityTemplate* entityTemplate = GetTemplate(templateName);
 
-	// Create new shell entity with next UID
-	CEntity* newEntity = new CShellEntity(entityTemplate, m_NextUID,
-		name, position, rotation, scale, team, damage);
-
-	// Get vector index for new entity and add it to vector
-	TUInt32 entityIndex = static_cast<int>(m_Entities.size());
-	m_Entities.push_back(newEntity);
-
-	// Add mapping from UID to entity index into hash map
-	m_EntityUIDMap->SetKeyValue(m_NextUID, entityIndex);
-
-	m_IsEnumerating = false; // Cancel any entity enumeration (entity list has changed)
+	// Create new ammo entity with next UID
+	CEntity* newEntity = new CAmmoEntity(entityTemplate, m_NextUID++,
+		name, position, rotation, scale);
 
-							 // Return UID of new entity then increase it ready for next entity
-	return m_NextUID++;
+	// Add to the ammo crates, return UID of new entity
+	return AddEntity(newEntity, UpdateGroup_Ammo);
 }
 
-TEntityUID CEntityManager::CreateAmmo(const string& templateName, const string& name, const CVector3& position, const CVector3& rotation, const CVector3& scale)
-{
-	// Get template associated with the template name
-	CEntityTemplate* entityTemplate = GetTemplate(templateName);
-
-	// Create new shell entity with next UID
-	CEntity* newEntity = new CAmmoEntity(entityTemplate, m_NextUID,
-		name, position, rotation, scale);
 
+// Add a new entity to its update group or the sleeping entities. Returns its UID
+TEntityUID CEntityManager::AddEntity( CEntity* newEntity, EUpdateGroup group )
+{
 	// Get vector index for new entity and add it to vector
-	TUInt32 entityIndex = static_cast<int>(m_Entities.size());
-	m_Entities.push_back(newEntity);
+	TUInt32 entityIndex = static_cast<TUInt32>(m_Entities.size());
+	m_Entities.push_back( newEntity );
+	m_EntityGroups.push_back( static_cast<TUInt8>(group) );
 
 	// Add mapping from UID to entity index into hash map
-	m_EntityUIDMap->SetKeyValue(m_NextUID, entityIndex);
+	m_EntityUIDMap->SetKeyValue( newEntity->GetUID(), entityIndex );
+
+	// Active entities are kept in their group, before the sleeping ones
+	if (group != UpdateGroup_None && !newEntity->IsSleeping())
+	{
+		MoveEntity( entityIndex, UpdateGroup_Sleeping, group );
+	}
 
 	m_IsEnumerating = false; // Cancel any entity enumeration (entity list has changed)
 
-							 // Return UID of new entity then increase it ready for next entity
-	return m_NextUID++;
-	return TEntityUID();
+	return newEntity->GetUID();
 }
 
 
@@ -236,6 +216,10 @@ bool CEntityManager::DestroyEntity( TEntityUID UID )
 		return false;
 	}
 
+	// Move an active entity out of its group so it can be treated as sleeping. The last entity
+	// in the group takes its place
+	entityIndex = MoveEntity( entityIndex, EntityGroup( entityIndex ), UpdateGroup_Sleeping );
+
 	// Delete the given entity and remove from UID map
 	delete m_Entities[entityIndex];
 	m_EntityUIDMap->RemoveKey( UID );
@@ -245,57 +229,359 @@ bool CEntityManager::DestroyEntity( TEntityUID UID )
 	{
 		// ...put the last entity into the empty entity slot and update UID map
 		m_Entities[entityIndex] = m_Entities.back();
+		m_EntityGroups[entityIndex] = m_EntityGroups.back();
 		m_EntityUIDMap->SetKeyValue( m_Entities.back()->GetUID(), entityIndex );
 	}
 	m_Entities.pop_back(); // Remove last entity
+	m_EntityGroups.pop_back();
 
 	m_IsEnumerating = false; // Cancel any entity enumeration (entity list has changed)
 	return true;
 }
 
 
-// Destroy all entities held by the manager
+// Destroy all entities held by the manager, and discard any recorded commands. UIDs are given out
+// from the start again
 void CEntityManager::DestroyAllEntities()
 {
+	for (TUInt32 buffer = 0; buffer < m_CommandBuffers.size(); ++buffer)
+	{
+		m_CommandBuffers[buffer]->Clear();
+	}
+
 	m_EntityUIDMap->RemoveAllKeys();
 	while (m_Entities.size())
 	{
 		delete m_Entities.back();
 		m_Entities.pop_back();
 	}
+	m_EntityGroups.clear();
+	for (TUInt32 group = 0; group < UpdateGroup_Count; ++group)
+	{
+		m_GroupEnd[group] = 0;
+	}
+	m_NextUID = 0;
 
 	m_IsEnumerating = false; // Cancel any entity enumeration (entity list has changed)
 }
 
 
+// Swap the entities at two indexes in the list and update the UID map
+void CEntityManager::SwapEntities( TUInt32 index1, TUInt32 index2 )
+{
+	if (index1 != index2)
+	{
+		CEntity* temp = m_Entities[index1];
+		m_Entities[index1] = m_Entities[index2];
+		m_Entities[index2] = temp;
+		TUInt8 tempGroup = m_EntityGroups[index1];
+		m_EntityGroups[index1] = m_EntityGroups[index2];
+		m_EntityGroups[index2] = tempGroup;
+		m_EntityUIDMap->SetKeyValue( m_Entities[index1]->GetUID(), index1 );
+		m_EntityUIDMap->SetKeyValue( m_Entities[index2]->GetUID(), index2 );
+	}
+}
+
+// Move the entity at the given index from one update group to another (either may be the
+// sleeping entities), by swapping it across the group boundaries in between. Returns its new
+// index. Only the groups between the two are disturbed
+TUInt32 CEntityManager::MoveEntity( TUInt32 entityIndex, TUInt32 fromGroup, TUInt32 toGroup )
+{
+	// Moving towards the start: swap with the first entity of each group passed, then grow the
+	// group before to take in the moved entity
+	for (TUInt32 group = fromGroup; group > toGroup; --group)
+	{
+		TUInt32 groupStart = GroupStart( group );
+		SwapEntities( entityIndex, groupStart );
+		entityIndex = groupStart;
+		++m_GroupEnd[group - 1];
+	}
+
+	// Moving towards the end: swap with the last entity of each group passed, then shrink that
+	// group to leave the moved entity at the start of the next
+	for (TUInt32 group = fromGroup; group < toGroup; ++group)
+	{
+		--m_GroupEnd[group];
+		SwapEntities( entityIndex, m_GroupEnd[group] );
+		entityIndex = m_GroupEnd[group];
+	}
+	return entityIndex;
+}
+
+
 /////////////////////////////////////
-// Update / Rendering
+// Deferred creation / destruction
+
+// Set the number of command buffers, one for each thread that updates entities. Any commands
+// already recorded are applied first
+void CEntityManager::SetNumCommandBuffers( TUInt32 numBuffers )
+{
+	GEN_ASSERT( numBuffers > 0, "Entity manager needs at least one command buffer" );
+	ApplyCommands();
+	while (m_CommandBuffers.size() > numBuffers)
+	{
+		delete m_CommandBuffers.back();
+		m_CommandBuffers.pop_back();
+	}
+	while (m_CommandBuffers.size() < numBuffers)
+	{
+		m_CommandBuffers.push_back( new CEntityCommandBuffer() );
+	}
+}
+
+// Compare recorded creations by the entity that recorded them then the order it recorded them in,
+// for sorting
+static bool CreateBefore( const SCreateCommand* command1, const SCreateCommand* command2 )
+{
+	return command1->creator < command2->creator ||
+	       (command1->creator == command2->creator && command1->sequence < command2->sequence);
+}
+
+// Apply the commands recorded in all buffers and clear them. All creations are applied first,
+// given UIDs in creator order, then all destructions in one pass
+void CEntityManager::ApplyCommands()
+{
+	// Gather commands from all buffers
+	m_CreateList.clear();
+	m_DestroyList.clear();
+	for (TUInt32 buffer = 0; buffer < m_CommandBuffers.size(); ++buffer)
+	{
+		const vector<SCreateCommand>& creates = m_CommandBuffers[buffer]->Creates();
+		for (TUInt32 create = 0; create < creates.size(); ++create)
+		{
+			m_CreateList.push_back( &creates[create] );
+		}
+		const vector<TEntityUID>& destroys = m_CommandBuffers[buffer]->Destroys();
+		m_DestroyList.insert( m_DestroyList.end(), destroys.begin(), destroys.end() );
+	}
+	if (m_CreateList.empty() && m_DestroyList.empty())
+	{
+		return;
+	}
+
+	// Create new entities in creator order with increasing UIDs, allocating list space once
+	sort( m_CreateList.begin(), m_CreateList.end(), CreateBefore );
+	m_Entities.reserve( m_Entities.size() + m_CreateList.size() );
+	m_EntityGroups.reserve( m_Entities.size() + m_CreateList.size() );
+	for (TUInt32 create = 0; create < m_CreateList.size(); ++create)
+	{
+		ApplyCreate( *m_CreateList[create] );
+	}
+
+	// Delete destroyed entities (once each, an entity may be destroyed by several commands),
+	// leaving gaps in the list, then close all the gaps together
+	sort( m_DestroyList.begin(), m_DestroyList.end() );
+	m_DestroyList.erase( unique( m_DestroyList.begin(), m_DestroyList.end() ), m_DestroyList.end() );
+	TUInt32 numDestroyed = 0;
+	for (TUInt32 destroy = 0; destroy < m_DestroyList.size(); ++destroy)
+	{
+		TUInt32 entityIndex;
+		if (m_EntityUIDMap->LookUpKey( m_DestroyList[destroy], &entityIndex ))
+		{
+			delete m_Entities[entityIndex];
+			m_Entities[entityIndex] = 0;
+			m_EntityUIDMap->RemoveKey( m_DestroyList[destroy] );
+			++numDestroyed;
+		}
+	}
+	if (numDestroyed > 0)
+	{
+		CompactEntities();
+	}
+
+	for (TUInt32 buffer = 0; buffer < m_CommandBuffers.size(); ++buffer)
+	{
+		m_CommandBuffers[buffer]->Clear();
+	}
+	m_IsEnumerating = false; // Cancel any entity enumeration (entity list has changed)
+}
+
+// Create the entity described by a recorded command, with the next UID
+void CEntityManager::ApplyCreate( const SCreateCommand& command )
+{
+	CEntityTemplate* entityTemplate = GetTemplate( command.templateName );
+	switch (command.type)
+	{
+	case EntityCommand_CreateEntity:
+		AddEntity( new CEntity( entityTemplate, m_NextUID++, command.name, command.position,
+		                        command.rotation, command.scale ), UpdateGroup_None );
+		break;
+	case EntityCommand_CreateTank:
+		AddEntity( new CTankEntity( static_cast<CTankTemplate*>(entityTemplate), m_NextUID++, command.team,
+		                            command.name, command.position, command.rotation, command.scale,
+		                            command.patrolPoints ), UpdateGroup_Tank );
+		break;
+	case EntityCommand_CreateAmmo:
+		AddEntity( new CAmmoEntity( entityTemplate, m_NextUID++, command.name, command.position,
+		                            command.rotation, command.scale ), UpdateGroup_Ammo );
+		break;
+	}
+}
 
-// Call all entity update functions. Pass the time since last update
-void CEntityManager::UpdateAllEntities( float updateTime )
+// Remove the null entries left by destroyed entities from the entity list, keeping the order of
+// the others, and update the group ends and UID map to match
+void CEntityManager::CompactEntities()
 {
-	TUInt32 entity = 0;
-	while (entity < m_Entities.size())
+	TUInt32 numEntities = static_cast<TUInt32>(m_Entities.size());
+	TUInt32 read = 0;
+	TUInt32 write = 0;
+	for (TUInt32 group = 0; group <= UpdateGroup_Count; ++group)
 	{
-		// Update entity, if it returns false, then destroy it
-		if (!m_Entities[entity]->Update( updateTime ))
+		TUInt32 groupEnd = (group < UpdateGroup_Count) ? m_GroupEnd[group] : numEntities;
+		for (; read < groupEnd; ++read)
 		{
-			DestroyEntity(m_Entities[entity]->GetUID());
+			if (m_Entities[read])
+			{
+				if (write != read)
+				{
+					m_Entities[write] = m_Entities[read];
+					m_EntityGroups[write] = m_EntityGroups[read];
+					m_EntityUIDMap->SetKeyValue( m_Entities[write]->GetUID(), write );
+				}
+				++write;
+			}
 		}
-		else
+		if (group < UpdateGroup_Count)
 		{
-			++entity;
+			m_GroupEnd[group] = write;
 		}
 	}
+	m_Entities.resize( write );
+	m_EntityGroups.resize( write );
+}
+
+
+/////////////////////////////////////
+// Sleeping
+
+// Wake a sleeping entity so it is updated again. Returns false if the entity doesn't exist
+bool CEntityManager::WakeEntity( TEntityUID UID )
+{
+	TUInt32 entityIndex;
+	if (!m_EntityUIDMap->LookUpKey( UID, &entityIndex ))
+	{
+		return false;
+	}
+
+	// Entities with no behaviour stay asleep
+	TUInt32 group = m_EntityGroups[entityIndex];
+	if (group == UpdateGroup_None)
+	{
+		return true;
+	}
+	m_Entities[entityIndex]->Wake();
+	if (entityIndex >= NumActiveEntities())
+	{
+		MoveEntity( entityIndex, UpdateGroup_Sleeping, group );
+		m_IsEnumerating = false; // Cancel any entity enumeration (entity list has changed)
+	}
+	return true;
+}
+
+
+/////////////////////////////////////
+// Update / Rendering
+
+// First phase of the tick. Wake any entities sent messages since the last update, fetch the
+// messages of all active entities and take snapshots of all entities, then call the update
+// functions of all active entities in parallel. Pass the time since last update
+void CEntityManager::UpdateAllEntities( float updateTime, CJobSystem& jobSystem )
+{
+	// Wake entities that have been sent messages since the last update
+	Messenger.TakeRecipients( &m_WakeList );
+	for (TUInt32 wake = 0; wake < m_WakeList.size(); ++wake)
+	{
+		WakeEntity( m_WakeList[wake] );
+	}
+
+	// Everything entities read from the messenger and from each other is gathered before the
+	// updates start
+	ReceiveGroupMessages<CTankEntity>( UpdateGroup_Tank );
+	ReceiveGroupMessages<CAmmoEntity>( UpdateGroup_Ammo );
+	TakeSnapshots();
+
+	// Update each group of active entities in turn, each as a parallel loop over a single type
+	m_UpdateResults.resize( NumActiveEntities() );
+	UpdateGroup<CTankEntity>( UpdateGroup_Tank, updateTime, jobSystem );
+	UpdateGroup<CAmmoEntity>( UpdateGroup_Ammo, updateTime, jobSystem );
+}
+
+// Second phase of the tick. Commit the updates of all active entities in turn. Entities whose
+// update returned false are recorded for destruction and those that went to sleep are moved to
+// the sleeping entities
+void CEntityManager::CommitAllEntities()
+{
+	CommitGroup<CTankEntity>( UpdateGroup_Tank );
+	CommitGroup<CAmmoEntity>( UpdateGroup_Ammo );
+
+	// Only once all groups are committed (the update results are indexed by the entity list),
+	// move entities that went to sleep out of their group. The last entity in the group takes each
+	// one's place
+	for (TUInt32 group = 0; group < UpdateGroup_Count; ++group)
+	{
+		TUInt32 entity = GroupStart( group );
+		while (entity < m_GroupEnd[group])
+		{
+			if (m_Entities[entity]->IsSleeping())
+			{
+				MoveEntity( entity, group, UpdateGroup_Sleeping );
+				m_IsEnumerating = false; // Cancel any entity enumeration (entity list has changed)
+			}
+			else
+			{
+				++entity;
+			}
+		}
+	}
+}
+
+// Return the snapshot of an entity taken at the start of the update, or 0 if the entity did not
+// exist then
+const SEntitySnapshot* CEntityManager::GetSnapshot( TEntityUID UID ) const
+{
+	TUInt32 entityIndex;
+	if (!m_EntityUIDMap->LookUpKey( UID, &entityIndex ) || entityIndex >= m_Snapshots.size() ||
+	    m_Snapshots[entityIndex].UID != UID)
+	{
+		return 0;
+	}
+	return &m_Snapshots[entityIndex];
+}
+
+// Take snapshots of all entities, indexed as the entity list
+void CEntityManager::TakeSnapshots()
+{
+	m_Snapshots.resize( m_Entities.size() );
+	for (TUInt32 entity = 0; entity < m_Entities.size(); ++entity)
+	{
+		SEntitySnapshot& snapshot = m_Snapshots[entity];
+		snapshot.UID = m_Entities[entity]->GetUID();
+		snapshot.position = m_Entities[entity]->Position();
+		snapshot.isTank = false;
+		snapshot.team = 0;
+		snapshot.HP = 0;
+		snapshot.alive = false;
+	}
+
+	// Tanks are always active
+	for (TUInt32 entity = GroupStart( UpdateGroup_Tank ); entity < m_GroupEnd[UpdateGroup_Tank]; ++entity)
+	{
+		CTankEntity* tank = static_cast<CTankEntity*>(m_Entities[entity]);
+		SEntitySnapshot& snapshot = m_Snapshots[entity];
+		snapshot.isTank = true;
+		snapshot.team = tank->GetTeam();
+		snapshot.HP = tank->GetHP();
+		snapshot.alive = tank->IsAlive();
+	}
 }
 
-// Render all entities
-void CEntityManager::RenderAllEntities()
+// Add all entities to the given render state to be drawn
+void CEntityManager::ExtractRenderAllEntities( SRenderState& state )
 {
 	TEntityIter entity = m_Entities.begin();
 	while (entity != m_Entities.end())
 	{
-		(*entity)->Render();
+		(*entity)->ExtractRender( state );
 		++entity;
 	}
 }
@@ -12,10 +12,11 @@ using namespace std;
 
 #include "Defines.h"
 #include "CHashTable.h"
+#include "CJobSystem.h"
 #include "Entity.h"
 #include "TankEntity.h"
-#include "ShellEntity.h"
 #include "AmmoEntity.h"
+#include "EntityCommandBuffer.h"
 #include "Camera.h"
 
 namespace gen
@@ -23,6 +24,26 @@ namespace gen
 
 // The entity manager is responsible for creation, update, rendering and deletion of
 // entities. It also manages UIDs for entities using a hash table
+//
+// Entities are either active or sleeping (see CEntity::IsSleeping). Only active entities are
+// updated, so static scenery and idle entities cost nothing each frame. Entities go to sleep from
+// their update function and are woken when sent a message or by WakeEntity
+//
+// Active entities are further grouped by concrete type (tanks, then ammo crates). Each group is
+// updated in its own loop with non-virtual calls to that type's Update, so the loop runs through
+// the same code for every entity rather than jumping between types. Base entities have no
+// behaviour so are never active
+//
+// Each tick is in two phases. UpdateAllEntities runs the updates of all active entities in
+// parallel, each reading only itself, shared systems that don't change during the update and
+// the snapshots taken of all entities at the start of the tick (GetSnapshot). CommitAllEntities
+// then commits each entity's changes to the rest of the world in turn, in list order, so the
+// result is the same however many threads ran the updates (see CEntity::Commit)
+//
+// Entities must not be created or destroyed directly while entities are being updated. Instead
+// the commands are recorded in a command buffer (see Commands) and applied together at the end of
+// the tick by ApplyCommands. Entities are destroyed during the update by returning false from
+// their Update function, which is recorded in the same way
 class CEntityManager
 {
 /////////////////////////////////////
@@ -94,19 +115,6 @@ public:
 		const vector<CVector3> patrolPoints = {}
 	);
 
-	// Create a shell, requires a shell template name, may supply entity name and position
-	// Returns the UID of the new entity
-	TEntityUID CreateShell
-	(
-		const string&   templateName,
-		const string&   name = "",
-		const CVector3& position = CVector3::kOrigin,
-		const CVector3& rotation = CVector3(0.0f, 0.0f, 0.0f),
-		const CVector3& scale = CVector3(1.0f, 1.0f, 1.0f),
-		const int		team = 0,
-		const int		damage = 20
-	);
-
 	// Create an ammo crate, requires a template name, may supply entity name and position
 	// Returns the UID of the new entity
 	TEntityUID CreateAmmo
@@ -123,10 +131,53 @@ public:
 	// Destroy the given entity - returns true if the entity existed and was destroyed
 	bool DestroyEntity( TEntityUID UID );
 
-	// Destroy all entities held by the manager
+	// Destroy all entities held by the manager, and discard any recorded commands. UIDs are given
+	// out from the start again
 	void DestroyAllEntities();
 
 
+
+	/////////////////////////////////////
+	// Deferred creation / destruction
+
+	// Set the number of command buffers, one for each thread that updates entities. Any commands
+	// already recorded are applied first
+	void SetNumCommandBuffers( TUInt32 numBuffers );
+
+	// Return a command buffer to record entity creation and destruction in during the update.
+	// Each thread must use its own buffer, and set the entity recording in it (SetCreator). Entities
+	// are set as the creator while they commit, see CommitGroup
+	CEntityCommandBuffer& Commands( TUInt32 buffer = 0 )
+	{
+		return *m_CommandBuffers[buffer];
+	}
+
+	// Apply the commands recorded in all buffers and clear them. All creations are applied first,
+	// ordered by the UID of the entity that recorded them then the order it recorded them in, and
+	// given UIDs in that order, so the result doesn't depend on which buffers were used. Then all
+	// destructions are applied in one pass that removes the entities and closes the gaps, only
+	// updating the UIDs of entities that moved
+	void ApplyCommands();
+
+
+	/////////////////////////////////////
+	// Sleeping
+
+	// Wake a sleeping entity so it is updated again. Returns false if the entity doesn't exist
+	bool WakeEntity( TEntityUID UID );
+
+	// Return the number of entities that are updated each frame, and of those that are not
+	TUInt32 NumActiveEntities() const
+	{
+		return m_GroupEnd[UpdateGroup_Count - 1];
+	}
+
+	TUInt32 NumSleepingEntities() const
+	{
+		return static_cast<TUInt32>(m_Entities.size()) - NumActiveEntities();
+	}
+
+
 	/////////////////////////////////////
 	// Template / Entity access
 
@@ -238,18 +289,127 @@ public:
 	/////////////////////////////////////
 	// Update / Rendering
 
-	// Call all entity update functions - not the ideal method, OK for this example
-	// Pass the time since last update
-	void UpdateAllEntities( float updateTime );
+	// First phase of the tick. Wake any entities sent messages since the last update, fetch the
+	// messages of all active entities and take snapshots of all entities, then call the update
+	// functions of all active entities in parallel using the given job system. Pass the time since
+	// last update
+	void UpdateAllEntities( float updateTime, CJobSystem& jobSystem );
 
-	// Render all entities - not the ideal method, OK for this example
-	void RenderAllEntities();
+	// Second phase of the tick. Commit the updates of all active entities in turn. Entities whose
+	// update returned false are recorded for destruction and those that went to sleep are moved
+	// to the sleeping entities
+	void CommitAllEntities();
+
+	// Return the snapshot of an entity taken at the start of the update, or 0 if the entity did
+	// not exist then. Snapshots are only valid during UpdateAllEntities and CommitAllEntities
+	const SEntitySnapshot* GetSnapshot( TEntityUID UID ) const;
+
+	// Add all entities to the given render state to be drawn - not the ideal method, OK for this
+	// example
+	void ExtractRenderAllEntities( SRenderState& state );
 
 		
 /////////////////////////////////////
 //	Private interface
 private:
 
+	// Groups of active entities, one for each entity type that has behaviour. Used as an index
+	// into m_GroupEnd. The sleeping entities follow the last group, so UpdateGroup_Count is also
+	// used for them, and for entities that never wake
+	enum EUpdateGroup
+	{
+		UpdateGroup_Tank,
+		UpdateGroup_Ammo,
+		UpdateGroup_Count,
+		UpdateGroup_Sleeping = UpdateGroup_Count,
+		UpdateGroup_None = UpdateGroup_Count
+	};
+
+	// Add a new entity to its update group or the sleeping entities. Returns its UID
+	TEntityUID AddEntity( CEntity* newEntity, EUpdateGroup group );
+
+	// Create the entity described by a recorded command, with the next UID
+	void ApplyCreate( const SCreateCommand& command );
+
+	// Remove the null entries left by destroyed entities from the entity list, keeping the order
+	// of the others, and update the group ends and UID map to match
+	void CompactEntities();
+
+	// Swap the entities at two indexes in the list and update the UID map
+	void SwapEntities( TUInt32 index1, TUInt32 index2 );
+
+	// Index of the first entity in an update group (or the first sleeping entity)
+	TUInt32 GroupStart( TUInt32 group ) const
+	{
+		return (group == 0) ? 0 : m_GroupEnd[group - 1];
+	}
+
+	// Return the update group an entity in the list is currently in, UpdateGroup_Sleeping if it is
+	// not active
+	TUInt32 EntityGroup( TUInt32 entityIndex ) const
+	{
+		return (entityIndex < NumActiveEntities()) ? m_EntityGroups[entityIndex] : UpdateGroup_Sleeping;
+	}
+
+	// Move the entity at the given index from one update group to another (either may be the
+	// sleeping entities), by swapping it across the group boundaries in between. Returns its new
+	// index. Only the groups between the two are disturbed
+	TUInt32 MoveEntity( TUInt32 entityIndex, TUInt32 fromGroup, TUInt32 toGroup );
+
+	// Number of entities updated together by one job
+	static const TUInt32 kUpdateGrainSize = 8;
+
+	// Functions for each group of active entities, all of the given concrete type. Calls are
+	// qualified, so they are not virtual - the group only holds this type
+
+	// Fetch the messages of the entities in one group
+	template <class TEntity>
+	void ReceiveGroupMessages( TUInt32 group )
+	{
+		for (TUInt32 entity = GroupStart( group ); entity < m_GroupEnd[group]; ++entity)
+		{
+			static_cast<TEntity*>(m_Entities[entity])->TEntity::ReceiveMessages();
+		}
+	}
+
+	// Update the entities in one group in parallel, keeping the result of each update. The entity
+	// list must not change until the group is committed
+	template <class TEntity>
+	void UpdateGroup( TUInt32 group, TFloat32 updateTime, CJobSystem& jobSystem )
+	{
+		jobSystem.ParallelFor( GroupStart( group ), m_GroupEnd[group], kUpdateGrainSize,
+			[&]( TUInt32 begin, TUInt32 end )
+			{
+				for (TUInt32 entity = begin; entity < end; ++entity)
+				{
+					TEntity* groupEntity = static_cast<TEntity*>(m_Entities[entity]);
+					m_UpdateResults[entity] = groupEntity->TEntity::Update( updateTime ) ? 1 : 0;
+				}
+			} );
+	}
+
+	// Commit the updates of the entities in one group in list order, recording the destruction of
+	// those whose update returned false. Creations recorded by an entity's commit are keyed by it
+	template <class TEntity>
+	void CommitGroup( TUInt32 group )
+	{
+		for (TUInt32 entity = GroupStart( group ); entity < m_GroupEnd[group]; ++entity)
+		{
+			TEntity* groupEntity = static_cast<TEntity*>(m_Entities[entity]);
+			Commands().SetCreator( groupEntity->GetUID() );
+			groupEntity->TEntity::Commit();
+			if (!m_UpdateResults[entity])
+			{
+				Commands().DestroyEntity( groupEntity->GetUID() );
+			}
+		}
+		Commands().SetCreator( SystemUID );
+	}
+
+	// Take snapshots of all entities, indexed as the entity list
+	void TakeSnapshots();
+
+
 	/////////////////////////////////////
 	// Types
 
@@ -274,8 +434,26 @@ private:
 
 	// The main list of entities. This vector is kept packed - i.e. with no gaps. If an
 	// entity is removed from the middle of the list, the last entity is moved down to
-	// fill its space
-	TEntities m_Entities;
+	// fill its space. Active entities are kept at the start of the list, grouped by type.
+	// Group g is entities GroupStart(g) to m_GroupEnd[g] - 1, sleeping entities are after the
+	// last group. The update group of each entity (whether active or not) is held alongside
+	TEntities      m_Entities;
+	vector<TUInt8> m_EntityGroups;
+	TUInt32        m_GroupEnd[UpdateGroup_Count];
+
+	// Entities to wake at the start of the next update, taken from the messenger
+	vector<TEntityUID> m_WakeList;
+
+	// Snapshots of all entities and results of the updates of active entities (1 to keep the
+	// entity, 0 to destroy it) in the current tick, both indexed as the entity list
+	vector<SEntitySnapshot> m_Snapshots;
+	vector<TUInt8>          m_UpdateResults;
+
+	// Command buffers for deferred creation and destruction, and the commands from all of them
+	// gathered and sorted when they are applied
+	vector<CEntityCommandBuffer*> m_CommandBuffers;
+	vector<const SCreateCommand*> m_CreateList;
+	vector<TEntityUID>            m_DestroyList;
 
 	// A mapping from UIDs to indexes into the above array
 	CHashTable<TEntityUID, TUInt32>* m_EntityUIDMap;
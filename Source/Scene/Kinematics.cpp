@@ -0,0 +1,246 @@
+/*******************************************
+	Kinematics.cpp
+
+	Tank movement state in arrays, integrated
+	for all tanks in one SSE loop
+********************************************/
+
+#include "FastMath.h"
+
+#include "Kinematics.h"
+#include "EntityManager.h"
+#include "TankEntity.h"
+
+namespace gen
+{
+
+// Select elements of a where the mask is set, otherwise b
+static inline __m128 Select4( const __m128 mask, const __m128 a, const __m128 b )
+{
+	return _mm_or_ps( _mm_and_ps( mask, a ), _mm_andnot_ps( mask, b ) );
+}
+
+
+/*-----------------------------------------------------------------------------------------
+	Tanks
+-----------------------------------------------------------------------------------------*/
+
+// Add a tank facing the given direction (only x and z are used)
+void CKinematics::AddTank( TEntityUID UID, const CVector3& facing )
+{
+	// Grow the arrays by four padding tanks when full
+	TUInt32 tank = m_NumTanks++;
+	if (tank == m_Values[0].size())
+	{
+		for (TUInt32 value = 0; value < Value_Count; ++value)
+		{
+			m_Values[value].resize( tank + 4 );
+		}
+		for (TUInt32 padding = tank; padding < tank + 4; ++padding)
+		{
+			ResetTank( padding );
+		}
+	}
+	m_UIDs.push_back( UID );
+	m_Moves.push_back( 1 );
+
+	TFloat32 facingLength = Sqrt( facing.x * facing.x + facing.z * facing.z );
+	if (facingLength > 0.001f)
+	{
+		m_Values[Value_HeadingX][tank] = facing.x / facingLength;
+		m_Values[Value_HeadingZ][tank] = facing.z / facingLength;
+	}
+}
+
+// Remove a tank. Does nothing if the tank is not present
+void CKinematics::RemoveTank( TEntityUID UID )
+{
+	for (TUInt32 tank = 0; tank < m_NumTanks; ++tank)
+	{
+		if (m_UIDs[tank] == UID)
+		{
+			// Move the last tank into the gap, leaving padding behind
+			--m_NumTanks;
+			m_UIDs[tank] = m_UIDs.back();
+			m_UIDs.pop_back();
+			m_Moves[tank] = m_Moves.back();
+			m_Moves.pop_back();
+			for (TUInt32 value = 0; value < Value_Count; ++value)
+			{
+				m_Values[value][tank] = m_Values[value][m_NumTanks];
+			}
+			ResetTank( m_NumTanks );
+			return;
+		}
+	}
+}
+
+// Set a tank's values to those of a stationary tank facing along Z
+void CKinematics::ResetTank( TUInt32 tank )
+{
+	for (TUInt32 value = 0; value < Value_Count; ++value)
+	{
+		m_Values[value][tank] = 0.0f;
+	}
+	m_Values[Value_HeadingZ][tank] = 1.0f;
+}
+
+
+/*-----------------------------------------------------------------------------------------
+	Update
+-----------------------------------------------------------------------------------------*/
+
+// Read the position, wanted movement, step time and limits of each tank
+void CKinematics::ReadTanks( CEntityManager& entityManager )
+{
+	for (TUInt32 tank = 0; tank < m_NumTanks; ++tank)
+	{
+		CTankEntity* tankEntity = static_cast<CTankEntity*>(entityManager.GetEntity( m_UIDs[tank] ));
+		CTankTemplate* tankTemplate = static_cast<CTankTemplate*>(tankEntity->Template());
+		m_Values[Value_PosX][tank] = tankEntity->Position().x;
+		m_Values[Value_PosZ][tank] = tankEntity->Position().z;
+		m_Values[Value_DesiredX][tank] = tankEntity->GetDesiredHeading().x;
+		m_Values[Value_DesiredZ][tank] = tankEntity->GetDesiredHeading().z;
+		m_Values[Value_DesiredSpeed][tank] = tankEntity->GetDesiredSpeed();
+		m_Values[Value_TurretTurnRate][tank] = tankEntity->GetDesiredTurretTurnRate();
+		m_Values[Value_TurnSpeed][tank] = tankTemplate->GetTurnSpeed();
+		m_Values[Value_Acceleration][tank] = tankTemplate->GetAcceleration();
+		m_Values[Value_TurretTurnSpeed][tank] = tankEntity->GetMaxTurretTurnRate();
+		m_Values[Value_StepTime][tank] = tankEntity->GetMoveTime();
+		m_Moves[tank] = tankEntity->IsAlive() ? 1 : 0;
+	}
+}
+
+// Turn, accelerate and move all tanks, each over its step time
+void CKinematics::Integrate()
+{
+	TFloat32* posX = m_Values[Value_PosX].data();
+	TFloat32* posZ = m_Values[Value_PosZ].data();
+	TFloat32* headingX = m_Values[Value_HeadingX].data();
+	TFloat32* headingZ = m_Values[Value_HeadingZ].data();
+	TFloat32* speed = m_Values[Value_Speed].data();
+	const TFloat32* desiredX = m_Values[Value_DesiredX].data();
+	const TFloat32* desiredZ = m_Values[Value_DesiredZ].data();
+	const TFloat32* desiredSpeed = m_Values[Value_DesiredSpeed].data();
+	const TFloat32* turnSpeed = m_Values[Value_TurnSpeed].data();
+	const TFloat32* acceleration = m_Values[Value_Acceleration].data();
+	const TFloat32* turretTurnSpeed = m_Values[Value_TurretTurnSpeed].data();
+	const TFloat32* turretTurnRate = m_Values[Value_TurretTurnRate].data();
+	TFloat32* turretYaw = m_Values[Value_TurretYaw].data();
+	TFloat32* turretTurn = m_Values[Value_TurretTurn].data();
+	const TFloat32* stepTime = m_Values[Value_StepTime].data();
+
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 signMask = _mm_set1_ps( -0.0f );
+	const __m128 minLengthSquared = _mm_set1_ps( 1e-6f );
+	const __m128 pi = _mm_set1_ps( kfPi );
+	const __m128 twoPi = _mm_set1_ps( 2.0f * kfPi );
+	const __m128 invTwoPi = _mm_set1_ps( 0.5f / kfPi );
+
+	// Arrays are padded so the last group of four is complete
+	for (TUInt32 tank = 0; tank < m_NumTanks; tank += 4)
+	{
+		// With no step time a tank has no turn, speed change or distance, so is unchanged
+		__m128 time = _mm_loadu_ps( stepTime + tank );
+		__m128 hx = _mm_loadu_ps( headingX + tank );
+		__m128 hz = _mm_loadu_ps( headingZ + tank );
+
+		// Normalise the wanted heading, or keep the current heading if there is none
+		__m128 sx = _mm_loadu_ps( desiredX + tank );
+		__m128 sz = _mm_loadu_ps( desiredZ + tank );
+		__m128 lengthSquared = _mm_add_ps( _mm_mul_ps( sx, sx ), _mm_mul_ps( sz, sz ) );
+		__m128 hasHeading = _mm_cmpgt_ps( lengthSquared, minLengthSquared );
+		__m128 invLength = FastInvSqrt4( _mm_max_ps( lengthSquared, minLengthSquared ) );
+		sx = Select4( hasHeading, _mm_mul_ps( sx, invLength ), hx );
+		sz = Select4( hasHeading, _mm_mul_ps( sz, invLength ), hz );
+
+		// Turn to the wanted heading if it is within the maximum turn, otherwise turn by the
+		// maximum towards it. Right of the heading is (hz, -hx), the turn takes the sign of the
+		// wanted heading's component along it
+		__m128 maxTurn = _mm_min_ps( _mm_mul_ps( _mm_loadu_ps( turnSpeed + tank ), time ), pi );
+		__m128 sinMaxTurn, cosMaxTurn;
+		FastSinCos4( maxTurn, &sinMaxTurn, &cosMaxTurn );
+		__m128 right = _mm_sub_ps( _mm_mul_ps( sx, hz ), _mm_mul_ps( sz, hx ) );
+		__m128 sinTurn = _mm_or_ps( _mm_andnot_ps( signMask, sinMaxTurn ), _mm_and_ps( signMask, right ) );
+		__m128 turnedX = _mm_add_ps( _mm_mul_ps( hx, cosMaxTurn ), _mm_mul_ps( hz, sinTurn ) );
+		__m128 turnedZ = _mm_sub_ps( _mm_mul_ps( hz, cosMaxTurn ), _mm_mul_ps( hx, sinTurn ) );
+		__m128 cosAngle = _mm_add_ps( _mm_mul_ps( hx, sx ), _mm_mul_ps( hz, sz ) );
+		__m128 reached = _mm_cmpge_ps( cosAngle, cosMaxTurn );
+		hx = Select4( reached, sx, turnedX );
+		hz = Select4( reached, sz, turnedZ );
+
+		// Renormalise so rounding doesn't build up over many ticks
+		invLength = FastInvSqrt4( _mm_add_ps( _mm_mul_ps( hx, hx ), _mm_mul_ps( hz, hz ) ) );
+		hx = _mm_mul_ps( hx, invLength );
+		hz = _mm_mul_ps( hz, invLength );
+
+		// Aim for the wanted speed scaled down when not facing the wanted heading, so tanks turn
+		// tightly rather than circling their target. Speed changes by at most the acceleration
+		__m128 facing = _mm_max_ps( zero, _mm_add_ps( _mm_mul_ps( hx, sx ), _mm_mul_ps( hz, sz ) ) );
+		__m128 targetSpeed = _mm_mul_ps( _mm_loadu_ps( desiredSpeed + tank ), facing );
+		__m128 maxChange = _mm_mul_ps( _mm_loadu_ps( acceleration + tank ), time );
+		__m128 v = _mm_loadu_ps( speed + tank );
+		__m128 change = _mm_sub_ps( targetSpeed, v );
+		change = _mm_min_ps( maxChange, _mm_max_ps( _mm_sub_ps( zero, maxChange ), change ) );
+		v = _mm_add_ps( v, change );
+
+		__m128 distance = _mm_mul_ps( v, time );
+		_mm_storeu_ps( posX + tank, _mm_add_ps( _mm_loadu_ps( posX + tank ), _mm_mul_ps( hx, distance ) ) );
+		_mm_storeu_ps( posZ + tank, _mm_add_ps( _mm_loadu_ps( posZ + tank ), _mm_mul_ps( hz, distance ) ) );
+		_mm_storeu_ps( headingX + tank, hx );
+		_mm_storeu_ps( headingZ + tank, hz );
+		_mm_storeu_ps( speed + tank, v );
+
+		// Turn the turret at the wanted rate, limited to the turret turn speed, keeping the yaw
+		// in the range -pi to pi
+		__m128 maxTurretRate = _mm_loadu_ps( turretTurnSpeed + tank );
+		__m128 turretRate = _mm_loadu_ps( turretTurnRate + tank );
+		turretRate = _mm_min_ps( maxTurretRate, _mm_max_ps( _mm_sub_ps( zero, maxTurretRate ), turretRate ) );
+		__m128 turn = _mm_mul_ps( turretRate, time );
+		__m128 yaw = _mm_add_ps( _mm_loadu_ps( turretYaw + tank ), turn );
+		__m128 turns = _mm_cvtepi32_ps( _mm_cvtps_epi32( _mm_mul_ps( yaw, invTwoPi ) ) );
+		yaw = _mm_sub_ps( yaw, _mm_mul_ps( turns, twoPi ) );
+		_mm_storeu_ps( turretYaw + tank, yaw );
+		_mm_storeu_ps( turretTurn + tank, turn );
+	}
+}
+
+// Set the transforms and speeds of all living tanks from the results
+void CKinematics::WriteTanks( CEntityManager& entityManager )
+{
+	for (TUInt32 tank = 0; tank < m_NumTanks; ++tank)
+	{
+		if (!m_Moves[tank])
+		{
+			continue;
+		}
+		CTankEntity* tankEntity = static_cast<CTankEntity*>(entityManager.GetEntity( m_UIDs[tank] ));
+		CQuatTransform& transform = tankEntity->Transform();
+		transform.pos.x = m_Values[Value_PosX][tank];
+		transform.pos.z = m_Values[Value_PosZ][tank];
+
+		// The body only rotates around Y - the rotation for a heading at angle a is
+		// (cos a/2, 0, sin a/2, 0), which is (1 + cos a, 0, sin a, 0) normalised
+		TFloat32 headingX = m_Values[Value_HeadingX][tank];
+		TFloat32 headingZ = m_Values[Value_HeadingZ][tank];
+		if (headingZ > -0.9999f)
+		{
+			transform.quat = CQuaternion( 1.0f + headingZ, 0.0f, headingX, 0.0f );
+			transform.quat.Normalise();
+		}
+		else
+		{
+			transform.quat = CQuaternion( 0.0f, 0.0f, 1.0f, 0.0f ); // Facing directly backwards
+		}
+
+		// The turret node may have its own rotation from the mesh, so is turned rather than set
+		if (m_Values[Value_TurretTurn][tank] != 0.0f)
+		{
+			tankEntity->Transform( 2 ).RotateY( m_Values[Value_TurretTurn][tank] );
+		}
+		tankEntity->SetSpeed( m_Values[Value_Speed][tank] );
+	}
+}
+
+
+} // namespace gen
@@ -0,0 +1,199 @@
+/*******************************************
+	Kinematics.h
+
+	Tank movement state in arrays, integrated
+	for all tanks in one SSE loop
+********************************************/
+
+#pragma once
+
+#include <vector>
+using namespace std;
+
+#include "Defines.h"
+#include "CVector3.h"
+#include "Entity.h"
+
+namespace gen
+{
+
+// Forward declaration of classes, where includes are only possible/necessary in the .cpp file
+class CEntityManager;
+
+
+/*-----------------------------------------------------------------------------------------
+-------------------------------------------------------------------------------------------
+	Kinematics Class
+-------------------------------------------------------------------------------------------
+-----------------------------------------------------------------------------------------*/
+
+// Holds the movement state of every tank - heading, speed and turret yaw - in separate arrays
+// for each value (structure of arrays), with the limits from each tank's template. Tank AI only
+// writes the movement it wants (CTankEntity::GetDesiredHeading, GetDesiredSpeed and
+// GetDesiredTurretTurnRate). Each tick, after the AI:
+//  - ReadTanks copies the positions and wanted movement of all tanks into the arrays
+//  - Other passes may adjust the wanted movement (e.g. CSteering adds separation)
+//  - Integrate turns, accelerates and moves all tanks within their template's TurnSpeed and
+//    Acceleration and the tank's maximum turret turn rate (all per second, the turret rate is the
+//    template's TurretTurnSpeed plus a boost used when aiming). It works on four tanks at a time
+//    in SSE registers with no branches, so costs little more than a copy of the arrays
+//  - Other passes may correct the new positions (e.g. CCollisionSystem resolves collisions)
+//  - WriteTanks sets the tank transforms and speeds from the results
+//
+// Each tank is moved by its own step time (CTankEntity::GetMoveTime). Tanks with a lower AI level
+// of detail step only every few ticks, by the time built up since their last step, and keep still
+// between - a zero step time leaves a tank unchanged.
+//
+// Heading, speed and turret yaw are kept between ticks. Positions are read from the tanks each
+// tick so other code may still place a tank (e.g. when picked up with the mouse). Arrays are
+// padded to a multiple of four with stationary tanks. Dead tanks are not written back
+class CKinematics
+{
+/////////////////////////////////////
+//	Constructors/Destructors
+public:
+	// Constructor creates an empty set of tanks
+	CKinematics()
+	{
+		m_NumTanks = 0;
+	}
+
+private:
+	// Prevent use of copy constructor and assignment operator (private and not defined)
+	CKinematics( const CKinematics& );
+	CKinematics& operator=( const CKinematics& );
+
+
+/////////////////////////////////////
+//	Public interface
+public:
+
+	/////////////////////////////////////
+	// Tanks
+
+	// Add a tank facing the given direction (only x and z are used)
+	void AddTank( TEntityUID UID, const CVector3& facing );
+
+	// Remove a tank. Does nothing if the tank is not present
+	void RemoveTank( TEntityUID UID );
+
+	TUInt32 NumTanks() const
+	{
+		return m_NumTanks;
+	}
+
+	TEntityUID GetUID( TUInt32 tank ) const
+	{
+		return m_UIDs[tank];
+	}
+
+	// Return false for tanks whose results are not written back (dead)
+	bool CanMove( TUInt32 tank ) const
+	{
+		return m_Moves[tank] != 0;
+	}
+
+
+	/////////////////////////////////////
+	// Update
+
+	// Read the position, wanted movement, step time and limits of each tank
+	void ReadTanks( CEntityManager& entityManager );
+
+	// Turn, accelerate and move all tanks, each over its step time
+	void Integrate();
+
+	// Set the transforms and speeds of all living tanks from the results
+	void WriteTanks( CEntityManager& entityManager );
+
+
+	/////////////////////////////////////
+	// Array access for other movement passes, NumTanks elements in each
+
+	// Positions and headings (XZ plane, unit length). Positions may be adjusted after integration
+	// (e.g. CCollisionSystem pushes colliding tanks apart)
+	const TFloat32* PosX() const
+	{
+		return m_Values[Value_PosX].data();
+	}
+
+	const TFloat32* PosZ() const
+	{
+		return m_Values[Value_PosZ].data();
+	}
+
+	TFloat32* PosX()
+	{
+		return m_Values[Value_PosX].data();
+	}
+
+	TFloat32* PosZ()
+	{
+		return m_Values[Value_PosZ].data();
+	}
+
+	const TFloat32* HeadingX() const
+	{
+		return m_Values[Value_HeadingX].data();
+	}
+
+	const TFloat32* HeadingZ() const
+	{
+		return m_Values[Value_HeadingZ].data();
+	}
+
+	// Wanted heading (need not be normalised, zero to keep the current heading) and speed
+	TFloat32* DesiredX()
+	{
+		return m_Values[Value_DesiredX].data();
+	}
+
+	TFloat32* DesiredZ()
+	{
+		return m_Values[Value_DesiredZ].data();
+	}
+
+	TFloat32* DesiredSpeed()
+	{
+		return m_Values[Value_DesiredSpeed].data();
+	}
+
+
+/////////////////////////////////////
+//	Private interface
+private:
+
+	// Values held for each tank, each in its own array
+	enum EValue
+	{
+		Value_PosX,
+		Value_PosZ,
+		Value_HeadingX,
+		Value_HeadingZ,
+		Value_Speed,
+		Value_DesiredX,
+		Value_DesiredZ,
+		Value_DesiredSpeed,
+		Value_TurnSpeed,        // Limits from the template, per second
+		Value_Acceleration,
+		Value_TurretTurnSpeed,
+		Value_TurretTurnRate,   // Wanted turret turn rate, per second
+		Value_TurretYaw,        // Turret yaw relative to its starting direction
+		Value_TurretTurn,       // Turret rotation this update
+		Value_StepTime,         // Time to move the tank by this update, 0 between level of detail steps
+		Value_Count
+	};
+
+	// Set a tank's values to those of a stationary tank facing along Z
+	void ResetTank( TUInt32 tank );
+
+
+	// Tanks in the arrays, and value arrays padded to a multiple of 4
+	vector<TEntityUID> m_UIDs;
+	vector<TUInt8>     m_Moves; // 0 for dead tanks, which are not written back
+	vector<TFloat32>   m_Values[Value_Count];
+	TUInt32            m_NumTanks;
+};
+
+
+} // namespace gen
@@ -25,6 +25,7 @@ void CMessenger::SendMessage( TEntityUID to, const SMessage& msg )
 	// Simply insert the UID/message pair into the message map. It will be inserted next
 	// to any other pairs with the same UID
 	m_Messages.insert( UIDMsgPair( to, msg ) );
+	m_Recipients.push_back( to );
 }
 
 
@@ -49,5 +50,44 @@ bool CMessenger::FetchMessage( TEntityUID to, SMessage* msg )
 }
 
 
+// Move all messages for the given UID into a mailbox, after any it has not yet fetched
+void CMessenger::FetchMessages( TEntityUID to, CMailbox* pMailbox )
+{
+	// Remove the messages fetched from the mailbox last time
+	pMailbox->m_Received.erase( pMailbox->m_Received.begin(),
+	                            pMailbox->m_Received.begin() + pMailbox->m_NextReceived );
+	pMailbox->m_NextReceived = 0;
+
+	// Messages for a UID are together in the multimap, in the order they were sent
+	pair<TMessageIter, TMessageIter> messages = m_Messages.equal_range( to );
+	for (TMessageIter itMessage = messages.first; itMessage != messages.second; ++itMessage)
+	{
+		pMailbox->m_Received.push_back( itMessage->second );
+	}
+	m_Messages.erase( messages.first, messages.second );
+}
+
+// Send all the messages sent to a mailbox, in the order they were sent, and clear them
+void CMessenger::SendMessages( CMailbox* pMailbox )
+{
+	for (TUInt32 message = 0; message < pMailbox->m_Sent.size(); ++message)
+	{
+		SendMessage( pMailbox->m_SendTo[message], pMailbox->m_Sent[message] );
+	}
+	pMailbox->m_SendTo.clear();
+	pMailbox->m_Sent.clear();
+}
+
+
+// Move the UIDs sent messages since the last call into the given list (which is cleared
+// first). Used to wake sleeping entities that have been sent messages. A UID may appear more
+// than once
+void CMessenger::TakeRecipients( vector<TEntityUID>* pRecipients )
+{
+	pRecipients->clear();
+	pRecipients->swap( m_Recipients );
+}
+
+
 
 } // namespace gen
@@ -7,6 +7,7 @@
 #pragma once
 
 #include <map>
+#include <vector>
 using namespace std;
 
 #include "Defines.h"
@@ -25,7 +26,6 @@ enum EMessageType
 	Msg_Stop, // Stop all action
 	Msg_Start,// Start the game
 	Msg_Evade,// Move into the evade state with a new target
-	Msg_Help, // Help the friendly tank if appropriate
 	Msg_Collected // Collected an ammo crate (destroy ammo entity)
 };
 
@@ -55,6 +55,65 @@ struct SMessage
 };
 
 
+// Messages received and sent by one entity while entities are updated in parallel. Received
+// messages are fetched from the messenger before the update and sent messages are passed to it
+// when the update is committed, so the update itself never touches the shared messenger
+class CMailbox
+{
+/////////////////////////////////////
+//	Constructors/Destructors
+public:
+	CMailbox()
+	{
+		m_NextReceived = 0;
+	}
+
+private:
+	// Disallow use of copy constructor and assignment operator (private and not defined)
+	CMailbox( const CMailbox& );
+	CMailbox& operator=( const CMailbox& );
+
+
+/////////////////////////////////////
+//	Public interface
+public:
+
+	// Fetch the next message received, returns false if there are none left. Messages not
+	// fetched are kept for the next update
+	bool FetchMessage( SMessage* msg )
+	{
+		if (m_NextReceived == m_Received.size())
+		{
+			return false;
+		}
+		*msg = m_Received[m_NextReceived++];
+		return true;
+	}
+
+	// Send a message to a particular UID, it is passed to the messenger when the update is
+	// committed
+	void SendMessage( TEntityUID to, const SMessage& msg )
+	{
+		m_SendTo.push_back( to );
+		m_Sent.push_back( msg );
+	}
+
+
+/////////////////////////////////////
+//	Private interface
+private:
+	friend class CMessenger;
+
+	// Messages received, the first m_NextReceived have been fetched
+	vector<SMessage> m_Received;
+	TUInt32          m_NextReceived;
+
+	// Messages sent and who to
+	vector<TEntityUID> m_SendTo;
+	vector<SMessage>   m_Sent;
+};
+
+
 // Messenger class allows the sending and receipt of messages between entities - addressed by UID
 class CMessenger
 {
@@ -86,6 +145,24 @@ public:
 	// pointer. Returns false if there are no messages for this UID
 	bool FetchMessage( TEntityUID to, SMessage* msg );
 
+	// Move all messages for the given UID into a mailbox, after any it has not yet fetched
+	void FetchMessages( TEntityUID to, CMailbox* pMailbox );
+
+	// Send all the messages sent to a mailbox, in the order they were sent, and clear them
+	void SendMessages( CMailbox* pMailbox );
+
+	// Move the UIDs sent messages since the last call into the given list (which is cleared
+	// first). Used to wake sleeping entities that have been sent messages. A UID may appear
+	// more than once
+	void TakeRecipients( vector<TEntityUID>* pRecipients );
+
+	// Discard all messages, e.g. when all entities are destroyed
+	void Clear()
+	{
+		m_Messages.clear();
+		m_Recipients.clear();
+	}
+
 
 /////////////////////////////////////
 //	Private interface
@@ -101,6 +178,9 @@ private:
     typedef pair<TEntityUID, SMessage> UIDMsgPair; // The type stored by the multimap
 
 	TMessages m_Messages;
+
+	// UIDs sent messages since the last call to TakeRecipients
+	vector<TEntityUID> m_Recipients;
 };
 
 
@@ -0,0 +1,916 @@
+/*******************************************
+	NavGrid.cpp
+
+	Navigation grid baked from static
+	obstacles, with cached A* path finding
+	and shared flow fields
+********************************************/
+
+#include <functional>
+#include <algorithm>
+
+#include "NavGrid.h"
+#include "ObstacleBVH.h"
+
+namespace gen
+{
+
+// Neighbour offsets and costs (in cells), orthogonal first then diagonal. The opposite of each
+// neighbour is the offset back to the original cell
+const TFloat32 kDiagonalCost = 1.41421356f;
+const TInt32 kNeighbourX[8] = { 1, -1, 0, 0, 1, -1, 1, -1 };
+const TInt32 kNeighbourZ[8] = { 0, 0, 1, -1, 1, 1, -1, -1 };
+const TFloat32 kNeighbourCost[8] =
+	{ 1.0f, 1.0f, 1.0f, 1.0f, kDiagonalCost, kDiagonalCost, kDiagonalCost, kDiagonalCost };
+const TUInt8 kOppositeNeighbour[8] = { 1, 0, 3, 2, 7, 6, 5, 4 };
+
+// Flow field values for the goal cell and cells with no route to the goal
+const TUInt8 kFlowGoal = 8;
+const TUInt8 kFlowNone = 0xff;
+const TFloat32 kFlowUnreachable = 1e30f;
+
+
+/*-----------------------------------------------------------------------------------------
+	Construction
+-----------------------------------------------------------------------------------------*/
+
+// Constructor creates an empty grid
+CNavGrid::CNavGrid()
+{
+	m_Origin = CVector3::kOrigin;
+	m_Width = 0;
+	m_Height = 0;
+	m_CellSize = 1.0f;
+	m_AgentRadius = 0.0f;
+	m_SearchNumber = 0;
+	m_SearchInProgress = false;
+	m_SearchKey = 0;
+	m_SearchLastFrame = 0;
+	m_SearchBudget = 20000;
+	m_FrameNumber = 0;
+	m_FrameCellsVisited = 0;
+	m_FrameSearches = 0;
+	m_FrameCacheHits = 0;
+	m_FrameFlowFieldBuilds = 0;
+	m_ReadOnly = false;
+}
+
+
+/*-----------------------------------------------------------------------------------------
+	Building
+-----------------------------------------------------------------------------------------*/
+
+// Build the grid over the area between two points (only x and z are used) from the bounds of
+// the given obstacles, which are expanded by the agent radius
+void CNavGrid::Build( const CObstacleBVH& obstacles, const CVector3& minPt, const CVector3& maxPt,
+                      TFloat32 cellSize, TFloat32 agentRadius )
+{
+	Clear();
+
+	m_Origin = CVector3( minPt.x, 0.0f, minPt.z );
+	m_CellSize = cellSize;
+	m_AgentRadius = agentRadius;
+	m_Width = static_cast<TInt32>(Ceil( (maxPt.x - minPt.x) / cellSize ));
+	m_Height = static_cast<TInt32>(Ceil( (maxPt.z - minPt.z) / cellSize ));
+	TUInt32 numCells = m_Width * m_Height;
+
+	m_Blocked.resize( numCells );
+	m_Cost.resize( numCells );
+	m_Previous.resize( numCells );
+	m_VisitedSearch.resize( numCells, 0 );
+	m_ClosedSearch.resize( numCells, 0 );
+
+	for (TUInt32 obstacle = 0; obstacle < obstacles.NumObstacles(); ++obstacle)
+	{
+		m_Obstacles.push_back( obstacles.GetObstacleFootprint( obstacle ) );
+	}
+	RasteriseRegion( 0, 0, m_Width - 1, m_Height - 1 );
+}
+
+// Remove the grid and all cached paths
+void CNavGrid::Clear()
+{
+	m_Width = 0;
+	m_Height = 0;
+	m_Blocked.clear();
+	m_Obstacles.clear();
+	m_Cost.clear();
+	m_Previous.clear();
+	m_VisitedSearch.clear();
+	m_ClosedSearch.clear();
+	m_SearchNumber = 0;
+	CancelSearch();
+	m_PathCache.clear();
+	m_FlowFields.clear();
+}
+
+
+/*-----------------------------------------------------------------------------------------
+	Obstacle changes
+-----------------------------------------------------------------------------------------*/
+
+// Add an obstacle with the given world bounds
+void CNavGrid::AddObstacle( const SAABB& bounds )
+{
+	m_Obstacles.push_back( bounds );
+	UpdateObstacleRegion( bounds );
+}
+
+// Remove an obstacle with the given world bounds. Returns false if there is no such obstacle
+bool CNavGrid::RemoveObstacle( const SAABB& bounds )
+{
+	for (TUInt32 obstacle = 0; obstacle < m_Obstacles.size(); ++obstacle)
+	{
+		if (m_Obstacles[obstacle].minPt == bounds.minPt && m_Obstacles[obstacle].maxPt == bounds.maxPt)
+		{
+			m_Obstacles[obstacle] = m_Obstacles.back();
+			m_Obstacles.pop_back();
+			UpdateObstacleRegion( bounds );
+			return true;
+		}
+	}
+	return false;
+}
+
+// Update the cells covered by an obstacle, remove cached paths through them and repair flow
+// fields
+void CNavGrid::UpdateObstacleRegion( const SAABB& bounds )
+{
+	TInt32 minX, minZ, maxX, maxZ;
+	if (!CellRange( bounds, &minX, &minZ, &maxX, &maxZ ))
+	{
+		return;
+	}
+	RasteriseRegion( minX, minZ, maxX, maxZ );
+	CancelSearch();
+
+	// Diagonal moves past the corners of changed cells are also affected, so routes through the
+	// cells around the region must be updated too
+	minX = Max( minX - 1, 0 );
+	minZ = Max( minZ - 1, 0 );
+	maxX = Min( maxX + 1, m_Width - 1 );
+	maxZ = Min( maxZ + 1, m_Height - 1 );
+
+	// Remove cached paths whose cell range overlaps the region
+	map<TUInt64, SCachedPath>::iterator path = m_PathCache.begin();
+	while (path != m_PathCache.end())
+	{
+		const SCachedPath& cached = path->second;
+		if (cached.minX <= maxX && cached.maxX >= minX && cached.minZ <= maxZ && cached.maxZ >= minZ)
+		{
+			path = m_PathCache.erase( path );
+		}
+		else
+		{
+			++path;
+		}
+	}
+	RepairFlowFields( minX, minZ, maxX, maxZ );
+}
+
+
+/*-----------------------------------------------------------------------------------------
+	Cells
+-----------------------------------------------------------------------------------------*/
+
+// Get the cell containing a point. Returns false if the point is off the grid
+bool CNavGrid::CellFromPoint( const CVector3& point, TInt32* pX, TInt32* pZ ) const
+{
+	TInt32 x = static_cast<TInt32>(Floor( (point.x - m_Origin.x) / m_CellSize ));
+	TInt32 z = static_cast<TInt32>(Floor( (point.z - m_Origin.z) / m_CellSize ));
+	if (x < 0 || z < 0 || x >= m_Width || z >= m_Height)
+	{
+		return false;
+	}
+	*pX = x;
+	*pZ = z;
+	return true;
+}
+
+// Centre of a cell at the given height
+CVector3 CNavGrid::CellCentre( TInt32 x, TInt32 z, TFloat32 y ) const
+{
+	return CVector3( m_Origin.x + (x + 0.5f) * m_CellSize, y, m_Origin.z + (z + 0.5f) * m_CellSize );
+}
+
+// Return true if a point is on the grid and not blocked
+bool CNavGrid::IsWalkable( const CVector3& point ) const
+{
+	TInt32 x, z;
+	return CellFromPoint( point, &x, &z ) && !IsBlocked( x, z );
+}
+
+// Get the range of cells covered by world bounds expanded by the agent radius, clamped to the
+// grid. Returns false if the bounds are entirely off the grid
+bool CNavGrid::CellRange( const SAABB& bounds, TInt32* pMinX, TInt32* pMinZ,
+                          TInt32* pMaxX, TInt32* pMaxZ ) const
+{
+	TInt32 minX = static_cast<TInt32>(Floor( (bounds.minPt.x - m_AgentRadius - m_Origin.x) / m_CellSize ));
+	TInt32 minZ = static_cast<TInt32>(Floor( (bounds.minPt.z - m_AgentRadius - m_Origin.z) / m_CellSize ));
+	TInt32 maxX = static_cast<TInt32>(Floor( (bounds.maxPt.x + m_AgentRadius - m_Origin.x) / m_CellSize ));
+	TInt32 maxZ = static_cast<TInt32>(Floor( (bounds.maxPt.z + m_AgentRadius - m_Origin.z) / m_CellSize ));
+	if (maxX < 0 || maxZ < 0 || minX >= m_Width || minZ >= m_Height)
+	{
+		return false;
+	}
+	*pMinX = Max( minX, 0 );
+	*pMinZ = Max( minZ, 0 );
+	*pMaxX = Min( maxX, m_Width - 1 );
+	*pMaxZ = Min( maxZ, m_Height - 1 );
+	return true;
+}
+
+// Recalculate which cells are blocked within a range of cells
+void CNavGrid::RasteriseRegion( TInt32 minX, TInt32 minZ, TInt32 maxX, TInt32 maxZ )
+{
+	for (TInt32 z = minZ; z <= maxZ; ++z)
+	{
+		for (TInt32 x = minX; x <= maxX; ++x)
+		{
+			m_Blocked[z * m_Width + x] = 0;
+		}
+	}
+
+	// Block the part of each obstacle that overlaps the region
+	for (TUInt32 obstacle = 0; obstacle < m_Obstacles.size(); ++obstacle)
+	{
+		TInt32 obstacleMinX, obstacleMinZ, obstacleMaxX, obstacleMaxZ;
+		if (CellRange( m_Obstacles[obstacle], &obstacleMinX, &obstacleMinZ, &obstacleMaxX, &obstacleMaxZ ))
+		{
+			for (TInt32 z = Max( minZ, obstacleMinZ ); z <= Min( maxZ, obstacleMaxZ ); ++z)
+			{
+				for (TInt32 x = Max( minX, obstacleMinX ); x <= Min( maxX, obstacleMaxX ); ++x)
+				{
+					m_Blocked[z * m_Width + x] = 1;
+				}
+			}
+		}
+	}
+}
+
+// Find the nearest walkable cell to the given cell, updating the cell. Returns false if there
+// is none nearby
+bool CNavGrid::FindNearestFreeCell( TInt32* pX, TInt32* pZ ) const
+{
+	// Search rings of cells of increasing size around the cell
+	for (TInt32 ring = 1; ring <= kMaxFreeCellSearch; ++ring)
+	{
+		bool found = false;
+		TInt32 nearestX = 0, nearestZ = 0, nearestDistanceSquared = 0;
+		for (TInt32 dz = -ring; dz <= ring; ++dz)
+		{
+			for (TInt32 dx = -ring; dx <= ring; ++dx)
+			{
+				TInt32 x = *pX + dx;
+				TInt32 z = *pZ + dz;
+				bool onRing = (dx == -ring || dx == ring || dz == -ring || dz == ring);
+				if (onRing && x >= 0 && z >= 0 && x < m_Width && z < m_Height && !IsBlocked( x, z ))
+				{
+					TInt32 distanceSquared = dx * dx + dz * dz;
+					if (!found || distanceSquared < nearestDistanceSquared)
+					{
+						found = true;
+						nearestDistanceSquared = distanceSquared;
+						nearestX = x;
+						nearestZ = z;
+					}
+				}
+			}
+		}
+		if (found)
+		{
+			*pX = nearestX;
+			*pZ = nearestZ;
+			return true;
+		}
+	}
+	return false;
+}
+
+
+/*-----------------------------------------------------------------------------------------
+	Path finding
+-----------------------------------------------------------------------------------------*/
+
+// Start a new frame, resetting the search budget. Call once per frame before queries
+void CNavGrid::BeginFrame()
+{
+	++m_FrameNumber;
+	m_FrameCellsVisited = 0;
+	m_FrameSearches = 0;
+	m_FrameCacheHits = 0;
+	m_FrameFlowFieldBuilds = 0;
+}
+
+// Find a path from start to goal. The path is returned as a list of waypoints to drive
+// through in turn, not including the start but ending at the goal. If the goal is in a
+// blocked cell the path ends at the nearest walkable cell instead
+ENavResult CNavGrid::FindPath( const CVector3& start, const CVector3& goal, vector<CVector3>* pPath )
+{
+	pPath->clear();
+
+	// Agents may be slightly inside blocked cells (e.g. pushed by others), or have a goal inside
+	// an obstacle, so use the nearest walkable cells
+	TInt32 startX, startZ, goalX, goalZ;
+	if (!CellFromPoint( start, &startX, &startZ ) || !CellFromPoint( goal, &goalX, &goalZ ))
+	{
+		return Nav_NoPath;
+	}
+	if (IsBlocked( startX, startZ ) && !FindNearestFreeCell( &startX, &startZ ))
+	{
+		return Nav_NoPath;
+	}
+	bool goalBlocked = IsBlocked( goalX, goalZ );
+	if (goalBlocked && !FindNearestFreeCell( &goalX, &goalZ ))
+	{
+		return Nav_NoPath;
+	}
+
+	// Look in the cache first, otherwise search if there is budget left
+	TUInt64 key = (static_cast<TUInt64>(startZ * m_Width + startX) << 32) | (goalZ * m_Width + goalX);
+	map<TUInt64, SCachedPath>::iterator cached = m_PathCache.find( key );
+	if (cached != m_PathCache.end())
+	{
+		++m_FrameCacheHits;
+	}
+	else
+	{
+		if (m_ReadOnly || m_FrameCellsVisited >= m_SearchBudget)
+		{
+			return Nav_Deferred;
+		}
+
+		// A search that ran out of budget is only replaced once its query stops being made, so
+		// long searches are not restarted by other queries every frame and never finished
+		if (m_SearchInProgress && m_SearchKey != key && m_SearchLastFrame + kMaxSearchIdleFrames >= m_FrameNumber)
+		{
+			return Nav_Deferred;
+		}
+		++m_FrameSearches;
+
+		vector<TUInt32> cells;
+		ENavResult result = Search( startX, startZ, goalX, goalZ, &cells );
+		if (result != Nav_Found)
+		{
+			return result;
+		}
+		if (m_PathCache.size() >= kMaxCachedPaths)
+		{
+			m_PathCache.clear();
+		}
+		cached = m_PathCache.insert( make_pair( key, SCachedPath() ) ).first;
+		SmoothPath( cells, goal.y, &cached->second );
+	}
+
+	// Cached paths end at the goal cell centre, so replace with the actual goal if it is walkable
+	*pPath = cached->second.waypoints;
+	if (!goalBlocked)
+	{
+		pPath->back() = goal;
+	}
+	return Nav_Found;
+}
+
+// Get the point to drive towards from a given point to reach a goal, using the flow field for
+// the goal cell. The field is built if it is not already held, which uses the search budget.
+// The point is the centre of the next cell on the way, or the goal itself from the goal cell
+ENavResult CNavGrid::GetFlowTarget( const CVector3& point, const CVector3& goal, CVector3* pTarget )
+{
+	TInt32 x, z, goalX, goalZ;
+	if (!CellFromPoint( point, &x, &z ))
+	{
+		return Nav_NoPath;
+	}
+	SFlowField* field;
+	ENavResult result = GetGoalFlowField( goal, &field, &goalX, &goalZ );
+	if (result != Nav_Found)
+	{
+		return result;
+	}
+	bool goalBlocked = !IsWalkable( goal );
+
+	// An agent pushed into a blocked cell first heads for the nearest walkable one
+	if (IsBlocked( x, z ))
+	{
+		if (!FindNearestFreeCell( &x, &z ) || field->next[z * m_Width + x] == kFlowNone)
+		{
+			return Nav_NoPath;
+		}
+		*pTarget = CellCentre( x, z, goal.y );
+		return Nav_Found;
+	}
+
+	TUInt8 next = field->next[z * m_Width + x];
+	if (next == kFlowNone)
+	{
+		return Nav_NoPath;
+	}
+	if (next == kFlowGoal)
+	{
+		*pTarget = goalBlocked ? CellCentre( goalX, goalZ, goal.y ) : goal;
+	}
+	else
+	{
+		*pTarget = CellCentre( x + kNeighbourX[next], z + kNeighbourZ[next], goal.y );
+	}
+	return Nav_Found;
+}
+
+// Get the distance to drive from a given point to a goal, following the flow field for the goal
+// cell. The field is built if it is not already held, as GetFlowTarget. Returns Nav_NoPath if the
+// point is blocked or has no route to the goal
+ENavResult CNavGrid::GetFlowDistance( const CVector3& point, const CVector3& goal, TFloat32* pDistance )
+{
+	TInt32 x, z, goalX, goalZ;
+	if (!CellFromPoint( point, &x, &z ))
+	{
+		return Nav_NoPath;
+	}
+	SFlowField* field;
+	ENavResult result = GetGoalFlowField( goal, &field, &goalX, &goalZ );
+	if (result != Nav_Found)
+	{
+		return result;
+	}
+
+	TFloat32 cost = field->cost[z * m_Width + x];
+	if (cost >= kFlowUnreachable)
+	{
+		return Nav_NoPath;
+	}
+	*pDistance = cost * m_CellSize;
+	return Nav_Found;
+}
+
+// Keep the flow field for a goal, as if GetFlowTarget had been called. The field is built if it is
+// not already held, which uses the search budget
+void CNavGrid::UseFlowField( const CVector3& goal )
+{
+	CVector3 target;
+	GetFlowTarget( goal, goal, &target );
+}
+
+
+/*-----------------------------------------------------------------------------------------
+	Search
+-----------------------------------------------------------------------------------------*/
+
+// A* search between two walkable cells, continuing the search in progress if it is for the
+// same cells. Returns the cells on the path from start to goal (inclusive) and Nav_Found,
+// Nav_NoPath if there is no path, or Nav_Deferred if the search budget is used up first
+ENavResult CNavGrid::Search( TInt32 startX, TInt32 startZ, TInt32 goalX, TInt32 goalZ, vector<TUInt32>* pCells )
+{
+	TUInt32 startCell = startZ * m_Width + startX;
+	TUInt32 goalCell = goalZ * m_Width + goalX;
+	TUInt64 key = (static_cast<TUInt64>(startCell) << 32) | goalCell;
+
+	// Open list holds cells to visit ordered by estimated total cost (lowest first). A cell may
+	// be in the list more than once if a cheaper route is found, later copies are skipped. The
+	// list and the search number are kept between frames so the search can be continued
+	vector<TOpenCell>& open = m_SearchOpen;
+	if (!m_SearchInProgress || m_SearchKey != key)
+	{
+		++m_SearchNumber;
+		m_SearchInProgress = true;
+		m_SearchKey = key;
+		open.clear();
+		m_Cost[startCell] = 0.0f;
+		m_VisitedSearch[startCell] = m_SearchNumber;
+		open.push_back( TOpenCell( 0.0f, startCell ) );
+	}
+	m_SearchLastFrame = m_FrameNumber;
+
+	bool found = false;
+	while (!open.empty())
+	{
+		if (m_FrameCellsVisited >= m_SearchBudget)
+		{
+			return Nav_Deferred;
+		}
+
+		TUInt32 cell = open.front().second;
+		pop_heap( open.begin(), open.end(), greater<TOpenCell>() );
+		open.pop_back();
+		if (m_ClosedSearch[cell] == m_SearchNumber)
+		{
+			continue;
+		}
+		m_ClosedSearch[cell] = m_SearchNumber;
+		++m_FrameCellsVisited;
+		if (cell == goalCell)
+		{
+			found = true;
+			break;
+		}
+
+		TInt32 x = cell % m_Width;
+		TInt32 z = cell / m_Width;
+		for (TUInt32 neighbour = 0; neighbour < 8; ++neighbour)
+		{
+			TInt32 nx = x + kNeighbourX[neighbour];
+			TInt32 nz = z + kNeighbourZ[neighbour];
+			if (nx < 0 || nz < 0 || nx >= m_Width || nz >= m_Height || IsBlocked( nx, nz ))
+			{
+				continue;
+			}
+
+			// Diagonal moves must not cut the corner of a blocked cell
+			if (neighbour >= 4 && (IsBlocked( nx, z ) || IsBlocked( x, nz )))
+			{
+				continue;
+			}
+
+			TUInt32 neighbourCell = nz * m_Width + nx;
+			TFloat32 cost = m_Cost[cell] + kNeighbourCost[neighbour];
+			if (m_VisitedSearch[neighbourCell] != m_SearchNumber || cost < m_Cost[neighbourCell])
+			{
+				m_VisitedSearch[neighbourCell] = m_SearchNumber;
+				m_Cost[neighbourCell] = cost;
+				m_Previous[neighbourCell] = cell;
+
+				// Octile distance to goal - exact on an open 8-neighbour grid, so never overestimates
+				TFloat32 dx = static_cast<TFloat32>(Abs( goalX - nx ));
+				TFloat32 dz = static_cast<TFloat32>(Abs( goalZ - nz ));
+				TFloat32 estimate = Max( dx, dz ) + (kDiagonalCost - 1.0f) * Min( dx, dz );
+				open.push_back( TOpenCell( cost + estimate, neighbourCell ) );
+				push_heap( open.begin(), open.end(), greater<TOpenCell>() );
+			}
+		}
+	}
+	CancelSearch();
+	if (!found)
+	{
+		return Nav_NoPath;
+	}
+
+	// Follow previous cells back from the goal
+	pCells->clear();
+	for (TUInt32 cell = goalCell; cell != startCell; cell = m_Previous[cell])
+	{
+		pCells->push_back( cell );
+	}
+	pCells->push_back( startCell );
+	reverse( pCells->begin(), pCells->end() );
+	return Nav_Found;
+}
+
+// Reduce a path of cells to the waypoints needed to drive it in straight lines
+void CNavGrid::SmoothPath( const vector<TUInt32>& cells, TFloat32 y, SCachedPath* pPath ) const
+{
+	pPath->waypoints.clear();
+	pPath->minX = pPath->maxX = cells[0] % m_Width;
+	pPath->minZ = pPath->maxZ = cells[0] / m_Width;
+
+	// From each waypoint, go as far along the path as possible in a straight line
+	CVector3 waypoint = CellCentre( cells[0] % m_Width, cells[0] / m_Width, y );
+	for (TUInt32 cell = 1; cell < cells.size(); ++cell)
+	{
+		TInt32 x = cells[cell] % m_Width;
+		TInt32 z = cells[cell] / m_Width;
+		pPath->minX = Min( pPath->minX, x );
+		pPath->minZ = Min( pPath->minZ, z );
+		pPath->maxX = Max( pPath->maxX, x );
+		pPath->maxZ = Max( pPath->maxZ, z );
+
+		if (!IsLineClear( waypoint, CellCentre( x, z, y ) ))
+		{
+			TUInt32 previous = cells[cell - 1];
+			waypoint = CellCentre( previous % m_Width, previous / m_Width, y );
+			pPath->waypoints.push_back( waypoint );
+		}
+	}
+	TUInt32 goal = cells.back();
+	pPath->waypoints.push_back( CellCentre( goal % m_Width, goal / m_Width, y ) );
+}
+
+// Return true if the straight line between two points only crosses walkable cells
+bool CNavGrid::IsLineClear( const CVector3& start, const CVector3& end ) const
+{
+	TInt32 x, z, endX, endZ;
+	if (!CellFromPoint( start, &x, &z ) || !CellFromPoint( end, &endX, &endZ ))
+	{
+		return false;
+	}
+
+	// Visit each cell the line passes through in turn (Amanatides & Woo). tMax is the distance
+	// along the line (0 to 1) to the next cell boundary in each axis, tDelta the distance
+	// between boundaries
+	TFloat32 dx = end.x - start.x;
+	TFloat32 dz = end.z - start.z;
+	TInt32 stepX = (dx > 0.0f) ? 1 : -1;
+	TInt32 stepZ = (dz > 0.0f) ? 1 : -1;
+	TFloat32 tMaxX = 1e30f, tDeltaX = 1e30f;
+	TFloat32 tMaxZ = 1e30f, tDeltaZ = 1e30f;
+	if (dx != 0.0f)
+	{
+		TFloat32 boundaryX = m_Origin.x + (x + (stepX > 0 ? 1 : 0)) * m_CellSize;
+		tMaxX = (boundaryX - start.x) / dx;
+		tDeltaX = m_CellSize / Abs( dx );
+	}
+	if (dz != 0.0f)
+	{
+		TFloat32 boundaryZ = m_Origin.z + (z + (stepZ > 0 ? 1 : 0)) * m_CellSize;
+		tMaxZ = (boundaryZ - start.z) / dz;
+		tDeltaZ = m_CellSize / Abs( dz );
+	}
+
+	while (true)
+	{
+		if (IsBlocked( x, z ))
+		{
+			return false;
+		}
+		if ((x == endX && z == endZ) || Min( tMaxX, tMaxZ ) > 1.0f)
+		{
+			return true;
+		}
+
+		// Lines between cell centres often pass through cell corners, allow for rounding there
+		const TFloat32 kCornerTolerance = 1e-5f;
+		if (tMaxX < tMaxZ - kCornerTolerance)
+		{
+			x += stepX;
+			tMaxX += tDeltaX;
+		}
+		else if (tMaxZ < tMaxX - kCornerTolerance)
+		{
+			z += stepZ;
+			tMaxZ += tDeltaZ;
+		}
+		else
+		{
+			// Line passes through a corner, so must not be blocked on either side
+			if (IsBlocked( x + stepX, z ) || IsBlocked( x, z + stepZ ))
+			{
+				return false;
+			}
+			x += stepX;
+			z += stepZ;
+			tMaxX += tDeltaX;
+			tMaxZ += tDeltaZ;
+		}
+	}
+}
+
+
+
+/*-----------------------------------------------------------------------------------------
+	Flow fields
+-----------------------------------------------------------------------------------------*/
+
+// Get the flow field for a goal cell, building it if necessary (replacing the least recently
+// used field if there are too many) or continuing to build it. Returns 0 if the field is not
+// complete when the search budget is used up
+CNavGrid::SFlowField* CNavGrid::GetFlowField( TUInt32 goalCell )
+{
+	SFlowField* pField = 0;
+	TUInt32 oldest = 0;
+	for (TUInt32 field = 0; field < m_FlowFields.size() && !pField; ++field)
+	{
+		if (m_FlowFields[field].goalCell == goalCell)
+		{
+			pField = &m_FlowFields[field];
+		}
+		else if (m_FlowFields[field].lastUsedFrame < m_FlowFields[oldest].lastUsedFrame)
+		{
+			oldest = field;
+		}
+	}
+
+	if (pField)
+	{
+		// Read only queries don't mark the field as used or continue building it, UseFlowField
+		// is called for them
+		if (pField->open.empty())
+		{
+			if (!m_ReadOnly)
+			{
+				pField->lastUsedFrame = m_FrameNumber;
+			}
+			return pField;
+		}
+		if (m_ReadOnly)
+		{
+			return 0;
+		}
+		pField->lastUsedFrame = m_FrameNumber;
+	}
+	else
+	{
+		if (m_ReadOnly || m_FrameCellsVisited >= m_SearchBudget)
+		{
+			return 0;
+		}
+		++m_FrameFlowFieldBuilds;
+
+		// Reuse the least recently used field's memory if there are too many
+		if (m_FlowFields.size() < kMaxFlowFields)
+		{
+			oldest = static_cast<TUInt32>(m_FlowFields.size());
+			m_FlowFields.push_back( SFlowField() );
+		}
+		pField = &m_FlowFields[oldest];
+		pField->goalCell = goalCell;
+		pField->lastUsedFrame = m_FrameNumber;
+		pField->cost.assign( m_Width * m_Height, kFlowUnreachable );
+		pField->next.assign( m_Width * m_Height, kFlowNone );
+		pField->open.clear();
+
+		// Costs spread outwards from the goal to the whole grid
+		pField->cost[goalCell] = 0.0f;
+		pField->next[goalCell] = kFlowGoal;
+		SeedFlowField( pField, vector<TUInt32>( 1, goalCell ) );
+	}
+
+	return PropagateFlowField( pField, true ) ? pField : 0;
+}
+
+// Get the complete flow field for a goal point, whose cell is returned. If the goal is blocked the
+// nearest walkable cell is used. Returns Nav_NoPath if there is no such cell or Nav_Deferred if
+// the field is not complete
+ENavResult CNavGrid::GetGoalFlowField( const CVector3& goal, SFlowField** ppField, TInt32* pGoalX, TInt32* pGoalZ )
+{
+	if (!CellFromPoint( goal, pGoalX, pGoalZ ))
+	{
+		return Nav_NoPath;
+	}
+	if (IsBlocked( *pGoalX, *pGoalZ ) && !FindNearestFreeCell( pGoalX, pGoalZ ))
+	{
+		return Nav_NoPath;
+	}
+	*ppField = GetFlowField( *pGoalZ * m_Width + *pGoalX );
+	return *ppField ? Nav_Found : Nav_Deferred;
+}
+
+// Add cells to a field's open list to spread costs outwards from
+void CNavGrid::SeedFlowField( SFlowField* pField, const vector<TUInt32>& seeds )
+{
+	for (TUInt32 seed = 0; seed < seeds.size(); ++seed)
+	{
+		pField->open.push_back( TOpenCell( pField->cost[seeds[seed]], seeds[seed] ) );
+		push_heap( pField->open.begin(), pField->open.end(), greater<TOpenCell>() );
+	}
+}
+
+// Spread costs to the goal outwards from the cells in the open list, updating every cell that
+// can reach the goal more cheaply than its current cost. If budgeted, stops when the search
+// budget is used up. Returns true if the field is complete
+bool CNavGrid::PropagateFlowField( SFlowField* pField, bool budgeted )
+{
+	// Dijkstra's algorithm, as A* but with no goal to estimate the distance to. As in Search, a
+	// cell may be in the open list more than once, copies with a higher cost than the cell's
+	// current cost are skipped. The open list is kept in the field so the search can be resumed
+	vector<TOpenCell>& open = pField->open;
+	while (!open.empty())
+	{
+		if (budgeted && m_FrameCellsVisited >= m_SearchBudget)
+		{
+			return false;
+		}
+
+		TFloat32 cellCost = open.front().first;
+		TUInt32 cell = open.front().second;
+		pop_heap( open.begin(), open.end(), greater<TOpenCell>() );
+		open.pop_back();
+		if (cellCost > pField->cost[cell])
+		{
+			continue;
+		}
+		++m_FrameCellsVisited;
+
+		TInt32 x = cell % m_Width;
+		TInt32 z = cell / m_Width;
+		for (TUInt32 neighbour = 0; neighbour < 8; ++neighbour)
+		{
+			TInt32 nx = x + kNeighbourX[neighbour];
+			TInt32 nz = z + kNeighbourZ[neighbour];
+			if (nx < 0 || nz < 0 || nx >= m_Width || nz >= m_Height || IsBlocked( nx, nz ))
+			{
+				continue;
+			}
+			if (neighbour >= 4 && (IsBlocked( nx, z ) || IsBlocked( x, nz )))
+			{
+				continue;
+			}
+
+			// The neighbour moves back towards this cell on its way to the goal
+			TUInt32 neighbourCell = nz * m_Width + nx;
+			TFloat32 cost = cellCost + kNeighbourCost[neighbour];
+			if (cost < pField->cost[neighbourCell])
+			{
+				pField->cost[neighbourCell] = cost;
+				pField->next[neighbourCell] = kOppositeNeighbour[neighbour];
+				open.push_back( TOpenCell( cost, neighbourCell ) );
+				push_heap( open.begin(), open.end(), greater<TOpenCell>() );
+			}
+		}
+	}
+
+	// Release the open list memory, held fields are usually complete
+	vector<TOpenCell>().swap( open );
+	return true;
+}
+
+// Update flow fields after the cells within a range have changed. Only cells whose route to
+// the goal passed through the range are recalculated
+void CNavGrid::RepairFlowFields( TInt32 minX, TInt32 minZ, TInt32 maxX, TInt32 maxZ )
+{
+	// Each cell is marked as unknown, affected by the change or unaffected
+	const TUInt8 kUnknown = 0, kAffected = 1, kUnaffected = 2;
+	TUInt32 numCells = m_Width * m_Height;
+	vector<TUInt8> state;
+	vector<TUInt32> route;
+	vector<TUInt32> seeds;
+
+	TUInt32 field = 0;
+	while (field < m_FlowFields.size())
+	{
+		SFlowField& flowField = m_FlowFields[field];
+
+		// The goal may now be blocked, in which case the field is removed and a new one will be
+		// built for the nearest walkable cell when next needed. Fields still being built are also
+		// removed, they will be started again when next needed
+		TInt32 goalX = flowField.goalCell % m_Width;
+		TInt32 goalZ = flowField.goalCell / m_Width;
+		if ((goalX >= minX && goalX <= maxX && goalZ >= minZ && goalZ <= maxZ) || !flowField.open.empty())
+		{
+			m_FlowFields[field] = m_FlowFields.back();
+			m_FlowFields.pop_back();
+			continue;
+		}
+
+		// Follow the route from each cell towards the goal until reaching the changed range (the
+		// cell is affected), the goal or no route (unaffected), or a cell already marked. Every
+		// cell on the route is then marked the same, so each cell is followed only once
+		state.assign( numCells, kUnknown );
+		for (TUInt32 cell = 0; cell < numCells; ++cell)
+		{
+			route.clear();
+			TUInt32 routeCell = cell;
+			while (state[routeCell] == kUnknown)
+			{
+				TInt32 x = routeCell % m_Width;
+				TInt32 z = routeCell / m_Width;
+				TUInt8 next = flowField.next[routeCell];
+				if (x >= minX && x <= maxX && z >= minZ && z <= maxZ)
+				{
+					state[routeCell] = kAffected;
+				}
+				else if (next == kFlowGoal || next == kFlowNone)
+				{
+					state[routeCell] = kUnaffected;
+				}
+				else
+				{
+					route.push_back( routeCell );
+					routeCell = (z + kNeighbourZ[next]) * m_Width + x + kNeighbourX[next];
+				}
+			}
+			for (TUInt32 i = 0; i < route.size(); ++i)
+			{
+				state[route[i]] = state[routeCell];
+			}
+		}
+
+		// Clear affected cells, then spread costs into them from unaffected neighbours. Cells that
+		// could not reach the goal before may now be able to, and removed obstacles may give
+		// shorter routes for unaffected cells - propagation updates any cell it makes cheaper
+		for (TUInt32 cell = 0; cell < numCells; ++cell)
+		{
+			if (state[cell] == kAffected)
+			{
+				flowField.cost[cell] = kFlowUnreachable;
+				flowField.next[cell] = kFlowNone;
+			}
+		}
+		seeds.clear();
+		for (TUInt32 cell = 0; cell < numCells; ++cell)
+		{
+			if (state[cell] != kAffected || IsBlocked( cell % m_Width, cell / m_Width ))
+			{
+				continue;
+			}
+			TInt32 x = cell % m_Width;
+			TInt32 z = cell / m_Width;
+			for (TUInt32 neighbour = 0; neighbour < 8; ++neighbour)
+			{
+				TInt32 nx = x + kNeighbourX[neighbour];
+				TInt32 nz = z + kNeighbourZ[neighbour];
+				if (nx >= 0 && nz >= 0 && nx < m_Width && nz < m_Height)
+				{
+					TUInt32 neighbourCell = nz * m_Width + nx;
+					if (state[neighbourCell] == kUnaffected && flowField.next[neighbourCell] != kFlowNone)
+					{
+						seeds.push_back( neighbourCell );
+					}
+				}
+			}
+		}
+		SeedFlowField( &flowField, seeds );
+		PropagateFlowField( &flowField, false );
+		++field;
+	}
+}
+
+
+} // namespace gen
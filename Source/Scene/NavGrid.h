@@ -0,0 +1,366 @@
+/*******************************************
+	NavGrid.h
+
+	Navigation grid baked from static
+	obstacles, with cached A* path finding
+	and shared flow fields
+********************************************/
+
+#pragma once
+
+#include <vector>
+#include <map>
+#include <atomic>
+using namespace std;
+
+#include "Defines.h"
+#include "CVector3.h"
+#include "Geometry.h"
+
+namespace gen
+{
+
+// Forward declaration of classes, where includes are only possible/necessary in the .cpp file
+class CObstacleBVH;
+
+
+/////////////////////////////////////
+//	Public types
+
+// Result of a path query
+enum ENavResult
+{
+	Nav_Found,    // Path returned
+	Nav_NoPath,   // Start or goal are off the grid or there is no route between them
+	Nav_Deferred  // Search budget for this frame is used up, try again next frame
+};
+
+
+/*-----------------------------------------------------------------------------------------
+-------------------------------------------------------------------------------------------
+	Navigation Grid Class
+-------------------------------------------------------------------------------------------
+-----------------------------------------------------------------------------------------*/
+
+// Divides an area of the ground (XZ plane) into square cells, each either walkable or blocked
+// by an obstacle. Obstacle boxes are expanded by the radius of the agents using the grid, so an
+// agent whose centre stays in walkable cells doesn't hit obstacles
+//
+// Paths are found with A* over the cells (8 neighbours, no cutting corners of blocked cells)
+// then smoothed by removing waypoints that can be skipped in a straight line. Found paths are
+// cached by start and goal cell, and only paths crossing the area of a changed obstacle are
+// removed from the cache. Searches are limited by a budget of cells visited per frame - once the
+// budget is used, queries that are not in the cache are deferred to a later frame. A search that
+// runs out of budget part way is kept and continued when the same query is made again, so long
+// searches are spread over several frames rather than going over the budget
+//
+// For goals shared by many agents (e.g. an ammo crate or a rally point) a flow field can be used
+// instead. The field holds the direction to the goal from every cell, built once for the goal
+// cell then looked up by each agent. Building a field also uses the search budget, so a field for
+// a large grid is built over several frames and queries are deferred until it is complete. A few
+// recently used fields are kept, and they are repaired rather than rebuilt when obstacles change
+class CNavGrid
+{
+/////////////////////////////////////
+//	Constructors/Destructors
+public:
+	// Constructor creates an empty grid
+	CNavGrid();
+
+private:
+	// Prevent use of copy constructor and assignment operator (private and not defined)
+	CNavGrid( const CNavGrid& );
+	CNavGrid& operator=( const CNavGrid& );
+
+
+/////////////////////////////////////
+//	Public interface
+public:
+
+	/////////////////////////////////////
+	// Building
+
+	// Build the grid over the area between two points (only x and z are used) from the bounds of
+	// the given obstacles, which are expanded by the agent radius
+	void Build( const CObstacleBVH& obstacles, const CVector3& minPt, const CVector3& maxPt,
+	            TFloat32 cellSize, TFloat32 agentRadius );
+
+	// Remove the grid and all cached paths
+	void Clear();
+
+
+	/////////////////////////////////////
+	// Obstacle changes
+	// Only the cells covered by the obstacle are updated, and only cached paths that pass
+	// through those cells are removed
+
+	// Add an obstacle with the given world bounds
+	void AddObstacle( const SAABB& bounds );
+
+	// Remove an obstacle with the given world bounds. Returns false if there is no such obstacle
+	bool RemoveObstacle( const SAABB& bounds );
+
+
+	/////////////////////////////////////
+	// Path finding
+
+	// Start a new frame, resetting the search budget. Call once per frame before queries
+	void BeginFrame();
+
+	// While read only, queries may be made from several threads at once. They only use paths and
+	// flow fields already held and return Nav_Deferred for anything that would need a search, so
+	// the grid is not changed. Used while entities are updated in parallel
+	void SetReadOnly( bool readOnly )
+	{
+		m_ReadOnly = readOnly;
+	}
+
+	// Find a path from start to goal. The path is returned as a list of waypoints to drive
+	// through in turn, not including the start but ending at the goal. If the goal is in a
+	// blocked cell the path ends at the nearest walkable cell instead. Returns Nav_Deferred if
+	// the search budget runs out first, the search continues when the query is made again
+	ENavResult FindPath( const CVector3& start, const CVector3& goal, vector<CVector3>* pPath );
+
+	// Get the point to drive towards from a given point to reach a goal, using the flow field for
+	// the goal cell. The field is built if it is not already held, which uses the search budget
+	// and may take several frames. The point is the centre of the next cell on the way, or the
+	// goal itself from the goal cell
+	ENavResult GetFlowTarget( const CVector3& point, const CVector3& goal, CVector3* pTarget );
+
+	// Get the distance to drive from a given point to a goal, following the flow field for the
+	// goal cell. The field is built if it is not already held, as GetFlowTarget. Returns
+	// Nav_NoPath if the point is blocked or has no route to the goal
+	ENavResult GetFlowDistance( const CVector3& point, const CVector3& goal, TFloat32* pDistance );
+
+	// Keep the flow field for a goal, as if GetFlowTarget had been called. The field is built (or
+	// its building continued) if it is not already held, which uses the search budget
+	void UseFlowField( const CVector3& goal );
+
+	// Return true if a point is on the grid and not blocked
+	bool IsWalkable( const CVector3& point ) const;
+
+
+	/////////////////////////////////////
+	// Settings and statistics
+
+	// Maximum number of cells visited by searches each frame
+	TUInt32 GetSearchBudget() const
+	{
+		return m_SearchBudget;
+	}
+
+	void SetSearchBudget( TUInt32 budget )
+	{
+		m_SearchBudget = budget;
+	}
+
+	// Path queries this frame that were searched and that were found in the cache
+	TUInt32 NumFrameSearches() const
+	{
+		return m_FrameSearches;
+	}
+
+	TUInt32 NumFrameCacheHits() const
+	{
+		return m_FrameCacheHits;
+	}
+
+	// Cells visited by path searches and flow field builds this frame, at most the search budget
+	TUInt32 NumFrameCellsVisited() const
+	{
+		return m_FrameCellsVisited;
+	}
+
+	TUInt32 NumCachedPaths() const
+	{
+		return static_cast<TUInt32>(m_PathCache.size());
+	}
+
+	// Flow fields started this frame and currently held (including those still being built)
+	TUInt32 NumFrameFlowFieldBuilds() const
+	{
+		return m_FrameFlowFieldBuilds;
+	}
+
+	TUInt32 NumFlowFields() const
+	{
+		return static_cast<TUInt32>(m_FlowFields.size());
+	}
+
+	// Most flow fields held at once, the least recently used is replaced when another is needed
+	TUInt32 MaxFlowFields() const
+	{
+		return kMaxFlowFields;
+	}
+
+
+/////////////////////////////////////
+//	Private interface
+private:
+
+	// A path in the cache, with the range of cells it passes through
+	struct SCachedPath
+	{
+		vector<CVector3> waypoints;
+		TInt32 minX, minZ, maxX, maxZ;
+	};
+
+	// A cell waiting to be visited by a search, with its (estimated) cost to reach the goal
+	typedef pair<TFloat32, TUInt32> TOpenCell;
+
+	// A flow field towards a goal cell. For each cell holds the cost to reach the goal and the
+	// neighbour (0-7) to move to next, or kFlowGoal / kFlowNone for the goal and cells with no
+	// route. A field being built holds the open list (a heap, lowest cost first) of the search so
+	// it can continue in a later frame, the field is complete when the list is empty. Fields used
+	// least recently are removed first when there are too many
+	struct SFlowField
+	{
+		TUInt32           goalCell;
+		TUInt32           lastUsedFrame;
+		vector<TFloat32>  cost;
+		vector<TUInt8>    next;
+		vector<TOpenCell> open;
+	};
+
+	// Maximum number of paths in the cache. The cache is emptied when it is full
+	static const TUInt32 kMaxCachedPaths = 256;
+
+	// Maximum number of flow fields held
+	static const TUInt32 kMaxFlowFields = 8;
+
+	// Furthest distance (in cells) to look for a walkable cell when the start or goal is blocked
+	static const TInt32 kMaxFreeCellSearch = 8;
+
+	// Frames a search that ran out of budget is kept without its query being made again, before
+	// another query may replace it. Long enough for a tank with the lowest AI level of detail to
+	// ask again
+	static const TUInt32 kMaxSearchIdleFrames = 4;
+
+
+	/////////////////////////////////////
+	// Cells
+
+	// Get the cell containing a point. Returns false if the point is off the grid
+	bool CellFromPoint( const CVector3& point, TInt32* pX, TInt32* pZ ) const;
+
+	// Centre of a cell at the given height
+	CVector3 CellCentre( TInt32 x, TInt32 z, TFloat32 y ) const;
+
+	bool IsBlocked( TInt32 x, TInt32 z ) const
+	{
+		return m_Blocked[z * m_Width + x] != 0;
+	}
+
+	// Get the range of cells covered by world bounds expanded by the agent radius, clamped to the
+	// grid. Returns false if the bounds are entirely off the grid
+	bool CellRange( const SAABB& bounds, TInt32* pMinX, TInt32* pMinZ, TInt32* pMaxX, TInt32* pMaxZ ) const;
+
+	// Recalculate which cells are blocked within a range of cells
+	void RasteriseRegion( TInt32 minX, TInt32 minZ, TInt32 maxX, TInt32 maxZ );
+
+	// Update the cells covered by an obstacle and remove cached paths through them
+	void UpdateObstacleRegion( const SAABB& bounds );
+
+	// Find the nearest walkable cell to the given cell, updating the cell. Returns false if there
+	// is none nearby
+	bool FindNearestFreeCell( TInt32* pX, TInt32* pZ ) const;
+
+
+	/////////////////////////////////////
+	// Search
+
+	// A* search between two walkable cells, continuing the search in progress if it is for the
+	// same cells. Returns the cells on the path from start to goal (inclusive) and Nav_Found,
+	// Nav_NoPath if there is no path, or Nav_Deferred if the search budget is used up first
+	ENavResult Search( TInt32 startX, TInt32 startZ, TInt32 goalX, TInt32 goalZ, vector<TUInt32>* pCells );
+
+	// Stop the search in progress, e.g. when the cells it has visited have changed
+	void CancelSearch()
+	{
+		m_SearchOpen.clear();
+		m_SearchInProgress = false;
+	}
+
+	// Reduce a path of cells to the waypoints needed to drive it in straight lines
+	void SmoothPath( const vector<TUInt32>& cells, TFloat32 y, SCachedPath* pPath ) const;
+
+	// Return true if the straight line between two points only crosses walkable cells
+	bool IsLineClear( const CVector3& start, const CVector3& end ) const;
+
+
+	/////////////////////////////////////
+	// Flow fields
+
+	// Get the flow field for a goal cell, building it if necessary (replacing the least recently
+	// used field if there are too many) or continuing to build it. Returns 0 if the field is not
+	// complete when the search budget is used up
+	SFlowField* GetFlowField( TUInt32 goalCell );
+
+	// Get the complete flow field for a goal point, whose cell is returned. If the goal is blocked
+	// the nearest walkable cell is used. Returns Nav_NoPath if there is no such cell or
+	// Nav_Deferred if the field is not complete
+	ENavResult GetGoalFlowField( const CVector3& goal, SFlowField** ppField, TInt32* pGoalX, TInt32* pGoalZ );
+
+	// Add cells to a field's open list to spread costs outwards from
+	void SeedFlowField( SFlowField* pField, const vector<TUInt32>& seeds );
+
+	// Spread costs to the goal outwards from the cells in the open list, updating every cell that
+	// can reach the goal more cheaply than its current cost. If budgeted, stops when the search
+	// budget is used up. Returns true if the field is complete
+	bool PropagateFlowField( SFlowField* pField, bool budgeted );
+
+	// Update flow fields after the cells within a range have changed. Only cells whose route to
+	// the goal passed through the range are recalculated
+	void RepairFlowFields( TInt32 minX, TInt32 minZ, TInt32 maxX, TInt32 maxZ );
+
+
+	/////////////////////////////////////
+	// Data
+
+	// Grid area and cells, cell (x, z) is at index z * width + x
+	CVector3 m_Origin; // Corner of cell (0, 0)
+	TInt32   m_Width;
+	TInt32   m_Height;
+	TFloat32 m_CellSize;
+	TFloat32 m_AgentRadius;
+	vector<TUInt8> m_Blocked;
+
+	// Obstacle bounds used to decide which cells are blocked
+	vector<SAABB> m_Obstacles;
+
+	// Search data for each cell - cost from start and previous cell on the path. Only valid for
+	// cells whose visit/closed markers match the current search number, which avoids clearing
+	// the arrays for every search
+	vector<TFloat32> m_Cost;
+	vector<TUInt32>  m_Previous;
+	vector<TUInt32>  m_VisitedSearch;
+	vector<TUInt32>  m_ClosedSearch;
+	TUInt32          m_SearchNumber;
+
+	// Search that ran out of budget, with its open list (a heap, lowest estimated cost first),
+	// cells (start in the upper 32 bits, goal in the lower) and the last frame it was asked for
+	bool              m_SearchInProgress;
+	vector<TOpenCell> m_SearchOpen;
+	TUInt64           m_SearchKey;
+	TUInt32           m_SearchLastFrame;
+
+	// Cached paths, key is start cell index in the upper 32 bits and goal cell index in the lower
+	map<TUInt64, SCachedPath> m_PathCache;
+
+	// Flow fields, in no particular order
+	vector<SFlowField> m_FlowFields;
+
+	// Search budget and statistics for this frame
+	TUInt32 m_SearchBudget;
+	TUInt32 m_FrameNumber;
+	TUInt32 m_FrameCellsVisited;
+	TUInt32 m_FrameSearches;
+	atomic<TUInt32> m_FrameCacheHits; // Counted by read only queries too
+	TUInt32 m_FrameFlowFieldBuilds;
+
+	// Only held paths and flow fields may be used, see SetReadOnly
+	bool m_ReadOnly;
+};
+
+
+} // namespace gen
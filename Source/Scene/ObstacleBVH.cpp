@@ -0,0 +1,291 @@
+/*******************************************
+	ObstacleBVH.cpp
+
+	Bounding volume hierarchy of static
+	obstacles for line of sight queries
+********************************************/
+
+#include <algorithm>
+
+#include "ObstacleBVH.h"
+#include "EntityManager.h"
+
+namespace gen
+{
+
+/*-----------------------------------------------------------------------------------------
+	Building
+-----------------------------------------------------------------------------------------*/
+
+// Build the hierarchy from the world bounds of all entities whose template is flagged as an
+// obstacle. Uses the bounds of the mesh triangles transformed by each entity's world matrix.
+// Queries are precise against the mesh triangles
+void CObstacleBVH::Build( CEntityManager& entityManager )
+{
+	Clear();
+	for (TUInt32 i = 0; i < entityManager.NumEntities(); ++i)
+	{
+		CEntity* entity = entityManager.GetEntityAtIndex( i );
+		CEntityTemplate* entityTemplate = entity->Template();
+		if (entityTemplate->IsObstacle())
+		{
+			// Mesh hierarchy is built on first use and shared by all entities of the template.
+			// A mesh without triangles has nothing to hit
+			SObstacle obstacle;
+			obstacle.meshBVH = entityTemplate->MeshBVH();
+			if (obstacle.meshBVH->NumTriangles() == 0)
+			{
+				continue;
+			}
+			obstacle.bounds = TransformAABB( obstacle.meshBVH->GetBounds(), entity->Matrix() );
+			obstacle.footprint = obstacle.bounds;
+			TFloat32 collisionRadius = entityTemplate->GetCollisionRadius();
+			if (collisionRadius > 0.0f)
+			{
+				// Column of the collision radius around the model's Y axis, full height of the mesh
+				SAABB column = obstacle.meshBVH->GetBounds();
+				column.minPt.x = column.minPt.z = -collisionRadius;
+				column.maxPt.x = column.maxPt.z = collisionRadius;
+				obstacle.footprint = TransformAABB( column, entity->Matrix() );
+			}
+			obstacle.UID = entity->GetUID();
+			obstacle.invWorldMatrix = InverseAffine( entity->Matrix() );
+			m_Obstacles.push_back( obstacle );
+		}
+	}
+	BuildTree();
+}
+
+// Build the hierarchy from a list of boxes, each with the UID of the entity it belongs to.
+// Queries test against the boxes only
+void CObstacleBVH::Build( const vector<SAABB>& bounds, const vector<TEntityUID>& UIDs )
+{
+	Clear();
+	m_Obstacles.resize( bounds.size() );
+	for (TUInt32 i = 0; i < bounds.size(); ++i)
+	{
+		m_Obstacles[i].bounds = bounds[i];
+		m_Obstacles[i].footprint = bounds[i];
+		m_Obstacles[i].UID = UIDs[i];
+		m_Obstacles[i].meshBVH = 0;
+	}
+	BuildTree();
+}
+
+// Remove all obstacles
+void CObstacleBVH::Clear()
+{
+	m_Nodes.clear();
+	m_Obstacles.clear();
+}
+
+
+// Build the tree from the current obstacle list
+void CObstacleBVH::BuildTree()
+{
+	if (m_Obstacles.empty())
+	{
+		return;
+	}
+
+	// A binary tree with n leaves has 2n - 1 nodes, so this is an upper limit
+	m_Nodes.reserve( 2 * m_Obstacles.size() );
+	m_Nodes.resize( 1 );
+	BuildNode( 0, 0, static_cast<TUInt32>(m_Obstacles.size()) );
+}
+
+// Build the node at the given index to contain the given range of obstacles, then build its
+// children. The obstacles in the range are reordered so those in each child are together
+void CObstacleBVH::BuildNode( TUInt32 nodeIndex, TUInt32 first, TUInt32 count )
+{
+	// Node bounds contain all obstacles, also find bounds of the obstacle centres to choose split
+	SAABB bounds, centreBounds;
+	bounds.SetEmpty();
+	centreBounds.SetEmpty();
+	for (TUInt32 i = first; i < first + count; ++i)
+	{
+		bounds.Expand( m_Obstacles[i].bounds );
+		centreBounds.Expand( m_Obstacles[i].bounds.Centre() );
+	}
+	m_Nodes[nodeIndex].bounds = bounds;
+
+	// Small ranges, or obstacles all at the same point, become leaves
+	CVector3 centreSize = centreBounds.maxPt - centreBounds.minPt;
+	if (count <= kMaxLeafSize || LengthSquared( centreSize ) == 0.0f)
+	{
+		m_Nodes[nodeIndex].first = first;
+		m_Nodes[nodeIndex].count = count;
+		return;
+	}
+
+	// Split at the median centre along the longest axis of the centres
+	TUInt32 axis = 0;
+	if (centreSize.y > centreSize[axis])  axis = 1;
+	if (centreSize.z > centreSize[axis])  axis = 2;
+	TUInt32 half = count / 2;
+	nth_element( m_Obstacles.begin() + first, m_Obstacles.begin() + first + half,
+	             m_Obstacles.begin() + first + count,
+	             [axis]( const SObstacle& a, const SObstacle& b )
+	             {
+	                 return a.bounds.minPt[axis] + a.bounds.maxPt[axis] < b.bounds.minPt[axis] + b.bounds.maxPt[axis];
+	             } );
+
+	// Children are allocated together. Note that m_Nodes may reallocate in BuildNode so node
+	// data is accessed by index
+	TUInt32 childIndex = static_cast<TUInt32>(m_Nodes.size());
+	m_Nodes.resize( childIndex + 2 );
+	m_Nodes[nodeIndex].first = childIndex;
+	m_Nodes[nodeIndex].count = 0;
+	BuildNode( childIndex, first, half );
+	BuildNode( childIndex + 1, first + half, count - half );
+}
+
+
+/*-----------------------------------------------------------------------------------------
+	Queries
+-----------------------------------------------------------------------------------------*/
+
+// Return true if a ray (from a segment) that has hit an obstacle's box also hits its mesh
+// within the maximum distance. Returns the distance of the hit in pT if given (nearest hit
+// for mesh obstacles, entry to the box otherwise)
+bool CObstacleBVH::HitsObstacle( const SObstacle& obstacle, const SRay& ray, const TFloat32 maxT,
+                                 const TFloat32 boxT, TFloat32* pT /*= 0*/ ) const
+{
+	if (!obstacle.meshBVH)
+	{
+		if (pT)
+		{
+			*pT = boxT;
+		}
+		return true;
+	}
+
+	// Transform ray into model space. The direction is not normalised so distances are unchanged
+	SRay modelRay = { obstacle.invWorldMatrix.TransformPoint( ray.origin ),
+	                  obstacle.invWorldMatrix.TransformVector( ray.direction ) };
+	if (pT)
+	{
+		return obstacle.meshBVH->Intersect( modelRay, maxT, pT );
+	}
+	return obstacle.meshBVH->IsOccluded( modelRay, maxT );
+}
+
+
+// Return true if the segment passes through any obstacle. Stops at the first obstacle found
+// so is faster than FirstHit
+bool CObstacleBVH::IsOccluded( const SSegment& segment ) const
+{
+	if (m_Nodes.empty())
+	{
+		return false;
+	}
+
+	SPrecalcRay ray = PrecalcRay( segment );
+	SRay segmentRay = { segment.start, segment.end - segment.start };
+	TUInt32 stack[kMaxDepth];
+	TUInt32 stackSize = 0;
+	stack[stackSize++] = 0;
+	while (stackSize > 0)
+	{
+		const SNode& node = m_Nodes[stack[--stackSize]];
+		if (!RayAABB( ray, node.bounds ))
+		{
+			continue;
+		}
+
+		if (node.count == 0)
+		{
+			stack[stackSize++] = node.first;
+			stack[stackSize++] = node.first + 1;
+		}
+		else
+		{
+			for (TUInt32 i = node.first; i < node.first + node.count; ++i)
+			{
+				TFloat32 boxT;
+				if (RayAABB( ray, m_Obstacles[i].bounds, &boxT ) &&
+				    HitsObstacle( m_Obstacles[i], segmentRay, 1.0f, boxT ))
+				{
+					return true;
+				}
+			}
+		}
+	}
+	return false;
+}
+
+// Find the first obstacle along a segment. Returns false if there is none, otherwise returns
+// true along with the parametric distance of the hit (0 to 1) and optionally the obstacle
+// entity's UID
+bool CObstacleBVH::FirstHit( const SSegment& segment, TFloat32* pT, TEntityUID* pUID /*= 0*/ ) const
+{
+	if (m_Nodes.empty())
+	{
+		return false;
+	}
+
+	// The ray's maxT is reduced to the nearest hit found so far, so boxes further away than that
+	// are rejected by the box tests
+	SPrecalcRay ray = PrecalcRay( segment );
+	SRay segmentRay = { segment.start, segment.end - segment.start };
+	TUInt32 nearest = 0;
+	bool found = false;
+
+	TUInt32 stack[kMaxDepth];
+	TUInt32 stackSize = 0;
+	if (RayAABB( ray, m_Nodes[0].bounds ))
+	{
+		stack[stackSize++] = 0;
+	}
+	while (stackSize > 0)
+	{
+		const SNode& node = m_Nodes[stack[--stackSize]];
+		if (node.count == 0)
+		{
+			// Visit the nearer child first (pushed last) to find close hits early
+			TFloat32 t0, t1;
+			bool hit0 = RayAABB( ray, m_Nodes[node.first].bounds, &t0 );
+			bool hit1 = RayAABB( ray, m_Nodes[node.first + 1].bounds, &t1 );
+			if (hit0 && hit1)
+			{
+				stack[stackSize++] = (t0 <= t1) ? node.first + 1 : node.first;
+				stack[stackSize++] = (t0 <= t1) ? node.first : node.first + 1;
+			}
+			else if (hit0)
+			{
+				stack[stackSize++] = node.first;
+			}
+			else if (hit1)
+			{
+				stack[stackSize++] = node.first + 1;
+			}
+		}
+		else
+		{
+			for (TUInt32 i = node.first; i < node.first + node.count; ++i)
+			{
+				TFloat32 boxT, t;
+				if (RayAABB( ray, m_Obstacles[i].bounds, &boxT ) &&
+				    HitsObstacle( m_Obstacles[i], segmentRay, ray.maxT, boxT, &t ))
+				{
+					ray.maxT = t;
+					nearest = i;
+					found = true;
+				}
+			}
+		}
+	}
+
+	if (found)
+	{
+		*pT = ray.maxT;
+		if (pUID)
+		{
+			*pUID = m_Obstacles[nearest].UID;
+		}
+	}
+	return found;
+}
+
+
+} // namespace gen
@@ -0,0 +1,166 @@
+/*******************************************
+	ObstacleBVH.h
+
+	Bounding volume hierarchy of static
+	obstacles for line of sight queries
+********************************************/
+
+#pragma once
+
+#include <vector>
+using namespace std;
+
+#include "Defines.h"
+#include "Geometry.h"
+#include "Entity.h"
+
+namespace gen
+{
+
+// Forward declaration of classes, where includes are only possible/necessary in the .cpp file
+class CEntityManager;
+
+
+/*-----------------------------------------------------------------------------------------
+-------------------------------------------------------------------------------------------
+	Obstacle BVH Class
+-------------------------------------------------------------------------------------------
+-----------------------------------------------------------------------------------------*/
+
+// Holds the world-space bounding boxes of static obstacles (buildings, trees etc.) in a binary
+// tree of boxes, where each node's box contains those of its children. Segment queries only
+// visit the parts of the tree the segment passes through, so cost grows with the log of the
+// number of obstacles. The tree is built once after the level is loaded - obstacles are not
+// expected to move
+//
+// Obstacles built from entities also refer to the triangle hierarchy of their mesh (CMeshBVH).
+// Segments that hit an obstacle's box are then tested precisely against its triangles, so a
+// segment passing through the empty parts of a tree's box is not blocked
+//
+// Each obstacle also has a footprint, the box that blocks movement, used by navigation and
+// collisions. It is the obstacle's bounds unless its template has a collision radius, e.g. so a
+// tree blocks movement with its trunk rather than the whole of its canopy
+class CObstacleBVH
+{
+/////////////////////////////////////
+//	Constructors/Destructors
+public:
+	// Constructor creates an empty hierarchy
+	CObstacleBVH() {}
+
+private:
+	// Prevent use of copy constructor and assignment operator (private and not defined)
+	CObstacleBVH( const CObstacleBVH& );
+	CObstacleBVH& operator=( const CObstacleBVH& );
+
+
+/////////////////////////////////////
+//	Public interface
+public:
+
+	/////////////////////////////////////
+	// Building
+
+	// Build the hierarchy from the world bounds of all entities whose template is flagged as an
+	// obstacle. Uses the mesh bounds transformed by each entity's world matrix. Queries are
+	// precise against the mesh triangles
+	void Build( CEntityManager& entityManager );
+
+	// Build the hierarchy from a list of boxes, each with the UID of the entity it belongs to.
+	// Queries test against the boxes only
+	void Build( const vector<SAABB>& bounds, const vector<TEntityUID>& UIDs );
+
+	// Remove all obstacles
+	void Clear();
+
+
+	/////////////////////////////////////
+	// Queries
+
+	// Return true if the segment passes through any obstacle. Stops at the first obstacle found
+	// so is faster than FirstHit
+	bool IsOccluded( const SSegment& segment ) const;
+
+	// Find the first obstacle along a segment. Returns false if there is none, otherwise returns
+	// true along with the parametric distance of the hit (0 to 1) and optionally the obstacle
+	// entity's UID
+	bool FirstHit( const SSegment& segment, TFloat32* pT, TEntityUID* pUID = 0 ) const;
+
+
+	/////////////////////////////////////
+	// Getters
+
+	TUInt32 NumObstacles() const
+	{
+		return static_cast<TUInt32>(m_Obstacles.size());
+	}
+
+	const SAABB& GetObstacleBounds( TUInt32 index ) const
+	{
+		return m_Obstacles[index].bounds;
+	}
+
+	// World bounds of the part of an obstacle that blocks movement
+	const SAABB& GetObstacleFootprint( TUInt32 index ) const
+	{
+		return m_Obstacles[index].footprint;
+	}
+
+	TEntityUID GetObstacleUID( TUInt32 index ) const
+	{
+		return m_Obstacles[index].UID;
+	}
+
+
+/////////////////////////////////////
+//	Private interface
+private:
+
+	// Obstacle bounds, footprint and the UID of the entity it belongs to. Obstacles with a mesh
+	// hierarchy also hold the inverse of the entity's world matrix to transform queries into model
+	// space
+	struct SObstacle
+	{
+		SAABB           bounds;
+		SAABB           footprint;
+		TEntityUID      UID;
+		const CMeshBVH* meshBVH; // 0 for box only obstacles
+		CMatrix4x4      invWorldMatrix;
+	};
+
+	// Tree node. Interior nodes have two children in consecutive nodes starting at index first.
+	// Leaf nodes refer to count obstacles starting at index first
+	struct SNode
+	{
+		SAABB   bounds;
+		TUInt32 first;
+		TUInt32 count; // 0 for interior nodes
+	};
+
+	// Maximum obstacles in a leaf node, and maximum depth of tree that can be traversed
+	static const TUInt32 kMaxLeafSize = 4;
+	static const TUInt32 kMaxDepth = 64;
+
+	// Build the tree from the current obstacle list
+	void BuildTree();
+
+	// Build the node at the given index to contain the given range of obstacles, then build its
+	// children. The obstacles in the range are reordered so those in each child are together
+	void BuildNode( TUInt32 nodeIndex, TUInt32 first, TUInt32 count );
+
+	// Return true if a ray (from a segment) that has hit an obstacle's box also hits its mesh
+	// within the maximum distance. Returns the distance of the hit in pT if given (nearest hit
+	// for mesh obstacles, entry to the box otherwise)
+	bool HitsObstacle( const SObstacle& obstacle, const SRay& ray, const TFloat32 maxT,
+	                   const TFloat32 boxT, TFloat32* pT = 0 ) const;
+
+
+	// Tree nodes, root is at index 0
+	vector<SNode> m_Nodes;
+
+	// Obstacles, ordered so each leaf node refers to a contiguous range
+	vector<SObstacle> m_Obstacles;
+};
+
+
+} // namespace gen
@@ -0,0 +1,298 @@
+/*******************************************
+	ProjectileSystem.cpp
+
+	Shells held in arrays, moved together in
+	one SSE loop and swept against tanks and
+	scenery
+********************************************/
+
+#include <xmmintrin.h>
+
+#include "ProjectileSystem.h"
+#include "EntityManager.h"
+#include "TankEntity.h"
+#include "ObstacleBVH.h"
+#include "RenderState.h"
+
+namespace gen
+{
+
+/*-----------------------------------------------------------------------------------------
+	Shells
+-----------------------------------------------------------------------------------------*/
+
+// Remove all shells
+void CProjectileSystem::Clear()
+{
+	for (TUInt32 value = 0; value < Value_Count; ++value)
+	{
+		m_Values[value].clear();
+	}
+	m_Teams.clear();
+	m_Damages.clear();
+	m_NumShells = 0;
+	m_Tanks.clear();
+	m_TankPositions.clear();
+}
+
+// Fire a shell from a position in a direction (need not be normalised). It will damage the
+// first tank not on the given team that it hits
+void CProjectileSystem::Fire( const CVector3& position, const CVector3& direction, TUInt32 team,
+                              TInt32 damage )
+{
+	GEN_ASSERT( !direction.IsZero(), "Shell fired with no direction" );
+
+	// Grow the arrays by four padding shells when full. Padding has no life so is harmless to
+	// integrate
+	TUInt32 shell = m_NumShells++;
+	if (shell == m_Values[0].size())
+	{
+		for (TUInt32 value = 0; value < Value_Count; ++value)
+		{
+			m_Values[value].resize( shell + 4, 0.0f );
+		}
+	}
+	m_Teams.push_back( team );
+	m_Damages.push_back( damage );
+
+	CVector3 velocity = Normalise( direction ) * m_Speed;
+	m_Values[Value_PosX][shell] = position.x;
+	m_Values[Value_PosY][shell] = position.y;
+	m_Values[Value_PosZ][shell] = position.z;
+	m_Values[Value_VelX][shell] = velocity.x;
+	m_Values[Value_VelY][shell] = velocity.y;
+	m_Values[Value_VelZ][shell] = velocity.z;
+	m_Values[Value_Life][shell] = m_LifeTime;
+}
+
+// Remove a shell, moving the last shell into its place
+void CProjectileSystem::RemoveShell( TUInt32 shell )
+{
+	--m_NumShells;
+	for (TUInt32 value = 0; value < Value_Count; ++value)
+	{
+		m_Values[value][shell] = m_Values[value][m_NumShells];
+		m_Values[value][m_NumShells] = 0.0f;
+	}
+	m_Teams[shell] = m_Teams.back();
+	m_Teams.pop_back();
+	m_Damages[shell] = m_Damages.back();
+	m_Damages.pop_back();
+}
+
+
+/*-----------------------------------------------------------------------------------------
+	Update / Render
+-----------------------------------------------------------------------------------------*/
+
+// Move all shells over the update time, damage the live tanks they hit and remove shells
+// that have hit a tank or scenery or run out of life
+void CProjectileSystem::Update( TFloat32 updateTime, CEntityManager& entityManager,
+                                const CObstacleBVH& obstacles )
+{
+	m_NumHits = 0;
+	m_NumObstacleHits = 0;
+	if (m_NumShells == 0)
+	{
+		return;
+	}
+	Integrate( updateTime );
+	BuildTankHash( entityManager );
+
+	// Test the path each shell took this tick, so fast shells or long ticks can't pass through
+	// tanks or scenery. Tanks are taken to be at their new positions for the whole tick
+	// Removing a shell moves the last shell into its place, so don't advance past it
+	TUInt32 shell = 0;
+	while (shell < m_NumShells)
+	{
+		SSegment path;
+		path.end = CVector3( m_Values[Value_PosX][shell], m_Values[Value_PosY][shell], m_Values[Value_PosZ][shell] );
+		path.start = path.end - CVector3( m_Values[Value_VelX][shell], m_Values[Value_VelY][shell], m_Values[Value_VelZ][shell] ) * updateTime;
+		TFloat32 tankT;
+		CTankEntity* tank = FindHitTank( m_Teams[shell], path, &tankT );
+
+		// Scenery stops the shell if it is hit first, only need to test up to any tank hit
+		SSegment obstaclePath = path;
+		if (tank)
+		{
+			obstaclePath.end = path.start + (path.end - path.start) * tankT;
+		}
+		TFloat32 obstacleT;
+		if (obstacles.FirstHit( obstaclePath, &obstacleT ))
+		{
+			++m_NumObstacleHits;
+			RemoveShell( shell );
+		}
+		else if (tank)
+		{
+			tank->Hit( static_cast<TFloat32>(m_Damages[shell]) );
+			++m_NumHits;
+			RemoveShell( shell );
+		}
+		else if (m_Values[Value_Life][shell] <= 0.0f)
+		{
+			RemoveShell( shell );
+		}
+		else
+		{
+			++shell;
+		}
+	}
+}
+
+// Move all shells and reduce their life
+void CProjectileSystem::Integrate( TFloat32 updateTime )
+{
+	TFloat32* posX = m_Values[Value_PosX].data();
+	TFloat32* posY = m_Values[Value_PosY].data();
+	TFloat32* posZ = m_Values[Value_PosZ].data();
+	const TFloat32* velX = m_Values[Value_VelX].data();
+	const TFloat32* velY = m_Values[Value_VelY].data();
+	const TFloat32* velZ = m_Values[Value_VelZ].data();
+	TFloat32* life = m_Values[Value_Life].data();
+
+	// Arrays are padded so the last group of four is complete
+	const __m128 time = _mm_set1_ps( updateTime );
+	for (TUInt32 shell = 0; shell < m_NumShells; shell += 4)
+	{
+		_mm_storeu_ps( posX + shell, _mm_add_ps( _mm_loadu_ps( posX + shell ), _mm_mul_ps( _mm_loadu_ps( velX + shell ), time ) ) );
+		_mm_storeu_ps( posY + shell, _mm_add_ps( _mm_loadu_ps( posY + shell ), _mm_mul_ps( _mm_loadu_ps( velY + shell ), time ) ) );
+		_mm_storeu_ps( posZ + shell, _mm_add_ps( _mm_loadu_ps( posZ + shell ), _mm_mul_ps( _mm_loadu_ps( velZ + shell ), time ) ) );
+		_mm_storeu_ps( life + shell, _mm_sub_ps( _mm_loadu_ps( life + shell ), time ) );
+	}
+}
+
+// Add all shells to the given render state to be drawn
+void CProjectileSystem::ExtractRender( SRenderState& state ) const
+{
+	if (!m_Template || m_NumShells == 0)
+	{
+		return;
+	}
+	CMesh* mesh = m_Template->Mesh();
+	TUInt32 numNodes = mesh->GetNumNodes();
+
+	// Shells face along their velocity, other nodes keep their default transforms from the mesh
+	for (TUInt32 shell = 0; shell < m_NumShells; ++shell)
+	{
+		CVector3 position( m_Values[Value_PosX][shell], m_Values[Value_PosY][shell], m_Values[Value_PosZ][shell] );
+		CVector3 velocity( m_Values[Value_VelX][shell], m_Values[Value_VelY][shell], m_Values[Value_VelZ][shell] );
+		CMatrix4x4* matrices = state.AddInstance( mesh );
+		matrices[0] = MatrixFaceDirection( position, velocity );
+		for (TUInt32 node = 1; node < numNodes; ++node)
+		{
+			const SMeshNode& meshNode = mesh->GetNode( node );
+			matrices[node] = meshNode.positionMatrix * matrices[meshNode.parent];
+		}
+	}
+}
+
+
+/*-----------------------------------------------------------------------------------------
+	Tank Hits
+-----------------------------------------------------------------------------------------*/
+
+// Put all live tanks in the spatial hash
+void CProjectileSystem::BuildTankHash( CEntityManager& entityManager )
+{
+	m_Tanks.clear();
+	m_TankPositions.clear();
+	entityManager.BeginEnumEntities( "", "", "Tank" );
+	CEntity* entity;
+	while (entity = entityManager.EnumEntity())
+	{
+		CTankEntity* tank = static_cast<CTankEntity*>(entity);
+		if (tank->IsAlive())
+		{
+			m_Tanks.push_back( tank );
+			m_TankPositions.push_back( tank->Position() );
+		}
+	}
+	entityManager.EndEnumEntities();
+
+	// Cells are as wide as a hit sphere so each tank overlaps at most 2x2 cells
+	TUInt32 numTanks = static_cast<TUInt32>(m_Tanks.size());
+	m_TankHash.Begin( numTanks, 2.0f * HitRadius() );
+	for (TUInt32 tank = 0; tank < numTanks; ++tank)
+	{
+		m_TankHash.SetItem( tank, m_TankPositions[tank].x, m_TankPositions[tank].z, HitRadius() );
+	}
+	m_TankHash.Build();
+}
+
+// Find the first enemy tank a shell hits moving along a path. Returns 0 if none, otherwise the
+// tank and the parametric distance of the hit along the path (0 to 1)
+CTankEntity* CProjectileSystem::FindHitTank( TUInt32 team, const SSegment& path, TFloat32* pT ) const
+{
+	SSphere tankSphere;
+	tankSphere.radius = HitRadius();
+
+	// Walk the cells the path passes through in order. Tanks are in every cell their hit sphere
+	// overlaps, so a hit on a tank is always found in the cell holding the point of the hit
+	TFloat32 cellSize = m_TankHash.CellSize();
+	TInt32 cellX, cellZ, endX, endZ;
+	m_TankHash.PositionCell( path.start.x, path.start.z, &cellX, &cellZ );
+	m_TankHash.PositionCell( path.end.x, path.end.z, &endX, &endZ );
+	TUInt32 numCells = Abs( endX - cellX ) + Abs( endZ - cellZ ) + 1;
+
+	// Distance along the path to the next cell boundary in X and Z, and between boundaries
+	TFloat32 dx = path.end.x - path.start.x;
+	TFloat32 dz = path.end.z - path.start.z;
+	TInt32 stepX = (dx > 0.0f) ? 1 : -1;
+	TInt32 stepZ = (dz > 0.0f) ? 1 : -1;
+	TFloat32 nextX = 1e30f, deltaX = 1e30f;
+	TFloat32 nextZ = 1e30f, deltaZ = 1e30f;
+	if (dx != 0.0f)
+	{
+		nextX = ((cellX + (dx > 0.0f ? 1 : 0)) * cellSize - path.start.x) / dx;
+		deltaX = cellSize / Abs( dx );
+	}
+	if (dz != 0.0f)
+	{
+		nextZ = ((cellZ + (dz > 0.0f ? 1 : 0)) * cellSize - path.start.z) / dz;
+		deltaZ = cellSize / Abs( dz );
+	}
+
+	CTankEntity* hitTank = 0;
+	TFloat32 hitT = 1.0f;
+	for (TUInt32 cell = 0; cell < numCells; ++cell)
+	{
+		// Different cells may share a bucket, which only costs extra hit tests as the tests are exact
+		TUInt32 bucket = m_TankHash.CellBucket( cellX, cellZ );
+		for (TUInt32 i = m_TankHash.BucketBegin( bucket ); i < m_TankHash.BucketEnd( bucket ); ++i)
+		{
+			TUInt32 tank = m_TankHash.Entry( i );
+			if (static_cast<TUInt32>(m_Tanks[tank]->GetTeam()) != team)
+			{
+				TFloat32 t;
+				tankSphere.centre = m_TankPositions[tank];
+				if (SegmentSphere( path, tankSphere, &t ) && t <= hitT)
+				{
+					hitTank = m_Tanks[tank];
+					hitT = t;
+				}
+			}
+		}
+
+		// Later cells can't hold an earlier hit than one within this cell
+		if (hitTank && hitT <= Min( nextX, nextZ ))
+		{
+			break;
+		}
+		if (nextX < nextZ)
+		{
+			cellX += stepX;
+			nextX += deltaX;
+		}
+		else
+		{
+			cellZ += stepZ;
+			nextZ += deltaZ;
+		}
+	}
+
+	*pT = hitT;
+	return hitTank;
+}
+
+} // namespace gen
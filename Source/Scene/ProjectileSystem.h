@@ -0,0 +1,191 @@
+/*******************************************
+	ProjectileSystem.h
+
+	Shells held in arrays, moved together in
+	one SSE loop and swept against tanks and
+	scenery
+********************************************/
+
+#pragma once
+
+#include <vector>
+using namespace std;
+
+#include "Defines.h"
+#include "CVector3.h"
+#include "CMatrix4x4.h"
+#include "Geometry.h"
+#include "SpatialHash.h"
+
+namespace gen
+{
+
+// Forward declaration of classes, where includes are only possible/necessary in the .cpp file
+class CEntityManager;
+class CEntityTemplate;
+class CTankEntity;
+class CObstacleBVH;
+struct SRenderState;
+
+
+/*-----------------------------------------------------------------------------------------
+-------------------------------------------------------------------------------------------
+	Projectile System Class
+-------------------------------------------------------------------------------------------
+-----------------------------------------------------------------------------------------*/
+
+// Holds every shell in flight in separate arrays for each value (structure of arrays) rather
+// than as entities. Each tick:
+//  - All shells are moved and aged in one SSE loop, four at a time with no branches. Arrays are
+//    padded to a multiple of four
+//  - Live tanks are placed in a spatial hash of cells one hit sphere across, each tank in every
+//    cell its hit sphere overlaps
+//  - The path each shell took over the tick is tested against the tanks in the cells it passed
+//    through (as a swept sphere, i.e. a segment against the tank sphere grown by the shell
+//    radius) and against the static obstacles. Hits are found however far a shell moves in a
+//    tick, so shells can't pass through tanks or buildings at low frame rates
+//  - Shells that hit an enemy tank damage it and are removed, as are shells that hit scenery or
+//    run out of life
+//
+// Shells have no behaviour of their own so need none of the entity machinery. They are rendered
+// with the mesh of a single template
+class CProjectileSystem
+{
+/////////////////////////////////////
+//	Constructors/Destructors
+public:
+	// Constructor sets the speed, life time and radius of shells and the radius of tanks they hit
+	CProjectileSystem( TFloat32 speed = 100.0f, TFloat32 lifeTime = 2.0f, TFloat32 tankRadius = 2.0f,
+	                   TFloat32 shellRadius = 0.0f )
+	{
+		m_Speed = speed;
+		m_LifeTime = lifeTime;
+		m_TankRadius = tankRadius;
+		m_ShellRadius = shellRadius;
+		m_Template = 0;
+		m_NumShells = 0;
+		m_NumHits = 0;
+		m_NumObstacleHits = 0;
+	}
+
+private:
+	// Prevent use of copy constructor and assignment operator (private and not defined)
+	CProjectileSystem( const CProjectileSystem& );
+	CProjectileSystem& operator=( const CProjectileSystem& );
+
+
+/////////////////////////////////////
+//	Public interface
+public:
+
+	/////////////////////////////////////
+	// Setup
+
+	// Set the template whose mesh is used to render shells
+	void SetTemplate( CEntityTemplate* shellTemplate )
+	{
+		m_Template = shellTemplate;
+	}
+
+	// Remove all shells
+	void Clear();
+
+
+	/////////////////////////////////////
+	// Shells
+
+	// Fire a shell from a position in a direction (need not be normalised). It will damage the
+	// first tank not on the given team that it hits
+	void Fire( const CVector3& position, const CVector3& direction, TUInt32 team, TInt32 damage );
+
+	TUInt32 NumShells() const
+	{
+		return m_NumShells;
+	}
+
+	// Number of tanks hit in the last update
+	TUInt32 NumHits() const
+	{
+		return m_NumHits;
+	}
+
+	// Number of shells stopped by scenery in the last update
+	TUInt32 NumObstacleHits() const
+	{
+		return m_NumObstacleHits;
+	}
+
+
+	/////////////////////////////////////
+	// Update / Render
+
+	// Move all shells over the update time, damage the live tanks they hit and remove shells
+	// that have hit a tank or scenery or run out of life
+	void Update( TFloat32 updateTime, CEntityManager& entityManager, const CObstacleBVH& obstacles );
+
+	// Add all shells to the given render state to be drawn
+	void ExtractRender( SRenderState& state ) const;
+
+
+/////////////////////////////////////
+//	Private interface
+private:
+
+	// Values held for each shell, each in its own array
+	enum EValue
+	{
+		Value_PosX,
+		Value_PosY,
+		Value_PosZ,
+		Value_VelX,
+		Value_VelY,
+		Value_VelZ,
+		Value_Life, // Remaining life, the shell is removed at zero
+		Value_Count
+	};
+
+	// Move all shells and reduce their life
+	void Integrate( TFloat32 updateTime );
+
+	// Put all live tanks in the spatial hash
+	void BuildTankHash( CEntityManager& entityManager );
+
+	// Distance between shell and tank centres at which they hit
+	TFloat32 HitRadius() const
+	{
+		return m_TankRadius + m_ShellRadius;
+	}
+
+	// Find the first enemy tank a shell hits moving along a path. Returns 0 if none, otherwise the
+	// tank and the parametric distance of the hit along the path (0 to 1)
+	CTankEntity* FindHitTank( TUInt32 team, const SSegment& path, TFloat32* pT ) const;
+
+	// Remove a shell, moving the last shell into its place
+	void RemoveShell( TUInt32 shell );
+
+
+	// Shells, value arrays padded to a multiple of 4
+	vector<TFloat32> m_Values[Value_Count];
+	vector<TUInt32>  m_Teams;
+	vector<TInt32>   m_Damages;
+	TUInt32          m_NumShells;
+
+	// Live tanks and their spatial hash, with an entry for each cell a tank's hit sphere overlaps
+	vector<CTankEntity*> m_Tanks;
+	vector<CVector3>     m_TankPositions;
+	CSpatialHash         m_TankHash;
+
+	// Settings
+	TFloat32         m_Speed;
+	TFloat32         m_LifeTime;
+	TFloat32         m_TankRadius;
+	TFloat32         m_ShellRadius;
+	CEntityTemplate* m_Template;
+
+	// Statistics
+	TUInt32 m_NumHits;
+	TUInt32 m_NumObstacleHits;
+};
+
+
+} // namespace gen
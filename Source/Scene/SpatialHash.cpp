@@ -0,0 +1,96 @@
+/*******************************************
+	SpatialHash.cpp
+
+	Spatial hash of items in a grid of square
+	cells on the XZ plane
+********************************************/
+
+#include "BaseMath.h"
+
+#include "SpatialHash.h"
+
+namespace gen
+{
+
+/*-----------------------------------------------------------------------------------------
+	Building
+-----------------------------------------------------------------------------------------*/
+
+// Start building the hash for the given number of items and cell size
+void CSpatialHash::Begin( TUInt32 numItems, TFloat32 cellSize )
+{
+	m_CellSize = cellSize;
+	m_MinX.resize( numItems );
+	m_MinZ.resize( numItems );
+	m_MaxX.resize( numItems );
+	m_MaxZ.resize( numItems );
+}
+
+// Set the position (XZ plane) and radius of an item, between Begin and Build
+void CSpatialHash::SetItem( TUInt32 item, TFloat32 x, TFloat32 z, TFloat32 radius )
+{
+	PositionCell( x - radius, z - radius, &m_MinX[item], &m_MinZ[item] );
+	PositionCell( x + radius, z + radius, &m_MaxX[item], &m_MaxZ[item] );
+}
+
+// Sort the items' entries into buckets, after all items are set
+void CSpatialHash::Build()
+{
+	// At least twice as many buckets as entries, as a power of 2, plus one for the end marker
+	TUInt32 numItems = static_cast<TUInt32>(m_MinX.size());
+	TUInt32 numEntries = 0;
+	for (TUInt32 item = 0; item < numItems; ++item)
+	{
+		numEntries += (m_MaxX[item] - m_MinX[item] + 1) * (m_MaxZ[item] - m_MinZ[item] + 1);
+	}
+	TUInt32 numBuckets = 16;
+	while (numBuckets < numEntries * 2)
+	{
+		numBuckets *= 2;
+	}
+	m_BucketStart.assign( numBuckets + 1, 0 );
+	m_BucketItems.resize( numEntries );
+
+	// Counting sort by bucket - count entries in each bucket, convert counts to start positions,
+	// then place each entry
+	for (TUInt32 item = 0; item < numItems; ++item)
+	{
+		for (TInt32 z = m_MinZ[item]; z <= m_MaxZ[item]; ++z)
+		{
+			for (TInt32 x = m_MinX[item]; x <= m_MaxX[item]; ++x)
+			{
+				++m_BucketStart[CellBucket( x, z ) + 1];
+			}
+		}
+	}
+	for (TUInt32 bucket = 1; bucket <= numBuckets; ++bucket)
+	{
+		m_BucketStart[bucket] += m_BucketStart[bucket - 1];
+	}
+	m_NextInBucket.assign( m_BucketStart.begin(), m_BucketStart.end() - 1 );
+	for (TUInt32 item = 0; item < numItems; ++item)
+	{
+		for (TInt32 z = m_MinZ[item]; z <= m_MaxZ[item]; ++z)
+		{
+			for (TInt32 x = m_MinX[item]; x <= m_MaxX[item]; ++x)
+			{
+				m_BucketItems[m_NextInBucket[CellBucket( x, z )]++] = item;
+			}
+		}
+	}
+}
+
+
+/*-----------------------------------------------------------------------------------------
+	Queries
+-----------------------------------------------------------------------------------------*/
+
+// Cell holding a position
+void CSpatialHash::PositionCell( TFloat32 x, TFloat32 z, TInt32* pX, TInt32* pZ ) const
+{
+	*pX = static_cast<TInt32>(Floor( x / m_CellSize ));
+	*pZ = static_cast<TInt32>(Floor( z / m_CellSize ));
+}
+
+
+} // namespace gen
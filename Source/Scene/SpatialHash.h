@@ -0,0 +1,128 @@
+/*******************************************
+	SpatialHash.h
+
+	Spatial hash of items in a grid of square
+	cells on the XZ plane
+********************************************/
+
+#pragma once
+
+#include <vector>
+using namespace std;
+
+#include "Defines.h"
+
+namespace gen
+{
+
+/*-----------------------------------------------------------------------------------------
+-------------------------------------------------------------------------------------------
+	Spatial Hash Class
+-------------------------------------------------------------------------------------------
+-----------------------------------------------------------------------------------------*/
+
+// Finds the items near a point by cell, without holding a grid over the whole world. Each item
+// is a circle on the XZ plane and has an entry in every cell it overlaps. Cells are hashed into a
+// fixed number of buckets, and entries are sorted by bucket with a counting sort, so the hash is
+// rebuilt each tick in two passes over the items with no allocation once the arrays have grown.
+// Different cells may share a bucket, so users must check the items found in a bucket (e.g. with
+// ItemInCell or an exact test)
+//
+// Build by calling Begin with the number of items and cell size, SetItem for each item, then
+// Build. Items in bucket b are Entry( i ) for BucketBegin( b ) <= i < BucketEnd( b )
+class CSpatialHash
+{
+/////////////////////////////////////
+//	Constructors/Destructors
+public:
+	// Constructor creates an empty hash
+	CSpatialHash()
+	{
+		m_CellSize = 1.0f;
+	}
+
+private:
+	// Prevent use of copy constructor and assignment operator (private and not defined)
+	CSpatialHash( const CSpatialHash& );
+	CSpatialHash& operator=( const CSpatialHash& );
+
+
+/////////////////////////////////////
+//	Public interface
+public:
+
+	/////////////////////////////////////
+	// Building
+
+	// Start building the hash for the given number of items and cell size
+	void Begin( TUInt32 numItems, TFloat32 cellSize );
+
+	// Set the position (XZ plane) and radius of an item, between Begin and Build
+	void SetItem( TUInt32 item, TFloat32 x, TFloat32 z, TFloat32 radius );
+
+	// Sort the items' entries into buckets, after all items are set
+	void Build();
+
+
+	/////////////////////////////////////
+	// Queries
+
+	// Cell holding a position
+	void PositionCell( TFloat32 x, TFloat32 z, TInt32* pX, TInt32* pZ ) const;
+
+	// Bucket of a cell
+	TUInt32 CellBucket( TInt32 x, TInt32 z ) const
+	{
+		TUInt32 hash = static_cast<TUInt32>(x) * 73856093u ^ static_cast<TUInt32>(z) * 19349663u;
+		return hash & static_cast<TUInt32>(m_BucketStart.size() - 2);
+	}
+
+	// Range of entries in a bucket
+	TUInt32 BucketBegin( TUInt32 bucket ) const
+	{
+		return m_BucketStart[bucket];
+	}
+
+	TUInt32 BucketEnd( TUInt32 bucket ) const
+	{
+		return m_BucketStart[bucket + 1];
+	}
+
+	// Item of an entry
+	TUInt32 Entry( TUInt32 entry ) const
+	{
+		return m_BucketItems[entry];
+	}
+
+	// Whether an item overlaps a cell
+	bool ItemInCell( TUInt32 item, TInt32 x, TInt32 z ) const
+	{
+		return x >= m_MinX[item] && x <= m_MaxX[item] && z >= m_MinZ[item] && z <= m_MaxZ[item];
+	}
+
+	TFloat32 CellSize() const
+	{
+		return m_CellSize;
+	}
+
+
+/////////////////////////////////////
+//	Private interface
+private:
+
+	// Cells overlapped by each item
+	vector<TInt32> m_MinX, m_MinZ, m_MaxX, m_MaxZ;
+
+	// Entries sorted by bucket, and the start of each bucket's entries plus an end marker. The
+	// number of buckets is a power of 2
+	vector<TUInt32> m_BucketStart;
+	vector<TUInt32> m_BucketItems;
+
+	// Next free entry in each bucket while building, kept to avoid allocating each build
+	vector<TUInt32> m_NextInBucket;
+
+	TFloat32 m_CellSize;
+};
+
+
+} // namespace gen
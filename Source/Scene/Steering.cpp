@@ -0,0 +1,244 @@
+/*******************************************
+	Steering.cpp
+
+	Separation steering between tanks
+	using a spatial hash
+********************************************/
+
+#include <xmmintrin.h>
+
+#include "Steering.h"
+#include "Kinematics.h"
+
+namespace gen
+{
+
+// Strength of separation relative to the wanted heading (which has length 1)
+const TFloat32 CSteering::kSeparationWeight = 1.5f;
+
+// Speed a stationary tank moves away from a tank at the same position, less when further
+const TFloat32 CSteering::kCrowdedSpeed = 2.0f;
+
+
+/*-----------------------------------------------------------------------------------------
+	Update
+-----------------------------------------------------------------------------------------*/
+
+// Add separation and avoidance from nearby tanks to the wanted movement of each tank
+void CSteering::Update( CKinematics& kinematics )
+{
+	BuildHash( kinematics );
+	GatherNeighbours( kinematics );
+	CalculateForces();
+	ApplyForces( kinematics );
+}
+
+
+/*-----------------------------------------------------------------------------------------
+	Neighbours
+-----------------------------------------------------------------------------------------*/
+
+// Put all tanks in the spatial hash, in cells the size of the neighbour radius
+void CSteering::BuildHash( const CKinematics& kinematics )
+{
+	TUInt32 numTanks = kinematics.NumTanks();
+	const TFloat32* posX = kinematics.PosX();
+	const TFloat32* posZ = kinematics.PosZ();
+	m_Hash.Begin( numTanks, m_NeighbourRadius );
+	for (TUInt32 tank = 0; tank < numTanks; ++tank)
+	{
+		m_Hash.SetItem( tank, posX[tank], posZ[tank], 0.0f );
+	}
+	m_Hash.Build();
+}
+
+// Find the nearest neighbours of each tank that can move and gather them into its slots
+void CSteering::GatherNeighbours( const CKinematics& kinematics )
+{
+	// Slot arrays are padded to a multiple of four for the force loop
+	TUInt32 numTanks = kinematics.NumTanks();
+	TUInt32 numSlots = (numTanks * kMaxNeighbours + 3) & ~3u;
+	for (TUInt32 value = 0; value < Slot_Count; ++value)
+	{
+		m_Slots[value].resize( numSlots );
+	}
+	const TFloat32* posX = kinematics.PosX();
+	const TFloat32* posZ = kinematics.PosZ();
+	TFloat32 radiusSquared = m_NeighbourRadius * m_NeighbourRadius;
+	m_NumNeighbours = 0;
+
+	for (TUInt32 tank = 0; tank < numTanks; ++tank)
+	{
+		// Nearest neighbours within the radius so far, sorted by distance
+		TUInt32 neighbours[kMaxNeighbours];
+		TFloat32 neighbourDistances[kMaxNeighbours];
+		TUInt32 numNeighbours = 0;
+
+		// Tanks that can't move are not steered, so need no neighbours
+		TInt32 cellX, cellZ;
+		m_Hash.PositionCell( posX[tank], posZ[tank], &cellX, &cellZ );
+		for (TInt32 z = cellZ - 1; z <= cellZ + 1 && kinematics.CanMove( tank ); ++z)
+		{
+			for (TInt32 x = cellX - 1; x <= cellX + 1; ++x)
+			{
+				TUInt32 bucket = m_Hash.CellBucket( x, z );
+				for (TUInt32 i = m_Hash.BucketBegin( bucket ); i < m_Hash.BucketEnd( bucket ); ++i)
+				{
+					TUInt32 other = m_Hash.Entry( i );
+					if (other == tank || !m_Hash.ItemInCell( other, x, z ))
+					{
+						continue;
+					}
+					TFloat32 dx = posX[other] - posX[tank];
+					TFloat32 dz = posZ[other] - posZ[tank];
+					TFloat32 distanceSquared = dx * dx + dz * dz;
+					if (distanceSquared >= radiusSquared ||
+					    (numNeighbours == kMaxNeighbours && distanceSquared >= neighbourDistances[numNeighbours - 1]))
+					{
+						continue;
+					}
+
+					// Insert in order, dropping the furthest if the list is full
+					TUInt32 insert = (numNeighbours < kMaxNeighbours) ? numNeighbours++ : kMaxNeighbours - 1;
+					while (insert > 0 && neighbourDistances[insert - 1] > distanceSquared)
+					{
+						neighbours[insert] = neighbours[insert - 1];
+						neighbourDistances[insert] = neighbourDistances[insert - 1];
+						--insert;
+					}
+					neighbours[insert] = other;
+					neighbourDistances[insert] = distanceSquared;
+				}
+			}
+		}
+		m_NumNeighbours += numNeighbours;
+
+		// Fill the tank's slots, empty slots as a neighbour at the neighbour radius
+		const TFloat32 kMinDistance = 0.001f;
+		for (TUInt32 neighbour = 0; neighbour < kMaxNeighbours; ++neighbour)
+		{
+			TUInt32 slot = tank * kMaxNeighbours + neighbour;
+			m_Slots[Slot_HeadingX][slot] = kinematics.HeadingX()[tank];
+			m_Slots[Slot_HeadingZ][slot] = kinematics.HeadingZ()[tank];
+			if (neighbour >= numNeighbours)
+			{
+				m_Slots[Slot_AwayX][slot] = 0.0f;
+				m_Slots[Slot_AwayZ][slot] = 0.0f;
+				m_Slots[Slot_DistanceSquared][slot] = radiusSquared;
+			}
+			else if (neighbourDistances[neighbour] < kMinDistance * kMinDistance)
+			{
+				// Tanks in the same place separate in opposite directions
+				m_Slots[Slot_AwayX][slot] = (tank < neighbours[neighbour]) ? kMinDistance : -kMinDistance;
+				m_Slots[Slot_AwayZ][slot] = 0.0f;
+				m_Slots[Slot_DistanceSquared][slot] = kMinDistance * kMinDistance;
+			}
+			else
+			{
+				m_Slots[Slot_AwayX][slot] = posX[tank] - posX[neighbours[neighbour]];
+				m_Slots[Slot_AwayZ][slot] = posZ[tank] - posZ[neighbours[neighbour]];
+				m_Slots[Slot_DistanceSquared][slot] = neighbourDistances[neighbour];
+			}
+		}
+	}
+
+	// Padding slots are empty
+	for (TUInt32 slot = numTanks * kMaxNeighbours; slot < numSlots; ++slot)
+	{
+		m_Slots[Slot_AwayX][slot] = 0.0f;
+		m_Slots[Slot_AwayZ][slot] = 0.0f;
+		m_Slots[Slot_DistanceSquared][slot] = radiusSquared;
+		m_Slots[Slot_HeadingX][slot] = 0.0f;
+		m_Slots[Slot_HeadingZ][slot] = 0.0f;
+	}
+}
+
+// Calculate the forces for every slot. Each neighbour pushes the tank directly away, from
+// nothing at the neighbour radius to full strength at the separation distance and more when
+// closer. Neighbours close ahead of the tank make it slow down, to a stop at the separation
+// distance. Four slots at a time in SSE, with no branches
+void CSteering::CalculateForces()
+{
+	const TFloat32* awayX = m_Slots[Slot_AwayX].data();
+	const TFloat32* awayZ = m_Slots[Slot_AwayZ].data();
+	const TFloat32* distanceSquared = m_Slots[Slot_DistanceSquared].data();
+	const TFloat32* headingX = m_Slots[Slot_HeadingX].data();
+	const TFloat32* headingZ = m_Slots[Slot_HeadingZ].data();
+	TFloat32* forceX = m_Slots[Slot_ForceX].data();
+	TFloat32* forceZ = m_Slots[Slot_ForceZ].data();
+	TFloat32* crowding = m_Slots[Slot_Crowding].data();
+	TFloat32* brake = m_Slots[Slot_Brake].data();
+
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps( 1.0f );
+	const __m128 minAheadCos = _mm_set1_ps( 0.5f ); // Ahead is within 60 degrees of the heading
+	const __m128 neighbourRadius = _mm_set1_ps( m_NeighbourRadius );
+	const __m128 separationDistance = _mm_set1_ps( m_SeparationDistance );
+	const __m128 strengthScale = _mm_set1_ps( 1.0f / (m_NeighbourRadius - m_SeparationDistance) );
+	const __m128 separationScale = _mm_set1_ps( 1.0f / m_SeparationDistance );
+
+	// Arrays are padded so the last group of four is complete
+	TUInt32 numSlots = static_cast<TUInt32>(m_Slots[Slot_AwayX].size());
+	for (TUInt32 slot = 0; slot < numSlots; slot += 4)
+	{
+		__m128 distance = _mm_sqrt_ps( _mm_loadu_ps( distanceSquared + slot ) );
+		__m128 unitAwayX = _mm_div_ps( _mm_loadu_ps( awayX + slot ), distance );
+		__m128 unitAwayZ = _mm_div_ps( _mm_loadu_ps( awayZ + slot ), distance );
+		__m128 strength = _mm_mul_ps( _mm_sub_ps( neighbourRadius, distance ), strengthScale );
+		_mm_storeu_ps( forceX + slot, _mm_mul_ps( unitAwayX, strength ) );
+		_mm_storeu_ps( forceZ + slot, _mm_mul_ps( unitAwayZ, strength ) );
+		_mm_storeu_ps( crowding + slot, _mm_mul_ps( _mm_sub_ps( separationDistance, distance ), separationScale ) );
+
+		// Brake for neighbours ahead, selecting 1 for the others
+		__m128 aheadCos = _mm_sub_ps( zero, _mm_add_ps( _mm_mul_ps( unitAwayX, _mm_loadu_ps( headingX + slot ) ),
+		                                               _mm_mul_ps( unitAwayZ, _mm_loadu_ps( headingZ + slot ) ) ) );
+		__m128 ahead = _mm_cmpgt_ps( aheadCos, minAheadCos );
+		__m128 aheadBrake = _mm_max_ps( zero, _mm_mul_ps( _mm_sub_ps( distance, separationDistance ), separationScale ) );
+		_mm_storeu_ps( brake + slot, _mm_or_ps( _mm_and_ps( ahead, aheadBrake ), _mm_andnot_ps( ahead, one ) ) );
+	}
+}
+
+// Add the forces in each tank's slots to its wanted heading and speed
+void CSteering::ApplyForces( CKinematics& kinematics )
+{
+	TFloat32* desiredX = kinematics.DesiredX();
+	TFloat32* desiredZ = kinematics.DesiredZ();
+	TFloat32* desiredSpeed = kinematics.DesiredSpeed();
+	for (TUInt32 tank = 0; tank < kinematics.NumTanks(); ++tank)
+	{
+		if (!kinematics.CanMove( tank ))
+		{
+			continue;
+		}
+		TFloat32 separationX = 0.0f, separationZ = 0.0f;
+		TFloat32 brake = 1.0f;
+		TFloat32 crowding = 0.0f; // How far the nearest tank is inside the separation distance (0-1)
+		for (TUInt32 slot = tank * kMaxNeighbours; slot < (tank + 1) * kMaxNeighbours; ++slot)
+		{
+			separationX += m_Slots[Slot_ForceX][slot];
+			separationZ += m_Slots[Slot_ForceZ][slot];
+			crowding = Max( crowding, m_Slots[Slot_Crowding][slot] );
+			brake = Min( brake, m_Slots[Slot_Brake][slot] );
+		}
+
+		// A stationary tank only moves if crowded, straight away from the tanks around it
+		if (desiredSpeed[tank] <= 0.0f)
+		{
+			if (crowding > 0.0f)
+			{
+				desiredX[tank] = separationX;
+				desiredZ[tank] = separationZ;
+				desiredSpeed[tank] = kCrowdedSpeed * crowding;
+			}
+			continue;
+		}
+
+		// The wanted heading need not stay normalised, the integrator normalises it
+		desiredX[tank] += separationX * kSeparationWeight;
+		desiredZ[tank] += separationZ * kSeparationWeight;
+		desiredSpeed[tank] *= brake;
+	}
+}
+
+
+} // namespace gen
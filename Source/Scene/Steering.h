@@ -0,0 +1,146 @@
+/*******************************************
+	Steering.h
+
+	Separation steering between tanks
+	using a spatial hash
+********************************************/
+
+#pragma once
+
+#include <vector>
+using namespace std;
+
+#include "Defines.h"
+#include "SpatialHash.h"
+
+namespace gen
+{
+
+// Forward declaration of classes, where includes are only possible/necessary in the .cpp file
+class CKinematics;
+
+
+/*-----------------------------------------------------------------------------------------
+-------------------------------------------------------------------------------------------
+	Steering Class
+-------------------------------------------------------------------------------------------
+-----------------------------------------------------------------------------------------*/
+
+// Adjusts the movement each tank wants (held in CKinematics) to keep tanks apart, before the
+// movement is integrated:
+//  - Tanks are placed in a spatial hash of cells the size of the neighbour radius, so each tank
+//    only checks tanks in the 3x3 cells around it, and keeps at most kMaxNeighbours of the
+//    nearest. Total cost is O(n*k) rather than O(n^2)
+//  - Nearby tanks push the wanted heading away from them (separation), and tanks close ahead
+//    reduce the wanted speed (avoidance)
+//
+// The pass is split in stages so the arithmetic is done in SSE. The neighbour search gathers the
+// offset to each neighbour and the tank's heading into slot arrays (structure of arrays), a fixed
+// number of slots for each tank. The forces from all slots are then calculated in one SSE loop,
+// four slots at a time with no branches, and finally each tank adds up the forces in its slots
+//
+// Stationary tanks (e.g. aiming) are avoided like any other, and keep their facing unless another
+// tank comes within the separation distance. Then they move slowly away so tanks don't stay
+// pressed together. All tanks, including dead ones, are avoided but dead tanks are not steered
+class CSteering
+{
+/////////////////////////////////////
+//	Constructors/Destructors
+public:
+	// Constructor sets the distance tanks are kept apart (centre to centre) by separation, and
+	// the radius at which separation starts
+	CSteering( TFloat32 separationDistance = 4.0f, TFloat32 neighbourRadius = 8.0f )
+	{
+		m_SeparationDistance = separationDistance;
+		m_NeighbourRadius = neighbourRadius;
+		m_NumNeighbours = 0;
+	}
+
+private:
+	// Prevent use of copy constructor and assignment operator (private and not defined)
+	CSteering( const CSteering& );
+	CSteering& operator=( const CSteering& );
+
+
+/////////////////////////////////////
+//	Public interface
+public:
+
+	/////////////////////////////////////
+	// Update
+
+	// Add separation and avoidance from nearby tanks to the wanted movement of each tank
+	void Update( CKinematics& kinematics );
+
+
+	/////////////////////////////////////
+	// Statistics
+
+	// Total number of neighbours used by all tanks in the last update
+	TUInt32 NumNeighbours() const
+	{
+		return m_NumNeighbours;
+	}
+
+
+/////////////////////////////////////
+//	Private interface
+private:
+
+	// Maximum neighbours used by each tank
+	static const TUInt32 kMaxNeighbours = 6;
+
+	// Strength of separation relative to the wanted heading (which has length 1)
+	static const TFloat32 kSeparationWeight;
+
+	// Speed a stationary tank moves away from a tank at the same position, less when further
+	static const TFloat32 kCrowdedSpeed;
+
+	// Values held for each neighbour slot, each in its own array. The first are gathered by the
+	// neighbour search, the rest are the forces calculated from them
+	enum ESlotValue
+	{
+		Slot_AwayX,           // Offset from the neighbour to the tank
+		Slot_AwayZ,
+		Slot_DistanceSquared,
+		Slot_HeadingX,        // Heading of the tank
+		Slot_HeadingZ,
+		Slot_ForceX,          // Separation force on the tank
+		Slot_ForceZ,
+		Slot_Crowding,        // How far the neighbour is inside the separation distance (0-1)
+		Slot_Brake,           // Speed scale for a neighbour ahead, 1 otherwise
+		Slot_Count
+	};
+
+	// Put all tanks in the spatial hash, in cells the size of the neighbour radius
+	void BuildHash( const CKinematics& kinematics );
+
+	// Find the nearest neighbours of each tank that can move and gather them into its slots
+	void GatherNeighbours( const CKinematics& kinematics );
+
+	// Calculate the forces for every slot, four at a time
+	void CalculateForces();
+
+	// Add the forces in each tank's slots to its wanted heading and speed
+	void ApplyForces( CKinematics& kinematics );
+
+
+	// Spatial hash of the tanks, each in the one cell holding its position
+	CSpatialHash m_Hash;
+
+	// Neighbour slots, kMaxNeighbours for each tank - slot n of a tank is at index
+	// tank * kMaxNeighbours + n. Slots without a neighbour are gathered as a neighbour at the
+	// neighbour radius, which gives no force, so the force loop needn't check for them. Arrays
+	// are padded to a multiple of 4 with empty slots
+	vector<TFloat32> m_Slots[Slot_Count];
+
+	// Settings
+	TFloat32 m_SeparationDistance;
+	TFloat32 m_NeighbourRadius;
+
+	// Statistics
+	TUInt32 m_NumNeighbours;
+};
+
+
+} // namespace gen
@@ -9,20 +9,25 @@
 //   You will need to add other instance data suitable for the assignment requirements
 // - A function GetTankUID is defined in TankAssignment.cpp and made available here, which returns
 //   the UID of the tank on a given team. This can be used to get the enemy tank UID
-// - Tanks have three parts: the root, the body and the turret. Each part has its own matrix, which
-//   can be accessed with the Matrix function - root: Matrix(), body: Matrix(1), turret: Matrix(2)
-//   However, the body and turret matrix are relative to the root's matrix - so to get the actual 
-//   world matrix of the body, for example, we must multiply: Matrix(1) * Matrix()
+// - Tanks have three parts: the root, the body and the turret. Each part has its own transform,
+//   which can be accessed with the Transform function - root: Transform(), body: Transform(1),
+//   turret: Transform(2). However, the body and turret transform are relative to the root's
+//   transform - so to get the actual world transform of the body, for example, we must
+//   multiply: Transform(1) * Transform()
 // - Vector facing work similar to the car tag lab will be needed for the turret->enemy facing 
 //   requirements for the Patrol and Aim states
-// - The CMatrix4x4 function DecomposeAffineEuler allows you to extract the x,y & z rotations
-//   of a matrix. This can be used on the *relative* turret matrix to help in rotating it to face
-//   forwards in Evade state
-// - The CShellEntity class is simply an outline. To support shell firing, you will need to add
-//   member data to it and rewrite its constructor & update function. You will also need to update 
-//   the CreateShell function in EntityManager.cpp to pass any additional constructor data required
+// - The CQuatTransform function GetYaw returns the rotation around the Y axis directly from the
+//   quaternion. This can be used to help in rotating the turret to face forwards in Evade state
+// - Shells are not entities, they are fired into the projectile system (CProjectileSystem), which
+//   moves them and damages the tanks they hit
 // - Destroy an entity by returning false from its Update function - the entity manager wil perform
-//   the destruction. Don't try to call DestroyEntity from within the Update function.
+//   the destruction. Don't try to call DestroyEntity or the Create functions from within the
+//   Update function, record them in Commit with EntityManager.Commands() instead - the entity
+//   manager sets the tank as their creator, and they are applied at the end of the tick in the
+//   same order however many threads updated the tanks.
+// - Tanks are updated in parallel, so the Update function may only change this tank. Read other
+//   entities through their snapshots (EntityManager.GetSnapshot), and record any other changes
+//   to apply in Commit, which is called for each tank in turn after all updates.
 // - As entities can be destroyed, you must check that entity UIDs refer to existant entities, before
 //   using their entity pointers. The return value from EntityManager.GetEntity will be NULL if the
 //   entity no longer exists. Use this to avoid trying to target a tank that no longer exists etc.
@@ -30,6 +35,12 @@
 #include "TankEntity.h"
 #include "EntityManager.h"
 #include "Messenger.h"
+#include "VisibilityTable.h"
+#include "Blackboard.h"
+#include "AIScheduler.h"
+#include "Kinematics.h"
+#include "NavGrid.h"
+#include "ProjectileSystem.h"
 
 namespace gen
 {
@@ -39,6 +50,24 @@ namespace gen
 //    CVector3 targetPos = EntityManager.GetEntity( targetUID )->GetMatrix().Position();
 extern CEntityManager EntityManager;
 
+// Distances and line of sight between tanks, updated each tick in TankAssignment.cpp
+extern CVisibilityTable VisibilityTable;
+
+// Knowledge shared by each team - enemy sightings, ammo crates and requests for help
+extern CBlackboard Blackboard;
+
+// Spreads tank decision making across frames
+extern CAIScheduler AIScheduler;
+
+// Tank movement, integrated for all tanks after the AI has decided how they should move
+extern CKinematics Kinematics;
+
+// Navigation grid for driving around obstacles
+extern CNavGrid NavGrid;
+
+// Shells in flight
+extern CProjectileSystem Projectiles;
+
 // Messenger class for sending messages to and between entities
 extern CMessenger Messenger;
 
@@ -47,6 +76,31 @@ extern CMessenger Messenger;
 extern TEntityUID GetTankUID( int team );
 
 
+// A target further than this from the one the current path leads to needs a new path
+const TFloat32 kRepathDistance = 1.0f;
+
+// Distance from a waypoint at which the tank moves on to the next one
+const TFloat32 kWaypointRadius = 3.0f;
+
+// Turret turn rate when returning to face forward, per radian it is away from forward
+const TFloat32 kTurretReturnRate = 4.0f;
+
+// Extra turret turn speed used when aiming, so the turret closes on an enemy faster than it scans
+// on patrol (radians per second)
+const TFloat32 kAimTurretBoost = 0.1f;
+
+// Tanks responding to a help request head for the rally point together, then drive to their own
+// guard position within this distance of it
+const TFloat32 kRallyDistance = 15.0f;
+
+
+// Cosines of the turret angles used by the tank states. Facing tests compare the cosine of the
+// angle to the enemy with these, so no arc cosine is needed
+const TFloat32 kCosViewAngle    = Cos( ToRadians( 15.0f ) ); // Enemy seen by the turret
+const TFloat32 kCosPreciseAngle = Cos( ToRadians( 1.0f ) );  // Turret aimed precisely at enemy
+const TFloat32 kCosAnyAngle     = -1.0f;                     // Any direction, enemy only needs to be visible
+
+
 
 /*-----------------------------------------------------------------------------------------
 -------------------------------------------------------------------------------------------
@@ -70,11 +124,20 @@ CTankEntity::CTankEntity
 {
 	m_TankTemplate = tankTemplate;
 
+	// Tanks are never static, they always need updating
+	Wake();
+
 	// Tanks are on teams so they know who the enemy is
 	m_Team = team;
 
+	// Each tank has its own random numbers, seeded from its UID
+	m_RandomState = (UID + 1) * 2654435761u;
+
 	// Initialise other tank data and state
 	m_Speed = 0.0f;
+	m_DesiredHeading = CVector3::kZero;
+	m_DesiredSpeed = 0.0f;
+	m_TurretTurnRate = 0.0f;
 	m_HP = m_TankTemplate->GetMaxHP();
 	m_State = Inactive;
 	m_Timer = 0.0f;
@@ -84,6 +147,21 @@ CTankEntity::CTankEntity
 
 
 	PatrolPoints = patrolPoints;			
+
+	// Paths between patrol points are found as each leg is first driven
+	m_PatrolPaths.resize(PatrolPoints.size());
+	m_PatrolPathFound.resize(PatrolPoints.size(), false);
+
+	// Decision making is scheduled and movement steered for as long as the tank exists
+	AIScheduler.AddTank(GetUID());
+	Kinematics.AddTank(GetUID(), Transform().ZAxis());
+}
+
+// Tank destructor removes the tank from the AI scheduler and movement
+CTankEntity::~CTankEntity()
+{
+	AIScheduler.RemoveTank(GetUID());
+	Kinematics.RemoveTank(GetUID());
 }
 
 
@@ -94,7 +172,7 @@ bool CTankEntity::Update( TFloat32 updateTime )
 {
 	// Fetch any messages
 	SMessage msg;
-	while (Messenger.FetchMessage( GetUID(), &msg ))
+	while (m_Mailbox.FetchMessage( &msg ))
 	{
 		
 		// Set state variables based on received messages
@@ -107,31 +185,79 @@ bool CTankEntity::Update( TFloat32 updateTime )
 				m_State = Patrol;
 				break;
 			case Msg_Evade:
-				evadePosition = Position() + CVector3{ float(Random(1,40)), 0, float(Random(1,40)) };
-				m_State = Evade;
-				break;
-			case Msg_Help:
-				// Get tank that was hit
-				tankToGuard = msg.from;
-
-				// Get a guard position
-				isGuarding = true;
-				if (static_cast<CTankEntity*>(EntityManager.GetEntity(tankToGuard))->GetState() != "Dead")
+				// Choose an evade position that isn't inside an obstacle, if possible in a few tries
+				for (int attempt = 0; attempt < 4; ++attempt)
 				{
-					guardPosition = EntityManager.GetEntity(tankToGuard)->Position() + CVector3{ float(Random(-10,10)),0,float(Random(-10,10)) };
+					evadePosition = Position() + CVector3{ float(RandomInt(1,40)), 0, float(RandomInt(1,40)) };
+					if (NavGrid.IsWalkable(evadePosition))
+					{
+						break;
+					}
 				}
-				
-				// Move into aim state
-				m_State = Aim;			
+				m_State = Evade;
 				break;
 		}
 	}
 
-	// Tank behaviour
+	// Respond to the latest request for help from the team
+	CBlackboard::SHelpRequest helpRequest;
+	if (m_State != Dead && Blackboard.GetNewHelpRequest(m_Team, &lastHelpRequest, &helpRequest))
+	{
+		// Get tank that was hit
+		tankToGuard = helpRequest.tank;
+
+		// Get a guard position. There is nothing to guard if the tank has since died
+		const SEntitySnapshot* guardedTank = EntityManager.GetSnapshot(tankToGuard);
+		if (guardedTank != 0 && guardedTank->alive)
+		{
+			isGuarding = true;
+			guardRallyPoint = helpRequest.position;
+			guardPosition = helpRequest.position + CVector3{ float(RandomInt(-10,10)),0,float(RandomInt(-10,10)) };
+		}
+
+		// Move into aim state
+		m_State = Aim;
+	}
+
+	// If tank runs out of health set to dead state
+	if (m_HP <= 0 && m_State != Dead)
+	{
+		m_State = Dead;
+
+		// Enemies no longer need to track this tank, removed from the blackboard on commit
+		m_JustDied = true;
+	}
+
+	// Messages and death are handled every tick, but tanks with a lower level of detail only run
+	// their behaviour every few ticks (see CAIScheduler), with the time accumulated between. The
+	// movement integrator also only moves them on those ticks, by the same time (see GetMoveTime).
+	// Dead tanks must stop at once
+	m_LODTime += updateTime;
+	++m_LODTicks;
+	if (m_LODTicks < m_UpdateInterval && m_State != Dead)
+	{
+		m_MoveTime = 0.0f;
+		return true;
+	}
+	updateTime = m_LODTime;
+	m_MoveTime = m_LODTime;
+	m_LODTime = 0.0f;
+	m_LODTicks = 0;
+
+	// Only the patrol and aim states look at enemies
+	if (m_State == Patrol || m_State == Aim)
+	{
+		UpdateEnemyBearing();
+	}
+
+	// Tank behaviour. States that drive set a heading, otherwise the tank keeps its heading, and
+	// the turret is still unless a state turns it
+	m_DesiredHeading = CVector3::kZero;
+	m_TurretTurnRate = 0.0f;
 	if (m_State == Patrol)
 	{
 		// Set speed to template speed
-		m_Speed = m_TankTemplate->GetMaxSpeed();
+		m_DesiredSpeed = m_TankTemplate->GetMaxSpeed();
 
 		// Drive between patrol points
 
@@ -145,20 +271,18 @@ bool CTankEntity::Update( TFloat32 updateTime )
 			{
 				currentPatrolPoint = 0;
 			}
+			StartPatrolLeg(currentPatrolPoint);
 		}
-		Matrix(0).FaceTarget(PatrolPoints[currentPatrolPoint]);
+		DriveTo(PatrolPoints[currentPatrolPoint]);
 
 		// Spin the turret
-		Matrix(2).RotateY(ToRadians(m_TankTemplate->GetTurretTurnSpeed()));
+		m_TurretTurnRate = m_TankTemplate->GetTurretTurnSpeed();
 
 		// If enemy is in view
-		if (IsLookingAtEnemy(ToRadians(15)))
+		if (IsLookingAtEnemy(kCosViewAngle))
 		{
-			if (LineOfSight())
-			{
-				// Move to aim state
-				m_State = Aim;
-			}
+			// Move to aim state
+			m_State = Aim;
 		}
 	}
 	else if (m_State == Aim)
@@ -167,32 +291,37 @@ bool CTankEntity::Update( TFloat32 updateTime )
 		if (isGuarding)
 		{
 			// Set to guard state if tank is not already looking at enemy
-			if (!IsLookingAtEnemy(15))
+			if (!IsLookingAtEnemy(kCosAnyAngle))
 			{
 				m_State = Guard;
 			}
 		}
-		// Start timer if idle
+		// Start timer if idle. Timed by adding up update times rather than with a clock, so the
+		// tank behaves the same however long the updates take to run
 		if (timerStarted == false)
 		{
-			timer.Start();
+			m_AimTime = 0.0f;
 			timerStarted = true;
 		}
+		else
+		{
+			m_AimTime += updateTime;
+		}
 		
 		// Set speed to 0
-		m_Speed = 0;
+		m_DesiredSpeed = 0;
 
 		// If less than a second has passed
-		if (timer.GetTime() < 1)
+		if (m_AimTime < 1)
 		{	
 			// If tank is still looking at enemy
-			if (IsLookingAtEnemy(ToRadians(15)))
+			if (IsLookingAtEnemy(kCosViewAngle))
 			{
 				// If tank is not within a smaller angle
-				if (!IsLookingAtEnemy(ToRadians(1)) && !correctAim)
+				if (!IsLookingAtEnemy(kCosPreciseAngle) && !correctAim)
 				{
-					// Rotate the turret faster
-					Matrix(2).RotateY(ToRadians(m_TankTemplate->GetTurretTurnSpeed() + 0.1));
+					// Keep turning the turret towards the enemy, faster than on patrol
+					m_TurretTurnRate = m_TankTemplate->GetTurretTurnSpeed() + kAimTurretBoost;
 				}
 				else
 				{
@@ -205,20 +334,20 @@ bool CTankEntity::Update( TFloat32 updateTime )
 		else
 		{
 			// Stop and reset the timer
-			timer.Stop();
 			timerStarted = false;
-			timer.Reset();
 			correctAim = false;
 
-			// Get rotation of turret
-			CVector3 turretRotation;
-			(Matrix(0) * Matrix(2)).DecomposeAffineEuler(NULL, &turretRotation, NULL);
+			// Get direction of turret in the XZ plane
+			TFloat32 turretYaw = (Transform(2) * Transform(0)).GetYaw();
+			CVector3 turretDirection( Sin( turretYaw ), 0.0f, Cos( turretYaw ) );
 
 			// If the tank has ammo
 			if (ammunition > 0)
 			{
-				// Fire a shell
-				EntityManager.CreateShell("Shell Type 1", "", Position(), turretRotation, { 1,1,1 }, m_Team, m_TankTemplate->GetShellDamage());
+				// Fire a shell, it is added to the projectile system on commit
+				m_FireShell = true;
+				m_ShellPosition = Position();
+				m_ShellDirection = turretDirection;
 
 				// Increment shell count
 				m_ShellCount++;
@@ -236,7 +365,7 @@ bool CTankEntity::Update( TFloat32 updateTime )
 					// Move to evade state with new position
 					SMessage msg;
 					msg.type = Msg_Evade;
-					Messenger.SendMessageA(GetUID(), msg);
+					m_Mailbox.SendMessageA(GetUID(), msg);
 				}
 			}		
 			else
@@ -250,10 +379,10 @@ bool CTankEntity::Update( TFloat32 updateTime )
 	else if (m_State == Evade)
 	{
 		// Set speed to template speed
-		m_Speed = m_TankTemplate->GetMaxSpeed();
+		m_DesiredSpeed = m_TankTemplate->GetMaxSpeed();
 
 		// Face the new position
-		Matrix(0).FaceTarget(evadePosition);
+		DriveTo(evadePosition);
 
 		// Rotate turret to face body
 		FixTurret();
@@ -269,26 +398,25 @@ bool CTankEntity::Update( TFloat32 updateTime )
 	else if (m_State == Empty)
 	{
 		// Stop the tank
-		m_Speed = 0;
+		m_DesiredSpeed = 0;
 
 		FixTurret();
 
-		// Look for nearest ammo crate
-		FindNearestAmmo();
-
+		// Nearest ammo crate is found in Think
 		if (nearestAmmo != 0)
 		{
-			if (EntityManager.GetEntity(nearestAmmo))
+			const SEntitySnapshot* nearestAmmoSnapshot = EntityManager.GetSnapshot(nearestAmmo);
+			if (nearestAmmoSnapshot)
 			{
 				// Get ammo position
-				auto nearestAmmoPosition = EntityManager.GetEntity(nearestAmmo)->Position();
+				auto nearestAmmoPosition = nearestAmmoSnapshot->position;
 
 				// If ammo is on the floor
 				if (nearestAmmoPosition.y < 1)
 				{
 					// Face the ammo and move towards it
-					Matrix(0).FaceTarget(nearestAmmoPosition);
-					m_Speed = m_TankTemplate->GetMaxSpeed();
+					FlowTo(nearestAmmoPosition);
+					m_DesiredSpeed = m_TankTemplate->GetMaxSpeed();
 				}
 
 				// If close enough to the ammo
@@ -300,11 +428,14 @@ bool CTankEntity::Update( TFloat32 updateTime )
 					// Set back to patrol state
 					m_State = Patrol;
 
+					// Crate is no longer available to other tanks, removed from the blackboard on commit
+					m_CollectedAmmo = nearestAmmo;
+
 					// Send a collected message to the ammo (to destroy)
 					SMessage msg;
 					msg.from = GetUID();
 					msg.type = Msg_Collected;
-					Messenger.SendMessageA(nearestAmmo, msg);
+					m_Mailbox.SendMessageA(nearestAmmo, msg);
 				}
 
 			}				
@@ -316,8 +447,15 @@ bool CTankEntity::Update( TFloat32 updateTime )
 		FixTurret();
 
 		//Move to build guard formation around tank that was hit
-		Matrix(0).FaceTarget(guardPosition);
-		m_Speed = m_TankTemplate->GetMaxSpeed();
+		if (Distance(Position(), guardRallyPoint) > kRallyDistance)
+		{
+			FlowTo(guardRallyPoint);
+		}
+		else
+		{
+			DriveTo(guardPosition);
+		}
+		m_DesiredSpeed = m_TankTemplate->GetMaxSpeed();
 		if (Distance(Position(), guardPosition) < 2)
 		{
 			isGuarding = false;
@@ -326,19 +464,17 @@ bool CTankEntity::Update( TFloat32 updateTime )
 	}
 	else if (m_State == Dead)
 	{
-		// Stop the tank
+		// Stop the tank, it is no longer moved
+		m_DesiredSpeed = 0;
 		m_Speed = 0;
 
 		// If tank has not been broken yet
 		if (!broken)
 		{
-			// Rotate the body and turret randomly
-			Matrix(0).RotateX(ToRadians(Random(45, 90)));
-			Matrix(0).RotateY(ToRadians(Random(45, 90)));
-			Matrix(0).RotateZ(ToRadians(Random(45, 90)));
-			(Matrix(0) * Matrix(2)).RotateX(ToRadians(Random(45, 90)));
-			(Matrix(0) * Matrix(2)).RotateY(ToRadians(Random(45, 90)));
-			(Matrix(0) * Matrix(2)).RotateZ(ToRadians(Random(45, 90)));
+			// Rotate the tank randomly
+			Transform(0).RotateX(ToRadians(RandomInt(45, 90)));
+			Transform(0).RotateY(ToRadians(RandomInt(45, 90)));
+			Transform(0).RotateZ(ToRadians(RandomInt(45, 90)));
 
 			// Lower tank to the ground
 			Position() -= {0, 1, 0};
@@ -350,276 +486,276 @@ bool CTankEntity::Update( TFloat32 updateTime )
 	}
 	else
 	{
-		m_Speed = 0;
+		m_DesiredSpeed = 0;
 	}
 
-	// If tank runs out of health set to dead state
-	if (m_HP <= 0)
-	{
-		m_State = Dead;
-	}
-
-	// Perform movement...
-	// Move along local Z axis scaled by update time
-	Matrix().MoveLocalZ( m_Speed * updateTime );
+	// Movement is performed by steering once all tanks are updated
 
 	return true; // Don't destroy the entity
 }
 
-void CTankEntity::FixTurret()
+// Fetch messages sent to the tank, ready for the update
+void CTankEntity::ReceiveMessages()
 {
-	// Get rotation of body and rotation of turret
-	CVector3 bodyRotation;
-	Matrix(0).DecomposeAffineEuler(NULL, &bodyRotation, NULL);
-	CVector3 turretRotation;
-	(Matrix(0) * Matrix(2)).DecomposeAffineEuler(NULL, &turretRotation, NULL);
-
-	// Rotate the turret to match the body
-	if (turretRotation.y < bodyRotation.y - ToRadians(3))
-	{
-		Matrix(2).RotateY(0.02);
-	}
-	else if (turretRotation.y > bodyRotation.y + ToRadians(3))
-	{
-		Matrix(2).RotateY(0.02);
-	}
+	Messenger.FetchMessages( GetUID(), &m_Mailbox );
 }
 
-
-bool CTankEntity::IsLookingAtEnemy(float targetAngle)
+// Apply the changes to the rest of the world recorded in the update - send messages, fire the
+// shell, update the blackboard and find the paths and flow fields that weren't ready
+void CTankEntity::Commit()
 {
-	// Find the nearest enemy tank
-	FindNearestTank();
-
-	// Get world matrix of the turret
-	CMatrix4x4 turretWorldMatrix = Matrix(2) * Matrix();
-
-	CTankEntity* tankEntity = dynamic_cast<CTankEntity*>(EntityManager.GetEntity(nearestEnemyTank));
+	Messenger.SendMessages( &m_Mailbox );
 
-	//Check the tank is alive and is in line of sight
-	if ( tankEntity != 0 && tankEntity->GetState() != "Dead" && LineOfSight())
+	if (m_FireShell)
 	{
-		// Get position of nearest tank
-		CVector3 targetPosition = EntityManager.GetEntity(nearestEnemyTank)->Matrix().Position();
-		auto distanceVector = targetPosition - Position();
-		distanceVector.Normalise();
+		Projectiles.Fire( m_ShellPosition, m_ShellDirection, m_Team, m_TankTemplate->GetShellDamage() );
+		m_FireShell = false;
+	}
+	if (m_CollectedAmmo != 0)
+	{
+		Blackboard.RemoveAmmo( m_CollectedAmmo );
+		m_CollectedAmmo = 0;
+	}
+	if (m_JustDied)
+	{
+		Blackboard.RemoveSightings( GetUID() );
+		m_JustDied = false;
+	}
 
-		// Check if within view distance
-		if (Distance(targetPosition, Position()) > viewDistance)
+	// Searches use the navigation grid's budget, which is shared in the order tanks are committed.
+	// If the search is deferred again the update will ask for it again
+	if (m_PathRequested)
+	{
+		if (NavGrid.FindPath( m_PathRequestStart, m_PathRequestTarget, &m_Path ) != Nav_Deferred)
 		{
-			return false;
+			m_PathIndex = 0;
+			m_PathTarget = m_PathRequestTarget;
+			m_HasPath = true;
 		}
-
-		// Get facing vector of turret
-		auto turretFacingVector = turretWorldMatrix.ZAxis();
-		turretFacingVector.Normalise();
-
-		// Calculate dot product between distance vector and turret facing vector
-		auto dot = distanceVector.Dot(turretFacingVector);
-
-		// If the acos(result) is less than the supplied angle then tank is within sight
-		if (acos(dot) <= targetAngle)
+		m_PathRequested = false;
+	}
+	if (m_PatrolLegRequested >= 0)
+	{
+		int patrolPoint = m_PatrolLegRequested;
+		int previousPoint = (patrolPoint == 0) ? static_cast<int>(PatrolPoints.size()) - 1 : patrolPoint - 1;
+		if (NavGrid.FindPath( PatrolPoints[previousPoint], PatrolPoints[patrolPoint], &m_PatrolPaths[patrolPoint] ) != Nav_Deferred)
 		{
-			return true;
+			m_PatrolPathFound[patrolPoint] = true;
 		}
+		m_PatrolLegRequested = -1;
 	}
+	if (m_FlowGoalUsed)
+	{
+		NavGrid.UseFlowField( m_FlowGoal );
+		m_FlowGoalUsed = false;
+	}
+}
 
-	return false;
+// Random integer from a to b (inclusive). Uses the tank's own generator (xorshift) rather than the
+// shared one, so the numbers a tank gets don't depend on the order tanks are updated in
+TInt32 CTankEntity::RandomInt( TInt32 a, TInt32 b )
+{
+	m_RandomState ^= m_RandomState << 13;
+	m_RandomState ^= m_RandomState >> 17;
+	m_RandomState ^= m_RandomState << 5;
+	return a + static_cast<TInt32>(m_RandomState % static_cast<TUInt32>(b - a + 1));
+}
 
+// Set the desired heading towards a target, the movement integrator turns the tank
+void CTankEntity::SteerTowards(const CVector3& target)
+{
+	CVector3 toTarget = target - Position();
+	toTarget.y = 0.0f;
+	m_DesiredHeading = toTarget.IsZero() ? CVector3::kZero : Normalise(toTarget);
 }
 
-void CTankEntity::FindNearestTank()
+// Drive towards a target, following a path around obstacles. A path is found when the target
+// changes. Only cached paths are available during the update, otherwise the search is made on
+// commit. Until then, or if there is no path, drive straight at the target
+void CTankEntity::DriveTo(const CVector3& target)
 {
-	// For each tank
-	EntityManager.BeginEnumEntities("", "", "Tank");
-	CEntity* entity;
-	while (entity = EntityManager.EnumEntity())
+	if (!m_HasPath || Distance(target, m_PathTarget) > kRepathDistance)
 	{
-		CTankEntity* tankEntity = dynamic_cast<CTankEntity*>(entity);
-
-		// If the tank is an enemy and not dead
-		if (tankEntity->GetTeam() != m_Team && tankEntity->GetState() != "Dead")
+		if (NavGrid.FindPath(Position(), target, &m_Path) == Nav_Deferred)
 		{
-			if (EntityManager.GetEntity(nearestEnemyTank) == 0)
-			{
-				nearestEnemyTank = 0;
-			}
-			if (nearestEnemyTank == 0)
-			{
-				nearestTankDistance = 9999999;
-			}
-			else
-			{
-				// Calculate current nearest tank distance
-				nearestTankDistance = Distance(Position(), EntityManager.GetEntity(nearestEnemyTank)->Position());
-			}
+			m_PathRequested = true;
+			m_PathRequestStart = Position();
+			m_PathRequestTarget = target;
+			SteerTowards(target);
+			return;
+		}
+		m_PathIndex = 0;
+		m_PathTarget = target;
+		m_HasPath = true;
+	}
+
+	// Move on to the next waypoint when close to the current one, then face the waypoint
+	while (m_PathIndex + 1 < m_Path.size() && Distance(Position(), m_Path[m_PathIndex]) < kWaypointRadius)
+	{
+		++m_PathIndex;
+	}
+	SteerTowards(m_PathIndex < m_Path.size() ? m_Path[m_PathIndex] : target);
+}
 
-			// Calculate distance between tank and self 
-			auto tankDistance = Distance(Position(), tankEntity->Position());
+// Drive towards a goal shared with other tanks, using the goal's flow field. Falls back to a
+// path of our own if the field can't be used this frame. The field is kept (or built if
+// missing) on commit
+void CTankEntity::FlowTo(const CVector3& goal)
+{
+	m_FlowGoalUsed = true;
+	m_FlowGoal = goal;
 
-			// If within view distance
-			if (Distance(Position(), tankEntity->Position()) < viewDistance)
-			{
-				// Set tank as nearest current tank
-				if (tankDistance < nearestTankDistance)
-				{
-					nearestEnemyTank = entity->GetUID();
-				}
-			}
-		}
+	CVector3 target;
+	if (NavGrid.GetFlowTarget(Position(), goal, &target) == Nav_Found)
+	{
+		SteerTowards(target);
+	}
+	else
+	{
+		DriveTo(goal);
 	}
-	EntityManager.EndEnumEntities();
 }
 
-void CTankEntity::FindNearestAmmo()
+// Follow the path for the patrol leg ending at the given patrol point. The path is found the
+// first time the leg is driven and reused after that
+void CTankEntity::StartPatrolLeg(int patrolPoint)
 {
-	// For each ammo crate
-	EntityManager.BeginEnumEntities("", "", "Ammo");
-	CEntity* entity;
-	while (entity = EntityManager.EnumEntity())
+	if (!m_PatrolPathFound[patrolPoint])
 	{
-		if (EntityManager.GetEntity(nearestAmmo) == 0)
-		{
-			nearestAmmo = 0;
-		}
-		if (nearestAmmo == 0)
-		{
-			nearestAmmoDistance = 9999999;
-		}
-		else
+		int previousPoint = (patrolPoint == 0) ? static_cast<int>(PatrolPoints.size()) - 1 : patrolPoint - 1;
+		if (NavGrid.FindPath(PatrolPoints[previousPoint], PatrolPoints[patrolPoint], &m_PatrolPaths[patrolPoint]) == Nav_Deferred)
 		{
-			// Calculate current nearest ammo distance
-			nearestAmmoDistance = Distance(Position(), EntityManager.GetEntity(nearestAmmo)->Position());
+			// Search for the leg on commit, DriveTo will find a path from the current position instead
+			m_PatrolLegRequested = patrolPoint;
+			return;
 		}
-
-		// Calculate distance between ammo and self
-		auto tankDistance = Distance(Position(), entity->Position());
-
-		// If distance is less than current nearest distance
-		if (tankDistance < nearestAmmoDistance)
-		{
-			// Update current nearest distance 
-			nearestAmmo = entity->GetUID();
-		}		
+		m_PatrolPathFound[patrolPoint] = true;
 	}
-	EntityManager.EndEnumEntities();
+	m_Path = m_PatrolPaths[patrolPoint];
+	m_PathIndex = 0;
+	m_PathTarget = PatrolPoints[patrolPoint];
+	m_HasPath = true;
 }
 
-void CTankEntity::Hit(float damage)
+void CTankEntity::FixTurret()
 {
-	// Remove health amount determined by shell
-	m_HP -= damage;
+	// Get rotation of body and rotation of turret around the Y axis
+	float bodyYaw = Transform(0).GetYaw();
+	float turretYaw = (Transform(2) * Transform(0)).GetYaw();
+
+	// Rotate the turret back to match the body, slowing as it gets close. The turn rate is
+	// limited to the turret turn speed when the movement is integrated
+	float yawDifference = turretYaw - bodyYaw;
+	yawDifference -= 2.0f * kfPi * Floor(yawDifference / (2.0f * kfPi) + 0.5f);
+	if (Abs(yawDifference) > ToRadians(3))
+	{
+		m_TurretTurnRate = -yawDifference * kTurretReturnRate;
+	}
+}
 
-	// For each tank
-	EntityManager.BeginEnumEntities("", "", "Tank");
-	CEntity* entity;
-	while (entity = EntityManager.EnumEntity())
+
+// Decision making, called by the AI scheduler when this tank's turn comes rather than every
+// tick. Chooses the enemy to target and the ammo crate to collect, which the states then use
+void CTankEntity::Think()
+{
+	if (m_State == Patrol || m_State == Aim)
 	{
-		CTankEntity* tankEntity = dynamic_cast<CTankEntity*>(entity);
+		FindNearestTank();
+		m_Perception.enemy = nearestEnemyTank;
+		m_Perception.enemyDistance = nearestTankDistance;
 
-		// If tank is friendly, not dead and looking at an enemy
-		if (tankEntity->GetTeam() == m_Team && tankEntity->GetState() != "Dead")
+		// Let the team know where the enemy is
+		if (nearestEnemyTank != 0)
 		{
-			// Send a help message
-			SMessage msg;
-			msg.from = GetUID();
-			msg.type = Msg_Help;
-			Messenger.SendMessageA(entity->GetUID(), msg);
+			Blackboard.ReportSighting(m_Team, nearestEnemyTank, EntityManager.GetEntity(nearestEnemyTank)->Position());
 		}
-
+	}
+	else if (m_State == Empty)
+	{
+		FindNearestAmmo();
 	}
 }
 
-bool CTankEntity::LineOfSight()
+// Priority of decision making in the current state, 0 if the state makes no decisions. The AI
+// scheduler multiplies this by the time since the tank last thought
+TFloat32 CTankEntity::ThinkPriority()
 {
-	//https://stackoverflow.com/a/293052/17702967
-
-	CVector3 p1 = (Matrix(0)*Matrix(2)).Position();
-	CVector3 p2 = EntityManager.GetEntity(nearestEnemyTank)->Position();
-	CVector3 BL{ -7.36,0,-4.35 + 40 };
-	CVector3 TR{ 5.12,0,5.36 + 40 };
-	CVector3 BR{ 5.12,0,-4.35 + 40 };
-	CVector3 TL{ -7.36,0,5.36 + 40 };
-	vector<float> results;
-
-	//Check if the corners are all on one side of the line
-	
-	float x, z;
-	//Bottom left corner
-	x = BL.x; z = BL.z;
-	auto functBL = ((p2.z - p1.z) * x) + ((p1.x - p2.x) * z) + ((p2.x * p1.z) - (p1.x * p2.z));
-	results.push_back(functBL);
-
-	//Bottom right corner
-	x = BR.x; z = BR.z;
-	auto functBR = ((p2.z - p1.z) * x) + ((p1.x - p2.x) * z) + ((p2.x * p1.z) - (p1.x * p2.z));
-	results.push_back(functBR);
-
-	//Top left corner
-	x = TL.x; z = TL.z;
-	auto functTL = ((p2.z - p1.z) * x) + ((p1.x - p2.x) * z) + ((p2.x * p1.z) - (p1.x * p2.z));
-	results.push_back(functTL);
-
-	//Top right corner
-	x = TR.x; z = TR.z;
-	auto functTR = ((p2.z - p1.z) * x) + ((p1.x - p2.x) * z) + ((p2.x * p1.z) - (p1.x * p2.z));
-	results.push_back(functTR);
-
-
-	bool allPos = false;
-	bool allNeg = false;
-	bool posFound = false;
-	bool negFound = false;
-
-	for (auto& result : results)
+	switch (m_State)
 	{
-		if(result > 0)
-		{
-			posFound = true;
-			if (!negFound)
-			{
-				allPos = true;
-			}
-			else
-			{
-				allPos = false;
-			}
-		}
-		else if(result < 0)
-		{
-			negFound = true;
-			if (!posFound)
-			{
-				allNeg = true;
-			}
-			else
-			{
-				allNeg = false;
-			}
-		}
-		else
-		{
-			allPos = false;
-			allNeg = false;
-			posFound = true;
-			negFound = true;
-		}
+		case Aim:
+			return 2.0f; // Aiming needs an up to date target
+		case Patrol:
+			return 1.0f;
+		case Empty:
+			return 0.25f; // Crates appear every few seconds, no need to look often
+		default:
+			return 0.0f;
 	}
+}
+
+// Fastest the tank may turn its turret (radians per second), the template speed plus the boost
+// used when aiming
+TFloat32 CTankEntity::GetMaxTurretTurnRate()
+{
+	return m_TankTemplate->GetTurretTurnSpeed() + kAimTurretBoost;
+}
 
-	if (allPos || allNeg)
+// Update the turret bearing to the enemy chosen in Think. The bearing changes every tick as
+// the turret turns, but is cheap to calculate
+void CTankEntity::UpdateEnemyBearing()
+{
+	m_Perception.enemyBearingCos = -1.0f;
+	const SEntitySnapshot* enemy = EntityManager.GetSnapshot(m_Perception.enemy);
+	if (enemy == 0 || !enemy->alive)
 	{
-		//All corners are on the same side of the line
-		return true;
+		m_Perception.enemy = 0;
+		return;
 	}
-	else
+
+	// Cosine of angle between turret facing and direction to enemy is the dot product of the two
+	CVector3 enemyDirection = enemy->position - Position();
+	enemyDirection.Normalise();
+	CQuatTransform turretWorldTransform = Transform(2) * Transform();
+	m_Perception.enemyBearingCos = enemyDirection.Dot(turretWorldTransform.ZAxis());
+}
+
+// Check if enemy tank is being looked at, within an angle given by its cosine. Uses the
+// cached perception results
+bool CTankEntity::IsLookingAtEnemy(TFloat32 cosAngle)
+{
+	return m_Perception.enemy != 0 && m_Perception.enemyBearingCos >= cosAngle;
+}
+
+// Find closest enemy tank that can be seen, using the visibility table
+void CTankEntity::FindNearestTank()
+{
+	nearestEnemyTank = 0;
+
+	// Distances and line of sight between tanks are calculated once per tick for all tanks
+	TUInt32 self, enemy;
+	if (VisibilityTable.FindTank(GetUID(), &self) && VisibilityTable.FindNearestVisibleEnemy(self, &enemy))
 	{
-		if (p1.x > TR.x && p2.x > TR.x) { return true; } // To the right
-		else if (p1.x < BL.x && p2.x < BL.x) { return true; } // To the left
-		else if (p1.z > TR.z && p2.z > TR.z) { return true; } // Above
-		else if (p1.z < BL.z && p2.z < BL.z) { return true; } // Below
-		else { return false; } //Intersection
+		nearestEnemyTank = VisibilityTable.GetTankUID(enemy);
+		nearestTankDistance = VisibilityTable.GetDistance(self, enemy);
 	}
 }
 
+// Find closest ammo crate on the ground, using the blackboard
+void CTankEntity::FindNearestAmmo()
+{
+	nearestAmmo = 0;
+	Blackboard.FindNearestAmmo(Position(), &nearestAmmo, &nearestAmmoDistance);
+}
+
+// Hit tank
+void CTankEntity::Hit(float damage)
+{
+	// Remove health amount determined by shell
+	m_HP -= damage;
+
+	// Ask the team for help
+	Blackboard.RequestHelp(m_Team, GetUID(), Position());
+}
+
 
 } // namespace gen
@@ -12,7 +12,7 @@ using namespace std;
 #include "Defines.h"
 #include "CVector3.h"
 #include "Entity.h"
-#include "CTimer.h"
+#include "Messenger.h"
 
 namespace gen
 {
@@ -136,8 +136,9 @@ public:
 		const vector<CVector3> patrolPoints = {}
 	);
 
-	// No destructor needed
-	
+	// Tank destructor removes the tank from the AI scheduler
+	~CTankEntity();
+
 
 
 /////////////////////////////////////
@@ -203,31 +204,113 @@ public:
 		return m_Team;
 	}
 
+	bool IsAlive()
+	{
+		return m_State != Dead;
+	}
+
+	// Direction (XZ plane, unit length) and speed the tank wants to move at, used by steering and
+	// the movement integrator. A zero direction keeps the current heading
+	const CVector3& GetDesiredHeading()
+	{
+		return m_DesiredHeading;
+	}
+
+	TFloat32 GetDesiredSpeed()
+	{
+		return m_DesiredSpeed;
+	}
+
+	// Rate the tank wants to turn its turret at (radians per second)
+	TFloat32 GetDesiredTurretTurnRate()
+	{
+		return m_TurretTurnRate;
+	}
+
+	// Fastest the tank may turn its turret (radians per second), the template speed plus the boost
+	// used when aiming
+	TFloat32 GetMaxTurretTurnRate();
+
+	// Time the movement integrator should move the tank by this tick. Tanks with a lower level of
+	// detail move only on ticks they run their behaviour, by the time since they last moved, and
+	// have 0 on other ticks
+	TFloat32 GetMoveTime()
+	{
+		return m_MoveTime;
+	}
+
+	/////////////////////////////////////
+	// Setters
+
+	// Set number of ticks between behaviour updates, used for AI level of detail
+	void SetUpdateInterval(TUInt32 ticks)
+	{
+		m_UpdateInterval = ticks;
+	}
+
+	// Set current speed, after the movement integrator has moved the tank
+	void SetSpeed(TFloat32 speed)
+	{
+		m_Speed = speed;
+	}
+
 	/////////////////////////////////////
 	// Update
 
+	// Fetch messages sent to the tank, ready for the update
+	virtual void ReceiveMessages();
+
 	// Update the tank - performs tank message processing and behaviour
 	// Return false if the entity is to be destroyed
 	// Keep as a virtual function in case of further derivation
 	virtual bool Update( TFloat32 updateTime );
+
+	// Apply the changes to the rest of the world recorded in the update - send messages, fire the
+	// shell, update the blackboard and find the paths and flow fields that weren't ready
+	virtual void Commit();
 	 
-	// Check if enemy tank is being looked at
-	bool IsLookingAtEnemy(float targetAngle);
+	// Decision making, called by the AI scheduler when this tank's turn comes rather than every
+	// tick. Chooses the enemy to target and the ammo crate to collect, which the states then use
+	void Think();
+
+	// Priority of decision making in the current state, 0 if the state makes no decisions. The AI
+	// scheduler multiplies this by the time since the tank last thought
+	TFloat32 ThinkPriority();
 
-	// Find closest tank
+	// Update the turret bearing to the enemy chosen in Think. The bearing changes every tick as
+	// the turret turns, but is cheap to calculate
+	void UpdateEnemyBearing();
+
+	// Check if enemy tank is being looked at, within an angle given by its cosine. Uses the
+	// cached perception results
+	bool IsLookingAtEnemy(TFloat32 cosAngle);
+
+	// Find closest enemy tank that can be seen, using the visibility table
 	void FindNearestTank();
 
-	// Find closest ammo
+	// Find closest ammo crate on the ground, using the blackboard
 	void FindNearestAmmo();
 
 	// Hit tank
 	void Hit(float damage);
 
-	// Check line of sight
-	bool LineOfSight();
-
 	//Rotate turret back to face body
 	void FixTurret();
+
+	// Set the desired heading towards a target, the movement integrator turns the tank
+	void SteerTowards(const CVector3& target);
+
+	// Drive towards a target, following a path around obstacles
+	void DriveTo(const CVector3& target);
+
+	// Drive towards a goal shared with other tanks, using the goal's flow field
+	void FlowTo(const CVector3& goal);
+
+	// Follow the path for the patrol leg ending at the given patrol point
+	void StartPatrolLeg(int patrolPoint);
+
+	// Random integer from a to b (inclusive), from the tank's own generator
+	TInt32 RandomInt(TInt32 a, TInt32 b);
 	
 
 /////////////////////////////////////
@@ -247,6 +330,14 @@ private:
 		Dead,
 		Guard
 	};
+	// Perception results. The enemy is chosen in Think, the bearing is updated every tick
+	struct SPerception
+	{
+		TEntityUID enemy;           // Nearest visible enemy when last thought, 0 if none
+		TFloat32   enemyDistance;   // Distance to the enemy
+		TFloat32   enemyBearingCos; // Cosine of angle between turret facing and direction to enemy
+	};
+
 	/////////////////////////////////////
 	// Data
 
@@ -258,6 +349,12 @@ private:
 	TFloat32 m_Speed; // Current speed (in facing direction)
 	TInt32   m_HP;    // Current hit points for the tank
 
+	// Movement wanted by the AI, applied by the movement integrator (see CKinematics). Turret turn
+	// rate is radians per second, positive is clockwise seen from above
+	CVector3 m_DesiredHeading;
+	TFloat32 m_DesiredSpeed;
+	TFloat32 m_TurretTurnRate;
+
 	// Tank state
 	EState   m_State; // Current state
 	TFloat32 m_Timer; // A timer used in the example update function   
@@ -278,7 +375,7 @@ private:
 	CVector3 evadePosition;
 
 	// Aim variables
-	CTimer timer;
+	TFloat32 m_AimTime = 0.0f; // Time spent aiming so far
 	bool timerStarted = false;
 	bool correctAim = false;
 
@@ -286,8 +383,27 @@ private:
 	TEntityUID nearestEnemyTank = 0;
 	TFloat32 nearestTankDistance;
 
+	// Cached perception results
+	SPerception m_Perception = {};
+
+	// Navigation - path being followed, index of the next waypoint and the target it leads to
+	vector<CVector3> m_Path;
+	TUInt32  m_PathIndex = 0;
+	CVector3 m_PathTarget;
+	bool     m_HasPath = false;
+
+	// Paths for each patrol leg, indexed by the patrol point the leg ends at
+	vector<vector<CVector3>> m_PatrolPaths;
+	vector<bool>             m_PatrolPathFound;
+
+	// Level of detail - ticks between behaviour updates, time and ticks since the last one, and
+	// the time to move by this tick
+	TUInt32  m_UpdateInterval = 1;
+	TFloat32 m_LODTime = 0.0f;
+	TUInt32  m_LODTicks = 0;
+	TFloat32 m_MoveTime = 0.0f;
+
 	// Combat variables
-	int viewDistance = 100;
 	int ammunition = 10;
 	int m_ShellCount = 0; // Number of times tank has fired
 
@@ -298,9 +414,30 @@ private:
 	//If tank has been rotated
 	bool broken = false;
 
-	bool isGuarding = false;
-	CVector3 guardPosition;
+	bool isGuarding = false; // Guard position and rally point are only set while guarding
+	CVector3 guardPosition = CVector3::kOrigin;
+	CVector3 guardRallyPoint = CVector3::kOrigin; // Position of the help request, shared by all tanks responding
 	TEntityUID tankToGuard;
+	TUInt32 lastHelpRequest = 0; // Serial of the last team help request responded to
+
+	// Messages received and sent in the update
+	CMailbox m_Mailbox;
+
+	// State of the tank's random number generator
+	TUInt32 m_RandomState;
+
+	// Changes to the rest of the world made in the update, applied on commit (see Commit)
+	bool       m_FireShell = false;
+	CVector3   m_ShellPosition;
+	CVector3   m_ShellDirection;
+	TEntityUID m_CollectedAmmo = 0;  // Crate to remove from the blackboard, 0 if none
+	bool       m_JustDied = false;   // Remove sightings of this tank from the blackboard
+	bool       m_PathRequested = false;
+	CVector3   m_PathRequestStart;
+	CVector3   m_PathRequestTarget;
+	int        m_PatrolLegRequested = -1; // Patrol point of a leg to find a path for, -1 if none
+	bool       m_FlowGoalUsed = false;
+	CVector3   m_FlowGoal;
 
 };
 } // namespace gen
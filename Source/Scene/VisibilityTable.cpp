@@ -0,0 +1,164 @@
+/*******************************************
+	VisibilityTable.cpp
+
+	Distances and line of sight between
+	all live tanks, updated once per tick
+********************************************/
+
+#include "VisibilityTable.h"
+#include "EntityManager.h"
+#include "TankEntity.h"
+#include "ObstacleBVH.h"
+
+namespace gen
+{
+
+/*-----------------------------------------------------------------------------------------
+	Update
+-----------------------------------------------------------------------------------------*/
+
+// Rebuild the table from the live tanks in the entity manager. Line of sight is blocked by
+// the given obstacles and limited to the given view distance
+void CVisibilityTable::Update( CEntityManager& entityManager, const CObstacleBVH& obstacles,
+                               TFloat32 viewDistance )
+{
+	Clear();
+
+	// Gather live tanks, positions are at the turret
+	entityManager.BeginEnumEntities( "", "", "Tank" );
+	CEntity* entity;
+	while (entity = entityManager.EnumEntity())
+	{
+		CTankEntity* tank = static_cast<CTankEntity*>(entity);
+		if (tank->IsAlive())
+		{
+			CVector3 turretPosition = (tank->Transform( 2 ) * tank->Transform( 0 )).pos;
+			m_UIDMap.SetKeyValue( tank->GetUID(), NumTanks() );
+			m_UIDs.push_back( tank->GetUID() );
+			m_Teams.push_back( tank->GetTeam() );
+			m_PosX.push_back( turretPosition.x );
+			m_PosY.push_back( turretPosition.y );
+			m_PosZ.push_back( turretPosition.z );
+		}
+	}
+	entityManager.EndEnumEntities();
+
+	TUInt32 numTanks = NumTanks();
+	if (numTanks < 2)
+	{
+		return;
+	}
+	m_DistancesSquared.resize( numTanks * (numTanks - 1) / 2 );
+	m_Visible.resize( m_DistancesSquared.size() );
+
+	// Each row of pairs is independent of the others, so rows could be split between threads
+	TFloat32 viewDistanceSquared = viewDistance * viewDistance;
+	for (TUInt32 row = 0; row < numTanks - 1; ++row)
+	{
+		TUInt32 rowStart = RowStart( row );
+		TFloat32* rowDistances = &m_DistancesSquared[rowStart];
+		TUInt8* rowVisible = &m_Visible[rowStart];
+
+		// Distances to all later tanks. No dependencies between iterations so this vectorises
+		const TFloat32 x = m_PosX[row];
+		const TFloat32 y = m_PosY[row];
+		const TFloat32 z = m_PosZ[row];
+		for (TUInt32 col = row + 1; col < numTanks; ++col)
+		{
+			TFloat32 dx = m_PosX[col] - x;
+			TFloat32 dy = m_PosY[col] - y;
+			TFloat32 dz = m_PosZ[col] - z;
+			rowDistances[col - row - 1] = dx*dx + dy*dy + dz*dz;
+		}
+
+		// Line of sight is the expensive part, only test enemies within view distance
+		SSegment sight;
+		sight.start = CVector3( x, y, z );
+		for (TUInt32 col = row + 1; col < numTanks; ++col)
+		{
+			rowVisible[col - row - 1] = 0;
+			if (m_Teams[col] != m_Teams[row] && rowDistances[col - row - 1] < viewDistanceSquared)
+			{
+				sight.end = CVector3( m_PosX[col], m_PosY[col], m_PosZ[col] );
+				rowVisible[col - row - 1] = obstacles.IsOccluded( sight ) ? 0 : 1;
+			}
+		}
+	}
+}
+
+// Remove all tanks
+void CVisibilityTable::Clear()
+{
+	m_UIDs.clear();
+	m_UIDMap.RemoveAllKeys();
+	m_Teams.clear();
+	m_PosX.clear();
+	m_PosY.clear();
+	m_PosZ.clear();
+	m_DistancesSquared.clear();
+	m_Visible.clear();
+}
+
+
+/*-----------------------------------------------------------------------------------------
+	Queries
+-----------------------------------------------------------------------------------------*/
+
+// Find the index of a tank in the table from its UID. Returns false if the tank is not in
+// the table (destroyed or dead at the last update)
+bool CVisibilityTable::FindTank( TEntityUID UID, TUInt32* pIndex ) const
+{
+	return m_UIDMap.LookUpKey( UID, pIndex );
+}
+
+// Find the nearest enemy that a tank can see. Returns false if it can see no enemies
+bool CVisibilityTable::FindNearestVisibleEnemy( TUInt32 tank, TUInt32* pEnemy ) const
+{
+	bool found = false;
+	TFloat32 nearestDistanceSquared = 0.0f;
+	for (TUInt32 other = 0; other < NumTanks(); ++other)
+	{
+		if (other != tank)
+		{
+			TUInt32 pair = PairIndex( tank, other );
+			if (m_Visible[pair] && (!found || m_DistancesSquared[pair] < nearestDistanceSquared))
+			{
+				nearestDistanceSquared = m_DistancesSquared[pair];
+				*pEnemy = other;
+				found = true;
+			}
+		}
+	}
+	return found;
+}
+
+// Return true if any tank of the given team can see the given tank
+bool CVisibilityTable::IsVisibleToTeam( TUInt32 tank, TUInt32 team ) const
+{
+	for (TUInt32 other = 0; other < NumTanks(); ++other)
+	{
+		if (other != tank && m_Teams[other] == team && IsVisible( tank, other ))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+// Distance from a tank to its nearest enemy, whether visible or not. Returns a very large
+// distance if there are no enemies
+TFloat32 CVisibilityTable::GetNearestEnemyDistance( TUInt32 tank ) const
+{
+	TFloat32 nearestDistanceSquared = 1e30f;
+	for (TUInt32 other = 0; other < NumTanks(); ++other)
+	{
+		if (other != tank && m_Teams[other] != m_Teams[tank])
+		{
+			nearestDistanceSquared = Min( nearestDistanceSquared, m_DistancesSquared[PairIndex( tank, other )] );
+		}
+	}
+	return (nearestDistanceSquared < 1e30f) ? Sqrt( nearestDistanceSquared ) : nearestDistanceSquared;
+}
+
+
+} // namespace gen
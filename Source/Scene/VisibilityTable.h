@@ -0,0 +1,160 @@
+/*******************************************
+	VisibilityTable.h
+
+	Distances and line of sight between
+	all live tanks, updated once per tick
+********************************************/
+
+#pragma once
+
+#include <vector>
+using namespace std;
+
+#include "Defines.h"
+#include "Error.h"
+#include "CHashTable.h"
+#include "Entity.h"
+
+namespace gen
+{
+
+// Forward declaration of classes, where includes are only possible/necessary in the .cpp file
+class CEntityManager;
+class CObstacleBVH;
+
+
+/*-----------------------------------------------------------------------------------------
+-------------------------------------------------------------------------------------------
+	Visibility Table Class
+-------------------------------------------------------------------------------------------
+-----------------------------------------------------------------------------------------*/
+
+// Holds the distance between every pair of live tanks and whether each pair of enemies can see
+// each other. Distance and line of sight are symmetric, so each pair is evaluated once per tick
+// rather than by both tanks (and again by any other tank interested in the pair). Line of sight
+// is only tested for enemy pairs within the view distance, and is taken between turret positions
+//
+// Tanks are referred to by their index in the table, which is valid until the next update
+class CVisibilityTable
+{
+/////////////////////////////////////
+//	Constructors/Destructors
+public:
+	// Constructor creates an empty table
+	CVisibilityTable() : m_UIDMap( 256, JOneAtATimeHash ) {}
+
+private:
+	// Prevent use of copy constructor and assignment operator (private and not defined)
+	CVisibilityTable( const CVisibilityTable& );
+	CVisibilityTable& operator=( const CVisibilityTable& );
+
+
+/////////////////////////////////////
+//	Public interface
+public:
+
+	/////////////////////////////////////
+	// Update
+
+	// Rebuild the table from the live tanks in the entity manager. Line of sight is blocked by
+	// the given obstacles and limited to the given view distance
+	void Update( CEntityManager& entityManager, const CObstacleBVH& obstacles,
+	             TFloat32 viewDistance );
+
+	// Remove all tanks
+	void Clear();
+
+
+	/////////////////////////////////////
+	// Queries
+
+	// Find the index of a tank in the table from its UID. Returns false if the tank is not in
+	// the table (destroyed or dead at the last update)
+	bool FindTank( TEntityUID UID, TUInt32* pIndex ) const;
+
+	// Distance between two different tanks
+	TFloat32 GetDistance( TUInt32 tank1, TUInt32 tank2 ) const
+	{
+		return Sqrt( m_DistancesSquared[PairIndex( tank1, tank2 )] );
+	}
+
+	// Return true if two different tanks are enemies that can see each other - within view
+	// distance and with no obstacles between them
+	bool IsVisible( TUInt32 tank1, TUInt32 tank2 ) const
+	{
+		return m_Visible[PairIndex( tank1, tank2 )] != 0;
+	}
+
+	// Find the nearest enemy that a tank can see. Returns false if it can see no enemies
+	bool FindNearestVisibleEnemy( TUInt32 tank, TUInt32* pEnemy ) const;
+
+	// Return true if any tank of the given team can see the given tank
+	bool IsVisibleToTeam( TUInt32 tank, TUInt32 team ) const;
+
+	// Distance from a tank to its nearest enemy, whether visible or not. Returns a very large
+	// distance if there are no enemies
+	TFloat32 GetNearestEnemyDistance( TUInt32 tank ) const;
+
+
+	/////////////////////////////////////
+	// Getters
+
+	TUInt32 NumTanks() const
+	{
+		return static_cast<TUInt32>(m_UIDs.size());
+	}
+
+	TEntityUID GetTankUID( TUInt32 tank ) const
+	{
+		return m_UIDs[tank];
+	}
+
+	TUInt32 GetTankTeam( TUInt32 tank ) const
+	{
+		return m_Teams[tank];
+	}
+
+
+/////////////////////////////////////
+//	Private interface
+private:
+
+	// Index of the data for a pair of different tanks. Pairs are stored in rows, row i holds the
+	// pairs (i, j) for j > i, so there are n(n-1)/2 in total
+	TUInt32 PairIndex( TUInt32 tank1, TUInt32 tank2 ) const
+	{
+		GEN_ASSERT( tank1 != tank2, "No pair data for a tank with itself" );
+		if (tank1 > tank2)
+		{
+			TUInt32 temp = tank1;
+			tank1 = tank2;
+			tank2 = temp;
+		}
+		return RowStart( tank1 ) + (tank2 - tank1 - 1);
+	}
+
+	// Index of the first pair in a row
+	TUInt32 RowStart( TUInt32 row ) const
+	{
+		return row * (2 * NumTanks() - row - 1) / 2;
+	}
+
+
+	// Tank data, positions in separate arrays of x, y and z so distances can be vectorised
+	vector<TEntityUID> m_UIDs;
+	vector<TUInt32>    m_Teams;
+	vector<TFloat32>   m_PosX;
+	vector<TFloat32>   m_PosY;
+	vector<TFloat32>   m_PosZ;
+
+	// Map from tank UID to index in the table. Looking up a key doesn't change the table, but
+	// the hash table has no const look up
+	mutable CHashTable<TEntityUID, TUInt32> m_UIDMap;
+
+	// Pair data - squared distance and enemy visibility (1 if visible)
+	vector<TFloat32> m_DistancesSquared;
+	vector<TUInt8>   m_Visible;
+};
+
+
+} // namespace gen
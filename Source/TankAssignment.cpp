@@ -13,10 +13,21 @@ using namespace std;
 
 #include "Defines.h"
 #include "CVector3.h"
+#include "CJobSystem.h"
+#include "RenderThread.h"
 #include "Camera.h"
 #include "Light.h"
 #include "EntityManager.h"
 #include "Messenger.h"
+#include "ObstacleBVH.h"
+#include "VisibilityTable.h"
+#include "Blackboard.h"
+#include "AIScheduler.h"
+#include "NavGrid.h"
+#include "Kinematics.h"
+#include "Steering.h"
+#include "CollisionSystem.h"
+#include "ProjectileSystem.h"
 #include "XML/CParseLevel.h"
 #include "TankAssignment.h"
 
@@ -34,6 +45,27 @@ float CameraMoveSpeed = 80.0f;
 // Amount of time to pass before calculating new average update time
 const float UpdateTimePeriod = 1.0f;
 
+// Distance at which tanks can see enemies
+const float TankViewDistance = 100.0f;
+
+// Number of tanks allowed to make decisions each frame
+const TUInt32 AIThinkBudget = 32;
+
+// Navigation grid area, cell size and the clearance tanks need around obstacles
+const CVector3 NavGridMin( -256.0f, 0.0f, -256.0f );
+const CVector3 NavGridMax( 256.0f, 0.0f, 256.0f );
+const float NavCellSize = 2.0f;
+const float TankRadius = 2.0f;
+
+// Tanks steer to stay this far apart (centre to centre) and consider others within this range
+const float TankSeparation = 2.0f * TankRadius;
+const float TankNeighbourRadius = 4.0f * TankRadius;
+
+// Shell speed, time before it expires (seconds) and radius
+const float ShellSpeed = 100.0f;
+const float ShellLifeTime = 2.0f;
+const float ShellRadius = 0.25f;
+
 
 //-----------------------------------------------------------------------------
 // Global system variables
@@ -62,10 +94,41 @@ extern CMessenger Messenger;
 // Global game/scene variables
 //-----------------------------------------------------------------------------
 
+// Worker threads, entities are updated in parallel on them
+CJobSystem JobSystem;
+
+// Draws each frame while the next is simulated
+CRenderThread RenderThread;
+
 // Entity manager
 CEntityManager EntityManager;
 CParseLevel LevelParser(&EntityManager);
 
+// Static obstacles for line of sight, built once the level is set up
+CObstacleBVH ObstacleBVH;
+
+// Distances and line of sight between tanks, updated at the start of each tick
+CVisibilityTable VisibilityTable;
+
+// Knowledge shared by each team - enemy sightings, ammo crates and requests for help
+CBlackboard Blackboard;
+
+// Spreads tank decision making across frames
+CAIScheduler AIScheduler( AIThinkBudget );
+
+// Navigation grid for driving around obstacles, built once the level is set up
+CNavGrid NavGrid;
+
+// Tank movement, integrated for all tanks once the AI has decided how they should move, after
+// steering has adjusted the movement to keep tanks apart. Collisions are then resolved before
+// the tanks are moved
+CKinematics Kinematics;
+CSteering Steering( TankSeparation, TankNeighbourRadius );
+CCollisionSystem Collisions( TankRadius );
+
+// Shells in flight, moved and hit-tested once the tanks have moved
+CProjectileSystem Projectiles( ShellSpeed, ShellLifeTime, TankRadius, ShellRadius );
+
 // Other scene elements
 const int NumLights = 2;
 CLight*  Lights[NumLights];
@@ -108,9 +171,13 @@ bool SceneSetup()
 	InitInput();
 	InitialiseMethods();
 
+	// One job thread for each hardware thread, including this one
+	JobSystem.Start();
+
 
 	//Load entities from xml
 	LevelParser.ParseFile("Entities.xml");
+	Projectiles.SetTemplate(EntityManager.GetTemplate("Shell Type 1"));
 
 	//Create tree entities
 	for (int i = 0; i < treeNum; i++)
@@ -124,9 +191,14 @@ bool SceneSetup()
 	while (entity = EntityManager.EnumEntity())
 	{
 		entity->Position() = CVector3(Random(-200.0f, 30.0f), 0.0f, Random(40.0f, 150.0f));
-		entity->Matrix().RotateY(Random(0.0f, 2.0f * kfPi));
+		entity->Transform().RotateY(Random(0.0f, 2.0f * kfPi));
 	}
 
+	// All scenery is placed, gather obstacles for line of sight tests
+	ObstacleBVH.Build(EntityManager);
+	NavGrid.Build(ObstacleBVH, NavGridMin, NavGridMax, NavCellSize, TankRadius);
+	Collisions.SetObstacles(ObstacleBVH);
+
 	/////////////////////////////
 	// Camera / light setup
 
@@ -141,6 +213,9 @@ bool SceneSetup()
 	// Ambient light level
 	AmbientLight = SColourRGBA(0.6f, 0.6f, 0.6f, 1.0f);
 
+	// Everything is loaded, from now on frames are drawn on the render thread
+	RenderThread.Start( DrawScene );
+
 	return true;
 }
 
@@ -148,6 +223,9 @@ bool SceneSetup()
 // Release everything in the scene
 void SceneShutdown()
 {
+	// Wait for the last frame to be drawn before releasing anything it uses
+	RenderThread.Stop();
+
 	// Release render methods
 	ReleaseMethods();
 
@@ -161,8 +239,15 @@ void SceneShutdown()
 	delete MainCamera;
 
 	// Destroy all entities
+	Projectiles.Clear();
+	Collisions.Clear();
+	Blackboard.Clear();
+	VisibilityTable.Clear();
+	NavGrid.Clear();
+	ObstacleBVH.Clear();
 	EntityManager.DestroyAllEntities();
 	EntityManager.DestroyAllTemplates();
+	JobSystem.Stop();
 }
 
 
@@ -181,8 +266,53 @@ void SceneShutdown()
 // Game loop functions
 //-----------------------------------------------------------------------------
 
-// Draw one frame of the scene
+// Draw a single text string at its position in its colour, may be centred on the position
+void RenderText( const SRenderText& text )
+{
+	RECT rect;
+	D3DXCOLOR colour( text.colour.r, text.colour.g, text.colour.b, 1.0f );
+	if (!text.centre)
+	{
+		SetRect( &rect, text.X, text.Y, 0, 0 );
+		OSDFont->DrawText( NULL, text.text.c_str(), -1, &rect, DT_NOCLIP, colour );
+	}
+	else
+	{
+		SetRect( &rect, text.X - 100, text.Y, text.X + 100, 0 );
+		OSDFont->DrawText( NULL, text.text.c_str(), -1, &rect, DT_CENTER | DT_NOCLIP, colour );
+	}
+}
+
+// Copy the scene into the next render state and hand it to the render thread, which draws it
+// while the next tick is simulated
 void RenderScene( float updateTime )
+{
+	SRenderState& state = RenderThread.NextState();
+	state.Clear();
+
+	// Update camera aspect ratio based on viewport size - for better results when changing window size
+	MainCamera->SetAspect( static_cast<TFloat32>(ViewportWidth) / ViewportHeight );
+
+	// Copy camera and light data, the camera matrices are also used for picking in the next tick
+	MainCamera->CalculateMatrices();
+	state.camera = *MainCamera;
+	for (int light = 0; light < NumLights; ++light)
+	{
+		state.lights.push_back( *Lights[light] );
+	}
+	state.ambientLight = AmbientLight;
+
+	// Entities and shells and on-screen text
+	EntityManager.ExtractRenderAllEntities( state );
+	Projectiles.ExtractRender( state );
+	RenderSceneText( updateTime, state );
+
+	RenderThread.Submit();
+}
+
+
+// Draw one frame of the scene from its render state, called on the render thread
+void DrawScene( SRenderState& state )
 {
 	// Setup the viewport - defines which part of the back-buffer we will render to (usually all of it)
 	D3D10_VIEWPORT vp;
@@ -198,45 +328,46 @@ void RenderScene( float updateTime )
 	g_pd3dDevice->OMSetRenderTargets( 1, &BackBufferRenderTarget, DepthStencilView );
 	
 	// Clear previous frame from back buffer and depth buffer
-	g_pd3dDevice->ClearRenderTargetView( BackBufferRenderTarget, &AmbientLight.r );
+	g_pd3dDevice->ClearRenderTargetView( BackBufferRenderTarget, &state.ambientLight.r );
 	g_pd3dDevice->ClearDepthStencilView( DepthStencilView, D3D10_CLEAR_DEPTH, 1.0f, 0 );
 
-	// Update camera aspect ratio based on viewport size - for better results when changing window size
-	MainCamera->SetAspect( static_cast<TFloat32>(ViewportWidth) / ViewportHeight );
-
 	// Set camera and light data in shaders
-	MainCamera->CalculateMatrices();
-	SetCamera(MainCamera);
-	SetAmbientLight(AmbientLight);
-	SetLights(&Lights[0]);
+	CLight* lights[NumLights];
+	for (int light = 0; light < NumLights; ++light)
+	{
+		lights[light] = &state.lights[light];
+	}
+	SetCamera( &state.camera );
+	SetAmbientLight( state.ambientLight );
+	SetLights( &lights[0] );
 
-	// Render entities and draw on-screen text
-	EntityManager.RenderAllEntities();
-	RenderSceneText( updateTime );
+	// Render entities and shells with their absolute matrices
+	for (TUInt32 instance = 0; instance < state.instances.size(); ++instance)
+	{
+		const SRenderInstance& renderInstance = state.instances[instance];
+		renderInstance.mesh->Render( &state.matrices[renderInstance.firstMatrix] );
+	}
+
+	// Draw on-screen text
+	for (TUInt32 text = 0; text < state.texts.size(); ++text)
+	{
+		RenderText( state.texts[text] );
+	}
 
     // Present the backbuffer contents to the display
 	SwapChain->Present( 0, 0 );
 }
 
 
-// Render a single text string at the given position in the given colour, may optionally centre it
-void RenderText( const string& text, int X, int Y, float r, float g, float b, bool centre = false )
+// Wait until the render thread has drawn the last frame, so Direct3D can be used directly
+void FinishRendering()
 {
-	RECT rect;
-	if (!centre)
-	{
-		SetRect( &rect, X, Y, 0, 0 );
-		OSDFont->DrawText( NULL, text.c_str(), -1, &rect, DT_NOCLIP, D3DXCOLOR( r, g, b, 1.0f ) );
-	}
-	else
-	{
-		SetRect( &rect, X - 100, Y, X + 100, 0 );
-		OSDFont->DrawText( NULL, text.c_str(), -1, &rect, DT_CENTER | DT_NOCLIP, D3DXCOLOR( r, g, b, 1.0f ) );
-	}
+	RenderThread.Finish();
 }
 
-// Render on-screen text each frame
-void RenderSceneText( float updateTime )
+
+// Add on-screen text to the render state each frame
+void RenderSceneText( float updateTime, SRenderState& state )
 {
 	// Accumulate update times to calculate the average over a given period
 	SumUpdateTimes += updateTime;
@@ -253,8 +384,13 @@ void RenderSceneText( float updateTime )
 	if (AverageUpdateTime >= 0.0f)
 	{
 		outText << "Frame Time: " << AverageUpdateTime * 1000.0f << "ms" << endl << "FPS:" << 1.0f / AverageUpdateTime;
-		RenderText( outText.str(), 2, 2, 0.0f, 0.0f, 0.0f );
-		RenderText( outText.str(), 0, 0, 1.0f, 1.0f, 0.0f );
+		outText << endl << "AI Tiers: " << AIScheduler.NumTanksInTier( AITier_High ) << " / "
+		        << AIScheduler.NumTanksInTier( AITier_Medium ) << " / " << AIScheduler.NumTanksInTier( AITier_Low );
+		outText << endl << "Shells: " << Projectiles.NumShells();
+		outText << endl << "Entities: " << EntityManager.NumActiveEntities() << " active / "
+		        << EntityManager.NumSleepingEntities() << " sleeping";
+		state.AddText( outText.str(), 2, 2, 0.0f, 0.0f, 0.0f );
+		state.AddText( outText.str(), 0, 0, 1.0f, 1.0f, 0.0f );
 		outText.str("");
 	}
 
@@ -334,15 +470,15 @@ void RenderSceneText( float updateTime )
 				if (tankEntity->GetUID() == NearestTankEntity)
 				{ 
 					//If grabbed render text red else render text yellow
-					if (!GrabbedTank) { RenderText(outText.str(), X, Y, 1.0f, 1.0f, 0.0f, true); }
-					else { RenderText(outText.str(), X, Y, 1.0f, 0.0f, 0.0f, true); }
+					if (!GrabbedTank) { state.AddText(outText.str(), X, Y, 1.0f, 1.0f, 0.0f, true); }
+					else { state.AddText(outText.str(), X, Y, 1.0f, 0.0f, 0.0f, true); }
 				}
 
 				//Render team 0 green
-				else if(tankEntity->GetTeam() == 0) { RenderText(outText.str(), X, Y, 0.0f, 1.0f, 0.0f, true); }
+				else if(tankEntity->GetTeam() == 0) { state.AddText(outText.str(), X, Y, 0.0f, 1.0f, 0.0f, true); }
 
 				//Render team 1 blue
-				else if (tankEntity->GetTeam() == 1) { RenderText(outText.str(), X, Y, 0.0f, 0.0f, 1.0f, true); }
+				else if (tankEntity->GetTeam() == 1) { state.AddText(outText.str(), X, Y, 0.0f, 0.0f, 1.0f, true); }
 
 				outText.str("");
 			}
@@ -356,8 +492,29 @@ void RenderSceneText( float updateTime )
 // Update the scene between rendering
 void UpdateScene( float updateTime )
 {
-	// Call all entity update functions
-	EntityManager.UpdateAllEntities( updateTime );
+	// Shared tank knowledge is updated before tanks make decisions, and decisions are made before
+	// the entity updates that act on them
+	VisibilityTable.Update( EntityManager, ObstacleBVH, TankViewDistance );
+	Blackboard.Update( updateTime );
+	NavGrid.BeginFrame();
+	AIScheduler.Update( EntityManager, VisibilityTable, MainCamera->Position(), updateTime );
+
+	// Update all entities in parallel, reading the world as it was at the start of the tick,
+	// then commit their changes to the world one by one. Navigation can only use paths already
+	// found while entities update, searches are made as they commit
+	NavGrid.SetReadOnly( true );
+	EntityManager.UpdateAllEntities( updateTime, JobSystem );
+	NavGrid.SetReadOnly( false );
+	EntityManager.CommitAllEntities();
+
+	// Then move the tanks as they decided, then the shells so they are hit-tested against the new
+	// tank positions
+	Kinematics.ReadTanks( EntityManager );
+	Steering.Update( Kinematics );
+	Kinematics.Integrate();
+	Collisions.Update( Kinematics );
+	Kinematics.WriteTanks( EntityManager );
+	Projectiles.Update( updateTime, EntityManager, ObstacleBVH );
 
 	//Get pointer to nearest entity
 	CEntity* nearestEntity = EntityManager.GetEntity(NearestTankEntity);
@@ -447,8 +604,8 @@ void UpdateScene( float updateTime )
 	if (ChaseCamera)
 	{
 		// Take camera position from player, moved backwards and upwards
-		MainCamera->Position() = nearestEntity->Position() - nearestEntity->Matrix().ZAxis() * 12.0f +
-			nearestEntity->Matrix().YAxis() * 5.0f;
+		MainCamera->Position() = nearestEntity->Position() - nearestEntity->Transform().ZAxis() * 12.0f +
+			nearestEntity->Transform().YAxis() * 5.0f;
 		// Face camera towards point above player
 		MainCamera->Matrix().FaceTarget(nearestEntity->Position() + CVector3(0, 3.0f, 0));
 	}
@@ -474,11 +631,13 @@ void UpdateScene( float updateTime )
 		AmmoTimerStarted = false;
 		AmmoTimerDuration = 0;
 
-		//Spawn a new ammo crate
-		auto newAmmoUID = EntityManager.CreateAmmo("Ammo", "Ammo", CVector3(Random(-100.0f, 100.0f), 50.0f, Random(-100.0f, 100.0f)));
-		EntityManager.GetEntity(newAmmoUID)->Matrix().Scale({ 0.5,0.5,0.5 });
+		//Spawn a new ammo crate, it is created with the other entity commands below
+		EntityManager.Commands().CreateAmmo("Ammo", "Ammo", CVector3(Random(-100.0f, 100.0f), 50.0f, Random(-100.0f, 100.0f)),
+			CVector3(0.0f, 0.0f, 0.0f), CVector3(0.5f, 0.5f, 0.5f));
 	}
 
+	// Create and destroy the entities recorded during the tick, together
+	EntityManager.ApplyCommands();
 }
 
 
@@ -9,6 +9,9 @@
 namespace gen
 {
 
+// Forward declaration of render state, only needed by reference here
+struct SRenderState;
+
 ///////////////////////////////
 // Scene management
 
@@ -21,11 +24,18 @@ void SceneShutdown();
 ///////////////////////////////
 // Game loop functions
 
-// Draw one frame of the scene
+// Copy the scene into the next render state and hand it to the render thread, which draws it
+// while the next tick is simulated
 void RenderScene( float updateTime );
 
-// Render on-screen text each frame
-void RenderSceneText( float updateTime );
+// Add on-screen text to the render state each frame
+void RenderSceneText( float updateTime, SRenderState& state );
+
+// Draw one frame of the scene from its render state, called on the render thread
+void DrawScene( SRenderState& state );
+
+// Wait until the render thread has drawn the last frame, so Direct3D can be used directly
+void FinishRendering();
 
 // Update the scene between rendering
 void UpdateScene( float updateTime );
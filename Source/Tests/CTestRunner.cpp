@@ -0,0 +1,93 @@
+/*******************************************
+	CTestRunner.cpp
+
+	Simple unit test runner
+********************************************/
+
+#include <cstdio>
+
+#include "CTestRunner.h"
+#include "CFatalException.h"
+
+namespace gen
+{
+
+// Only the first few failed checks in a test are printed, a broken loop can fail thousands
+const TUInt32 kMaxPrintedChecks = 10;
+
+TUInt32 CTestRunner::m_NumFailedChecks = 0;
+
+
+// Add a test to the suite
+void CTestRunner::Add( const string& group, const string& name, TTestFunc func )
+{
+	STest test;
+	test.group = group;
+	test.name = name;
+	test.func = func;
+	m_Tests.push_back( test );
+}
+
+
+// Run all (filtered) tests, printing a line for each one. Returns the number that failed
+TUInt32 CTestRunner::Run()
+{
+	TUInt32 numRun = 0;
+	TUInt32 numFailed = 0;
+	for (TUInt32 i = 0; i < m_Tests.size(); ++i)
+	{
+		const STest& test = m_Tests[i];
+		string fullName = test.group + "." + test.name;
+		if (!m_Filter.empty() && fullName.find( m_Filter ) == string::npos)
+		{
+			continue;
+		}
+
+		printf( "%-50s ", fullName.c_str() );
+		fflush( stdout );
+		m_NumFailedChecks = 0;
+		try
+		{
+			test.func();
+		}
+		catch (CFatalException& e)
+		{
+			printf( "\n  %s(%d): exception: %s", e.GetFileName().c_str(), e.GetLineNum(),
+			        e.GetDescription().c_str() );
+			++m_NumFailedChecks;
+		}
+		catch (...)
+		{
+			printf( "\n  Unknown exception" );
+			++m_NumFailedChecks;
+		}
+
+		++numRun;
+		if (m_NumFailedChecks > 0)
+		{
+			++numFailed;
+			printf( "\n  FAILED (%u checks)\n", m_NumFailedChecks );
+		}
+		else
+		{
+			printf( "passed\n" );
+		}
+	}
+
+	printf( "\n%u of %u tests passed\n", numRun - numFailed, numRun );
+	return numFailed;
+}
+
+
+// Record a failed check in the test being run. Used by the GEN_CHECK macros
+void CTestRunner::CheckFailed( const char* check, const char* file, int line )
+{
+	if (m_NumFailedChecks < kMaxPrintedChecks)
+	{
+		printf( "\n  %s(%d): check failed: %s", file, line, check );
+	}
+	++m_NumFailedChecks;
+}
+
+
+} // namespace gen
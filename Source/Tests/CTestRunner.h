@@ -0,0 +1,90 @@
+/*******************************************
+	CTestRunner.h
+
+	Simple unit test runner
+********************************************/
+
+#pragma once
+
+#include <string>
+#include <vector>
+using namespace std;
+
+#include "Defines.h"
+
+namespace gen
+{
+
+// A test function checks results with the GEN_CHECK macros below
+typedef void (*TTestFunc)();
+
+
+/*-----------------------------------------------------------------------------------------
+-------------------------------------------------------------------------------------------
+	Test Runner Class
+-------------------------------------------------------------------------------------------
+-----------------------------------------------------------------------------------------*/
+
+// Runs registered tests and reports the checks that fail. A test fails if any of its checks
+// fail or it throws an exception (e.g. from a GEN_ASSERT), the remaining tests still run
+class CTestRunner
+{
+/////////////////////////////////////
+//	Constructors/Destructors
+public:
+	CTestRunner() {}
+
+
+/////////////////////////////////////
+//	Public interface
+public:
+
+	// Add a test to the suite
+	void Add( const string& group, const string& name, TTestFunc func );
+
+	// Only run tests whose "group.name" contains this string (empty string runs all)
+	void SetFilter( const string& filter )
+	{
+		m_Filter = filter;
+	}
+
+	// Run all (filtered) tests, printing a line for each one. Returns the number that failed
+	TUInt32 Run();
+
+	// Record a failed check in the test being run. Used by the GEN_CHECK macros
+	static void CheckFailed( const char* check, const char* file, int line );
+
+
+/////////////////////////////////////
+//	Private interface
+private:
+
+	// Registered test
+	struct STest
+	{
+		string    group;
+		string    name;
+		TTestFunc func;
+	};
+
+	vector<STest> m_Tests;
+	string        m_Filter;
+
+	// Failed checks in the test being run
+	static TUInt32 m_NumFailedChecks;
+};
+
+
+/////////////////////////////////////
+// Checks
+
+// Check a condition is true, recording a failure in the current test if not. The test carries on
+#define GEN_CHECK( bCondition )\
+	if (!(bCondition)) { gen::CTestRunner::CheckFailed( #bCondition, __FILE__, __LINE__ ); }
+
+// Check two values are within a tolerance of each other
+#define GEN_CHECK_NEAR( a, b, tolerance )\
+	GEN_CHECK( (a) - (b) <= (tolerance) && (b) - (a) <= (tolerance) )
+
+
+} // namespace gen
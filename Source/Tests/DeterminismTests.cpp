@@ -0,0 +1,297 @@
+/*******************************************
+	DeterminismTests.cpp
+
+	Tests that the scene simulation gives the
+	same result however many job threads
+	update the entities
+********************************************/
+
+#include <cstdlib>
+#include <string>
+#include <vector>
+using namespace std;
+
+#include "Tests.h"
+#include "CJobSystem.h"
+#include "EntityManager.h"
+#include "Messenger.h"
+#include "ObstacleBVH.h"
+#include "VisibilityTable.h"
+#include "Blackboard.h"
+#include "AIScheduler.h"
+#include "NavGrid.h"
+#include "Kinematics.h"
+#include "Steering.h"
+#include "CollisionSystem.h"
+#include "ProjectileSystem.h"
+
+namespace gen
+{
+
+//-----------------------------------------------------------------------------
+// Global scene variables
+//-----------------------------------------------------------------------------
+// The scene systems that entities use, with the same settings as the game (see
+// TankAssignment.cpp)
+
+namespace
+{
+
+const float TankViewDistance = 100.0f;
+const TUInt32 AIThinkBudget = 32;
+
+const CVector3 NavGridMin( -256.0f, 0.0f, -256.0f );
+const CVector3 NavGridMax( 256.0f, 0.0f, 256.0f );
+const float NavCellSize = 2.0f;
+const float TankRadius = 2.0f;
+
+const float TankSeparation = 2.0f * TankRadius;
+const float TankNeighbourRadius = 4.0f * TankRadius;
+
+const float ShellSpeed = 100.0f;
+const float ShellLifeTime = 2.0f;
+const float ShellRadius = 0.25f;
+
+} // namespace
+
+extern CMessenger Messenger;
+
+CJobSystem JobSystem;
+CEntityManager EntityManager;
+CObstacleBVH ObstacleBVH;
+CVisibilityTable VisibilityTable;
+CBlackboard Blackboard;
+CAIScheduler AIScheduler( AIThinkBudget );
+CNavGrid NavGrid;
+CKinematics Kinematics;
+CSteering Steering( TankSeparation, TankNeighbourRadius );
+CCollisionSystem Collisions( TankRadius );
+CProjectileSystem Projectiles( ShellSpeed, ShellLifeTime, TankRadius, ShellRadius );
+
+
+namespace
+{
+
+// Ticks simulated by each run and the time for each, long enough for the teams to find each
+// other and fight
+const TUInt32 kNumTicks = 1800;
+const float kUpdateTime = 1.0f / 60.0f;
+
+// Camera position used to choose AI level of detail, where the game starts it
+const CVector3 kCameraPosition( 0.0f, 30.0f, -100.0f );
+
+// Tanks on each team, in rows of four. Enough that the entity update is split into several jobs
+const TUInt32 kTanksPerTeam = 16;
+
+
+/*-----------------------------------------------------------------------------------------
+	Scene
+-----------------------------------------------------------------------------------------*/
+
+// State of a tank after a tick, everything that should be the same in every run
+struct STankState
+{
+	TEntityUID UID;
+	CVector3   position;
+	TFloat32   bodyYaw;
+	TFloat32   turretYaw;
+	TFloat32   speed;
+	TInt32     HP;
+	string     state;
+	int        shellCount;
+
+	bool operator==( const STankState& other ) const
+	{
+		return UID == other.UID && position == other.position && bodyYaw == other.bodyYaw &&
+		       turretYaw == other.turretYaw && speed == other.speed && HP == other.HP &&
+		       state == other.state && shellCount == other.shellCount;
+	}
+};
+
+// Create the scene - two teams of tanks either side of a building and some trees, like the
+// game's level with more tanks. Patrol points are fixed rather than random
+void SetupScene()
+{
+	srand( 1 );
+
+	EntityManager.CreateTemplate( "Scenery", "Building", "Building.x" )->SetObstacle( true );
+	CEntityTemplate* tree = EntityManager.CreateTemplate( "Scenery", "Tree", "Tree1.x" );
+	tree->SetObstacle( true );
+	tree->SetCollisionRadius( 0.5f );
+	Projectiles.SetTemplate( EntityManager.CreateTemplate( "Projectile", "Shell Type 1", "Bullet.x" ) );
+	EntityManager.CreateTankTemplate( "Tank", "Rogue Scout", "HoverTank01.x", 12.0f, 2.2f, 2.0f, 0.79f, 130, 20 );
+	EntityManager.CreateTankTemplate( "Tank", "Rogue Warrior", "HoverTank02.x", 9.0f, 1.8f, 1.3f, 1.14f, 120, 35 );
+	EntityManager.CreateTankTemplate( "Tank", "Rogue Leader", "HoverTank03.x", 14.0f, 2.4f, 2.1f, 0.59f, 150, 30 );
+	EntityManager.CreateTankTemplate( "Tank", "Oberon MkII", "HoverTank04.x", 7.0f, 1.4f, 1.4f, 1.04f, 140, 40 );
+	EntityManager.CreateTankTemplate( "Tank", "Oberon MkIII", "HoverTank05.x", 13.0f, 2.0f, 2.2f, 0.69f, 170, 60 );
+	EntityManager.CreateTankTemplate( "Tank", "Oberon MkIV", "HoverTank08.x", 10.0f, 1.9f, 1.5f, 1.00f, 160, 55 );
+
+	EntityManager.CreateEntity( "Building", "Building", CVector3( 0.0f, 0.0f, 40.0f ) );
+	for (TUInt32 i = 0; i < 10; ++i)
+	{
+		EntityManager.CreateEntity( "Tree", "Tree", CVector3( -60.0f + 12.0f * i, 0.0f, i % 2 ? 5.0f : -5.0f ),
+		                            CVector3( 0.0f, 0.7f * i, 0.0f ) );
+	}
+
+	const char* teamTemplates[2][3] = { { "Rogue Scout", "Rogue Warrior", "Rogue Leader" },
+	                                    { "Oberon MkII", "Oberon MkIII", "Oberon MkIV" } };
+	for (TUInt32 team = 0; team < 2; ++team)
+	{
+		TFloat32 side = team ? 1.0f : -1.0f;
+		for (TUInt32 tank = 0; tank < kTanksPerTeam; ++tank)
+		{
+			CVector3 position( side * (20.0f + 10.0f * (tank % 4)), 0.5f, side * (20.0f + 10.0f * (tank / 4)) );
+			vector<CVector3> patrolPoints;
+			patrolPoints.push_back( position );
+			patrolPoints.push_back( position + CVector3( 30.0f, 0.0f, 0.0f ) );
+			patrolPoints.push_back( position + CVector3( 30.0f, 0.0f, -side * 30.0f ) );
+			patrolPoints.push_back( position + CVector3( 0.0f, 0.0f, -side * 30.0f ) );
+			EntityManager.CreateTank( teamTemplates[team][tank % 3], team, "", position,
+			                          CVector3( 0.0f, team ? kfPi : 0.0f, 0.0f ),
+			                          CVector3( 1.0f, 1.0f, 1.0f ), patrolPoints );
+		}
+	}
+
+	ObstacleBVH.Build( EntityManager );
+	NavGrid.Build( ObstacleBVH, NavGridMin, NavGridMax, NavCellSize, TankRadius );
+	Collisions.SetObstacles( ObstacleBVH );
+
+	// Start all tanks, as pressing 1 in the game
+	EntityManager.BeginEnumEntities( "", "", "Tank" );
+	while (CEntity* entity = EntityManager.EnumEntity())
+	{
+		SMessage msg;
+		msg.type = Msg_Start;
+		Messenger.SendMessage( entity->GetUID(), msg );
+	}
+}
+
+// Simulate one tick, as the game's UpdateScene without the camera and keyboard
+void UpdateScene()
+{
+	VisibilityTable.Update( EntityManager, ObstacleBVH, TankViewDistance );
+	Blackboard.Update( kUpdateTime );
+	NavGrid.BeginFrame();
+	AIScheduler.Update( EntityManager, VisibilityTable, kCameraPosition, kUpdateTime );
+
+	NavGrid.SetReadOnly( true );
+	EntityManager.UpdateAllEntities( kUpdateTime, JobSystem );
+	NavGrid.SetReadOnly( false );
+	EntityManager.CommitAllEntities();
+
+	Kinematics.ReadTanks( EntityManager );
+	Steering.Update( Kinematics );
+	Kinematics.Integrate();
+	Collisions.Update( Kinematics );
+	Kinematics.WriteTanks( EntityManager );
+	Projectiles.Update( kUpdateTime, EntityManager, ObstacleBVH );
+
+	EntityManager.ApplyCommands();
+}
+
+// Add the state of each tank to a list
+void RecordTanks( vector<STankState>* pStates )
+{
+	EntityManager.BeginEnumEntities( "", "", "Tank" );
+	while (CEntity* entity = EntityManager.EnumEntity())
+	{
+		CTankEntity* tank = static_cast<CTankEntity*>(entity);
+		STankState state;
+		state.UID = tank->GetUID();
+		state.position = tank->Position();
+		state.bodyYaw = tank->Transform( 0 ).GetYaw();
+		state.turretYaw = (tank->Transform( 2 ) * tank->Transform( 0 )).GetYaw();
+		state.speed = tank->GetSpeed();
+		state.HP = tank->GetHP();
+		state.state = tank->GetState();
+		state.shellCount = tank->GetShellCount();
+		pStates->push_back( state );
+	}
+}
+
+// Release everything in the scene, ready to set it up again
+void ShutdownScene()
+{
+	Projectiles.Clear();
+	Collisions.Clear();
+	Blackboard.Clear();
+	VisibilityTable.Clear();
+	NavGrid.Clear();
+	ObstacleBVH.Clear();
+	EntityManager.DestroyAllEntities();
+	EntityManager.DestroyAllTemplates();
+	Messenger.Clear();
+}
+
+// Run the scene for the test length on the given number of job threads, recording the tanks'
+// state after every tick and the number of shells fired over the run
+void RunScene( TUInt32 numThreads, vector<STankState>* pStates, TUInt32* pNumShells )
+{
+	JobSystem.Start( numThreads );
+	SetupScene();
+
+	*pNumShells = 0;
+	for (TUInt32 tick = 0; tick < kNumTicks; ++tick)
+	{
+		UpdateScene();
+		RecordTanks( pStates );
+		*pNumShells += Projectiles.NumShells();
+	}
+
+	ShutdownScene();
+	JobSystem.Stop();
+}
+
+
+/*-----------------------------------------------------------------------------------------
+	Tests
+-----------------------------------------------------------------------------------------*/
+
+// The tanks are in exactly the same state after every tick whether entities are updated on one
+// thread or several. Also checks the tanks fought, so the test covers more than driving about
+void TestSameResultOnAnyThreads()
+{
+	vector<STankState> expected;
+	TUInt32 expectedShells;
+	RunScene( 1, &expected, &expectedShells );
+	GEN_CHECK( expected.size() == 2 * kTanksPerTeam * kNumTicks );
+	GEN_CHECK( expectedShells > 0 );
+
+	bool tankHit = false;
+	for (TUInt32 state = 0; state < expected.size(); ++state)
+	{
+		tankHit |= (expected[state].state == "Evade" || expected[state].state == "Dead");
+	}
+	GEN_CHECK( tankHit );
+
+	const TUInt32 threadCounts[] = { 2, 4 };
+	for (TUInt32 run = 0; run < sizeof(threadCounts) / sizeof(threadCounts[0]); ++run)
+	{
+		vector<STankState> states;
+		TUInt32 numShells;
+		RunScene( threadCounts[run], &states, &numShells );
+
+		// Find the first difference so a failure shows where the runs diverged when debugging
+		TUInt32 firstDifference = 0;
+		while (firstDifference < states.size() && firstDifference < expected.size() &&
+		       states[firstDifference] == expected[firstDifference])
+		{
+			++firstDifference;
+		}
+		GEN_CHECK( states.size() == expected.size() );
+		GEN_CHECK( firstDifference == expected.size() );
+		GEN_CHECK( numShells == expectedShells );
+	}
+}
+
+} // namespace
+
+
+// Scene determinism tests - the simulation doesn't depend on the number of job threads
+void AddDeterminismTests( CTestRunner& runner )
+{
+	runner.Add( "Determinism", "SameResultOnAnyThreads", TestSameResultOnAnyThreads );
+}
+
+
+} // namespace gen
@@ -0,0 +1,454 @@
+/*******************************************
+	GeometryTests.cpp
+
+	Tests for the geometry primitives and
+	intersection tests
+********************************************/
+
+#include "Tests.h"
+#include "BaseMath.h"
+#include "Geometry.h"
+
+namespace gen
+{
+
+namespace
+{
+
+// Number of random cases in each comparison test
+const TUInt32 kNumCases = 20000;
+
+// Tolerance for hit distances compared between two versions of a test
+const TFloat32 kTolerance = 1.0e-5f;
+
+
+/*-----------------------------------------------------------------------------------------
+	Random primitives
+-----------------------------------------------------------------------------------------*/
+// Cases are random but repeatable, each test seeds the generator itself. A local xorshift
+// generator is used rather than rand so the cases are the same on every platform. Components
+// are often zero or boxes flat, to cover the edge cases of the slab tests
+
+TUInt32 RandomState = 1;
+
+void SeedRandom( TUInt32 seed )
+{
+	RandomState = seed * 2654435761u + 1;
+}
+
+// Return true one time in n
+bool OneIn( TUInt32 n )
+{
+	RandomState ^= RandomState << 13;
+	RandomState ^= RandomState >> 17;
+	RandomState ^= RandomState << 5;
+	return RandomState % n == 0;
+}
+
+// Return random float from a to b
+TFloat32 RandomFloat( TFloat32 a, TFloat32 b )
+{
+	RandomState ^= RandomState << 13;
+	RandomState ^= RandomState >> 17;
+	RandomState ^= RandomState << 5;
+	return a + (b - a) * static_cast<TFloat32>(RandomState >> 8) / 16777215.0f;
+}
+
+CVector3 RandomPoint( TFloat32 range )
+{
+	return CVector3( RandomFloat( -range, range ), RandomFloat( -range, range ), RandomFloat( -range, range ) );
+}
+
+// Random direction, each component zero one time in four
+CVector3 RandomDirection()
+{
+	CVector3 direction = RandomPoint( 10.0f );
+	if (OneIn( 4 )) direction.x = 0.0f;
+	if (OneIn( 4 )) direction.y = 0.0f;
+	if (OneIn( 4 )) direction.z = 0.0f;
+	return direction;
+}
+
+// Random box, flat along an axis one time in eight and empty one time in eight
+SAABB RandomBox()
+{
+	SAABB box;
+	if (OneIn( 8 ))
+	{
+		box.SetEmpty();
+		return box;
+	}
+	CVector3 centre = RandomPoint( 10.0f );
+	CVector3 extents( RandomFloat( 0.0f, 5.0f ), RandomFloat( 0.0f, 5.0f ), RandomFloat( 0.0f, 5.0f ) );
+	if (OneIn( 8 ))
+	{
+		extents.y = 0.0f;
+	}
+	box.minPt = centre - extents;
+	box.maxPt = centre + extents;
+	return box;
+}
+
+SSphere RandomSphere()
+{
+	SSphere sphere = { RandomPoint( 10.0f ), RandomFloat( 0.0f, 5.0f ) };
+	return sphere;
+}
+
+SRay RandomRay()
+{
+	SRay ray = { RandomPoint( 20.0f ), RandomDirection() };
+	return ray;
+}
+
+bool IsEmpty( const SAABB& box )
+{
+	return box.minPt.x > box.maxPt.x || box.minPt.y > box.maxPt.y || box.minPt.z > box.maxPt.z;
+}
+
+
+/*-----------------------------------------------------------------------------------------
+	Box tests
+-----------------------------------------------------------------------------------------*/
+
+// Empty boxes are never hit, by the scalar or SSE tests, even by segments passing through the
+// whole world
+void TestEmptyBoxNeverHit()
+{
+	SeedRandom( 1 );
+	SAABB empty;
+	empty.SetEmpty();
+	SAABB4 empty4;
+	for (TUInt32 i = 0; i < 4; ++i)
+	{
+		empty4.SetEmpty( i );
+	}
+
+	SSegment segments[] =
+	{
+		{ CVector3( -1.0e6f, 0.0f, 0.0f ), CVector3( 1.0e6f, 0.0f, 0.0f ) },
+		{ CVector3( 0.0f, 0.0f, 0.0f ), CVector3( 0.0f, 0.0f, 0.0f ) },
+		{ CVector3( -1.0e6f, -1.0e6f, -1.0e6f ), CVector3( 1.0e6f, 1.0e6f, 1.0e6f ) },
+		{ CVector3( 5.0f, 5.0f, 5.0f ), CVector3( 5.0f, 5.0f, -5.0f ) },
+	};
+	for (TUInt32 i = 0; i < sizeof(segments) / sizeof(segments[0]); ++i)
+	{
+		GEN_CHECK( !SegmentAABB( segments[i], empty ) );
+		GEN_CHECK( SegmentAABB4( segments[i], empty4 ) == 0 );
+	}
+	for (TUInt32 i = 0; i < 1000; ++i)
+	{
+		SRay ray = RandomRay();
+		GEN_CHECK( !RayAABB( ray, 1.0e6f, empty ) );
+		GEN_CHECK( RayAABB4( PrecalcRay( ray, 1.0e6f ), empty4 ) == 0 );
+	}
+
+	// Only the real box in a mixed set of four is hit
+	SAABB box = { CVector3( -1.0f, -1.0f, -1.0f ), CVector3( 1.0f, 1.0f, 1.0f ) };
+	SAABB4 mixed = empty4;
+	mixed.Set( 2, box );
+	GEN_CHECK( SegmentAABB4( segments[0], mixed ) == 4 );
+
+	// Packet test against an empty box
+	SRay4 rays;
+	TFloat32 maxT[4];
+	for (TUInt32 i = 0; i < 4; ++i)
+	{
+		SRay ray = { CVector3( -100.0f, 0.0f, 0.0f ), CVector3( 1.0f, 0.0f, 0.0f ) };
+		rays.Set( i, ray );
+		maxT[i] = 1000.0f;
+	}
+	GEN_CHECK( Ray4AABB( rays, maxT, empty ) == 0 );
+	GEN_CHECK( Ray4AABB( rays, maxT, box ) == 15 );
+}
+
+// Rays with zero direction components are inside or outside each slab for their whole length
+void TestZeroDirection()
+{
+	SAABB box = { CVector3( -1.0f, -1.0f, -1.0f ), CVector3( 1.0f, 1.0f, 1.0f ) };
+	SAABB4 box4;
+	for (TUInt32 i = 0; i < 4; ++i)
+	{
+		box4.Set( i, box );
+	}
+
+	// Along x, inside, outside and exactly on the y and z faces. Rays lying in a face plane may
+	// hit or miss, but the scalar and SSE tests must agree
+	const TFloat32 offsets[] = { 0.0f, 0.5f, 1.0f, -1.0f, 1.001f, -1.5f, 100.0f };
+	for (TUInt32 i = 0; i < sizeof(offsets) / sizeof(offsets[0]); ++i)
+	{
+		for (TUInt32 j = 0; j < sizeof(offsets) / sizeof(offsets[0]); ++j)
+		{
+			SRay ray = { CVector3( -10.0f, offsets[i], offsets[j] ), CVector3( 1.0f, 0.0f, 0.0f ) };
+			TFloat32 t;
+			bool hit = RayAABB( ray, 100.0f, box, &t );
+			GEN_CHECK( (RayAABB4( PrecalcRay( ray, 100.0f ), box4 ) == 15) == hit );
+			if (Abs( offsets[i] ) != 1.0f && Abs( offsets[j] ) != 1.0f)
+			{
+				GEN_CHECK( hit == (Abs( offsets[i] ) < 1.0f && Abs( offsets[j] ) < 1.0f) );
+			}
+			if (hit)
+			{
+				GEN_CHECK_NEAR( t, 9.0f, kTolerance );
+			}
+		}
+	}
+
+	// Zero length ray is a point test
+	SRay inside = { CVector3( 0.5f, 0.5f, 0.5f ), CVector3( 0.0f, 0.0f, 0.0f ) };
+	SRay outside = { CVector3( 1.5f, 0.5f, 0.5f ), CVector3( 0.0f, 0.0f, 0.0f ) };
+	GEN_CHECK( RayAABB( inside, 1.0f, box ) );
+	GEN_CHECK( !RayAABB( outside, 1.0f, box ) );
+	GEN_CHECK( RayAABB4( PrecalcRay( inside, 1.0f ), box4 ) == 15 );
+	GEN_CHECK( RayAABB4( PrecalcRay( outside, 1.0f ), box4 ) == 0 );
+}
+
+// Rays and segments starting inside a volume hit at t = 0
+void TestStartInside()
+{
+	SeedRandom( 2 );
+	for (TUInt32 i = 0; i < 1000; ++i)
+	{
+		SAABB box;
+		do
+		{
+			box = RandomBox();
+		} while (IsEmpty( box ));
+		CVector3 size = box.maxPt - box.minPt;
+		CVector3 start = box.minPt + CVector3( RandomFloat( 0.0f, 1.0f ) * size.x, RandomFloat( 0.0f, 1.0f ) * size.y,
+		                                       RandomFloat( 0.0f, 1.0f ) * size.z );
+		SSegment segment = { start, start + RandomDirection() };
+
+		TFloat32 t = -1.0f;
+		GEN_CHECK( SegmentAABB( segment, box, &t ) );
+		GEN_CHECK( t == 0.0f );
+
+		SAABB4 box4;
+		TFloat32 t4[4];
+		for (TUInt32 j = 0; j < 4; ++j)
+		{
+			box4.Set( j, box );
+		}
+		GEN_CHECK( SegmentAABB4( segment, box4, t4 ) == 15 );
+		GEN_CHECK( t4[0] == 0.0f );
+
+		SSphere sphere = RandomSphere();
+		SSegment sphereSegment = { sphere.centre, sphere.centre + RandomDirection() };
+		GEN_CHECK( SegmentSphere( sphereSegment, sphere, &t ) );
+		GEN_CHECK( t == 0.0f );
+	}
+}
+
+// Compare the slab test against stepping along the segment. Any sample point well inside the
+// box must give a hit, and a hit must be on the box surface or inside it
+void TestSegmentAABBBruteForce()
+{
+	SeedRandom( 3 );
+	const TUInt32 kNumSteps = 500;
+	const TFloat32 kMargin = 1.0e-3f;
+	for (TUInt32 i = 0; i < kNumCases / 10; ++i)
+	{
+		SAABB box = RandomBox();
+		SSegment segment = { RandomPoint( 20.0f ), RandomPoint( 20.0f ) };
+		TFloat32 t;
+		bool hit = SegmentAABB( segment, box, &t );
+
+		SAABB inner = { box.minPt + CVector3( kMargin, kMargin, kMargin ),
+		                box.maxPt - CVector3( kMargin, kMargin, kMargin ) };
+		bool sampleInside = false;
+		TFloat32 firstInside = 2.0f;
+		for (TUInt32 step = 0; step <= kNumSteps && !sampleInside; ++step)
+		{
+			TFloat32 stepT = static_cast<TFloat32>(step) / kNumSteps;
+			if (!IsEmpty( inner ) && inner.Contains( segment.start + stepT * (segment.end - segment.start) ))
+			{
+				sampleInside = true;
+				firstInside = stepT;
+			}
+		}
+
+		if (sampleInside)
+		{
+			GEN_CHECK( hit );
+		}
+		if (hit)
+		{
+			GEN_CHECK( !IsEmpty( box ) );
+			GEN_CHECK( t >= 0.0f && t <= 1.0f );
+			GEN_CHECK( t <= firstInside );
+			CVector3 hitPt = segment.start + t * (segment.end - segment.start);
+			SAABB outer = { box.minPt - CVector3( kMargin, kMargin, kMargin ),
+			                box.maxPt + CVector3( kMargin, kMargin, kMargin ) };
+			GEN_CHECK( outer.Contains( hitPt ) );
+		}
+	}
+}
+
+// The four box SSE tests give the same hits and distances as the scalar test
+void TestAABB4MatchesScalar()
+{
+	SeedRandom( 4 );
+	for (TUInt32 i = 0; i < kNumCases; ++i)
+	{
+		SAABB boxes[4];
+		SAABB4 boxes4;
+		for (TUInt32 j = 0; j < 4; ++j)
+		{
+			boxes[j] = RandomBox();
+			boxes4.Set( j, boxes[j] );
+		}
+
+		SPrecalcRay ray = PrecalcRay( RandomRay(), RandomFloat( 0.0f, 10.0f ) );
+		SSegment segment = { RandomPoint( 20.0f ), RandomPoint( 20.0f ) };
+		if (OneIn( 4 ))
+		{
+			segment.end.x = segment.start.x;
+		}
+
+		TFloat32 rayT4[4], segmentT4[4];
+		TUInt32 rayMask = RayAABB4( ray, boxes4, rayT4 );
+		TUInt32 segmentMask = SegmentAABB4( segment, boxes4, segmentT4 );
+		for (TUInt32 j = 0; j < 4; ++j)
+		{
+			TFloat32 t;
+			bool hit = RayAABB( ray, boxes[j], &t );
+			GEN_CHECK( hit == ((rayMask & (1 << j)) != 0) );
+			if (hit)
+			{
+				GEN_CHECK_NEAR( t, rayT4[j], kTolerance );
+			}
+
+			hit = SegmentAABB( segment, boxes[j], &t );
+			GEN_CHECK( hit == ((segmentMask & (1 << j)) != 0) );
+			if (hit)
+			{
+				GEN_CHECK_NEAR( t, segmentT4[j], kTolerance );
+			}
+		}
+	}
+}
+
+// The four ray packet box test gives the same hits as the scalar test
+void TestRay4AABBMatchesScalar()
+{
+	SeedRandom( 5 );
+	for (TUInt32 i = 0; i < kNumCases; ++i)
+	{
+		SAABB box = RandomBox();
+		SRay rays[4];
+		SRay4 rays4;
+		TFloat32 maxT[4];
+		for (TUInt32 j = 0; j < 4; ++j)
+		{
+			rays[j] = RandomRay();
+			rays4.Set( j, rays[j] );
+			maxT[j] = RandomFloat( 0.0f, 10.0f );
+		}
+
+		TUInt32 mask = Ray4AABB( rays4, maxT, box );
+		for (TUInt32 j = 0; j < 4; ++j)
+		{
+			GEN_CHECK( RayAABB( rays[j], maxT[j], box ) == ((mask & (1 << j)) != 0) );
+		}
+	}
+}
+
+
+/*-----------------------------------------------------------------------------------------
+	Sphere and triangle tests
+-----------------------------------------------------------------------------------------*/
+
+// The four sphere SSE tests give the same hits and distances as the scalar tests
+void TestSphere4MatchesScalar()
+{
+	SeedRandom( 6 );
+	for (TUInt32 i = 0; i < kNumCases; ++i)
+	{
+		SSphere spheres[4];
+		SSphere4 spheres4;
+		for (TUInt32 j = 0; j < 4; ++j)
+		{
+			spheres[j] = RandomSphere();
+			spheres4.Set( j, spheres[j] );
+		}
+
+		SSphere moving = RandomSphere();
+		CVector3 movement = (OneIn( 8 )) ? CVector3( 0.0f, 0.0f, 0.0f ) : RandomDirection();
+
+		TFloat32 t4[4];
+		TUInt32 overlapMask = SphereSphere4( moving, spheres4 );
+		TUInt32 sweptMask = SweptSphereSphere4( moving, movement, spheres4, t4 );
+		for (TUInt32 j = 0; j < 4; ++j)
+		{
+			GEN_CHECK( SphereSphere( moving, spheres[j] ) == ((overlapMask & (1 << j)) != 0) );
+
+			TFloat32 t;
+			bool hit = SweptSphereSphere( moving, movement, spheres[j], &t );
+			GEN_CHECK( hit == ((sweptMask & (1 << j)) != 0) );
+			if (hit)
+			{
+				GEN_CHECK_NEAR( t, t4[j], kTolerance );
+			}
+		}
+	}
+}
+
+// The four ray packet triangle test gives the same hits and distances as the scalar test, and
+// only shortens the maximum distance of rays that hit
+void TestRay4TriangleMatchesScalar()
+{
+	SeedRandom( 7 );
+	for (TUInt32 i = 0; i < kNumCases; ++i)
+	{
+		CVector3 v0 = RandomPoint( 10.0f );
+		CVector3 v1 = RandomPoint( 10.0f );
+		CVector3 v2 = RandomPoint( 10.0f );
+
+		SRay rays[4];
+		SRay4 rays4;
+		TFloat32 maxT[4], maxT4[4];
+		for (TUInt32 j = 0; j < 4; ++j)
+		{
+			// Aim most rays near the triangle so there are plenty of hits
+			rays[j].origin = RandomPoint( 20.0f );
+			rays[j].direction = (v0 + v1 + v2) * (1.0f / 3.0f) + RandomPoint( 5.0f ) - rays[j].origin;
+			rays4.Set( j, rays[j] );
+			maxT[j] = maxT4[j] = RandomFloat( 0.0f, 2.0f );
+		}
+
+		TUInt32 mask = Ray4Triangle( rays4, maxT4, v0, v1, v2 );
+		for (TUInt32 j = 0; j < 4; ++j)
+		{
+			TFloat32 t;
+			bool hit = RayTriangle( rays[j], maxT[j], v0, v1, v2, &t );
+			GEN_CHECK( hit == ((mask & (1 << j)) != 0) );
+			if (hit)
+			{
+				GEN_CHECK_NEAR( t, maxT4[j], kTolerance );
+			}
+			else
+			{
+				GEN_CHECK( maxT4[j] == maxT[j] );
+			}
+		}
+	}
+}
+
+} // namespace
+
+
+// Geometry primitives and intersection tests, scalar against SSE versions
+void AddGeometryTests( CTestRunner& runner )
+{
+	runner.Add( "Geometry", "EmptyBoxNeverHit", TestEmptyBoxNeverHit );
+	runner.Add( "Geometry", "ZeroDirection", TestZeroDirection );
+	runner.Add( "Geometry", "StartInside", TestStartInside );
+	runner.Add( "Geometry", "SegmentAABBBruteForce", TestSegmentAABBBruteForce );
+	runner.Add( "Geometry", "AABB4MatchesScalar", TestAABB4MatchesScalar );
+	runner.Add( "Geometry", "Ray4AABBMatchesScalar", TestRay4AABBMatchesScalar );
+	runner.Add( "Geometry", "Sphere4MatchesScalar", TestSphere4MatchesScalar );
+	runner.Add( "Geometry", "Ray4TriangleMatchesScalar", TestRay4TriangleMatchesScalar );
+}
+
+
+} // namespace gen
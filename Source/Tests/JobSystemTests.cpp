@@ -0,0 +1,256 @@
+/*******************************************
+	JobSystemTests.cpp
+
+	Tests for the work-stealing job system -
+	parallel for results, job dependencies,
+	child jobs and shutdown
+********************************************/
+
+#include <atomic>
+#include <thread>
+#include <vector>
+using namespace std;
+
+#include "Tests.h"
+#include "CJobSystem.h"
+
+namespace gen
+{
+
+namespace
+{
+
+// Threads to start for each test, more than most test machines have cores so threads are
+// preempted mid-job and the stealing and finishing paths are exercised
+const TUInt32 kNumThreads = 4;
+
+// Times to repeat each threaded test, races only show up occasionally
+const TUInt32 kNumRepeats = 500;
+
+
+/*-----------------------------------------------------------------------------------------
+	Job functions
+-----------------------------------------------------------------------------------------*/
+
+// Order in which jobs ran, each job records the next count in the slot given by its begin index
+struct SJobOrder
+{
+	atomic<TUInt32> nextCount;
+	atomic<TUInt32> counts[8];
+};
+
+void RecordOrder( SJob* job )
+{
+	SJobOrder* order = static_cast<SJobOrder*>(job->data);
+	order->counts[job->begin] = order->nextCount++;
+}
+
+// Count the jobs run
+void CountJob( SJob* job )
+{
+	++*static_cast<atomic<TUInt32>*>(job->data);
+}
+
+// Create a child job for each index in the range, each counting itself, on the given system
+CJobSystem* SpawnSystem = 0;
+
+void SpawnChildren( SJob* job )
+{
+	for (TUInt32 child = job->begin; child < job->end; ++child)
+	{
+		SpawnSystem->Run( SpawnSystem->CreateJob( CountJob, job->data, 0, 0, job ) );
+	}
+}
+
+
+/*-----------------------------------------------------------------------------------------
+	Tests
+-----------------------------------------------------------------------------------------*/
+
+// Parallel for calls the function on every index exactly once, for a range of sizes and grain
+// sizes including empty ranges and grains larger than the range
+void TestParallelForCoversRange()
+{
+	CJobSystem jobSystem;
+	jobSystem.Start( kNumThreads );
+
+	const TUInt32 sizes[] = { 0, 1, 7, 64, 1000, 10000 };
+	const TUInt32 grainSizes[] = { 0, 1, 16, 64, 20000 };
+	for (TUInt32 repeat = 0; repeat < kNumRepeats / 10; ++repeat)
+	{
+		for (TUInt32 size = 0; size < sizeof(sizes) / sizeof(sizes[0]); ++size)
+		{
+			for (TUInt32 grain = 0; grain < sizeof(grainSizes) / sizeof(grainSizes[0]); ++grain)
+			{
+				// Offset the range to check sub-ranges are not assumed to start at 0
+				const TUInt32 offset = 5;
+				vector<TUInt32> calls( sizes[size] + offset, 0 );
+				jobSystem.ParallelFor( offset, offset + sizes[size], grainSizes[grain],
+				                       [&]( TUInt32 begin, TUInt32 end )
+				{
+					for (TUInt32 i = begin; i < end; ++i)
+					{
+						++calls[i];
+					}
+				} );
+
+				bool allOnce = true;
+				for (TUInt32 i = 0; i < calls.size(); ++i)
+				{
+					allOnce &= (calls[i] == (i < offset ? 0u : 1u));
+				}
+				GEN_CHECK( allOnce );
+			}
+		}
+	}
+	jobSystem.Stop();
+}
+
+// Parallel for gives the same result when the system has not been started, running on the
+// calling thread alone
+void TestParallelForSingleThread()
+{
+	CJobSystem jobSystem;
+	GEN_CHECK( jobSystem.NumThreads() == 1 );
+
+	vector<TUInt32> values( 1000, 0 );
+	jobSystem.ParallelFor( 0, 1000, 16, [&]( TUInt32 begin, TUInt32 end )
+	{
+		for (TUInt32 i = begin; i < end; ++i)
+		{
+			values[i] = i * 3;
+		}
+	} );
+
+	bool allSet = true;
+	for (TUInt32 i = 0; i < values.size(); ++i)
+	{
+		allSet &= (values[i] == i * 3);
+	}
+	GEN_CHECK( allSet );
+}
+
+// A job never starts before the jobs it depends on have finished, whatever order they are run
+// in. Covers a chain, a job depending on several others and a dependency that has finished but
+// not yet been waited on
+void TestDependencyOrder()
+{
+	CJobSystem jobSystem;
+	jobSystem.Start( kNumThreads );
+
+	for (TUInt32 repeat = 0; repeat < kNumRepeats; ++repeat)
+	{
+		SJobOrder order;
+		order.nextCount = 0;
+
+		// Chain 0 -> 1 -> 2, run backwards so the later jobs are queued first
+		SJob* first  = jobSystem.CreateJob( RecordOrder, &order, 0, 0 );
+		SJob* second = jobSystem.CreateJob( RecordOrder, &order, 1, 1 );
+		SJob* third  = jobSystem.CreateJob( RecordOrder, &order, 2, 2 );
+		jobSystem.AddDependency( second, first );
+		jobSystem.AddDependency( third, second );
+
+		// Job 5 waits for jobs 3 and 4 as well as the end of the chain
+		SJob* fourth = jobSystem.CreateJob( RecordOrder, &order, 3, 3 );
+		SJob* fifth  = jobSystem.CreateJob( RecordOrder, &order, 4, 4 );
+		SJob* join   = jobSystem.CreateJob( RecordOrder, &order, 5, 5 );
+		jobSystem.AddDependency( join, third );
+		jobSystem.AddDependency( join, fourth );
+		jobSystem.AddDependency( join, fifth );
+
+		jobSystem.Run( join );
+		jobSystem.Run( third );
+		jobSystem.Run( fifth );
+		jobSystem.Run( second );
+		jobSystem.Run( fourth );
+		jobSystem.Run( first );
+		jobSystem.Wait( join );
+
+		GEN_CHECK( order.nextCount == 6 );
+		GEN_CHECK( order.counts[0] < order.counts[1] && order.counts[1] < order.counts[2] );
+		GEN_CHECK( order.counts[2] < order.counts[5] );
+		GEN_CHECK( order.counts[3] < order.counts[5] && order.counts[4] < order.counts[5] );
+
+		// Depending on a finished job doesn't hold the new job back. The jobs above have been
+		// waited on so may be reused, the dependency must be a job that hasn't
+		SJob* early = jobSystem.CreateJob( RecordOrder, &order, 6, 6 );
+		jobSystem.Run( early );
+		while (!jobSystem.IsFinished( early ))
+		{
+			this_thread::yield();
+		}
+		SJob* late = jobSystem.CreateJob( RecordOrder, &order, 7, 7 );
+		jobSystem.AddDependency( late, early );
+		jobSystem.Run( late );
+		jobSystem.Wait( late );
+		GEN_CHECK( order.counts[6] == 6 && order.counts[7] == 7 );
+	}
+	jobSystem.Stop();
+}
+
+// A parent is not finished until all of its children are, including children created while
+// it runs. Many more jobs are created than a ring holds, so slots are reused while other
+// threads may still be finishing the jobs that used them
+void TestChildJobsAndReuse()
+{
+	CJobSystem jobSystem;
+	jobSystem.Start( kNumThreads );
+	SpawnSystem = &jobSystem;
+
+	const TUInt32 kNumChildren = 100;
+	for (TUInt32 repeat = 0; repeat < kNumRepeats; ++repeat)
+	{
+		atomic<TUInt32> count( 0 );
+		SJob* parent = jobSystem.CreateJob( SpawnChildren, &count, 0, kNumChildren );
+		SJob* after = jobSystem.CreateJob( CountJob, &count );
+		jobSystem.AddDependency( after, parent );
+		jobSystem.Run( after );
+		jobSystem.Run( parent );
+
+		jobSystem.Wait( parent );
+		GEN_CHECK( count >= kNumChildren );
+		jobSystem.Wait( after );
+		GEN_CHECK( count == kNumChildren + 1 );
+	}
+	SpawnSystem = 0;
+	jobSystem.Stop();
+}
+
+// Stopping the system runs every job already queued before the workers exit, and the system
+// can be started again afterwards
+void TestStopFinishesJobs()
+{
+	CJobSystem jobSystem;
+	for (TUInt32 repeat = 0; repeat < kNumRepeats / 10; ++repeat)
+	{
+		jobSystem.Start( kNumThreads );
+		GEN_CHECK( jobSystem.NumThreads() == kNumThreads );
+
+		const TUInt32 kNumJobs = 200;
+		atomic<TUInt32> count( 0 );
+		for (TUInt32 job = 0; job < kNumJobs; ++job)
+		{
+			jobSystem.Run( jobSystem.CreateJob( CountJob, &count ) );
+		}
+		jobSystem.Stop();
+
+		GEN_CHECK( count == kNumJobs );
+		GEN_CHECK( jobSystem.NumThreads() == 1 );
+	}
+}
+
+} // namespace
+
+
+// Job system tests - parallel for results, dependency ordering, child jobs and shutdown
+void AddJobSystemTests( CTestRunner& runner )
+{
+	runner.Add( "JobSystem", "ParallelForCoversRange", TestParallelForCoversRange );
+	runner.Add( "JobSystem", "ParallelForSingleThread", TestParallelForSingleThread );
+	runner.Add( "JobSystem", "DependencyOrder", TestDependencyOrder );
+	runner.Add( "JobSystem", "ChildJobsAndReuse", TestChildJobsAndReuse );
+	runner.Add( "JobSystem", "StopFinishesJobs", TestStopFinishesJobs );
+}
+
+
+} // namespace gen
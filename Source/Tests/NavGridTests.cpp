@@ -0,0 +1,352 @@
+/*******************************************
+	NavGridTests.cpp
+
+	Tests for the navigation grid - paths,
+	the path cache, the search budget,
+	obstacle changes and flow fields
+********************************************/
+
+#include <vector>
+using namespace std;
+
+#include "Tests.h"
+#include "ObstacleBVH.h"
+#include "NavGrid.h"
+
+namespace gen
+{
+
+namespace
+{
+
+/*-----------------------------------------------------------------------------------------
+	Test level
+-----------------------------------------------------------------------------------------*/
+// A small square area with a wall across the middle, leaving a gap at the positive x end. Cells
+// are 1 unit across so the grid is 64 x 64
+
+const CVector3 kGridMin( -32.0f, 0.0f, -32.0f );
+const CVector3 kGridMax( 32.0f, 0.0f, 32.0f );
+const TFloat32 kCellSize = 1.0f;
+const TFloat32 kAgentRadius = 1.0f;
+
+// The wall, and a box that fills the gap at its end
+const SAABB kWall = { CVector3( -32.0f, 0.0f, -1.0f ), CVector3( 16.0f, 5.0f, 1.0f ) };
+const SAABB kGapFiller = { CVector3( 16.0f, 0.0f, -1.0f ), CVector3( 32.0f, 5.0f, 1.0f ) };
+
+// Points either side of the wall, and two points next to each other far from it
+const CVector3 kSouth( 8.0f, 0.0f, -20.0f );
+const CVector3 kNorth( 8.0f, 0.0f, 20.0f );
+const CVector3 kCornerA( -28.0f, 0.0f, -28.0f );
+const CVector3 kCornerB( -20.0f, 0.0f, -28.0f );
+
+// Distance between points checked along a path
+const TFloat32 kPathStep = 0.25f;
+
+// Tolerance for flow field distances compared between two grids. Equal routes may add up their
+// steps in a different order
+const TFloat32 kDistanceTolerance = 1.0e-3f;
+
+// Build a grid over the test area with the given obstacles
+void BuildGrid( CNavGrid& grid, const vector<SAABB>& boxes )
+{
+	CObstacleBVH obstacles;
+	obstacles.Build( boxes, vector<TEntityUID>( boxes.size(), 0 ) );
+	grid.Build( obstacles, kGridMin, kGridMax, kCellSize, kAgentRadius );
+}
+
+// Return true if every point along a path from the start through each waypoint is walkable
+bool IsPathWalkable( const CNavGrid& grid, const CVector3& start, const vector<CVector3>& path )
+{
+	CVector3 from = start;
+	for (TUInt32 waypoint = 0; waypoint < path.size(); ++waypoint)
+	{
+		TFloat32 length = Distance( from, path[waypoint] );
+		for (TFloat32 t = 0.0f; t < length; t += kPathStep)
+		{
+			if (!grid.IsWalkable( from + (path[waypoint] - from) * (t / length) ))
+			{
+				return false;
+			}
+		}
+		from = path[waypoint];
+	}
+	return grid.IsWalkable( from );
+}
+
+// Make a path query each frame until it is no longer deferred, giving up after the given number
+// of frames. Returns the result and the number of frames taken. Also checks that the searches in
+// each frame stay within the budget
+ENavResult FindPathOverFrames( CNavGrid& grid, const CVector3& start, const CVector3& goal,
+                               vector<CVector3>* pPath, TUInt32 maxFrames, TUInt32* pNumFrames )
+{
+	ENavResult result = Nav_Deferred;
+	*pNumFrames = 0;
+	while (result == Nav_Deferred && *pNumFrames < maxFrames)
+	{
+		grid.BeginFrame();
+		result = grid.FindPath( start, goal, pPath );
+		GEN_CHECK( grid.NumFrameCellsVisited() <= grid.GetSearchBudget() );
+		++*pNumFrames;
+	}
+	return result;
+}
+
+
+/*-----------------------------------------------------------------------------------------
+	Tests
+-----------------------------------------------------------------------------------------*/
+
+// Paths go around the wall through the gap without entering blocked cells, and end at the goal.
+// A goal inside an obstacle gives a path to the nearest walkable cell
+void TestPathAroundObstacle()
+{
+	CNavGrid grid;
+	BuildGrid( grid, vector<SAABB>( 1, kWall ) );
+	GEN_CHECK( !grid.IsWalkable( CVector3( 0.0f, 0.0f, 0.0f ) ) );
+	GEN_CHECK( grid.IsWalkable( CVector3( 24.0f, 0.0f, 0.0f ) ) );
+
+	vector<CVector3> path;
+	grid.BeginFrame();
+	GEN_CHECK( grid.FindPath( kSouth, kNorth, &path ) == Nav_Found );
+	GEN_CHECK( path.size() >= 2 && path.back() == kNorth );
+	GEN_CHECK( IsPathWalkable( grid, kSouth, path ) );
+
+	const CVector3 insideWall( 0.0f, 0.0f, 0.0f );
+	GEN_CHECK( grid.FindPath( kSouth, insideWall, &path ) == Nav_Found );
+	GEN_CHECK( IsPathWalkable( grid, kSouth, path ) );
+	GEN_CHECK( Distance( path.back(), insideWall ) < 3.0f * kCellSize );
+
+	// Off the grid
+	GEN_CHECK( grid.FindPath( kSouth, CVector3( 100.0f, 0.0f, 0.0f ), &path ) == Nav_NoPath );
+}
+
+// A repeated query is found in the cache without searching, a query for a different goal cell
+// searches again
+void TestPathCache()
+{
+	CNavGrid grid;
+	BuildGrid( grid, vector<SAABB>( 1, kWall ) );
+
+	vector<CVector3> path, cachedPath;
+	grid.BeginFrame();
+	GEN_CHECK( grid.FindPath( kSouth, kNorth, &path ) == Nav_Found );
+	GEN_CHECK( grid.NumFrameSearches() == 1 && grid.NumFrameCacheHits() == 0 );
+
+	grid.BeginFrame();
+	GEN_CHECK( grid.FindPath( kSouth, kNorth, &cachedPath ) == Nav_Found );
+	GEN_CHECK( grid.NumFrameSearches() == 0 && grid.NumFrameCacheHits() == 1 );
+	GEN_CHECK( grid.NumFrameCellsVisited() == 0 );
+	GEN_CHECK( cachedPath == path );
+
+	GEN_CHECK( grid.FindPath( kSouth, kNorth + CVector3( 4.0f, 0.0f, 0.0f ), &path ) == Nav_Found );
+	GEN_CHECK( grid.NumFrameSearches() == 1 && grid.NumCachedPaths() == 2 );
+
+	// Read only queries only use the cache
+	grid.BeginFrame();
+	grid.SetReadOnly( true );
+	GEN_CHECK( grid.FindPath( kSouth, kNorth, &path ) == Nav_Found );
+	GEN_CHECK( grid.FindPath( kCornerA, kCornerB, &path ) == Nav_Deferred );
+	grid.SetReadOnly( false );
+}
+
+// A search longer than the budget is spread over several frames, never visiting more cells in a
+// frame than the budget, and gives the same path as an unlimited search. Other queries are
+// deferred while it is in progress. A goal that can't be reached is also found over several
+// frames rather than searching the whole area at once
+void TestSearchBudget()
+{
+	vector<CVector3> path, expected;
+	TUInt32 numFrames;
+	{
+		CNavGrid grid;
+		BuildGrid( grid, vector<SAABB>( 1, kWall ) );
+		GEN_CHECK( FindPathOverFrames( grid, kCornerA, kNorth, &expected, 1, &numFrames ) == Nav_Found );
+	}
+
+	CNavGrid grid;
+	BuildGrid( grid, vector<SAABB>( 1, kWall ) );
+	grid.SetSearchBudget( 200 );
+	grid.BeginFrame();
+	GEN_CHECK( grid.FindPath( kCornerA, kNorth, &path ) == Nav_Deferred );
+	GEN_CHECK( grid.NumFrameCellsVisited() == 200 );
+
+	grid.BeginFrame();
+	GEN_CHECK( grid.FindPath( kCornerB, kSouth, &path ) == Nav_Deferred );
+	GEN_CHECK( grid.NumFrameCellsVisited() == 0 );
+
+	GEN_CHECK( FindPathOverFrames( grid, kCornerA, kNorth, &path, 100, &numFrames ) == Nav_Found );
+	GEN_CHECK( numFrames > 1 );
+	GEN_CHECK( path == expected );
+
+	// Once finished, other queries can search
+	GEN_CHECK( FindPathOverFrames( grid, kCornerB, kSouth, &path, 100, &numFrames ) == Nav_Found );
+
+	// Close the gap, so the north side can't be reached. The search visits every cell on the south
+	// side before giving up, which takes several frames
+	grid.AddObstacle( kGapFiller );
+	GEN_CHECK( FindPathOverFrames( grid, kSouth, kNorth, &path, 100, &numFrames ) == Nav_NoPath );
+	GEN_CHECK( numFrames > 1 );
+}
+
+// Adding or removing an obstacle updates the cells it covers and removes the cached paths that
+// cross them, but keeps paths elsewhere
+void TestObstacleChanges()
+{
+	CNavGrid grid;
+	BuildGrid( grid, vector<SAABB>( 1, kWall ) );
+
+	vector<CVector3> path;
+	grid.BeginFrame();
+	GEN_CHECK( grid.FindPath( kSouth, kNorth, &path ) == Nav_Found );
+	GEN_CHECK( grid.FindPath( kCornerA, kCornerB, &path ) == Nav_Found );
+	GEN_CHECK( grid.NumCachedPaths() == 2 );
+
+	// Filling the gap removes the path through it and leaves no way round
+	grid.AddObstacle( kGapFiller );
+	GEN_CHECK( !grid.IsWalkable( CVector3( 24.0f, 0.0f, 0.0f ) ) );
+	GEN_CHECK( grid.NumCachedPaths() == 1 );
+	grid.BeginFrame();
+	GEN_CHECK( grid.FindPath( kSouth, kNorth, &path ) == Nav_NoPath );
+	GEN_CHECK( grid.FindPath( kCornerA, kCornerB, &path ) == Nav_Found );
+	GEN_CHECK( grid.NumFrameCacheHits() == 1 );
+
+	// Removing the wall opens a straight route, the cells under the gap filler stay blocked
+	GEN_CHECK( grid.RemoveObstacle( kWall ) );
+	GEN_CHECK( !grid.RemoveObstacle( kWall ) );
+	GEN_CHECK( grid.IsWalkable( CVector3( 0.0f, 0.0f, 0.0f ) ) );
+	GEN_CHECK( !grid.IsWalkable( CVector3( 24.0f, 0.0f, 0.0f ) ) );
+	grid.BeginFrame();
+	GEN_CHECK( grid.FindPath( kSouth, kNorth, &path ) == Nav_Found );
+	GEN_CHECK( path.size() == 1 && path.back() == kNorth );
+	GEN_CHECK( IsPathWalkable( grid, kSouth, path ) );
+}
+
+// A flow field repaired after obstacles are added and removed gives the same distance to the
+// goal from every cell as a field built from scratch for the final obstacles
+void TestFlowFieldRepair()
+{
+	// Some scattered boxes as well as the wall, so routes have to bend
+	vector<SAABB> boxes( 1, kWall );
+	for (TUInt32 box = 0; box < 6; ++box)
+	{
+		TFloat32 x = -24.0f + 9.0f * box;
+		TFloat32 z = (box % 2) ? 10.0f : -12.0f;
+		SAABB bounds = { CVector3( x, 0.0f, z ), CVector3( x + 3.0f, 5.0f, z + 2.0f + box ) };
+		boxes.push_back( bounds );
+	}
+	CNavGrid grid;
+	BuildGrid( grid, boxes );
+
+	const CVector3 goal( -10.0f, 0.0f, 24.0f );
+	TFloat32 distance;
+	grid.BeginFrame();
+	GEN_CHECK( grid.GetFlowDistance( kSouth, goal, &distance ) == Nav_Found );
+
+	// Close the gap then reopen part of the wall. Each change repairs the field rather than
+	// removing it
+	const SAABB kNewBox = { CVector3( -2.0f, 0.0f, 16.0f ), CVector3( 4.0f, 5.0f, 18.0f ) };
+	grid.AddObstacle( kGapFiller );
+	grid.BeginFrame();
+	GEN_CHECK( grid.GetFlowDistance( kSouth, goal, &distance ) == Nav_NoPath );
+	grid.AddObstacle( kNewBox );
+	grid.RemoveObstacle( kWall );
+	GEN_CHECK( grid.NumFlowFields() == 1 );
+	grid.BeginFrame();
+	GEN_CHECK( grid.GetFlowDistance( kSouth, goal, &distance ) == Nav_Found );
+	GEN_CHECK( grid.NumFrameFlowFieldBuilds() == 0 );
+
+	boxes[0] = kGapFiller;
+	boxes.push_back( kNewBox );
+	CNavGrid rebuilt;
+	BuildGrid( rebuilt, boxes );
+	rebuilt.BeginFrame();
+
+	bool allMatch = true;
+	for (TFloat32 z = kGridMin.z + 0.5f * kCellSize; z < kGridMax.z; z += kCellSize)
+	{
+		for (TFloat32 x = kGridMin.x + 0.5f * kCellSize; x < kGridMax.x; x += kCellSize)
+		{
+			CVector3 point( x, 0.0f, z );
+			TFloat32 repairedDistance = 0.0f, rebuiltDistance = 0.0f;
+			ENavResult repaired = grid.GetFlowDistance( point, goal, &repairedDistance );
+			ENavResult rebuiltResult = rebuilt.GetFlowDistance( point, goal, &rebuiltDistance );
+			allMatch &= (repaired == rebuiltResult && repaired != Nav_Deferred);
+			allMatch &= (repairedDistance - rebuiltDistance <= kDistanceTolerance &&
+			             rebuiltDistance - repairedDistance <= kDistanceTolerance);
+		}
+	}
+	GEN_CHECK( allMatch );
+	GEN_CHECK( rebuilt.NumFrameFlowFieldBuilds() == 1 );
+}
+
+// When a new flow field is needed and the most are held, the one used least recently is replaced.
+// Read only queries don't count as a use
+void TestFlowFieldEviction()
+{
+	CNavGrid grid;
+	BuildGrid( grid, vector<SAABB>( 1, kWall ) );
+
+	// One more goal than the fields held, along the south side
+	const TUInt32 numGoals = grid.MaxFlowFields() + 1;
+	vector<CVector3> goals;
+	for (TUInt32 goal = 0; goal < numGoals; ++goal)
+	{
+		goals.push_back( CVector3( -28.0f + 6.0f * goal, 0.0f, -20.0f ) );
+	}
+	for (TUInt32 goal = 0; goal + 1 < numGoals; ++goal)
+	{
+		grid.BeginFrame();
+		grid.UseFlowField( goals[goal] );
+		GEN_CHECK( grid.NumFrameFlowFieldBuilds() == 1 );
+	}
+	GEN_CHECK( grid.NumFlowFields() == grid.MaxFlowFields() );
+
+	// Use the first field again, so the second is the oldest and is replaced by the last goal's
+	grid.BeginFrame();
+	grid.UseFlowField( goals[0] );
+	GEN_CHECK( grid.NumFrameFlowFieldBuilds() == 0 );
+	grid.BeginFrame();
+	grid.UseFlowField( goals[numGoals - 1] );
+	GEN_CHECK( grid.NumFrameFlowFieldBuilds() == 1 );
+	GEN_CHECK( grid.NumFlowFields() == grid.MaxFlowFields() );
+
+	grid.BeginFrame();
+	grid.UseFlowField( goals[0] );
+	GEN_CHECK( grid.NumFrameFlowFieldBuilds() == 0 );
+	grid.UseFlowField( goals[1] );
+	GEN_CHECK( grid.NumFrameFlowFieldBuilds() == 1 );
+
+	// The third field was replaced by the second's, so the fourth is now the oldest. A read only
+	// query doesn't keep it
+	CVector3 target;
+	grid.BeginFrame();
+	grid.SetReadOnly( true );
+	GEN_CHECK( grid.GetFlowTarget( kSouth, goals[3], &target ) == Nav_Found );
+	GEN_CHECK( grid.GetFlowTarget( kSouth, goals[2], &target ) == Nav_Deferred );
+	grid.SetReadOnly( false );
+	grid.BeginFrame();
+	grid.UseFlowField( goals[2] );
+	GEN_CHECK( grid.NumFrameFlowFieldBuilds() == 1 );
+	grid.UseFlowField( goals[4] );
+	GEN_CHECK( grid.NumFrameFlowFieldBuilds() == 1 );
+	grid.UseFlowField( goals[3] );
+	GEN_CHECK( grid.NumFrameFlowFieldBuilds() == 2 );
+}
+
+} // namespace
+
+
+// Navigation grid tests - paths, caching, the search budget, obstacle changes and flow fields
+void AddNavGridTests( CTestRunner& runner )
+{
+	runner.Add( "NavGrid", "PathAroundObstacle", TestPathAroundObstacle );
+	runner.Add( "NavGrid", "PathCache", TestPathCache );
+	runner.Add( "NavGrid", "SearchBudget", TestSearchBudget );
+	runner.Add( "NavGrid", "ObstacleChanges", TestObstacleChanges );
+	runner.Add( "NavGrid", "FlowFieldRepair", TestFlowFieldRepair );
+	runner.Add( "NavGrid", "FlowFieldEviction", TestFlowFieldEviction );
+}
+
+
+} // namespace gen
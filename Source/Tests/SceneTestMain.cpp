@@ -0,0 +1,53 @@
+/*******************************************
+	SceneTestMain.cpp
+
+	Scene tests - run the game simulation
+	without rendering
+
+	Usage: SceneTests [-filter text]
+	  -filter  Only run tests whose "Group.Name" contains the text
+
+	Must be run from the folder containing the
+	Media folder, meshes are loaded from it
+
+	Returns the number of failed tests, so 0 on success
+********************************************/
+
+#include <cstdio>
+#include <cstring>
+
+#include <d3d10.h>
+
+#include "Tests.h"
+
+namespace gen
+{
+
+// There is no Direct3D device, so meshes only load their geometry
+ID3D10Device* g_pd3dDevice = 0;
+
+} // namespace gen
+
+using namespace gen;
+
+int main( int argc, char* argv[] )
+{
+	string filter;
+	for (int arg = 1; arg < argc; ++arg)
+	{
+		if (arg + 1 < argc && !strcmp( argv[arg], "-filter" ))
+		{
+			filter = argv[++arg];
+			continue;
+		}
+		printf( "Usage: SceneTests [-filter text]\n" );
+		return 1;
+	}
+
+	CTestRunner runner;
+	runner.SetFilter( filter );
+	AddNavGridTests( runner );
+	AddDeterminismTests( runner );
+
+	return static_cast<int>(runner.Run());
+}
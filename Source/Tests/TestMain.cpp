@@ -0,0 +1,39 @@
+/*******************************************
+	TestMain.cpp
+
+	Unit tests
+
+	Usage: Tests [-filter text]
+	  -filter  Only run tests whose "Group.Name" contains the text
+
+	Returns the number of failed tests, so 0 on success
+********************************************/
+
+#include <cstdio>
+#include <cstring>
+
+#include "Tests.h"
+
+using namespace gen;
+
+int main( int argc, char* argv[] )
+{
+	string filter;
+	for (int arg = 1; arg < argc; ++arg)
+	{
+		if (arg + 1 < argc && !strcmp( argv[arg], "-filter" ))
+		{
+			filter = argv[++arg];
+			continue;
+		}
+		printf( "Usage: Tests [-filter text]\n" );
+		return 1;
+	}
+
+	CTestRunner runner;
+	runner.SetFilter( filter );
+	AddGeometryTests( runner );
+	AddJobSystemTests( runner );
+
+	return static_cast<int>(runner.Run());
+}
@@ -0,0 +1,29 @@
+/*******************************************
+	Tests.h
+
+	Unit test suites, each adds its tests
+	to the runner
+********************************************/
+
+#pragma once
+
+#include "CTestRunner.h"
+
+namespace gen
+{
+
+// Geometry primitives and intersection tests, scalar against SSE versions
+void AddGeometryTests( CTestRunner& runner );
+
+// Job system tests - parallel for results, dependency ordering, child jobs and shutdown
+void AddJobSystemTests( CTestRunner& runner );
+
+// Navigation grid tests - paths, caching, the search budget, obstacle changes and flow fields.
+// These need the scene code, so are in the separate SceneTests program
+void AddNavGridTests( CTestRunner& runner );
+
+// Scene determinism tests - the simulation doesn't depend on the number of job threads. These
+// need the scene code and its meshes, so are in the separate SceneTests program
+void AddDeterminismTests( CTestRunner& runner );
+
+} // namespace gen
@@ -96,10 +96,23 @@ bool CParseLevel::ParseTemplatesElement(XMLElement* rootElement)
 		string mesh = attr->Value();
 
 
+		// Optional attribute marking scenery that blocks line of sight, defaults to false
+		bool isObstacle = false;
+		attr = element->FindAttribute("Obstacle");
+		if (attr != nullptr)  isObstacle = attr->BoolValue();
+
+		// Optional radius of the part of an obstacle that blocks movement, defaults to 0 (all of it)
+		float collisionRadius = 0.0f;
+		attr = element->FindAttribute("CollisionRadius");
+		if (attr != nullptr)  collisionRadius = attr->FloatValue();
+
+
 		// We can create the entity template now for most types, but not ships, which still need more data
 		if (type != "Tank")
 		{
-			m_EntityManager->CreateTemplate(type, name, mesh);
+			CEntityTemplate* entityTemplate = m_EntityManager->CreateTemplate(type, name, mesh);
+			entityTemplate->SetObstacle(isObstacle);
+			entityTemplate->SetCollisionRadius(collisionRadius);
 		}
 
 